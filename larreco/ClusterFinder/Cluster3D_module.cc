@@ -63,6 +63,8 @@
 #include "lardataobj/RecoBase/Seed.h"
 
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/ClusterHit3DIO.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/HoughSeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PCASeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/ParallelHitsSeedFinderAlg.h"
@@ -479,14 +481,17 @@ private:
     float                                                     m_clusterMergeTime;      ///< Keeps track of the time to merge clusters
     float                                                     m_pathFindingTime;       ///< Keeps track of the path finding time
     float                                                     m_finishTime;            ///< Keeps track of time to run output module
+    float                                                     m_arenaMemory;           ///< Keeps track of the event arena memory (kB)
     std::string                                               m_pathInstance;          ///< Special instance for path points
     std::string                                               m_vertexInstance;        ///< Special instance name for vertex points
     std::string                                               m_extremeInstance;       ///< Instance name for the extreme points
+    std::unique_ptr<ClusterHit3DWriter>                       m_hit3DWriter;           ///< Records the 3D hits for the benchmarks if requested
 
     /**
      *   Other useful variables
      */
     const detinfo::DetectorProperties*                        m_detector;              ///<  Pointer to the detector properties
+    EventArena                                                m_eventArena;            ///<  Memory for the 3D hit, cluster and edge containers of an event
 
     // Algorithms
     std::unique_ptr<lar_cluster3d::IHit3DBuilder>             m_hit3DBuilderAlg;       ///<  Builds the 3D hits to operate on
@@ -525,6 +530,10 @@ Cluster3D::Cluster3D(fhicl::ParameterSet const &pset) :
     m_vertexInstance       = pset.get<std::string>("VertexPointsName",      "Vertex");
     m_extremeInstance      = pset.get<std::string>("ExtremePointsName",    "Extreme");
 
+    std::string hit3DDumpFile = pset.get<std::string>("Hit3DDumpFile", "");
+
+    if (!hit3DDumpFile.empty()) m_hit3DWriter = std::make_unique<ClusterHit3DWriter>(hit3DDumpFile);
+
     m_hit3DBuilderAlg = art::make_tool<lar_cluster3d::IHit3DBuilder>(pset.get<fhicl::ParameterSet>("Hit3DBuilderAlg"));
     m_clusterAlg      = art::make_tool<lar_cluster3d::IClusterAlg>(pset.get<fhicl::ParameterSet>("ClusterAlg"));
     m_clusterMergeAlg = art::make_tool<lar_cluster3d::IClusterModAlg>(pset.get<fhicl::ParameterSet>("ClusterMergeAlg"));
@@ -598,6 +607,10 @@ void Cluster3D::produce(art::Event &evt)
     // This really only does anything if we are monitoring since it clears our tree variables
     this->PrepareEvent(evt);
 
+    // The 3D hit, cluster and edge containers of the event allocate from the event arena, which is
+    // released in one go when this scope ends (after the containers below have been destroyed)
+    EventArena::Scope arenaScope(m_eventArena);
+
     // Get instances of the primary data structures needed
     reco::ClusterParametersList          clusterParametersList;
     IHit3DBuilder::RecobHitToPtrMap      clusterHitToArtPtrMap;
@@ -606,6 +619,8 @@ void Cluster3D::produce(art::Event &evt)
     // Call the algorithm that builds 3D hits and stores the hit collection
     m_hit3DBuilderAlg->Hit3DBuilder(evt, *hitPairList, clusterHitToArtPtrMap);
 
+    if (m_hit3DWriter) m_hit3DWriter->Write(*hitPairList);
+
     // Call the main workhorse algorithm for building the local version of candidate 3D clusters
     m_clusterAlg->Cluster3DHits(*hitPairList, clusterParametersList);
 
@@ -645,12 +660,14 @@ void Cluster3D::produce(art::Event &evt)
         m_clusterMergeTime      = m_clusterMergeAlg->getTimeToExecute();
         m_pathFindingTime       = m_clusterPathAlg->getTimeToExecute();
         m_finishTime            = theClockFinish.accumulated_real_time();
+        m_arenaMemory           = m_eventArena.bytesReserved() / 1024.;
         m_hits                  = static_cast<int>(clusterHitToArtPtrMap.size());
         m_hits3D                = static_cast<int>(hitPairList->size());
         m_pRecoTree->Fill();
 
         mf::LogDebug("Cluster3D") << "*** Cluster3D total time: " << m_totalTime << ", art: " << m_artHitsTime << ", make: " << m_makeHitsTime
-        << ", build: " << m_buildNeighborhoodTime << ", clustering: " << m_dbscanTime << ", merge: " << m_clusterMergeTime << ", path: " << m_pathFindingTime << ", finish: " << m_finishTime << std::endl;
+        << ", build: " << m_buildNeighborhoodTime << ", clustering: " << m_dbscanTime << ", merge: " << m_clusterMergeTime << ", path: " << m_pathFindingTime << ", finish: " << m_finishTime
+        << ", arena: " << m_arenaMemory << " kB (max " << m_eventArena.highWaterMark() / 1024. << " kB)" << std::endl;
     }
 
     // Will we ever get here? ;-)
@@ -675,6 +692,7 @@ void Cluster3D::InitializeMonitoring()
     m_pRecoTree->Branch("clusterMergeTime",     &m_clusterMergeTime,      "time/F");
     m_pRecoTree->Branch("pathfindingtime",      &m_pathFindingTime,       "time/F");
     m_pRecoTree->Branch("finishTime",           &m_finishTime,            "time/F");
+    m_pRecoTree->Branch("arenaMemory",          &m_arenaMemory,           "memory/F");
 
     m_clusterPathAlg->initializeHistograms(*tfs.get());
 
@@ -696,6 +714,7 @@ void Cluster3D::PrepareEvent(const art::Event &evt)
     m_dbscanTime            = 0.f;
     m_pathFindingTime       = 0.f;
     m_finishTime            = 0.f;
+    m_arenaMemory           = 0.f;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
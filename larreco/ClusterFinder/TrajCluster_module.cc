@@ -191,6 +191,7 @@ namespace cluster {
   void TrajCluster::beginJob()
   {
     art::ServiceHandle<art::TFileService const> tfs;
+    tca::TCContextScope tcContext(fTCAlg.Context());
 
     showertree = tfs->make<TTree>("showervarstree", "showerVarsTree");
     fTCAlg.DefineShTree(showertree);
@@ -201,6 +202,7 @@ namespace cluster {
   //----------------------------------------------------------------------------
   void TrajCluster::endJob()
   {
+    tca::TCContextScope tcContext(fTCAlg.Context());
     std::vector<unsigned int> const& fAlgModCount = fTCAlg.GetAlgModCount();
     std::vector<std::string> const& fAlgBitNames = fTCAlg.GetAlgBitNames();
     if(fAlgBitNames.size() != fAlgModCount.size()) return;
@@ -225,7 +227,10 @@ namespace cluster {
     // 2D vertices (EndPoint2D), 3D vertices, PFParticles and Showers. These data products
     // are then collected and written to the event. Each slice is considered as an independent
     // collection of hits with the additional requirement that all hits in a slice reside in
-    // one TPC
+    // one TPC. The slices are reconstructed concurrently if TrajClusterAlg.ParallelSlices is set
+
+    // install the TrajClusterAlg state on this thread
+    tca::TCContextScope tcContext(fTCAlg.Context());
 
     // pointers to the slices in the event
     std::vector<art::Ptr<recob::Slice>> slices;
@@ -267,6 +272,9 @@ namespace cluster {
       auto const* geom = lar::providerFrom<geo::Geometry>();
       // a list of TPCs that will be considered when comparing with MC
       std::vector<unsigned int> tpcList;
+      // hits and IDs of the slices in all TPCs to be reconstructed
+      std::vector<std::vector<unsigned int>> slHitsVec;
+      std::vector<int> slHitsIDs;
       for(const auto& tpcid : geom->IterateTPCIDs()) {
         // only reconstruct hits in a user-selected TPC in debug mode
         if(tca::tcc.modes[tca::kDebug] && tca::tcc.recoTPC >= 0 && (short)tpcid.TPC != tca::tcc.recoTPC) continue;
@@ -323,11 +331,18 @@ namespace cluster {
               } // Look for debug hit
             } // iht
           } // tca::tcc.dbgStp
-          fTCAlg.RunTrajClusterAlg(tpcHits, slcIDs[isl]);
+          if(tca::tcc.modes[tca::kDebug]) {
+            // reconstruct now to keep the debug hit defined above
+            fTCAlg.RunTrajClusterAlg(tpcHits, slcIDs[isl]);
+          } else {
+            slHitsVec.push_back(std::move(tpcHits));
+            slHitsIDs.push_back(slcIDs[isl]);
+          }
           // this is only used for MC truth matching
           tpcList.push_back(tpcid.TPC);
         } // isl
       } // TPC
+      fTCAlg.RunTrajClusterAlg(slHitsVec, slHitsIDs);
       // stitch PFParticles between TPCs, create PFP start vertices, etc
       fTCAlg.FinishEvent();
       if(!evt.isRealData()) fTCAlg.fTM.MatchTruth(tpcList);
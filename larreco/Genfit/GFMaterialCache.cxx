@@ -0,0 +1,115 @@
+#include "larreco/Genfit/GFMaterialCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "larreco/Genfit/GFException.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
+
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMedium.h"
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+// margin against the tolerance of the geometry navigation (cm)
+static const double SafetyMargin = 1.E-6;
+
+genf::GFMaterialCache::GFMaterialCache(TGeoManager& geoManager, double voxelSize, std::size_t maxVoxels):
+  fVoxelSize(voxelSize) {
+
+  if (!(voxelSize > 0.) || (maxVoxels == 0))
+    throw GFException(std::string(__func__) + ": invalid voxel size or number of voxels", __LINE__, __FILE__).setFatal();
+
+  TGeoVolume* top = geoManager.GetTopVolume();
+  if (!top)
+    throw GFException(std::string(__func__) + ": no top volume", __LINE__, __FILE__).setFatal();
+  const TGeoBBox* box = static_cast<const TGeoBBox*>(top->GetShape()); // all shapes are boxes
+  const double halfSize[3] = { box->GetDX(), box->GetDY(), box->GetDZ() };
+  const double* origin = box->GetOrigin();
+
+  double nVoxels;
+  while(true){
+    nVoxels = 1.;
+    for(int i=0;i<3;++i){
+      fN[i] = std::max(1., std::ceil(2.*halfSize[i]/fVoxelSize));
+      nVoxels *= fN[i];
+    }
+    if(nVoxels <= maxVoxels) break;
+    fVoxelSize *= std::max(1.01, std::cbrt(nVoxels/maxVoxels));
+  }
+  for(int i=0;i<3;++i) fMin[i] = origin[i] - 0.5*fN[i]*fVoxelSize;
+
+  fSafety.resize(std::size_t(nVoxels));
+  fMaterial.resize(std::size_t(nVoxels), 0);
+
+  TGeoNavigator* nav = geoManager.GetCurrentNavigator();
+  if (!nav) nav = geoManager.AddNavigator();
+
+  std::map<const TGeoMaterial*, int> materialIndex; // -1 for materials that can't be cached
+  std::size_t index = 0;
+  for(unsigned int iz=0;iz<fN[2];++iz){
+    for(unsigned int iy=0;iy<fN[1];++iy){
+      for(unsigned int ix=0;ix<fN[0];++ix, ++index){
+        fSafety[index] = -1.;
+
+        nav->SetCurrentPoint(fMin[0]+(ix+0.5)*fVoxelSize, fMin[1]+(iy+0.5)*fVoxelSize, fMin[2]+(iz+0.5)*fVoxelSize);
+        if (!nav->FindNode() || nav->IsOutside()) continue;
+        TGeoMedium* medium = nav->GetCurrentVolume()->GetMedium();
+        if (!medium) continue; // GFMaterialEffects throws there
+
+        const TGeoMaterial* mat = medium->GetMaterial();
+        auto iMat = materialIndex.find(mat);
+        if (iMat == materialIndex.end()) {
+          int matIndex = -1;
+          try {
+            MaterialParameters params;
+            params.density              = mat->GetDensity();
+            params.Z                    = mat->GetZ();
+            params.A                    = mat->GetA();
+            params.radiationLength      = mat->GetRadLen();
+            params.meanExcitationEnergy = GFMaterialEffects::MeanExcEnergy_get(const_cast<TGeoMaterial*>(mat));
+            if (fMaterials.size() < 65535) {
+              matIndex = fMaterials.size();
+              fMaterials.push_back(params);
+            }
+          }
+          catch(GFException&) {} // left to the navigation, which throws if a track gets there
+          iMat = materialIndex.emplace(mat, matIndex).first;
+        }
+        if (iMat->second < 0) continue;
+
+        double safety = nav->Safety() - SafetyMargin;
+        if (safety <= 0.) continue;
+        float safetyF = safety;
+        if (safetyF > safety) safetyF = std::nextafter(safetyF, 0.f);
+        fSafety[index] = safetyF;
+        fMaterial[index] = iMat->second;
+      }
+    }
+  }
+}
+
+
+const genf::GFMaterialCache::MaterialParameters* genf::GFMaterialCache::find(double x, double y, double z, double dist) const {
+  const double pos[3] = { x, y, z };
+  unsigned int voxel[3];
+  double dist2 = 0.; // squared distance from the voxel centre
+  for(int i=0;i<3;++i){
+    const double u = (pos[i]-fMin[i])/fVoxelSize;
+    if (!(u >= 0.) || (u >= fN[i])) return NULL;
+    voxel[i] = (unsigned int)u;
+    const double d = (u-voxel[i]-0.5)*fVoxelSize;
+    dist2 += d*d;
+  }
+  const std::size_t index = (std::size_t(voxel[2])*fN[1] + voxel[1])*fN[0] + voxel[0];
+  const double safety = fSafety[index];
+  if (safety < 0.) return NULL;
+
+  // the sphere of radius dist around the point must be in the safety sphere of the centre
+  if (dist + std::sqrt(dist2) >= safety) return NULL;
+  return &fMaterials[fMaterial[index]];
+}
@@ -0,0 +1,68 @@
+/** @addtogroup RKTrackRep
+ * @{
+ */
+
+#ifndef GFMATERIALCACHE_H
+#define GFMATERIALCACHE_H
+
+#include <cstddef>
+#include <vector>
+
+class TGeoManager;
+
+namespace genf {
+
+/** @brief  Material parameters of the geometry on a regular grid of voxels
+ *
+ *  For each voxel of a grid covering the top volume of the geometry, the
+ *  cache stores the parameters of the material at the centre of the voxel
+ *  and the safety distance there, i.e. the distance from the centre to the
+ *  closest volume boundary. A straight step starting at a point of the voxel
+ *  then crosses no boundary if it stays in the safety sphere of the voxel:
+ *  in that case GFMaterialEffects takes the material from the cache and the
+ *  whole step at once, without navigating the geometry.
+ *
+ *  The cache is not modified after its construction and can be shared by
+ *  threads.
+ */
+
+class GFMaterialCache {
+ public:
+
+  struct MaterialParameters {
+    double density;
+    double Z;
+    double A;
+    double radiationLength;
+    double meanExcitationEnergy;
+  };
+
+  /** @brief Fills the cache from the geometry
+   *
+   *  The voxels are cubes of side voxelSize (cm), increased if needed so that
+   *  the grid is made of at most maxVoxels voxels.
+   */
+  GFMaterialCache(TGeoManager& geoManager, double voxelSize, std::size_t maxVoxels = 1 << 22);
+
+  //! Returns the material of a straight step of length dist from (x,y,z), NULL if the step may cross a boundary
+  const MaterialParameters* find(double x, double y, double z, double dist) const;
+
+  double voxelSize() const {return fVoxelSize;}
+  std::size_t nVoxels() const {return fSafety.size();}
+  std::size_t nMaterials() const {return fMaterials.size();}
+
+ private:
+  double fMin[3]; //!< lower corner of the grid
+  unsigned int fN[3]; //!< number of voxels on each axis
+  double fVoxelSize;
+
+  std::vector<float> fSafety; //!< safety at the voxel centres, rounded down; negative if not usable
+  std::vector<unsigned short> fMaterial; //!< index of the material of each voxel in fMaterials
+  std::vector<MaterialParameters> fMaterials;
+};
+
+} // end namespace
+
+#endif
+
+/** @} */
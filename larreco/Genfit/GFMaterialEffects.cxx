@@ -27,13 +27,15 @@
 #include "TGeoManager.h"
 #include "TGeoMaterial.h"
 #include "TGeoMedium.h"
+#include "TGeoNavigator.h"
 #include "TGeoVolume.h"
 #include "TMatrixT.h"
 #include "TMatrixTBase.h"
 #include "TMatrixTUtils.h"
 #include "TParticlePDG.h"
 
-genf::GFMaterialEffects* genf::GFMaterialEffects::finstance = NULL;
+thread_local std::unique_ptr<genf::GFMaterialEffects> genf::GFMaterialEffects::finstance;
+std::shared_ptr<const genf::GFMaterialCache> genf::GFMaterialEffects::fMaterialCache;
 
 
 
@@ -70,19 +72,17 @@ genf::GFMaterialEffects::GFMaterialEffects():
   fmEE(0),
   fpdg(0),
   fcharge(0),
-  fmass(0) {
+  fmass(0),
+  fparticlePdg(0) {
 }
 
 genf::GFMaterialEffects* genf::GFMaterialEffects::getInstance() {
-  if(finstance == NULL) finstance = new GFMaterialEffects();
-  return finstance;
+  if(!finstance) finstance.reset(new GFMaterialEffects());
+  return finstance.get();
 }
 
 void genf::GFMaterialEffects::destruct() {
-  if(finstance != NULL) {
-    delete finstance;
-    finstance = NULL;
-  }
+  finstance.reset();
 }
 
 double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
@@ -117,17 +117,32 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
       double step;
       */
 
-      gGeoManager->InitTrack(points.at(i-1).X(),points.at(i-1).Y(),points.at(i-1).Z(),
-			       dir.X(),dir.Y(),dir.Z());
+      // if the cache knows that no boundary is crossed, the segment is a single step
+      const GFMaterialCache::MaterialParameters* cached = fMaterialCache
+        ? fMaterialCache->find(points.at(i-1).X(),points.at(i-1).Y(),points.at(i-1).Z(), dist)
+        : NULL;
+
+      TGeoNavigator* nav = NULL;
+      if(cached==NULL){
+        nav = navigator();
+        nav->InitTrack(points.at(i-1).X(),points.at(i-1).Y(),points.at(i-1).Z(),
+                       dir.X(),dir.Y(),dir.Z());
+      }
 
       while(X<dist){
 
-	getParameters();
-	//        geoMatManager->getMaterialParameters(matDensity, matZ, matA, radiationLength, mEE);
+        if(cached!=NULL){
+          getParameters(*cached);
+          fstep = dist-X;
+        }
+        else{
+	  getParameters(nav);
+	  //        geoMatManager->getMaterialParameters(matDensity, matZ, matA, radiationLength, mEE);
 
-	//        step = geoMatManager->stepOrNextBoundary(dist-X);
-	gGeoManager->FindNextBoundaryAndStep(dist-X);
-        fstep = gGeoManager->GetStep();
+	  //        step = geoMatManager->stepOrNextBoundary(dist-X);
+	  nav->FindNextBoundaryAndStep(dist-X);
+          fstep = nav->GetStep();
+        }
 
         // Loop over EnergyLoss classes
         if(fmatZ>1.E-3){
@@ -192,7 +207,16 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
 
   static const double maxPloss = .005; // maximum relative momentum loss allowed
 
-  gGeoManager->InitTrack(posx,posy,posz,dirx,diry,dirz);
+  // if the cache knows that no boundary is crossed, the distance is a single step
+  const GFMaterialCache::MaterialParameters* cached = fMaterialCache
+    ? fMaterialCache->find(posx,posy,posz,maxDist)
+    : NULL;
+
+  TGeoNavigator* nav = NULL;
+  if(cached==NULL){
+    nav = navigator();
+    nav->InitTrack(posx,posy,posz,dirx,diry,dirz);
+  }
 
   double X(0.);
   double dP = 0.;
@@ -204,10 +228,16 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
 
   while(X<maxDist){
 
-    getParameters();
+    if(cached!=NULL){
+      getParameters(*cached);
+      fstep = maxDist-X;
+    }
+    else{
+      getParameters(nav);
 
-    gGeoManager->FindNextBoundaryAndStep(maxDist-X);
-    fstep = gGeoManager->GetStep();
+      nav->FindNextBoundaryAndStep(maxDist-X);
+      fstep = nav->GetStep();
+    }
     //
     //    step = geoMatManager->stepOrNextBoundary(maxDist-X);
 
@@ -252,24 +282,42 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
   return X;
 }
 
-void genf::GFMaterialEffects::getParameters(){
-  if (!gGeoManager->GetCurrentVolume()->GetMedium())
+void genf::GFMaterialEffects::getParameters(TGeoNavigator* nav){
+  if (!nav->GetCurrentVolume()->GetMedium())
     throw GFException(std::string(__func__) + ": no medium", __LINE__, __FILE__).setFatal();
-  TGeoMaterial * mat = gGeoManager->GetCurrentVolume()->GetMedium()->GetMaterial();
-  fmatDensity      = mat->GetDensity();
-  fmatZ            = mat->GetZ();
-  fmatA            = mat->GetA();
-  fradiationLength = mat->GetRadLen();
-  fmEE             = MeanExcEnergy_get(mat);
+  TGeoMaterial * mat = nav->GetCurrentVolume()->GetMedium()->GetMaterial();
+  GFMaterialCache::MaterialParameters params;
+  params.density              = mat->GetDensity();
+  params.Z                    = mat->GetZ();
+  params.A                    = mat->GetA();
+  params.radiationLength      = mat->GetRadLen();
+  params.meanExcitationEnergy = MeanExcEnergy_get(mat);
+  getParameters(params);
+}
+
+void genf::GFMaterialEffects::getParameters(const GFMaterialCache::MaterialParameters& mat){
+  fmatDensity      = mat.density;
+  fmatZ            = mat.Z;
+  fmatA            = mat.A;
+  fradiationLength = mat.radiationLength;
+  fmEE             = mat.meanExcitationEnergy;
 
   // You know what? F*ck it. Just force this to be LAr.... is what I *could/will* say here ....
   // See comment in energyLossBetheBloch() for why fmEE is in eV here.
   fmatDensity = 1.40; fmatZ = 18.0; fmatA = 39.95; fradiationLength=13.947; fmEE=188.0;
 
+  if(fpdg==0 || fpdg!=fparticlePdg){ // look the particle up only when it changes
+    TParticlePDG * part = TDatabasePDG::Instance()->GetParticle(fpdg);
+    fcharge = part->Charge()/(3.);
+    fmass = part->Mass();
+    fparticlePdg = fpdg;
+  }
+}
 
-  TParticlePDG * part = TDatabasePDG::Instance()->GetParticle(fpdg);
-  fcharge = part->Charge()/(3.);
-  fmass = part->Mass();
+TGeoNavigator* genf::GFMaterialEffects::navigator() const {
+  TGeoNavigator* nav = gGeoManager->GetCurrentNavigator();
+  if(nav==NULL) nav = gGeoManager->AddNavigator(); // first navigation in this thread
+  return nav;
 }
 
 
@@ -25,10 +25,14 @@
 #define GFMATERIALEFFECTS_H
 
 #include "TObject.h"
+#include <memory>
 #include <vector>
 #include "TVector3.h"
 
+#include "larreco/Genfit/GFMaterialCache.h"
+
 class TGeoMaterial;
+class TGeoNavigator;
 
 /** @brief  Handles energy loss classes. Contains stepper and energy loss/noise matrix calculation
  *
@@ -42,6 +46,15 @@ class TGeoMaterial;
  *  exceed a specified maximum momentum loss. After propagation, the energy loss
  *  for the given length and (optionally) the noise matrix can be calculated.
  *
+ *  The material along the steps is taken from the GFMaterialCache set with
+ *  setMaterialCache() where the cache knows that no volume boundary is
+ *  crossed, and from the navigation in gGeoManager otherwise.
+ *  An object keeps the state of the current calculation, so it must not be
+ *  used by more than one thread at a time: getInstance() returns a different
+ *  object in each thread. TGeoManager has a navigator per thread only in its
+ *  multi-thread mode, so gGeoManager->SetMaxThreads() must have been called
+ *  before material effects are computed in more than one thread; otherwise
+ *  all the threads share the same navigator.
  *
  */
 
@@ -50,14 +63,21 @@ namespace genf {
 class GFMaterialEffects : public TObject{
  private:
 
+  static thread_local std::unique_ptr<GFMaterialEffects> finstance;
+  static std::shared_ptr<const GFMaterialCache> fMaterialCache;
+
+ public:
   GFMaterialEffects();
   virtual ~GFMaterialEffects();
-  static GFMaterialEffects* finstance;
 
- public:
+  //! Returns the object of the calling thread
   static GFMaterialEffects* getInstance();
   static void destruct();
 
+  //! Sets the material cache used by all the objects; must not be called while tracks are extrapolated
+  static void setMaterialCache(std::shared_ptr<const GFMaterialCache> cache){fMaterialCache=cache;}
+  static const GFMaterialCache* getMaterialCache(){return fMaterialCache.get();}
+
   void setEnergyLossBetheBloch(bool opt = true){fEnergyLossBetheBloch=opt;}
   void setNoiseBetheBloch(bool opt = true){fNoiseBetheBloch=opt;}
   void setNoiseCoulomb(bool opt = true){fNoiseCoulomb=opt;}
@@ -99,7 +119,13 @@ class GFMaterialEffects : public TObject{
   //  std::vector<GFAbsEnergyLoss*> fEnergyLoss;
   //! interface to material and geometry
   //GFGeoMatManager *geoMatManager;
-  void getParameters();
+  //! sets the material parameters from the current volume of the navigator, and the particle ones
+  void getParameters(TGeoNavigator* nav);
+  //! sets the material parameters from the cache, and the particle ones
+  void getParameters(const GFMaterialCache::MaterialParameters& mat);
+
+  //! returns the navigator of the calling thread (the only one if gGeoManager is not multi-thread), adding one if needed
+  TGeoNavigator* navigator() const;
 
   //! sets fbeta, fgamma, fgammasquare; must only be used after calling getParameters()
   void calcBeta(double mom);
@@ -333,8 +359,12 @@ class GFMaterialEffects : public TObject{
    */
   void noiseBrems(const double& mom,
                         TMatrixT<double>* noise) const;
-  double MeanExcEnergy_get(int Z);
-  double MeanExcEnergy_get(TGeoMaterial*);
+
+ public:
+  static double MeanExcEnergy_get(int Z);
+  static double MeanExcEnergy_get(TGeoMaterial*);
+
+ private:
 
   bool fEnergyLossBetheBloch;
   bool fNoiseBetheBloch;
@@ -361,6 +391,7 @@ class GFMaterialEffects : public TObject{
   int fpdg;
   double fcharge;
   double fmass;
+  int fparticlePdg; // particle fcharge and fmass belong to
 
 
   // public:
@@ -378,14 +378,14 @@ void genf::RKTrackRep::extrapolateToPoint(const TVector3& pos,
 
   TVector3 point = o + fState[3][0]*u + fState[4][0]*v;
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = point.X();
-  state7[1][0] = point.Y();
-  state7[2][0] = point.Z();
-  state7[3][0] = pTilde.X();
-  state7[4][0] = pTilde.Y();
-  state7[5][0] = pTilde.Z();
-  state7[6][0] = fState[0][0];
+  double state7[7];
+  state7[0] = point.X();
+  state7[1] = point.Y();
+  state7[2] = point.Z();
+  state7[3] = pTilde.X();
+  state7[4] = pTilde.Y();
+  state7[5] = pTilde.Z();
+  state7[6] = fState[0][0];
 
   double coveredDistance(0.);
 
@@ -393,16 +393,16 @@ void genf::RKTrackRep::extrapolateToPoint(const TVector3& pos,
   int iterations(0);
 
   while(true){
-    pl.setON(pos,TVector3(state7[3][0],state7[4][0],state7[5][0]));
-    coveredDistance =  this->Extrap(pl,&state7);
+    pl.setON(pos,TVector3(state7[3],state7[4],state7[5]));
+    coveredDistance =  this->Extrap(pl,state7);
 
     if(fabs(coveredDistance)<MINSTEP) break;
     if(++iterations == maxIt) {
       throw GFException("RKTrackRep::extrapolateToPoint==> extrapolation to point failed, maximum number of iterations reached",__LINE__,__FILE__).setFatal();
     }
   }
-  poca.SetXYZ(state7[0][0],state7[1][0],state7[2][0]);
-  dirInPoca.SetXYZ(state7[3][0],state7[4][0],state7[5][0]);
+  poca.SetXYZ(state7[0],state7[1],state7[2]);
+  dirInPoca.SetXYZ(state7[3],state7[4],state7[5]);
 }
 
 
@@ -438,14 +438,14 @@ void genf::RKTrackRep::extrapolateToLine(const TVector3& point1,
 
   TVector3 point = o + fState[3][0]*u + fState[4][0]*v;
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = point.X();
-  state7[1][0] = point.Y();
-  state7[2][0] = point.Z();
-  state7[3][0] = pTilde.X();
-  state7[4][0] = pTilde.Y();
-  state7[5][0] = pTilde.Z();
-  state7[6][0] = fState[0][0];
+  double state7[7];
+  state7[0] = point.X();
+  state7[1] = point.Y();
+  state7[2] = point.Z();
+  state7[3] = pTilde.X();
+  state7[4] = pTilde.Y();
+  state7[5] = pTilde.Z();
+  state7[6] = fState[0][0];
 
   double coveredDistance(0.);
 
@@ -454,18 +454,18 @@ void genf::RKTrackRep::extrapolateToLine(const TVector3& point1,
 
   while(true){
     pl.setO(point1);
-    TVector3 currentDir(state7[3][0],state7[4][0],state7[5][0]);
+    TVector3 currentDir(state7[3],state7[4],state7[5]);
     pl.setU(currentDir.Cross(point2-point1));
     pl.setV(point2-point1);
-    coveredDistance = this->Extrap(pl,&state7);
+    coveredDistance = this->Extrap(pl,state7);
 
     if(fabs(coveredDistance)<MINSTEP) break;
     if(++iterations == maxIt) {
       throw GFException("RKTrackRep extrapolation to point failed, maximum number of iterations reached",__LINE__,__FILE__).setFatal();
     }
   }
-  poca.SetXYZ(state7[0][0],state7[1][0],state7[2][0]);
-  dirInPoca.SetXYZ(state7[3][0],state7[4][0],state7[5][0]);
+  poca.SetXYZ(state7[0],state7[1],state7[2]);
+  dirInPoca.SetXYZ(state7[3],state7[4],state7[5]);
   poca_onwire = poca2Line(point1,point2,poca);
 }
 
@@ -476,8 +476,7 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
                                TMatrixT<Double_t>& statePred,
                                TMatrixT<Double_t>& covPred){
 
-  TMatrixT<Double_t> cov7x7(7,7);
-  TMatrixT<Double_t> J_pM(7,5);
+  M7x5 J_pM; // zero by default
 
   TVector3 o=fRefPlane.getO();
   TVector3 u=fRefPlane.getU();
@@ -485,9 +484,9 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   TVector3 w=u.Cross(v);
   std::ostream* pOut = nullptr; // &std::cout if you really really want
 
-  J_pM[0][3] = u.X();J_pM[0][4]=v.X(); // dx/du
-  J_pM[1][3] = u.Y();J_pM[1][4]=v.Y();
-  J_pM[2][3] = u.Z();J_pM[2][4]=v.Z();
+  J_pM(0,3) = u.X();J_pM(0,4)=v.X(); // dx/du
+  J_pM(1,3) = u.Y();J_pM(1,4)=v.Y();
+  J_pM(2,3) = u.Z();J_pM(2,4)=v.Z();
 
   TVector3 pTilde = fSpu * (w + fState[1][0] * u + fState[2][0] * v);
   double pTildeMag = pTilde.Mag();
@@ -495,48 +494,50 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   //J_pM matrix is d(x,y,z,ax,ay,az,q/p) / d(q/p,u',v',u,v)
 
   // da_x/du'
-  J_pM[3][1] = fSpu/pTildeMag*(u.X()-pTilde.X()/(pTildeMag*pTildeMag)*u*pTilde);
-  J_pM[4][1] = fSpu/pTildeMag*(u.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*u*pTilde);
-  J_pM[5][1] = fSpu/pTildeMag*(u.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*u*pTilde);
+  J_pM(3,1) = fSpu/pTildeMag*(u.X()-pTilde.X()/(pTildeMag*pTildeMag)*u*pTilde);
+  J_pM(4,1) = fSpu/pTildeMag*(u.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*u*pTilde);
+  J_pM(5,1) = fSpu/pTildeMag*(u.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*u*pTilde);
   // da_x/dv'
-  J_pM[3][2] = fSpu/pTildeMag*(v.X()-pTilde.X()/(pTildeMag*pTildeMag)*v*pTilde);
-  J_pM[4][2] = fSpu/pTildeMag*(v.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*v*pTilde);
-  J_pM[5][2] = fSpu/pTildeMag*(v.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*v*pTilde);
+  J_pM(3,2) = fSpu/pTildeMag*(v.X()-pTilde.X()/(pTildeMag*pTildeMag)*v*pTilde);
+  J_pM(4,2) = fSpu/pTildeMag*(v.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*v*pTilde);
+  J_pM(5,2) = fSpu/pTildeMag*(v.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*v*pTilde);
   // dqOp/dqOp
-  J_pM[6][0] = 1.;
+  J_pM(6,0) = 1.;
 
-  TMatrixT<Double_t> J_pM_transp(J_pM);
-  J_pM_transp.T();
-
-  cov7x7 = J_pM*(fCov*J_pM_transp);
-  if (cov7x7[0][0]>=1000. || cov7x7[0][0]<1.E-50)
+  // the products are evaluated in the same order as with TMatrixT
+  M5x5 cov5x5(fCov.GetMatrixArray(), fCov.GetMatrixArray() + 25);
+  M5x7 covJ_pM_transp = cov5x5*ROOT::Math::Transpose(J_pM);
+  M7x7 cov7x7 = J_pM*covJ_pM_transp;
+  if (cov7x7(0,0)>=1000. || cov7x7(0,0)<1.E-50)
     {
       if (pOut) {
         (*pOut)  << "RKTrackRep::extrapolate(): cov7x7[0][0] is crazy. Rescale off-diags. Try again. fCov, cov7x7 were: " << std::endl;
         PrintROOTobject(*pOut, fCov);
-        PrintROOTobject(*pOut, cov7x7);
+        PrintROOTobject(*pOut, TMatrixT<Double_t>(7,7,cov7x7.Array()));
       }
       rescaleCovOffDiags();
-      cov7x7 = J_pM*(fCov*J_pM_transp);
+      cov5x5.SetElements(fCov.GetMatrixArray(), fCov.GetMatrixArray() + 25);
+      covJ_pM_transp = cov5x5*ROOT::Math::Transpose(J_pM);
+      cov7x7 = J_pM*covJ_pM_transp;
       if (pOut) {
         (*pOut) << "New cov7x7 and fCov are ... " << std::endl;
-        PrintROOTobject(*pOut, cov7x7);
+        PrintROOTobject(*pOut, TMatrixT<Double_t>(7,7,cov7x7.Array()));
         PrintROOTobject(*pOut, fCov);
       }
     }
 
 
   TVector3 pos = o + fState[3][0]*u + fState[4][0]*v;
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = pos.X();
-  state7[1][0] = pos.Y();
-  state7[2][0] = pos.Z();
-  state7[3][0] = pTilde.X()/pTildeMag;;
-  state7[4][0] = pTilde.Y()/pTildeMag;;
-  state7[5][0] = pTilde.Z()/pTildeMag;;
-  state7[6][0] = fState[0][0];
+  double state7[7];
+  state7[0] = pos.X();
+  state7[1] = pos.Y();
+  state7[2] = pos.Z();
+  state7[3] = pTilde.X()/pTildeMag;
+  state7[4] = pTilde.Y()/pTildeMag;
+  state7[5] = pTilde.Z()/pTildeMag;
+  state7[6] = fState[0][0];
 
-  double coveredDistance = this->Extrap(pl,&state7,&cov7x7);
+  double coveredDistance = this->Extrap(pl,state7,&cov7x7);
 
 
   TVector3 O = pl.getO();
@@ -544,42 +545,42 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   TVector3 V = pl.getV();
   TVector3 W = pl.getNormal();
 
-  double X = state7[0][0];
-  double Y = state7[1][0];
-  double Z = state7[2][0];
-  double AX = state7[3][0];
-  double AY = state7[4][0];
-  double AZ = state7[5][0];
-  double QOP = state7[6][0];
+  double X = state7[0];
+  double Y = state7[1];
+  double Z = state7[2];
+  double AX = state7[3];
+  double AY = state7[4];
+  double AZ = state7[5];
+  double QOP = state7[6];
   TVector3 A(AX,AY,AZ);
   TVector3 Point(X,Y,Z);
-  TMatrixT<Double_t> J_Mp(5,7);
+  M5x7 J_Mp; // zero by default
 
   // J_Mp matrix is d(q/p,u',v',u,v) / d(x,y,z,ax,ay,az,q/p)
-  J_Mp[0][6] = 1.;
+  J_Mp(0,6) = 1.;
   //du'/da_x
   double AtW = A*W;
-  J_Mp[1][3] = (U.X()*(AtW)-W.X()*(A*U))/(AtW*AtW);
-  J_Mp[1][4] = (U.Y()*(AtW)-W.Y()*(A*U))/(AtW*AtW);
-  J_Mp[1][5] = (U.Z()*(AtW)-W.Z()*(A*U))/(AtW*AtW);
+  J_Mp(1,3) = (U.X()*(AtW)-W.X()*(A*U))/(AtW*AtW);
+  J_Mp(1,4) = (U.Y()*(AtW)-W.Y()*(A*U))/(AtW*AtW);
+  J_Mp(1,5) = (U.Z()*(AtW)-W.Z()*(A*U))/(AtW*AtW);
   //dv'/da_x
-  J_Mp[2][3] = (V.X()*(AtW)-W.X()*(A*V))/(AtW*AtW);
-  J_Mp[2][4] = (V.Y()*(AtW)-W.Y()*(A*V))/(AtW*AtW);
-  J_Mp[2][5] = (V.Z()*(AtW)-W.Z()*(A*V))/(AtW*AtW);
+  J_Mp(2,3) = (V.X()*(AtW)-W.X()*(A*V))/(AtW*AtW);
+  J_Mp(2,4) = (V.Y()*(AtW)-W.Y()*(A*V))/(AtW*AtW);
+  J_Mp(2,5) = (V.Z()*(AtW)-W.Z()*(A*V))/(AtW*AtW);
   //du/dx
-  J_Mp[3][0] = U.X();
-  J_Mp[3][1] = U.Y();
-  J_Mp[3][2] = U.Z();
+  J_Mp(3,0) = U.X();
+  J_Mp(3,1) = U.Y();
+  J_Mp(3,2) = U.Z();
   //dv/dx
-  J_Mp[4][0] = V.X();
-  J_Mp[4][1] = V.Y();
-  J_Mp[4][2] = V.Z();
+  J_Mp(4,0) = V.X();
+  J_Mp(4,1) = V.Y();
+  J_Mp(4,2) = V.Z();
 
-  TMatrixT<Double_t> J_Mp_transp(J_Mp);
-  J_Mp_transp.T();
+  M7x5 const cov7x7J_Mp_transp = cov7x7*ROOT::Math::Transpose(J_Mp);
+  M5x5 const cov5x5Pred = J_Mp*cov7x7J_Mp_transp;
 
   covPred.ResizeTo(5,5);
-  covPred = J_Mp*(cov7x7*J_Mp_transp);
+  covPred.SetMatrixArray(cov5x5Pred.Array());
 
 
   statePred.ResizeTo(5,1);
@@ -612,29 +613,29 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
 
   TVector3 pos = o + fState[3][0]*u + fState[4][0]*v;
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = pos.X();
-  state7[1][0] = pos.Y();
-  state7[2][0] = pos.Z();
-  state7[3][0] = pTilde.X()/pTildeMag;
-  state7[4][0] = pTilde.Y()/pTildeMag;
-  state7[5][0] = pTilde.Z()/pTildeMag;
-  state7[6][0] = fState[0][0];
+  double state7[7];
+  state7[0] = pos.X();
+  state7[1] = pos.Y();
+  state7[2] = pos.Z();
+  state7[3] = pTilde.X()/pTildeMag;
+  state7[4] = pTilde.Y()/pTildeMag;
+  state7[5] = pTilde.Z()/pTildeMag;
+  state7[6] = fState[0][0];
 
   TVector3 O = pl.getO();
   TVector3 U = pl.getU();
   TVector3 V = pl.getV();
   TVector3 W = pl.getNormal();
 
-  double coveredDistance = this->Extrap(pl,&state7);
+  double coveredDistance = this->Extrap(pl,state7);
 
-  double X = state7[0][0];
-  double Y = state7[1][0];
-  double Z = state7[2][0];
-  double AX = state7[3][0];
-  double AY = state7[4][0];
-  double AZ = state7[5][0];
-  double QOP = state7[6][0];
+  double X = state7[0];
+  double Y = state7[1];
+  double Z = state7[2];
+  double AX = state7[3];
+  double AY = state7[4];
+  double AZ = state7[5];
+  double QOP = state7[6];
   TVector3 A(AX,AY,AZ);
   TVector3 Point(X,Y,Z);
 
@@ -1055,7 +1056,7 @@ bool genf::RKTrackRep::RKutta (const GFDetPlane& plane,
 
 
 
-double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* state, TMatrixT<Double_t>* cov) const {
+double genf::RKTrackRep::Extrap( const GFDetPlane& plane, double* state7, M7x7* cov) const {
 
   static const int maxNumIt(2000);
   int numIt(0);
@@ -1067,16 +1068,24 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
 //  else {} // not needed std::fill(P, P + 7, 0);
 
   for(int i=0;i<7;++i){
-    P[i] = (*state)[i][0];
+    P[i] = state7[i];
   }
 
-  TMatrixT<Double_t> jac(7,7);
-  TMatrixT<Double_t> jacT(7,7);
-  TMatrixT<Double_t> oldCov(7,7);
-  if(calcCov) oldCov=(*cov);
+  // the material effects get the jacobian and the noise as TMatrixT,
+  // which here only wrap the fixed-size matrices
+  M7x7 jac; // zero unless the covariance is propagated
+  M7x7 noise;
+  TMatrixT<Double_t> jacAdapter, noiseAdapter;
+  jacAdapter.Use(7,7,jac.Array());
+  noiseAdapter.Use(7,7,noise.Array());
+
   double coveredDistance(0.);
   double sumDistance(0.);
 
+  // reused in all the iterations
+  std::vector<TVector3> points, pointsFilt;
+  std::vector<double> pointPaths, pointPathsFilt;
+
   while(true){
     if(numIt++ > maxNumIt){
       throw GFException("RKTrackRep::Extrap ==> maximum number of iterations exceeded",
@@ -1088,28 +1097,13 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
       for(int i=0; i<6; ++i){
         P[(i+1)*7+i] = 1.;
       }
-      P[55] =  (*state)[6][0];
-    }
-
-//    double dir(1.);
-    {
-      TVector3 Pvect(P[0],P[1],P[2]); //position
-      TVector3 Avect(P[3],P[4],P[5]); //direction
-      TVector3 dist = plane.dist(Pvect); //from point to plane
-      //      std::cout << "RKTrackRep::Extrap(): Position, Direction, Plane, dist " << std::endl;
-      //Pvect.Print();
-      //Avect.Print();
-      //plane.Print();
-      //dist.Print();
- //     if(dist*Avect<0.) dir=-1.;
+      P[55] =  state7[6];
     }
 
     TVector3 directionBefore(P[3],P[4],P[5]); // direction before propagation
     directionBefore.SetMag(1.);
 
     // propagation
-    std::vector<TVector3> points;
-    std::vector<double> pointPaths;
     if( ! this->RKutta(plane,P,coveredDistance,points,pointPaths,-1.,calcCov) ) { // maxLen currently not used
       //GFException exc("RKTrackRep::Extrap ==>  Runge Kutta propagation failed",__LINE__,__FILE__);
 
@@ -1126,8 +1120,8 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
     sumDistance+=coveredDistance;
 
     // filter Points
-    std::vector<TVector3> pointsFilt(1, points.at(0));
-    std::vector<double> pointPathsFilt(1, 0.);
+    pointsFilt.assign(1, points.at(0));
+    pointPathsFilt.assign(1, 0.);
     // only if in right direction
     for(unsigned int i=1;i<points.size();++i){
       if (pointPaths.at(i) * coveredDistance > 0.) {
@@ -1158,40 +1152,26 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
       throw GFException("RKTrackRep::Extrap ==> fabs(checkSum-coveredDistance)>1.E-7",__LINE__,__FILE__).setFatal();
     }
 
-    if(calcCov){ //calculate Jacobian jac
-      for(int i=0;i<7;++i){
-	      for(int j=0;j<7;++j){
-	        if(i<6) jac[i][j] = P[ (i+1)*7+j ];
-	        else jac[i][j] = P[ (i+1)*7+j ]/P[6];
-	      }
+    if(calcCov){ //calculate Jacobian jac in place from the derivatives in P
+      double* J = jac.Array();
+      for(int i=0;i<6;++i){
+        for(int j=0;j<7;++j) J[i*7+j] = P[ (i+1)*7+j ];
       }
-      jacT = jac;
-      jacT.T();
+      for(int j=0;j<7;++j) J[6*7+j] = P[ 7*7+j ]/P[6];
     }
 
-    TMatrixT<Double_t> noise(7,7); // zero everywhere by default
+    noise = M7x7(); // zero everywhere by default
 
     // call MatEffects
     double momLoss; // momLoss has a sign - negative loss means momentum gain
 
-    /*
-    momLoss = fEffect->effects(pointsFilt,
-                               pointPathsFilt,
-                               fabs(fCharge/P[6]), // momentum
-                               fPdg,
-                               calcCov,
-                               &noise,
-                               &jac,
-                               &directionBefore,
-                               &directionAfter);
-    */
     momLoss = GFMaterialEffects::getInstance()->effects(pointsFilt,
                                pointPathsFilt,
                                fabs(fCharge/P[6]), // momentum
                                fPdg,
                                calcCov,
-                               &noise,
-                               &jac,
+                               &noiseAdapter,
+                               &jacAdapter,
                                &directionBefore,
                                &directionAfter);
 
@@ -1200,8 +1180,8 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
     }
 
     if(calcCov){ //propagate cov and add noise
-      oldCov = *cov;
-      *cov = jacT*((oldCov)*jac)+noise;
+      M7x7 const oldCovJac = (*cov)*jac;
+      *cov = ROOT::Math::Transpose(jac)*oldCovJac+noise;
     }
 
 
@@ -1211,10 +1191,9 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
       if(plane.distance(P[0],P[1],P[2])<MINSTEP) break;
     }
   }
-  (*state)[0][0] = P[0];  (*state)[1][0] = P[1];
-  (*state)[2][0] = P[2];  (*state)[3][0] = P[3];
-  (*state)[4][0] = P[4];  (*state)[5][0] = P[5];
-  (*state)[6][0] = P[6];
+  for(int i=0;i<7;++i){
+    state7[i] = P[i];
+  }
 
   return sumDistance;
 }
@@ -32,6 +32,7 @@
 #include "larreco/Genfit/GFAbsTrackRep.h"
 #include "larreco/Genfit/GFDetPlane.h"
 #include <TMatrixT.h>
+#include "Math/SMatrix.h"
 
 namespace genf { class GFTrackCand; }
 
@@ -164,6 +165,15 @@ class RKTrackRep : public GFAbsTrackRep {
 
  private:
 
+  //@{
+  /// Fixed-size matrices of the propagation in the 7-dimensional global
+  /// (x,y,z,ax,ay,az,q/p) and 5-dimensional plane (q/p,u',v',u,v) coordinates
+  typedef ROOT::Math::SMatrix<double,7,7> M7x7;
+  typedef ROOT::Math::SMatrix<double,7,5> M7x5;
+  typedef ROOT::Math::SMatrix<double,5,7> M5x7;
+  typedef ROOT::Math::SMatrix<double,5,5> M5x5;
+  //@}
+
   GFDetPlane fCachePlane;
   double fCacheSpu;
   double fSpu;
@@ -205,8 +215,11 @@ class RKTrackRep : public GFAbsTrackRep {
     * so that the direction doesn't change and tiny steps are filtered out. After the propagation the material effects in #fEffect are called.
     * Extrap() will loop until the plane is reached, unless the propagation fails or the maximum number of
     * iterations is exceeded.
+    * The state (x,y,z,ax,ay,az,q/p) is updated in place, and so is the covariance if given; the
+    * jacobian and the noise of each step are kept in fixed-size matrices, which the material effects
+    * see through TMatrixT adapters, so that no matrix is allocated during the propagation.
     */
-  double Extrap(const GFDetPlane& plane, TMatrixT<Double_t>* state, TMatrixT<Double_t>* cov=NULL) const;
+  double Extrap(const GFDetPlane& plane, double* state7, M7x7* cov=NULL) const;
 
 
   //  void setData(const TMatrixT<Double_t>& /* st */, const GFDetPlane& /* pl */, const TMatrixT<Double_t>* cov=NULL, const TMatrixT<double>* aux=NULL);
@@ -25,9 +25,11 @@
 
 // C/C++ standard library
 #include <algorithm> // std::accumulate()
+#include <functional> // std::function
 #include <string>
 #include <memory> // std::unique_ptr()
 #include <utility> // std::move()
+#include <vector>
 
 // Framework includes
 #include "art/Framework/Core/ModuleMacros.h"
@@ -37,6 +39,8 @@
 #include "art_root_io/TFileService.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "art/Utilities/make_tool.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 // LArSoft Includes
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
@@ -52,6 +56,11 @@
 // ROOT Includes
 #include "TH1F.h"
 #include "TMath.h"
+#include "TROOT.h"
+
+// TBB Includes
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 
 namespace hit{
 class GausHitFinder : public art::EDProducer {
@@ -67,7 +76,23 @@ private:
 
     void FillOutHitParameterVector(const std::vector<double>& input, std::vector<double>& output);
 
+    /// Hits found on a single wire, together with the fit quality of each pulse train
+    struct WireHits
+    {
+        std::vector<recob::Hit> allHits;           ///< all hits found on the wire
+        std::vector<recob::Hit> filteredHits;      ///< hits surviving the pulse train filter and HitFilterAlg
+        std::vector<double>     firstChi2Vec;      ///< chi2/NDF of the first fit of each pulse train
+        std::vector<double>     chi2Vec;           ///< final chi2/NDF of each pulse train
+    };
+
+    using ChargeFunc = std::function<double (double,double,double,double,int,int)>;
+
+    /// Finds and fits the hits on one wire; touches no module state so may run concurrently
+    void findWireHits(const recob::Wire&, const geo::GeometryCore&, const ChargeFunc&, WireHits&) const;
+
     bool                fFilterHits;
+    bool                fParallelHitFinding;       ///< process wires concurrently (refused unless all the tools are thread safe)
+    size_t              fWireGrainSize;            ///< number of wires handed to a task at a time
 
     std::string         fCalDataModuleLabel;
     std::string         fAllHitsInstanceName;
@@ -105,6 +130,8 @@ GausHitFinder::GausHitFinder(fhicl::ParameterSet const& pset)
     fCalDataModuleLabel  = pset.get< std::string >("CalDataModuleLabel");
     fAllHitsInstanceName = pset.get< std::string >("AllHitsInstanceName","");
     fFilterHits          = pset.get< bool        >("FilterHits",false);
+    fParallelHitFinding  = pset.get< bool        >("ParallelHitFinding",false);
+    fWireGrainSize       = pset.get< size_t      >("WireGrainSize",16);
 
     if (fFilterHits) {
         fHitFilterAlg = std::make_unique<HitFilterAlg>(pset.get<fhicl::ParameterSet>("HitFilterAlg"));
@@ -139,6 +166,26 @@ GausHitFinder::GausHitFinder(fhicl::ParameterSet const& pset)
     // Recover the peak fitting tool
     fPeakFitterTool = art::make_tool<reco_tool::IPeakFitter>(pset.get<fhicl::ParameterSet>("PeakFitter"));
 
+    // The tools are shared by all the tasks, each of them has to allow it (e.g. no histograms).
+    // The fits are done with ROOT objects, make sure ROOT guards its global state
+    if (fParallelHitFinding)
+    {
+        for(size_t planeIdx = 0; planeIdx < fHitFinderToolVec.size(); planeIdx++)
+        {
+            if (fHitFinderToolVec[planeIdx] && !fHitFinderToolVec[planeIdx]->IsThreadSafe())
+                throw cet::exception("GausHitFinder") << "ParallelHitFinding is set, but the candidate hit finder tool of plane "
+                                                      << planeIdx << " is not thread safe (histogram or waveform output?)\n";
+        }
+
+        if (!fPeakFitterTool->IsThreadSafe())
+            throw cet::exception("GausHitFinder") << "ParallelHitFinding is set, but the peak fitter tool is not thread safe"
+                                                  << " (histogram output, or a non reentrant minimizer?)\n";
+
+        ROOT::EnableThreadSafety();
+
+        mf::LogInfo("GausHitFinder") << "Running parallel hit finding with a grain size of " << fWireGrainSize << " wires";
+    }
+
     // let HitCollectionCreator declare that we are going to produce
     // hits and associations with wires and raw digits
     // We want the option to output two hit collections, one filtered
@@ -190,6 +237,261 @@ void GausHitFinder::beginJob()
     fChi2	        = tfs->make<TH1F>("fChi2", "#chi^{2}", 10000, 0, 5000);
 }
 
+//-------------------------------------------------
+//-------------------------------------------------
+void GausHitFinder::findWireHits(const recob::Wire&       wire,
+                                 const geo::GeometryCore& geom,
+                                 const ChargeFunc&        chargeFunc,
+                                 WireHits&                wireHits) const
+{
+    // --- Setting Channel Number and Signal type ---
+    raw::ChannelID_t channel = wire.Channel();
+
+    // get the WireID for this hit
+    std::vector<geo::WireID> wids = geom.ChannelToWire(channel);
+    // for now, just take the first option returned from ChannelToWire
+    geo::WireID wid  = wids[0];
+    // We need to know the plane to look up parameters
+    geo::PlaneID::PlaneID_t plane = wid.Plane;
+
+    // ----------------------------------------------------------
+    // -- Setting the appropriate signal widths and thresholds --
+    // --    for the right plane.      --
+    // ----------------------------------------------------------
+
+    // #################################################
+    // ### Set up to loop over ROI's for this wire   ###
+    // #################################################
+    const recob::Wire::RegionsOfInterest_t& signalROI = wire.SignalROI();
+
+    for(const auto& range : signalROI.get_ranges())
+    {
+        // ROI start time
+        raw::TDCtick_t roiFirstBinTick = range.begin_index();
+
+        // ###########################################################
+        // ### Scan the waveform and find candidate peaks + merge  ###
+        // ###########################################################
+
+        reco_tool::ICandidateHitFinder::HitCandidateVec      hitCandidateVec;
+        reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
+
+        fHitFinderToolVec.at(plane)->findHitCandidates(range, 0, channel, fEventCount, hitCandidateVec);
+        fHitFinderToolVec.at(plane)->MergeHitCandidates(range, hitCandidateVec, mergedCandidateHitVec);
+
+        // #######################################################
+        // ### Lets loop over the pulses we found on this wire ###
+        // #######################################################
+
+        for(auto& mergedCands : mergedCandidateHitVec)
+        {
+            int startT= mergedCands.front().startTick;
+            int endT  = mergedCands.back().stopTick;
+
+            // ### Putting in a protection in case things went wrong ###
+            // ### In the end, this primarily catches the case where ###
+            // ### a fake pulse is at the start of the ROI           ###
+            if (endT - startT < 5) continue;
+
+            // #######################################################
+            // ### Clearing the parameter vector for the new pulse ###
+            // #######################################################
+
+            // === Setting the number of Gaussians to try ===
+            int nGausForFit = mergedCands.size();
+
+            // ##################################################
+            // ### Calling the function for fitting Gaussians ###
+            // ##################################################
+            double                                chi2PerNDF(0.);
+            int                                   NDF(1);
+		/*stand alone
+            reco_tool::IPeakFitter::PeakParamsVec peakParamsVec(nGausForFit);
+		*/
+            reco_tool::IPeakFitter::PeakParamsVec peakParamsVec;
+
+            // #######################################################
+            // ### If # requested Gaussians is too large then punt ###
+            // #######################################################
+            if (mergedCands.size() <= fMaxMultiHit)
+            {
+                fPeakFitterTool->findPeakParameters(range.data(), mergedCands, peakParamsVec, chi2PerNDF, NDF);
+
+                // If the chi2 is infinite then there is a real problem so we bail
+                if (!(chi2PerNDF < std::numeric_limits<double>::infinity()))
+                {
+                    chi2PerNDF = 2.*fChi2NDF;
+                    NDF        = 2;
+                }
+
+                wireHits.firstChi2Vec.push_back(chi2PerNDF);
+            }
+
+            // #######################################################
+            // ### If too large then force alternate solution      ###
+            // ### - Make n hits from pulse train where n will     ###
+            // ###   depend on the fhicl parameter fLongPulseWidth ###
+            // ### Also do this if chi^2 is too large              ###
+            // #######################################################
+            if (mergedCands.size() > fMaxMultiHit || nGausForFit * chi2PerNDF > fChi2NDF)
+            {
+                int longPulseWidth = fLongPulseWidthVec.at(plane);
+                int nHitsThisPulse = (endT - startT) / longPulseWidth;
+
+                if (nHitsThisPulse > fLongMaxHitsVec.at(plane))
+                {
+                    nHitsThisPulse = fLongMaxHitsVec.at(plane);
+                    longPulseWidth = (endT - startT) / nHitsThisPulse;
+                }
+
+                if (nHitsThisPulse * longPulseWidth < endT - startT) nHitsThisPulse++;
+
+                int firstTick = startT;
+                int lastTick  = std::min(firstTick + longPulseWidth, endT);
+
+                peakParamsVec.clear();
+                nGausForFit = nHitsThisPulse;
+                NDF         = 1.;
+                chi2PerNDF  =  chi2PerNDF > fChi2NDF ? chi2PerNDF : -1.;
+
+                for(int hitIdx = 0; hitIdx < nHitsThisPulse; hitIdx++)
+                {
+                    // This hit parameters
+                    double sumADC    = std::accumulate(range.begin() + firstTick, range.begin() + lastTick, 0.);
+                    double peakSigma = (lastTick - firstTick) / 3.;  // Set the width...
+                    double peakAmp   = 0.3989 * sumADC / peakSigma;  // Use gaussian formulation
+                    double peakMean  = (firstTick + lastTick) / 2.;
+
+                    // Store hit params
+                    reco_tool::IPeakFitter::PeakFitParams_t peakParams;
+
+                    peakParams.peakCenter         = peakMean;
+                    peakParams.peakCenterError    = 0.1 * peakMean;
+                    peakParams.peakSigma          = peakSigma;
+                    peakParams.peakSigmaError     = 0.1 * peakSigma;
+                    peakParams.peakAmplitude      = peakAmp;
+                    peakParams.peakAmplitudeError = 0.1 * peakAmp;
+
+                    peakParamsVec.push_back(peakParams);
+
+                    // set for next loop
+                    firstTick = lastTick;
+                    lastTick  = std::min(lastTick  + longPulseWidth, endT);
+                }
+            }
+
+            // #######################################################
+            // ### Loop through returned peaks and make recob hits ###
+            // #######################################################
+
+            int numHits(0);
+
+            // Make a container for what will be the filtered collection
+            std::vector<recob::Hit> filteredHitVec;
+
+            for(const auto& peakParams : peakParamsVec)
+            {
+                // Extract values for this hit
+                float peakAmp   = peakParams.peakAmplitude;
+                float peakMean  = peakParams.peakCenter;
+                float peakWidth = peakParams.peakSigma;
+
+                // Place one bit of protection here
+                if (std::isnan(peakAmp))
+                {
+                    mf::LogWarning("GausHitFinder") << "**** hit peak amplitude is a nan! Channel: " << channel << ", start tick: " << startT;
+                    continue;
+                }
+
+                // Extract errors
+                float peakAmpErr   = peakParams.peakAmplitudeError;
+                float peakMeanErr  = peakParams.peakCenterError;
+                float peakWidthErr = peakParams.peakSigmaError;
+
+                // ### Charge ###
+                float charge    = chargeFunc(peakMean, peakAmp, peakWidth, fAreaNormsVec[plane],startT,endT);;
+                float chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
+
+                // ### limits for getting sums
+                std::vector<float>::const_iterator sumStartItr = range.begin() + startT;
+                std::vector<float>::const_iterator sumEndItr   = range.begin() + endT;
+
+                // ### Sum of ADC counts
+                double sumADC = std::accumulate(sumStartItr, sumEndItr, 0.);
+
+                // ok, now create the hit
+                recob::HitCreator hitcreator(wire,                             // wire reference
+                                             wid,                              // wire ID
+                                             startT+roiFirstBinTick,           // start_tick TODO check
+                                             endT+roiFirstBinTick,             // end_tick TODO check
+                                             peakWidth,                        // rms
+                                             peakMean+roiFirstBinTick,         // peak_time
+                                             peakMeanErr,                      // sigma_peak_time
+                                             peakAmp,                          // peak_amplitude
+                                             peakAmpErr,                       // sigma_peak_amplitude
+                                             charge,                           // hit_integral
+                                             chargeErr,                        // hit_sigma_integral
+                                             sumADC,                           // summedADC FIXME
+                                             nGausForFit,                      // multiplicity
+                                             numHits,                          // local_index TODO check that the order is correct
+                                             chi2PerNDF,                       // goodness_of_fit
+                                             NDF                               // dof
+                                             );
+
+                filteredHitVec.push_back(hitcreator.copy());
+
+                // This loop will store ALL hits
+                wireHits.allHits.emplace_back(hitcreator.move());
+                numHits++;
+            } // <---End loop over gaussians
+
+            // Should we filter hits?
+            if (fFilterHits && !filteredHitVec.empty())
+            {
+                // #######################################################################
+                // Is all this sorting really necessary?  Would it be faster to just loop
+                // through the hits and perform simple cuts on amplitude and width on a
+                // hit-by-hit basis, either here in the module (using fPulseHeightCuts and
+                // fPulseWidthCuts) or in HitFilterAlg?
+                // #######################################################################
+
+                // Sort in ascending peak height
+                std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakAmplitude() > right.PeakAmplitude();});
+
+                // Reject if the first hit fails the PH/wid cuts
+                if (filteredHitVec.front().PeakAmplitude() < fPulseHeightCuts.at(plane) || filteredHitVec.front().RMS() < fPulseWidthCuts.at(plane)) filteredHitVec.clear();
+
+                // Now check other hits in the snippet
+                if (filteredHitVec.size() > 1)
+                {
+                    // The largest pulse height will now be at the front...
+                    float largestPH = filteredHitVec.front().PeakAmplitude();
+
+                    // Find where the pulse heights drop below threshold
+                    float threshold(fPulseRatioCuts.at(plane));
+
+                    std::vector<recob::Hit>::iterator smallHitItr = std::find_if(filteredHitVec.begin(),filteredHitVec.end(),[largestPH,threshold](const auto& hit){return hit.PeakAmplitude() < 8. && hit.PeakAmplitude() / largestPH < threshold;});
+
+                    // Shrink to fit
+                    if (smallHitItr != filteredHitVec.end()) filteredHitVec.resize(std::distance(filteredHitVec.begin(),smallHitItr));
+
+                    // Resort in time order
+                    std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakTime() < right.PeakTime();});
+                }
+
+                // Copy the hits we want to keep to the filtered hit collection
+                for(const auto& filteredHit : filteredHitVec)
+                    if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit))
+                        wireHits.filteredHits.push_back(filteredHit);
+            }
+
+            wireHits.chi2Vec.push_back(chi2PerNDF);
+
+        }//<---End loop over merged candidate hits
+
+    } //<---End looping over ROI's
+}
+
 //  This algorithm uses the fact that deconvolved signals are very smooth
 //  and looks for hits as areas between local minima that have signal above
 //  threshold.
@@ -229,14 +531,11 @@ void GausHitFinder::produce(art::Event& evt)
     art::Handle< std::vector<recob::Wire> > wireVecHandle;
     evt.getByLabel(fCalDataModuleLabel,wireVecHandle);
 
-    // Channel Number
-    raw::ChannelID_t channel = raw::InvalidChannelID;
-
     //#################################################
     //###    Set the charge determination method    ###
     //### Default is to compute the normalized area ###
     //#################################################
-    std::function<double (double,double,double,double,int,int)> chargeFunc = [](double peakMean, double peakAmp, double peakWidth, double areaNorm, int low, int hi){return std::sqrt(2*TMath::Pi())*peakAmp*peakWidth/areaNorm;};
+    ChargeFunc chargeFunc = [](double peakMean, double peakAmp, double peakWidth, double areaNorm, int low, int hi){return std::sqrt(2*TMath::Pi())*peakAmp*peakWidth/areaNorm;};
 
     //##############################################
     //### Alternative is to integrate over pulse ###
@@ -253,264 +552,51 @@ void GausHitFinder::produce(art::Event& evt)
     //##############################
     //### Looping over the wires ###
     //##############################
-    for(size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++)
-    {
-        // ####################################
-        // ### Getting this particular wire ###
-        // ####################################
-        art::Ptr<recob::Wire>   wire(wireVecHandle, wireIter);
-
-        // --- Setting Channel Number and Signal type ---
-        channel = wire->Channel();
-
-        // get the WireID for this hit
-        std::vector<geo::WireID> wids = geom->ChannelToWire(channel);
-        // for now, just take the first option returned from ChannelToWire
-        geo::WireID wid  = wids[0];
-        // We need to know the plane to look up parameters
-        geo::PlaneID::PlaneID_t plane = wid.Plane;
-
-        // ----------------------------------------------------------
-        // -- Setting the appropriate signal widths and thresholds --
-        // --    for the right plane.      --
-        // ----------------------------------------------------------
-
-        // #################################################
-        // ### Set up to loop over ROI's for this wire   ###
-        // #################################################
-        const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
-
-        for(const auto& range : signalROI.get_ranges())
-        {
-            // ROI start time
-            raw::TDCtick_t roiFirstBinTick = range.begin_index();
-
-            // ###########################################################
-            // ### Scan the waveform and find candidate peaks + merge  ###
-            // ###########################################################
+    size_t const nWires = wireVecHandle->size();
 
-            reco_tool::ICandidateHitFinder::HitCandidateVec      hitCandidateVec;
-            reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
-
-            fHitFinderToolVec.at(plane)->findHitCandidates(range, 0, channel, fEventCount, hitCandidateVec);
-            fHitFinderToolVec.at(plane)->MergeHitCandidates(range, hitCandidateVec, mergedCandidateHitVec);
-
-            // #######################################################
-            // ### Lets loop over the pulses we found on this wire ###
-            // #######################################################
-
-            for(auto& mergedCands : mergedCandidateHitVec)
-            {
-                int startT= mergedCands.front().startTick;
-                int endT  = mergedCands.back().stopTick;
-
-                // ### Putting in a protection in case things went wrong ###
-                // ### In the end, this primarily catches the case where ###
-                // ### a fake pulse is at the start of the ROI           ###
-                if (endT - startT < 5) continue;
-
-                // #######################################################
-                // ### Clearing the parameter vector for the new pulse ###
-                // #######################################################
-
-                // === Setting the number of Gaussians to try ===
-                int nGausForFit = mergedCands.size();
-
-                // ##################################################
-                // ### Calling the function for fitting Gaussians ###
-                // ##################################################
-                double                                chi2PerNDF(0.);
-                int                                   NDF(1);
-		/*stand alone
-                reco_tool::IPeakFitter::PeakParamsVec peakParamsVec(nGausForFit);
-		*/
-                reco_tool::IPeakFitter::PeakParamsVec peakParamsVec;
-
-                // #######################################################
-                // ### If # requested Gaussians is too large then punt ###
-                // #######################################################
-                if (mergedCands.size() <= fMaxMultiHit)
-                {
-                    fPeakFitterTool->findPeakParameters(range.data(), mergedCands, peakParamsVec, chi2PerNDF, NDF);
-
-                    // If the chi2 is infinite then there is a real problem so we bail
-                    if (!(chi2PerNDF < std::numeric_limits<double>::infinity()))
-                    {
-                        chi2PerNDF = 2.*fChi2NDF;
-                        NDF        = 2;
-                    }
-
-                    fFirstChi2->Fill(chi2PerNDF);
-                }
-
-                // #######################################################
-                // ### If too large then force alternate solution      ###
-                // ### - Make n hits from pulse train where n will     ###
-                // ###   depend on the fhicl parameter fLongPulseWidth ###
-                // ### Also do this if chi^2 is too large              ###
-                // #######################################################
-                if (mergedCands.size() > fMaxMultiHit || nGausForFit * chi2PerNDF > fChi2NDF)
-                {
-                    int longPulseWidth = fLongPulseWidthVec.at(plane);
-                    int nHitsThisPulse = (endT - startT) / longPulseWidth;
-
-                    if (nHitsThisPulse > fLongMaxHitsVec.at(plane))
-                    {
-                        nHitsThisPulse = fLongMaxHitsVec.at(plane);
-                        longPulseWidth = (endT - startT) / nHitsThisPulse;
-                    }
-
-                    if (nHitsThisPulse * longPulseWidth < endT - startT) nHitsThisPulse++;
-
-                    int firstTick = startT;
-                    int lastTick  = std::min(firstTick + longPulseWidth, endT);
-
-                    peakParamsVec.clear();
-                    nGausForFit = nHitsThisPulse;
-                    NDF         = 1.;
-                    chi2PerNDF  =  chi2PerNDF > fChi2NDF ? chi2PerNDF : -1.;
-
-                    for(int hitIdx = 0; hitIdx < nHitsThisPulse; hitIdx++)
-                    {
-                        // This hit parameters
-                        double sumADC    = std::accumulate(range.begin() + firstTick, range.begin() + lastTick, 0.);
-                        double peakSigma = (lastTick - firstTick) / 3.;  // Set the width...
-                        double peakAmp   = 0.3989 * sumADC / peakSigma;  // Use gaussian formulation
-                        double peakMean  = (firstTick + lastTick) / 2.;
-
-                        // Store hit params
-                        reco_tool::IPeakFitter::PeakFitParams_t peakParams;
-
-                        peakParams.peakCenter         = peakMean;
-                        peakParams.peakCenterError    = 0.1 * peakMean;
-                        peakParams.peakSigma          = peakSigma;
-                        peakParams.peakSigmaError     = 0.1 * peakSigma;
-                        peakParams.peakAmplitude      = peakAmp;
-                        peakParams.peakAmplitudeError = 0.1 * peakAmp;
-
-                        peakParamsVec.push_back(peakParams);
-
-                        // set for next loop
-                        firstTick = lastTick;
-                        lastTick  = std::min(lastTick  + longPulseWidth, endT);
-                    }
-                }
-
-                // #######################################################
-                // ### Loop through returned peaks and make recob hits ###
-                // #######################################################
-
-                int numHits(0);
-
-                // Make a container for what will be the filtered collection
-                std::vector<recob::Hit> filteredHitVec;
-
-                for(const auto& peakParams : peakParamsVec)
-                {
-                    // Extract values for this hit
-                    float peakAmp   = peakParams.peakAmplitude;
-                    float peakMean  = peakParams.peakCenter;
-                    float peakWidth = peakParams.peakSigma;
-
-                    // Place one bit of protection here
-                    if (std::isnan(peakAmp))
-                    {
-                        std::cout << "**** hit peak amplitude is a nan! Channel: " << channel << ", start tick: " << startT << std::endl;
-                        continue;
-                    }
-
-                    // Extract errors
-                    float peakAmpErr   = peakParams.peakAmplitudeError;
-                    float peakMeanErr  = peakParams.peakCenterError;
-                    float peakWidthErr = peakParams.peakSigmaError;
-
-                    // ### Charge ###
-                    float charge    = chargeFunc(peakMean, peakAmp, peakWidth, fAreaNormsVec[plane],startT,endT);;
-                    float chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
-
-                    // ### limits for getting sums
-                    std::vector<float>::const_iterator sumStartItr = range.begin() + startT;
-                    std::vector<float>::const_iterator sumEndItr   = range.begin() + endT;
-
-                    // ### Sum of ADC counts
-                    double sumADC = std::accumulate(sumStartItr, sumEndItr, 0.);
-
-                    // ok, now create the hit
-                    recob::HitCreator hitcreator(*wire,                            // wire reference
-                                                 wid,                              // wire ID
-                                                 startT+roiFirstBinTick,           // start_tick TODO check
-                                                 endT+roiFirstBinTick,             // end_tick TODO check
-                                                 peakWidth,                        // rms
-                                                 peakMean+roiFirstBinTick,         // peak_time
-                                                 peakMeanErr,                      // sigma_peak_time
-                                                 peakAmp,                          // peak_amplitude
-                                                 peakAmpErr,                       // sigma_peak_amplitude
-                                                 charge,                           // hit_integral
-                                                 chargeErr,                        // hit_sigma_integral
-                                                 sumADC,                           // summedADC FIXME
-                                                 nGausForFit,                      // multiplicity
-                                                 numHits,                          // local_index TODO check that the order is correct
-                                                 chi2PerNDF,                       // goodness_of_fit
-                                                 NDF                               // dof
-                                                 );
-
-                    filteredHitVec.push_back(hitcreator.copy());
-
-                    const recob::Hit hit(hitcreator.move());
-
-                    // This loop will store ALL hits
-                    allHitCol.emplace_back(std::move(hit), wire);
-                    numHits++;
-                } // <---End loop over gaussians
-
-                // Should we filter hits?
-                if (filteredHitCol && !filteredHitVec.empty())
-                {
-                    // #######################################################################
-                    // Is all this sorting really necessary?  Would it be faster to just loop
-                    // through the hits and perform simple cuts on amplitude and width on a
-                    // hit-by-hit basis, either here in the module (using fPulseHeightCuts and
-                    // fPulseWidthCuts) or in HitFilterAlg?
-                    // #######################################################################
-
-                    // Sort in ascending peak height
-                    std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakAmplitude() > right.PeakAmplitude();});
-
-                    // Reject if the first hit fails the PH/wid cuts
-                    if (filteredHitVec.front().PeakAmplitude() < fPulseHeightCuts.at(plane) || filteredHitVec.front().RMS() < fPulseWidthCuts.at(plane)) filteredHitVec.clear();
-
-                    // Now check other hits in the snippet
-                    if (filteredHitVec.size() > 1)
-                    {
-                        // The largest pulse height will now be at the front...
-                        float largestPH = filteredHitVec.front().PeakAmplitude();
-
-                        // Find where the pulse heights drop below threshold
-                        float threshold(fPulseRatioCuts.at(plane));
-
-                        std::vector<recob::Hit>::iterator smallHitItr = std::find_if(filteredHitVec.begin(),filteredHitVec.end(),[largestPH,threshold](const auto& hit){return hit.PeakAmplitude() < 8. && hit.PeakAmplitude() / largestPH < threshold;});
+    // Copy the hits of one wire to the output collections, also filling the
+    // monitoring histograms. Done in wire order for both modes of running so
+    // that the parallel output is identical to the serial one.
+    auto storeWireHits = [&](size_t wireIter, WireHits& wireHits)
+    {
+        art::Ptr<recob::Wire> wire(wireVecHandle, wireIter);
 
-                        // Shrink to fit
-                        if (smallHitItr != filteredHitVec.end()) filteredHitVec.resize(std::distance(filteredHitVec.begin(),smallHitItr));
+        for(const auto& chi2 : wireHits.firstChi2Vec) fFirstChi2->Fill(chi2);
+        for(const auto& chi2 : wireHits.chi2Vec)      fChi2->Fill(chi2);
 
-                        // Resort in time order
-                        std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakTime() < right.PeakTime();});
-                    }
+        for(auto& hit : wireHits.allHits) allHitCol.emplace_back(std::move(hit), wire);
 
-                    // Copy the hits we want to keep to the filtered hit collection
-                    for(const auto& filteredHit : filteredHitVec)
-                        if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit))
-                            filteredHitCol->emplace_back(filteredHit, wire);
-                }
+        if (filteredHitCol)
+        {
+            for(auto& hit : wireHits.filteredHits) filteredHitCol->emplace_back(std::move(hit), wire);
+        }
+    };
 
-                fChi2->Fill(chi2PerNDF);
+    if (fParallelHitFinding)
+    {
+        // One slot per wire, filled concurrently and merged afterwards
+        std::vector<WireHits> wireHitsVec(nWires);
 
-            }//<---End loop over merged candidate hits
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nWires, fWireGrainSize),
+                          [&](const tbb::blocked_range<size_t>& wireRange)
+                          {
+                              for(size_t wireIter = wireRange.begin(); wireIter != wireRange.end(); wireIter++)
+                                  findWireHits(wireVecHandle->at(wireIter), *geom, chargeFunc, wireHitsVec[wireIter]);
+                          });
 
-        } //<---End looping over ROI's
+        for(size_t wireIter = 0; wireIter < nWires; wireIter++) storeWireHits(wireIter, wireHitsVec[wireIter]);
+    }
+    else
+    {
+        for(size_t wireIter = 0; wireIter < nWires; wireIter++)
+        {
+            WireHits wireHits;
 
-   }//<---End looping over all the wires
+            findWireHits(wireVecHandle->at(wireIter), *geom, chargeFunc, wireHits);
 
+            storeWireHits(wireIter, wireHits);
+        }
+    }
 
     //==================================================================================================
     // End of the event -- move the hit collection and the associations into the event
@@ -0,0 +1,303 @@
+/*!
+ * Title:   GausLMFitAlg Class
+ *
+ * Description:
+ * Levenberg-Marquardt fit of a sum of Gaussians plus a constant baseline.
+ * See GausLMFitAlg.h for details.
+*/
+
+#include "GausLMFitAlg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+  constexpr double kLambdaStart = 1.e-3;   ///< initial damping
+  constexpr double kLambdaMax   = 1.e10;   ///< give up if the damping needed gets this large
+  constexpr double kLambdaScale = 10.;     ///< damping change after each step
+}
+
+hit::GausLMFitAlg::GausLMFitAlg(unsigned int maxIterations, double tolerance):
+  fMaxIterations(maxIterations),
+  fTolerance(tolerance)
+{}
+
+double hit::GausLMFitAlg::Evaluate(const float*        waveform,
+                                   size_t              nTicks,
+                                   const FitParams_t&  params,
+                                   const ParamArray_t& values,
+                                   Workspace&          workspace) const
+{
+    double* model    = workspace.model.data();
+    double* residual = workspace.residual.data();
+
+    std::fill(model, model + nTicks, values[3*params.nGaus]);
+
+    // Gaussians in the outer loop so the inner loop runs over contiguous ticks
+    for(size_t gausIdx = 0; gausIdx < params.nGaus; gausIdx++)
+    {
+        const double amplitude = values[3*gausIdx];
+        const double mean      = values[3*gausIdx + 1];
+        const double invSigma  = 1. / values[3*gausIdx + 2];
+
+        for(size_t tick = 0; tick < nTicks; tick++)
+        {
+            const double z = (double(tick) + 0.5 - mean) * invSigma;
+
+            model[tick] += amplitude * std::exp(-0.5 * z * z);
+        }
+    }
+
+    double chi2(0.);
+
+    for(size_t tick = 0; tick < nTicks; tick++)
+    {
+        residual[tick] = double(waveform[tick]) - model[tick];
+        chi2 += residual[tick] * residual[tick];
+    }
+
+    return chi2;
+}
+
+void hit::GausLMFitAlg::FillJacobian(size_t              nTicks,
+                                     const FitParams_t&  params,
+                                     const ParamArray_t& values,
+                                     Workspace&          workspace) const
+{
+    double* jacobian = workspace.jacobian.data();
+
+    for(size_t gausIdx = 0; gausIdx < params.nGaus; gausIdx++)
+    {
+        const double amplitude = values[3*gausIdx];
+        const double mean      = values[3*gausIdx + 1];
+        const double invSigma  = 1. / values[3*gausIdx + 2];
+
+        double* dAmplitude = jacobian + (3*gausIdx    ) * nTicks;
+        double* dMean      = jacobian + (3*gausIdx + 1) * nTicks;
+        double* dSigma     = jacobian + (3*gausIdx + 2) * nTicks;
+
+        for(size_t tick = 0; tick < nTicks; tick++)
+        {
+            const double z     = (double(tick) + 0.5 - mean) * invSigma;
+            const double gaus  = std::exp(-0.5 * z * z);
+            const double slope = amplitude * gaus * z * invSigma;
+
+            dAmplitude[tick] = gaus;
+            dMean[tick]      = slope;
+            dSigma[tick]     = slope * z;
+        }
+    }
+
+    if (params.floatBaseline) std::fill(jacobian + 3*params.nGaus*nTicks, jacobian + (3*params.nGaus + 1)*nTicks, 1.);
+}
+
+void hit::GausLMFitAlg::FillNormalEquations(size_t           nTicks,
+                                            size_t           nFree,
+                                            const Workspace& workspace,
+                                            Matrix_t&        alpha,
+                                            ParamArray_t&    beta) const
+{
+    const double* jacobian = workspace.jacobian.data();
+    const double* residual = workspace.residual.data();
+
+    for(size_t rowIdx = 0; rowIdx < nFree; rowIdx++)
+    {
+        const double* rowCol = jacobian + rowIdx * nTicks;
+
+        double betaSum(0.);
+
+        for(size_t tick = 0; tick < nTicks; tick++) betaSum += rowCol[tick] * residual[tick];
+
+        beta[rowIdx] = betaSum;
+
+        for(size_t colIdx = 0; colIdx <= rowIdx; colIdx++)
+        {
+            const double* colCol = jacobian + colIdx * nTicks;
+
+            double alphaSum(0.);
+
+            for(size_t tick = 0; tick < nTicks; tick++) alphaSum += rowCol[tick] * colCol[tick];
+
+            alpha[rowIdx * kMaxParams + colIdx] = alphaSum;
+            alpha[colIdx * kMaxParams + rowIdx] = alphaSum;
+        }
+    }
+}
+
+bool hit::GausLMFitAlg::Decompose(Matrix_t& matrix, size_t nDim)
+{
+    for(size_t rowIdx = 0; rowIdx < nDim; rowIdx++)
+    {
+        for(size_t colIdx = 0; colIdx <= rowIdx; colIdx++)
+        {
+            double sum = matrix[rowIdx * kMaxParams + colIdx];
+
+            for(size_t idx = 0; idx < colIdx; idx++) sum -= matrix[rowIdx * kMaxParams + idx] * matrix[colIdx * kMaxParams + idx];
+
+            if (rowIdx == colIdx)
+            {
+                if (!(sum > 0.)) return false;
+
+                matrix[rowIdx * kMaxParams + rowIdx] = std::sqrt(sum);
+            }
+            else matrix[rowIdx * kMaxParams + colIdx] = sum / matrix[colIdx * kMaxParams + colIdx];
+        }
+    }
+
+    return true;
+}
+
+void hit::GausLMFitAlg::Solve(const Matrix_t& decomposed, size_t nDim, ParamArray_t& vector)
+{
+    // Forward substitution with L
+    for(size_t rowIdx = 0; rowIdx < nDim; rowIdx++)
+    {
+        double sum = vector[rowIdx];
+
+        for(size_t idx = 0; idx < rowIdx; idx++) sum -= decomposed[rowIdx * kMaxParams + idx] * vector[idx];
+
+        vector[rowIdx] = sum / decomposed[rowIdx * kMaxParams + rowIdx];
+    }
+
+    // Back substitution with L^T
+    for(size_t rowIdx = nDim; rowIdx-- > 0;)
+    {
+        double sum = vector[rowIdx];
+
+        for(size_t idx = rowIdx + 1; idx < nDim; idx++) sum -= decomposed[idx * kMaxParams + rowIdx] * vector[idx];
+
+        vector[rowIdx] = sum / decomposed[rowIdx * kMaxParams + rowIdx];
+    }
+}
+
+bool hit::GausLMFitAlg::Fit(const float* waveform,
+                            size_t       nTicks,
+                            FitParams_t& params,
+                            double&      chi2,
+                            int&         NDF,
+                            Workspace&   workspace,
+                            FitStats_t*  stats) const
+{
+    chi2 = std::numeric_limits<double>::infinity();
+
+    const size_t nFree = 3 * params.nGaus + (params.floatBaseline ? 1 : 0);
+
+    if (params.nGaus == 0 || params.nGaus > kMaxGaussians || nTicks <= nFree) return false;
+
+    // Grow the buffers if needed, they are never shrunk
+    if (workspace.model.size() < nTicks)
+    {
+        workspace.model.resize(nTicks);
+        workspace.residual.resize(nTicks);
+    }
+
+    if (workspace.jacobian.size() < nFree * nTicks) workspace.jacobian.resize(nFree * nTicks);
+
+    FitStats_t localStats;
+
+    ParamArray_t values = params.value;
+
+    for(size_t parIdx = 0; parIdx < nFree; parIdx++)
+        values[parIdx] = std::min(std::max(values[parIdx], params.lowLimit[parIdx]), params.highLimit[parIdx]);
+
+    Matrix_t     alpha;
+    Matrix_t     curvature;
+    ParamArray_t beta;
+    ParamArray_t step;
+    ParamArray_t trial = values;
+
+    double curChi2 = Evaluate(waveform, nTicks, params, values, workspace);
+    double lambda  = kLambdaStart;
+    bool   update  = true;
+
+    localStats.evaluations++;
+
+    while(localStats.iterations < fMaxIterations && std::isfinite(curChi2))
+    {
+        if (update)
+        {
+            FillJacobian(nTicks, params, values, workspace);
+            FillNormalEquations(nTicks, nFree, workspace, alpha, beta);
+            update = false;
+        }
+
+        // Marquardt damping of the diagonal, then solve for the step
+        curvature = alpha;
+
+        for(size_t parIdx = 0; parIdx < nFree; parIdx++) curvature[parIdx * kMaxParams + parIdx] *= 1. + lambda;
+
+        localStats.iterations++;
+
+        if (!Decompose(curvature, nFree))
+        {
+            lambda *= kLambdaScale;
+
+            if (lambda > kLambdaMax) break;
+
+            continue;
+        }
+
+        step = beta;
+
+        Solve(curvature, nFree, step);
+
+        // Project the step back into the allowed region
+        for(size_t parIdx = 0; parIdx < nFree; parIdx++)
+            trial[parIdx] = std::min(std::max(values[parIdx] + step[parIdx], params.lowLimit[parIdx]), params.highLimit[parIdx]);
+
+        const double trialChi2 = Evaluate(waveform, nTicks, params, trial, workspace);
+
+        localStats.evaluations++;
+
+        if (trialChi2 < curChi2)
+        {
+            const double deltaChi2 = curChi2 - trialChi2;
+
+            values  = trial;
+            curChi2 = trialChi2;
+            lambda  = std::max(lambda / kLambdaScale, std::numeric_limits<double>::epsilon());
+            update  = true;
+
+            if (deltaChi2 <= fTolerance * curChi2) break;
+        }
+        else
+        {
+            lambda *= kLambdaScale;
+
+            // No downhill step is possible, we are at the minimum within precision
+            if (lambda > kLambdaMax) break;
+        }
+    }
+
+    if (!std::isfinite(curChi2)) return false;
+
+    // Errors from the inverse of J^T J at the minimum (unit weights, as the ROOT fit with option "W")
+    Evaluate(waveform, nTicks, params, values, workspace);
+    FillJacobian(nTicks, params, values, workspace);
+    FillNormalEquations(nTicks, nFree, workspace, alpha, beta);
+
+    if (!Decompose(alpha, nFree)) return false;
+
+    for(size_t parIdx = 0; parIdx < nFree; parIdx++)
+    {
+        ParamArray_t unitVec{};
+
+        unitVec[parIdx] = 1.;
+
+        Solve(alpha, nFree, unitVec);
+
+        params.error[parIdx] = std::sqrt(std::max(unitVec[parIdx], 0.));
+    }
+
+    if (!params.floatBaseline) params.error[3*params.nGaus] = 0.;
+
+    params.value = values;
+
+    chi2 = curChi2;
+    NDF  = int(nTicks - nFree);
+
+    if (stats) *stats = localStats;
+
+    return true;
+}
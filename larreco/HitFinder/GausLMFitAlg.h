@@ -0,0 +1,106 @@
+#ifndef GAUSLMFITALG_H
+#define GAUSLMFITALG_H
+
+/*!
+ * Title:   GausLMFitAlg Class
+ *
+ * Description:
+ * Levenberg-Marquardt fit of a sum of Gaussians plus a constant baseline to a
+ * waveform, done without ROOT. The model is
+ *
+ *     f(x) = sum_i A_i exp(-0.5 ((x - mu_i) / sigma_i)^2) + baseline
+ *
+ * evaluated at the centre of each tick (x = tick + 0.5) and fit by minimizing
+ * the unweighted sum of squared residuals, as done by the ROOT based peak
+ * fitter with its "W" option. Parameter limits are enforced by projecting each
+ * step back into the allowed box. Derivatives are computed analytically.
+ *
+ * The fixed size matrices live on the stack, the per tick buffers live in a
+ * caller owned Workspace which is reused between fits, so no memory is
+ * allocated once the workspace has grown to the largest waveform seen.
+ *
+ * Input:  waveform (pointer to floats and number of ticks) and initial values
+ * Output: fitted parameters, their errors, chi2 and the number of degrees of freedom
+*/
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace hit{
+
+  class GausLMFitAlg {
+
+  public:
+    static constexpr size_t kMaxGaussians = 16;                  ///< largest number of Gaussians in one fit
+    static constexpr size_t kMaxParams    = 3*kMaxGaussians + 1; ///< amplitude, mean, sigma per Gaussian plus baseline
+
+    using ParamArray_t = std::array<double,kMaxParams>;
+
+    /// Fit parameters: for Gaussian i the amplitude, mean and sigma are at
+    /// 3*i, 3*i+1 and 3*i+2; the baseline is at 3*nGaus
+    struct FitParams_t {
+      size_t       nGaus         = 0;
+      bool         floatBaseline = false;
+      ParamArray_t value{};
+      ParamArray_t lowLimit{};
+      ParamArray_t highLimit{};
+      ParamArray_t error{};
+    };
+
+    /// Buffers sized by the waveform length, owned by the caller and reused between fits
+    struct Workspace {
+      std::vector<double> model;     ///< model value at each tick
+      std::vector<double> residual;  ///< data - model at each tick
+      std::vector<double> jacobian;  ///< derivative of the model, one contiguous column per free parameter
+    };
+
+    /// Counters filled by Fit(), for monitoring and benchmarking
+    struct FitStats_t {
+      unsigned int iterations  = 0;  ///< number of normal equation solutions
+      unsigned int evaluations = 0;  ///< number of model evaluations
+    };
+
+    GausLMFitAlg(unsigned int maxIterations=100, double tolerance=1.e-6);
+
+    /// Performs the fit; returns false (leaving chi2 at infinity) on failure
+    bool Fit(const float* waveform,
+             size_t       nTicks,
+             FitParams_t& params,
+             double&      chi2,
+             int&         NDF,
+             Workspace&   workspace,
+             FitStats_t*  stats=nullptr) const;
+
+    /// Evaluates the model at the centre of each tick into the workspace, returns the chi2
+    double Evaluate(const float*         waveform,
+                    size_t               nTicks,
+                    const FitParams_t&   params,
+                    const ParamArray_t&  values,
+                    Workspace&           workspace) const;
+
+  private:
+    using Matrix_t = std::array<double,kMaxParams*kMaxParams>;
+
+    /// Fills the Jacobian columns of the free parameters, using the model stored in the workspace
+    void FillJacobian(size_t               nTicks,
+                      const FitParams_t&   params,
+                      const ParamArray_t&  values,
+                      Workspace&           workspace) const;
+
+    /// Builds J^T J and J^T r for the free parameters
+    void FillNormalEquations(size_t nTicks, size_t nFree, const Workspace& workspace, Matrix_t& alpha, ParamArray_t& beta) const;
+
+    /// In place Cholesky decomposition of a nDim x nDim matrix, false if not positive definite
+    static bool Decompose(Matrix_t& matrix, size_t nDim);
+
+    /// Solves L L^T x = b in place using a decomposed matrix
+    static void Solve(const Matrix_t& decomposed, size_t nDim, ParamArray_t& vector);
+
+    unsigned int fMaxIterations;   ///< maximum number of Levenberg-Marquardt iterations
+    double       fTolerance;       ///< relative chi2 change below which the fit has converged
+  };
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include "art_root_io/TFileService.h"
 #include "cetlib_except/exception.h"
 #include "larcore/Geometry/Geometry.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include "TProfile.h"
 
@@ -27,6 +28,7 @@ public:
     ~CandHitDerivative();
 
     void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override { return !fOutputHistograms; } // histograms and channel counts are shared
 
     void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            size_t,
@@ -75,8 +77,6 @@ private:
 
     // Member variables from the fhicl file
     std::unique_ptr<reco_tool::IWaveformTool> fWaveformTool;
-
-    const geo::GeometryCore*  fGeometry = lar::providerFrom<geo::Geometry>();
 };
 
 //----------------------------------------------------------------------
@@ -141,12 +141,6 @@ void CandHitDerivative::findHitCandidates(const recob::Wire::RegionsOfInterest_t
     fWaveformTool->firstDerivative(waveform, rawDerivativeVec);
     fWaveformTool->triangleSmooth(rawDerivativeVec, derivativeVec);
 
-    std::vector<geo::WireID> wids  = fGeometry->ChannelToWire(channel);
-    size_t                   plane = wids[0].Plane;
-    size_t                   cryo  = wids[0].Cryostat;
-    size_t                   tpc   = wids[0].TPC;
-    size_t                   wire  = wids[0].Wire;
-
     // Just make sure the input candidate hit vector has been cleared
     hitCandidateVec.clear();
 
@@ -155,9 +149,9 @@ void CandHitDerivative::findHitCandidates(const recob::Wire::RegionsOfInterest_t
 
     if (hitCandidateVec.empty())
     {
-        if (plane == 0)
+        if (fPlane == 0)
         {
-            std::cout << "** C/T/P: " << cryo << "/" << tpc << "/" << plane << ", wire: " << wire << " has not hits with input size: " << waveform.size() << std::endl;
+            mf::LogDebug("CandHitDerivative") << "** Plane: " << fPlane << ", channel: " << channel << " has not hits with input size: " << waveform.size();
         }
     }
 
@@ -172,12 +166,12 @@ void CandHitDerivative::findHitCandidates(const recob::Wire::RegionsOfInterest_t
     // Keep track of histograms if requested
     if (fOutputHistograms)
     {
-        // Recover the details...
-//        std::vector<geo::WireID> wids  = fGeometry->ChannelToWire(channel);
-//        size_t                   plane = wids[0].Plane;
-//        size_t                   cryo  = wids[0].Cryostat;
-//        size_t                   tpc   = wids[0].TPC;
-//        size_t                   wire  = wids[0].Wire;
+        // Recover the details... (geometry only needed here, so the tool can be used without services)
+        std::vector<geo::WireID> wids  = lar::providerFrom<geo::Geometry>()->ChannelToWire(channel);
+        size_t                   plane = wids[0].Plane;
+        size_t                   cryo  = wids[0].Cryostat;
+        size_t                   tpc   = wids[0].TPC;
+        size_t                   wire  = wids[0].Wire;
 
         size_t channelCnt = fChannelCntMap[channel]++;
 
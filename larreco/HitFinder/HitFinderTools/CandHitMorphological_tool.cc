@@ -27,6 +27,7 @@ public:
     ~CandHitMorphological();
 
     void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override { return !fOutputHistograms && !fOutputWaveforms; } // histograms and channel counts are shared
 
     void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            size_t,
@@ -104,8 +105,6 @@ private:
 
     //< All of the real work is done in the waveform tool
     std::unique_ptr<reco_tool::IWaveformTool> fWaveformTool;
-
-    const geo::GeometryCore*  fGeometry = lar::providerFrom<geo::Geometry>();
 };
 
 //----------------------------------------------------------------------
@@ -221,8 +220,8 @@ void CandHitMorphological::findHitCandidates(const recob::Wire::RegionsOfInteres
     // Keep track of histograms if requested
     if (fOutputWaveforms)
     {
-        // Recover the details...
-        std::vector<geo::WireID> wids  = fGeometry->ChannelToWire(channel);
+        // Recover the details... (geometry only needed here, so the tool can be used without services)
+        std::vector<geo::WireID> wids  = lar::providerFrom<geo::Geometry>()->ChannelToWire(channel);
         size_t                   plane = wids[0].Plane;
         size_t                   cryo  = wids[0].Cryostat;
         size_t                   tpc   = wids[0].TPC;
@@ -6,7 +6,6 @@
 #include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
 
 #include "art/Utilities/ToolMacros.h"
-#include "larcore/Geometry/Geometry.h"
 
 #include <algorithm>
 
@@ -21,6 +20,7 @@ public:
     ~CandHitStandard();
 
     void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override { return true; }
 
     void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            size_t,
@@ -43,8 +43,6 @@ private:
     // Member variables from the fhicl file
     int                      fPlane;                      ///< Plane we are meant to work with
     float                    fRoiThreshold;               ///< minimum maximum to minimum peak distance
-
-    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
 };
 
 //----------------------------------------------------------------------
@@ -76,12 +74,8 @@ void CandHitStandard::findHitCandidates(const recob::Wire::RegionsOfInterest_t::
     // Recover the actual waveform
     const Waveform& waveform = dataRange.data();
     
-    // Recover the plane index for this method
-    std::vector<geo::WireID> wids  = fGeometry->ChannelToWire(channel);
-    size_t                   plane = wids[0].Plane;
-
     // Use the recursive version to find the candidate hits
-    findHitCandidates(waveform.begin(),waveform.end(),roiStartTick,plane,hitCandidateVec);
+    findHitCandidates(waveform.begin(),waveform.end(),roiStartTick,fPlane,hitCandidateVec);
 
     return;
 }
@@ -25,6 +25,10 @@ namespace reco_tool
         // Define standard art tool interface
         virtual void configure(const fhicl::ParameterSet& pset) = 0;
 
+        // True if findHitCandidates and MergeHitCandidates may be called concurrently
+        // (e.g. by parallel hit finding), false if the tool keeps state while finding hits
+        virtual bool IsThreadSafe() const { return false; }
+
         // Define a structure to contain hits
         using HitCandidate_t = struct HitCandidate
         {
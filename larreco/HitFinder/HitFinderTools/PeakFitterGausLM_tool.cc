@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////
+/// \file   PeakFitterGausLM.cc
+/// \brief  Peak fitter using a ROOT free Levenberg-Marquardt fit of
+///         N Gaussians plus baseline, see hit::GausLMFitAlg
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/HitFinder/GausLMFitAlg.h"
+
+#include "art/Utilities/ToolMacros.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tbb/enumerable_thread_specific.h"
+
+namespace reco_tool
+{
+
+class PeakFitterGausLM : IPeakFitter
+{
+public:
+    explicit PeakFitterGausLM(const fhicl::ParameterSet& pset);
+
+    ~PeakFitterGausLM();
+
+    void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override { return true; } // workspaces are per thread
+
+    void findPeakParameters(const std::vector<float>&,
+                            const ICandidateHitFinder::HitCandidateVec&,
+                            PeakParamsVec&,
+                            double&,
+                            int&) const override;
+
+private:
+    // Member variables from the fhicl file
+    double                   fMinWidth;          ///< minimum initial width for gaussian fit
+    double                   fMaxWidthMult;      ///< multiplier for max width for gaussian fit
+    double                   fPeakRange;         ///< set range limits for peak center
+    double                   fAmpRange;          ///< set range limit for peak amplitude
+    bool                     fFloatBaseline;     ///< Allow baseline to "float" away from zero
+
+    std::unique_ptr<hit::GausLMFitAlg> fFitAlg;  ///< Does the actual fitting
+
+    /// Work buffers of the fit, one set per thread calling the tool
+    mutable tbb::enumerable_thread_specific<hit::GausLMFitAlg::Workspace> fWorkspaces;
+};
+
+//----------------------------------------------------------------------
+// Constructor.
+PeakFitterGausLM::PeakFitterGausLM(const fhicl::ParameterSet& pset)
+{
+    configure(pset);
+}
+
+PeakFitterGausLM::~PeakFitterGausLM()
+{
+}
+
+void PeakFitterGausLM::configure(const fhicl::ParameterSet& pset)
+{
+    // Start by recovering the parameters
+    fMinWidth      = pset.get<double>("MinWidth",      0.5);
+    fMaxWidthMult  = pset.get<double>("MaxWidthMult",  3.);
+    fPeakRange     = pset.get<double>("PeakRangeFact", 2.);
+    fAmpRange      = pset.get<double>("PeakAmpRange",  2.);
+    fFloatBaseline = pset.get< bool >("FloatBaseline", false);
+
+    fFitAlg = std::make_unique<hit::GausLMFitAlg>(pset.get<unsigned int>("MaxIterations", 100),
+                                                  pset.get<double      >("Tolerance",     1.e-6));
+
+    return;
+}
+
+// --------------------------------------------------------------------------------------------
+void PeakFitterGausLM::findPeakParameters(const std::vector<float>&                   roiSignalVec,
+                                          const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+                                          PeakParamsVec&                              peakParamsVec,
+                                          double&                                     chi2PerNDF,
+                                          int&                                        NDF) const
+{
+    // The starting values and limits follow those of PeakFitterGaussian so the
+    // two tools can be swapped without retuning
+    //
+    // *** NOTE: this algorithm assumes the reference time for input hit candidates is to
+    //           the first tick of the input waveform (ie 0)
+    //
+    if (hitCandidateVec.empty()) return;
+
+    // in case of a fit failure, set the chi-square to infinity
+    chi2PerNDF = std::numeric_limits<double>::infinity();
+
+    if (hitCandidateVec.size() > hit::GausLMFitAlg::kMaxGaussians)
+    {
+        mf::LogDebug("PeakFitterGausLM") << "Too many candidate hits to fit: " << hitCandidateVec.size();
+        return;
+    }
+
+    int startTime = hitCandidateVec.front().startTick;
+    int endTime   = hitCandidateVec.back().stopTick;
+    int roiSize   = endTime - startTime;
+
+    hit::GausLMFitAlg::FitParams_t fitParams;
+
+    fitParams.nGaus         = hitCandidateVec.size();
+    fitParams.floatBaseline = fFloatBaseline;
+
+    // Set the baseline if so desired
+    size_t const baselineIdx = 3 * fitParams.nGaus;
+    float        baseline(0.);
+
+    if (fFloatBaseline)
+    {
+        baseline = roiSignalVec[startTime];
+        fitParams.lowLimit[baselineIdx]  = baseline - 12.;
+        fitParams.highLimit[baselineIdx] = baseline + 12.;
+    }
+
+    fitParams.value[baselineIdx] = baseline;
+
+    // ### Setting the parameters for the Gaussian Fit ###
+    size_t parIdx{0};
+    for(auto const& candidateHit : hitCandidateVec)
+    {
+        double const peakMean   = candidateHit.hitCenter - float(startTime);
+        double const peakWidth  = candidateHit.hitSigma;
+        double const amplitude  = candidateHit.hitHeight - baseline;
+        double const meanLowLim = std::max(peakMean - fPeakRange * peakWidth,              0.);
+        double const meanHiLim  = std::min(peakMean + fPeakRange * peakWidth, double(roiSize));
+
+        fitParams.value[parIdx]       = amplitude;
+        fitParams.value[parIdx+1]     = peakMean;
+        fitParams.value[parIdx+2]     = peakWidth;
+        fitParams.lowLimit[parIdx]    = 0.1 * amplitude;
+        fitParams.highLimit[parIdx]   = fAmpRange * amplitude;
+        fitParams.lowLimit[parIdx+1]  = meanLowLim;
+        fitParams.highLimit[parIdx+1] = meanHiLim;
+        fitParams.lowLimit[parIdx+2]  = std::max(fMinWidth, 0.1 * peakWidth);
+        fitParams.highLimit[parIdx+2] = fMaxWidthMult * peakWidth;
+
+        parIdx += 3;
+    }
+
+    double chi2(std::numeric_limits<double>::infinity());
+    int    fitNDF(0);
+
+    if (!fFitAlg->Fit(roiSignalVec.data() + startTime, roiSize, fitParams, chi2, fitNDF, fWorkspaces.local()))
+    {
+        mf::LogDebug("PeakFitterGausLM") << "Fitter failed finding a hit";
+        return;
+    }
+
+    // ##################################################
+    // ### Getting the fitted parameters from the fit ###
+    // ##################################################
+    chi2PerNDF = chi2 / fitNDF;
+    NDF        = fitNDF;
+
+    parIdx = 0;
+    for(size_t idx = 0; idx < hitCandidateVec.size(); idx++)
+    {
+        PeakFitParams_t peakParams;
+
+        peakParams.peakAmplitude      = fitParams.value[parIdx];
+        peakParams.peakAmplitudeError = fitParams.error[parIdx];
+        peakParams.peakCenter         = fitParams.value[parIdx + 1] + float(startTime);
+        peakParams.peakCenterError    = fitParams.error[parIdx + 1];
+        peakParams.peakSigma          = fitParams.value[parIdx + 2];
+        peakParams.peakSigmaError     = fitParams.error[parIdx + 2];
+
+        peakParamsVec.emplace_back(peakParams);
+
+        parIdx += 3;
+    }
+
+    return;
+}
+
+DEFINE_ART_CLASS_TOOL(PeakFitterGausLM)
+}
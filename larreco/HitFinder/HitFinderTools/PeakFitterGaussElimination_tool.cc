@@ -21,6 +21,7 @@ public:
     ~PeakFitterGaussElimination();
 
     void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override { return true; }
 
     void findPeakParameters(const std::vector<float>&,
                             const ICandidateHitFinder::HitCandidateVec&,
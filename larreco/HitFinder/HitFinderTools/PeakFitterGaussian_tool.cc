@@ -9,11 +9,18 @@
 #include "art/Utilities/ToolMacros.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "art_root_io/TFileService.h"
-#include "larcore/Geometry/Geometry.h"
 
+#include <atomic>
 #include <cassert>
 #include <fstream>
+#include <memory>
 
+#include "tbb/enumerable_thread_specific.h"
+
+#include "Fit/DataRange.h"
+#include "Foption.h"
+#include "HFitInterface.h"
+#include "Math/MinimizerOptions.h"
 #include "TF1.h"
 #include "TH1F.h"
 
@@ -61,6 +68,7 @@ public:
     ~PeakFitterGaussian();
 
     void configure(const fhicl::ParameterSet& pset) override;
+    bool IsThreadSafe() const override;
 
     void findPeakParameters(const std::vector<float>&,
                             const ICandidateHitFinder::HitCandidateVec&,
@@ -76,6 +84,9 @@ private:
     double                   fAmpRange;          ///< set range limit for peak amplitude
     bool                     fFloatBaseline;     ///< Allow baseline to "float" away from zero
     bool                     fOutputHistograms;  ///< If true will generate summary style histograms
+    std::string              fMinimizerType;     ///< If set, the ROOT minimizer used for the fits (e.g. "Minuit2")
+    ROOT::Math::MinimizerOptions fMinimizerOptions; ///< Minimizer of the fits of this tool
+    Foption_t                fFitOption;         ///< Parsed fit options of the fits
 
     TH1F*                    fNumCandHitsHist;
     TH1F*                    fROISizeHist;
@@ -88,11 +99,20 @@ private:
     TH1F*                    fFitPeakAmpitudeHist;
     TH1F*                    fFitBaselineHist;
 
-    mutable BaselinedGausFitCache fFitCache; ///< Preallocated ROOT functions for the fits.
+    /// The ROOT objects used by a fit. Each thread calling the tool gets its own
+    /// copy so that findPeakParameters() can be used concurrently
+    struct FitWorkspace
+    {
+        FitWorkspace(size_t workspaceIdx);
+
+        BaselinedGausFitCache fitCache;    ///< Preallocated ROOT functions for the fits.
+        TH1F                  histogram;   ///< Histogram holding the waveform to fit
+    };
 
-    mutable TH1F             fHistogram;
+    FitWorkspace& getFitWorkspace() const;
 
-    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
+    mutable tbb::enumerable_thread_specific<std::unique_ptr<FitWorkspace>> fFitWorkspaces;
+    mutable std::atomic<size_t>                                             fNumFitWorkspaces{0};
 };
 
 //----------------------------------------------------------------------
@@ -106,6 +126,24 @@ PeakFitterGaussian::~PeakFitterGaussian()
 {
 }
 
+PeakFitterGaussian::FitWorkspace::FitWorkspace(size_t workspaceIdx)
+  : fitCache("BaselinedGausFitCache_" + std::to_string(workspaceIdx))
+  , histogram(("PeakFitterHitSignal_" + std::to_string(workspaceIdx)).c_str(),"",500,0.,500.)
+{
+    histogram.SetDirectory(nullptr);
+    histogram.Sumw2();
+}
+
+PeakFitterGaussian::FitWorkspace& PeakFitterGaussian::getFitWorkspace() const
+{
+    // Workspaces are created on first use by each thread
+    std::unique_ptr<FitWorkspace>& fitWorkspace = fFitWorkspaces.local();
+
+    if (!fitWorkspace) fitWorkspace = std::make_unique<FitWorkspace>(fNumFitWorkspaces++);
+
+    return *fitWorkspace;
+}
+
 void PeakFitterGaussian::configure(const fhicl::ParameterSet& pset)
 {
     // Start by recovering the parameters
@@ -115,14 +153,22 @@ void PeakFitterGaussian::configure(const fhicl::ParameterSet& pset)
     fAmpRange         = pset.get<double>("PeakAmpRange",     2.);
     fFloatBaseline    = pset.get< bool >("FloatBaseline",    false);
     fOutputHistograms = pset.get< bool >("OutputHistograms", false);
+    fMinimizerType    = pset.get< std::string >("MinimizerType", "");
+
+    // The default ROOT minimizer (TMinuit) is not reentrant, running fits
+    // concurrently needs one that is (e.g. Minuit2). It is only set in the
+    // options of this tool, the ROOT default used by other fits is unchanged
+    fMinimizerOptions = ROOT::Math::MinimizerOptions();
+    if (!fMinimizerType.empty()) fMinimizerOptions.SetMinimizerType(fMinimizerType.c_str());
 
-    fHistogram = TH1F("PeakFitterHitSignal","",500,0.,500.);
+    fFitOption = Foption_t();
+    ROOT::Fit::FitOptionsMake(ROOT::Fit::EFitObjectType::kHistogram, "QNWB", fFitOption);
 
-    fHistogram.Sumw2();
+    fFitWorkspaces.clear();
 
     std::string function = "Gaus(0)";
 
-    // If asked, define the global histograms
+    // If asked, define the global histograms (note that filling these is not thread safe)
     if (fOutputHistograms)
     {
         // Access ART's TFileService, which will handle creating and writing
@@ -147,6 +193,15 @@ void PeakFitterGaussian::configure(const fhicl::ParameterSet& pset)
     return;
 }
 
+// --------------------------------------------------------------------------------------------
+bool PeakFitterGaussian::IsThreadSafe() const
+{
+    // The histograms are shared, and TMinuit and TFumili keep the fit in global objects
+    std::string const& minimizer = fMinimizerOptions.MinimizerType();
+
+    return !fOutputHistograms && (minimizer != "Minuit") && (minimizer != "TMinuit") && (minimizer != "Fumili");
+}
+
 // --------------------------------------------------------------------------------------------
 void PeakFitterGaussian::findPeakParameters(const std::vector<float>&                   roiSignalVec,
                                             const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
@@ -169,15 +224,19 @@ void PeakFitterGaussian::findPeakParameters(const std::vector<float>&
     int endTime   = hitCandidateVec.back().stopTick;
     int roiSize   = endTime - startTime;
 
+    FitWorkspace& fitWorkspace = getFitWorkspace();
+    TH1F&         hitSignal    = fitWorkspace.histogram;
+
     // Check to see if we need a bigger histogram for fitting
-    if (roiSize > fHistogram.GetNbinsX())
+    if (roiSize > hitSignal.GetNbinsX())
     {
         std::string histName = "PeakFitterHitSignal_" + std::to_string(roiSize);
-        fHistogram = TH1F(histName.c_str(),"",roiSize,0.,roiSize);
-        fHistogram.Sumw2();
+        hitSignal = TH1F(histName.c_str(),"",roiSize,0.,roiSize);
+        hitSignal.SetDirectory(nullptr);
+        hitSignal.Sumw2();
     }
 
-    for(int idx = 0; idx < roiSize; idx++) fHistogram.SetBinContent(idx+1,roiSignalVec[startTime+idx]);
+    for(int idx = 0; idx < roiSize; idx++) hitSignal.SetBinContent(idx+1,roiSignalVec[startTime+idx]);
 
     // Build the string to describe the fit formula
 #if 0
@@ -199,8 +258,8 @@ void PeakFitterGaussian::findPeakParameters(const std::vector<float>&
     TF1 Gaus("Gaus",equation.c_str(),0,roiSize,TF1::EAddToList::kNo);
 #else
     unsigned int const nGaus = hitCandidateVec.size();
-    assert(fFitCache.Get(nGaus));
-    TF1& Gaus = *(fFitCache.Get(nGaus));
+    assert(fitWorkspace.fitCache.Get(nGaus));
+    TF1& Gaus = *(fitWorkspace.fitCache.Get(nGaus));
 
     // Set the baseline if so desired
     float baseline(0.);
@@ -251,8 +310,13 @@ void PeakFitterGaussian::findPeakParameters(const std::vector<float>&
 
     int fitResult{-1};
 
+    // As TH1::Fit(&Gaus,"QNWB","", 0., roiSize), but with the minimizer of this tool
     try
-    { fitResult = fHistogram.Fit(&Gaus,"QNWB","", 0., roiSize);}
+    {
+        Foption_t          fitOption(fFitOption);
+        ROOT::Fit::DataRange range(0., roiSize);
+        fitResult = ROOT::Fit::FitObject(&hitSignal, &Gaus, fitOption, fMinimizerOptions, "", range);
+    }
     catch(...)
     {mf::LogWarning("GausHitFinder") << "Fitter failed finding a hit";}
 
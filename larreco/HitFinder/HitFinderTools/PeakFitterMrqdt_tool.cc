@@ -8,7 +8,6 @@
 #include "art_root_io/TFileService.h"
 #include "cetlib_except/exception.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
-#include "larcore/Geometry/Geometry.h"
 
 #include <cmath>
 #include <cassert>
@@ -43,8 +42,6 @@ namespace reco_tool
     bool fFloatBaseline;
 
     std::unique_ptr<gshf::MarqFitAlg> fMarqFitAlg;
-
-    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
   };
   
   //--------------------------
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       ROIWaveformDump
+// Module Type: analyzer
+// File:        ROIWaveformDump_module.cc
+////////////////////////////////////////////////////////////////////////
+
+/*!
+ * Title:   ROIWaveformDump
+ * Inputs:  recob::Wire
+ * Outputs: binary file of ROI waveforms (see ROIWaveformIO.h)
+ *
+ * Description:
+ * Writes every region of interest of the input wires to a binary file, to be
+ * used as input to the hit finder tool benchmarks in test/HitFinder.
+ */
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <memory>
+#include <string>
+
+#include "larcore/Geometry/Geometry.h"
+#include "lardataobj/RecoBase/Wire.h"
+#include "larreco/HitFinder/ROIWaveformIO.h"
+
+namespace hit {
+  class ROIWaveformDump;
+}
+
+class hit::ROIWaveformDump : public art::EDAnalyzer {
+public:
+  explicit ROIWaveformDump(fhicl::ParameterSet const & p);
+
+private:
+  void analyze(art::Event const & e) override;
+
+  void endJob() override;
+
+  art::InputTag                      fWireModuleLabel;
+  size_t                             fMaxROIs;      ///< stop writing after this many ROIs (0 = no limit)
+
+  std::unique_ptr<ROIWaveformWriter> fWriter;
+};
+
+
+hit::ROIWaveformDump::ROIWaveformDump(fhicl::ParameterSet const & p)
+  :
+  EDAnalyzer(p),
+  fWireModuleLabel(p.get< art::InputTag >("WireModuleLabel")),
+  fMaxROIs        (p.get< size_t        >("MaxROIs", 0)),
+  fWriter         (std::make_unique<ROIWaveformWriter>(p.get< std::string >("FileName")))
+{
+}
+
+void hit::ROIWaveformDump::analyze(art::Event const & e)
+{
+  art::ServiceHandle<geo::Geometry const> geom;
+
+  auto const& wireVec = *e.getValidHandle< std::vector<recob::Wire> >(fWireModuleLabel);
+
+  for(auto const& wire : wireVec){
+
+    uint32_t const plane = geom->ChannelToWire(wire.Channel()).front().Plane;
+
+    for(auto const& range : wire.SignalROI().get_ranges()){
+
+      if(fMaxROIs > 0 && fWriter->NWritten() >= fMaxROIs) return;
+
+      fWriter->Write(wire.Channel(), plane, range.begin_index(), range.data());
+    }
+  }
+}
+
+void hit::ROIWaveformDump::endJob()
+{
+  mf::LogInfo("ROIWaveformDump") << "Wrote " << fWriter->NWritten() << " ROI waveforms";
+}
+
+DEFINE_ART_MODULE(hit::ROIWaveformDump)
@@ -0,0 +1,91 @@
+#include "ROIWaveformIO.h"
+
+#include "cetlib_except/exception.h"
+
+#include <cstring>
+
+namespace {
+  constexpr char     kMagic[8] = {'L','A','R','R','O','I','W','F'};
+  constexpr uint32_t kVersion  = 1;
+
+  template <typename T>
+  void writeValue(std::ofstream& output, const T& value)
+  { output.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+  template <typename T>
+  bool readValue(std::ifstream& input, T& value)
+  { return bool(input.read(reinterpret_cast<char*>(&value), sizeof(T))); }
+}
+
+namespace hit{
+
+  ROIWaveformWriter::ROIWaveformWriter(const std::string& fileName) :
+    fOutput(fileName, std::ios::binary | std::ios::trunc)
+  {
+    if (!fOutput)
+      throw cet::exception("ROIWaveformIO") << "Cannot open ROI waveform file " << fileName << " for writing\n";
+
+    fOutput.write(kMagic, sizeof(kMagic));
+    writeValue(fOutput, kVersion);
+  }
+
+  void ROIWaveformWriter::Write(uint32_t channel, uint32_t plane, uint32_t startTick, const std::vector<float>& samples) {
+
+    writeValue(fOutput, channel);
+    writeValue(fOutput, plane);
+    writeValue(fOutput, startTick);
+    writeValue(fOutput, uint32_t(samples.size()));
+
+    fOutput.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(float));
+
+    if (!fOutput) throw cet::exception("ROIWaveformIO") << "Failed writing ROI waveform for channel " << channel << "\n";
+
+    fNWritten++;
+  }
+
+  ROIWaveformVec ReadROIWaveforms(const std::string& fileName, size_t maxROIs) {
+
+    std::ifstream input(fileName, std::ios::binary);
+
+    if (!input) throw cet::exception("ROIWaveformIO") << "Cannot open ROI waveform file " << fileName << "\n";
+
+    char     magic[sizeof(kMagic)];
+    uint32_t version(0);
+
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !readValue(input, version))
+      throw cet::exception("ROIWaveformIO") << "File " << fileName << " is not a ROI waveform file\n";
+
+    if (version != kVersion)
+      throw cet::exception("ROIWaveformIO") << "File " << fileName << " has format version " << version << ", expected " << kVersion << "\n";
+
+    // the number of samples of a record is bounded by what is left in the file
+    const std::streampos dataStart = input.tellg();
+    input.seekg(0, std::ios::end);
+    const std::streamoff fileSize = input.tellg();
+    input.seekg(dataStart);
+
+    ROIWaveformVec roiVec;
+    ROIWaveform    roi;
+    uint32_t       nSamples(0);
+
+    while((maxROIs == 0 || roiVec.size() < maxROIs) && readValue(input, roi.channel))
+    {
+      if (!readValue(input, roi.plane) || !readValue(input, roi.startTick) || !readValue(input, nSamples))
+        throw cet::exception("ROIWaveformIO") << "Truncated record in " << fileName << "\n";
+
+      if (nSamples > (fileSize - std::streamoff(input.tellg())) / std::streamoff(sizeof(float)))
+        throw cet::exception("ROIWaveformIO") << "Truncated record in " << fileName << ": "
+          << nSamples << " samples announced for channel " << roi.channel << "\n";
+
+      roi.samples.resize(nSamples);
+
+      if (!input.read(reinterpret_cast<char*>(roi.samples.data()), nSamples * sizeof(float)))
+        throw cet::exception("ROIWaveformIO") << "Truncated record in " << fileName << "\n";
+
+      roiVec.push_back(roi);
+    }
+
+    return roiVec;
+  }
+
+}//end namespace hit
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       ROIWaveformIO
+// Purpose:     Read and write regions of interest of recob::Wire objects
+//              to a simple binary file, so that hit finding tools can be
+//              run on recorded waveforms outside of an art job
+//
+// File layout (native byte order):
+//   header: 8 byte magic "LARROIWF", uint32 format version
+//   record: uint32 channel, uint32 plane, uint32 start tick,
+//           uint32 number of samples, the samples as floats
+////////////////////////////////////////////////////////////////////////
+
+#ifndef ROIWAVEFORMIO_H
+#define ROIWAVEFORMIO_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace hit{
+
+  /// One region of interest of a wire
+  struct ROIWaveform {
+    uint32_t           channel   = 0;
+    uint32_t           plane     = 0;
+    uint32_t           startTick = 0;
+    std::vector<float> samples;
+  };
+
+  using ROIWaveformVec = std::vector<ROIWaveform>;
+
+  class ROIWaveformWriter {
+    public:
+      /// Opens the file and writes the header; throws cet::exception on failure
+      explicit ROIWaveformWriter(const std::string& fileName);
+
+      void Write(uint32_t channel, uint32_t plane, uint32_t startTick, const std::vector<float>& samples);
+
+      size_t NWritten() const { return fNWritten; }
+
+    private:
+      std::ofstream fOutput;
+      size_t        fNWritten = 0;
+  };
+
+  /// Reads back a whole file, up to maxROIs entries (0 for all); throws cet::exception on failure
+  ROIWaveformVec ReadROIWaveforms(const std::string& fileName, size_t maxROIs=0);
+
+}//end namespace hit
+#endif
@@ -49,9 +49,12 @@ namespace cmtool {
 
     for(auto const& c : clusters){
 
-      auto charge = c->GetParams().sum_charge ;
+      // the parameters up to the start and end points are needed
+      auto const& params = c->GetParams(::cluster::ClusterParamsAlg::kStartPointAndDirection);
 
-      time_difference  = c->GetParams().start_point.t - c->GetParams().end_point.t ;
+      auto charge = params.sum_charge ;
+
+      time_difference  = params.start_point.t - params.end_point.t ;
 
       if(time_difference < 0)
 	time_difference *= -1;
@@ -62,11 +65,11 @@ namespace cmtool {
       if(max_charge < charge)
 	max_charge = charge ;
 
-      if(c->GetParams().N_Hits > max_hits_1) {
+      if(params.N_Hits > max_hits_1) {
 	max_hits_2 = max_hits_1;
-	max_hits_1 = c->GetParams().N_Hits;
-      }else if(c->GetParams().N_Hits > max_hits_2)
-	max_hits_2 = c->GetParams().N_Hits;
+	max_hits_1 = params.N_Hits;
+      }else if(params.N_Hits > max_hits_2)
+	max_hits_2 = params.N_Hits;
 
     }
 
@@ -74,20 +77,21 @@ namespace cmtool {
     charge_ratio = 1;
     for(size_t c_index=0; c_index<clusters.size(); ++c_index) {
       auto const& c = clusters[c_index];
+      auto const& params = c->GetParams(::cluster::ClusterParamsAlg::kStartPointAndDirection);
 
-      double length = c->GetParams().length ;
-      //auto charge = c->GetParams().sum_charge ;
+      double length = params.length ;
+      //auto charge = params.sum_charge ;
       //Order hits from most to least
       //SetMaxMiddleMin(hits_0,hits_1,hits_2,max_hits,middle_hits,min_hits);
 
       //Make start_t always smaller
-      if(c->GetParams().start_point.t > c->GetParams().end_point.t){
-	start_t = c->GetParams().end_point.t   ;
-	end_t   = c->GetParams().start_point.t ;
+      if(params.start_point.t > params.end_point.t){
+	start_t = params.end_point.t   ;
+	end_t   = params.start_point.t ;
       }
       else{
-	start_t = c->GetParams().start_point.t ;
-	end_t	= c->GetParams().end_point.t   ;
+	start_t = params.start_point.t ;
+	end_t	= params.end_point.t   ;
       }
 
       if(prev_start_t ==0)
@@ -129,7 +133,7 @@ namespace cmtool {
 	std::cout<<"Charge Ratio: "<<charge_ratio<<std::endl;
 	//std::cout<<"Hits are: "<<min_hits<<", "<<middle_hits<<", "<<max_hits<<std::endl;
 	//				std::cout<<"Adjusted Charge Ratio: "<<adjusted_charge_ratio<<std::endl;
-	std::cout<<"Length and Width: "<<c->GetParams().length<<", "<<c->GetParams().width<<std::endl;
+	std::cout<<"Length and Width: "<<params.length<<", "<<params.width<<std::endl;
       }
 
     }
@@ -37,6 +37,15 @@ namespace cmtool {
     */
     virtual float Float(const std::vector<const cluster::ClusterParamsAlg*> &clusters);
 
+    /// Float() only prints in debug or verbose mode
+    virtual bool ThreadSafe() const { return !(_debug || _verbose); }
+
+    /// Float() reads the parameters up to the start and end points
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const
+    { return ::cluster::ClusterParamsAlg::kStartPointAndDirection; }
+
+    virtual bool UsesPolygon() const { return false; }
+
     void SetStartTimeCut(float start_time) { _start_time_cut = start_time ; }
 
     void SetRatioCut(float ratio) { _time_ratio_cut = ratio ; }
@@ -1,5 +1,7 @@
 #include "CBAlgoArray.h"
 
+#include <algorithm>
+
 namespace cmtool {
 
   //------------------------------------------
@@ -88,6 +90,62 @@ namespace cmtool {
     return status;
   }
 
+  //----------------------------------------
+  double CBAlgoArray::MaxPairDistance() const
+  //----------------------------------------
+  {
+    // Bool() stops at an AND with a false status and at an OR with a true one,
+    // otherwise the status becomes the result of the next algorithm: the result
+    // is A0 op1 (A1 op2 (A2 ...)), false beyond the distance folded from the last
+    // algorithm with the minimum for AND and the maximum for OR
+    if(_algo_array.empty()) return CBoolAlgoBase::MaxPairDistance();
+
+    double max_dist = _algo_array.back()->MaxPairDistance();
+    for(size_t i=_algo_array.size()-1; i>0; --i) {
+
+      if( _ask_and.at(i) )
+	max_dist = std::min(_algo_array.at(i-1)->MaxPairDistance(), max_dist);
+
+      else
+	max_dist = std::max(_algo_array.at(i-1)->MaxPairDistance(), max_dist);
+    }
+    return max_dist;
+  }
+
+  //-----------------------------------
+  bool CBAlgoArray::ThreadSafe() const
+  //-----------------------------------
+  {
+    for(auto const& algo : _algo_array)
+
+      if(!algo->ThreadSafe()) return false;
+
+    return true;
+  }
+
+  //-----------------------------------------------------------------------
+  ::cluster::ClusterParamsAlg::ParamsStage_t CBAlgoArray::ParamsStage() const
+  //-----------------------------------------------------------------------
+  {
+    auto stage = ::cluster::ClusterParamsAlg::kNoParams;
+    for(auto const& algo : _algo_array)
+
+      stage = std::max(stage, algo->ParamsStage());
+
+    return stage;
+  }
+
+  //------------------------------------
+  bool CBAlgoArray::UsesPolygon() const
+  //------------------------------------
+  {
+    for(auto const& algo : _algo_array)
+
+      if(algo->UsesPolygon()) return true;
+
+    return false;
+  }
+
   //------------------------
   void CBAlgoArray::Report()
   //------------------------
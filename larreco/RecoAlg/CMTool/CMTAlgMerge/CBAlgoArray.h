@@ -79,6 +79,18 @@ namespace cmtool {
     virtual void SetVerbose(bool doit=true)
     { for(auto &algo : _algo_array) algo->SetVerbose(doit); }
 
+    /// Distance beyond which the AND/OR combination of the algorithms is false
+    virtual double MaxPairDistance() const;
+
+    /// Thread-safe if all the algorithms are
+    virtual bool ThreadSafe() const;
+
+    /// The latest stage any of the algorithms reads
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const;
+
+    /// Whether any of the algorithms reads the polygon
+    virtual bool UsesPolygon() const;
+
     /// Function to reset the algorithm instance ... maybe implemented via child class
     virtual void Reset();
 
@@ -85,16 +85,20 @@ namespace cmtool {
     //if any two points are close enough to each other,
     //merge the two clusters
 
-    unsigned int npoints1 = cluster1.GetParams().PolyObject.Size();
-    unsigned int npoints2 = cluster2.GetParams().PolyObject.Size();
+    // only the polygons are needed
+    auto const& params1 = cluster1.GetParams(::cluster::ClusterParamsAlg::kNoParams, true);
+    auto const& params2 = cluster2.GetParams(::cluster::ClusterParamsAlg::kNoParams, true);
+
+    unsigned int npoints1 = params1.PolyObject.Size();
+    unsigned int npoints2 = params2.PolyObject.Size();
     //loop over points on first polygon
     for(unsigned int i = 0; i < npoints1; ++i){
-      float pt1w = cluster1.GetParams().PolyObject.Point(i).first;
-      float pt1t = cluster1.GetParams().PolyObject.Point(i).second;
+      float pt1w = params1.PolyObject.Point(i).first;
+      float pt1t = params1.PolyObject.Point(i).second;
       //loop over points on second polygon
       for(unsigned int j = 0; j < npoints2; ++j){
-	float pt2w = cluster2.GetParams().PolyObject.Point(j).first;
-	float pt2t = cluster2.GetParams().PolyObject.Point(j).second;
+	float pt2w = params2.PolyObject.Point(j).first;
+	float pt2t = params2.PolyObject.Point(j).second;
 	double distsqrd = pow(pt2w-pt1w,2)+pow(pt2t-pt1t,2);
 
 	if(_debug){
@@ -20,13 +20,17 @@ namespace cmtool {
 			       const ::cluster::ClusterParamsAlg &cluster2)
   {
 
-    if ( (cluster1.GetParams().PolyObject.Size() < 3) or (cluster2.GetParams().PolyObject.Size() < 3) )
+    // only the polygons are needed
+    auto const& params1 = cluster1.GetParams(::cluster::ClusterParamsAlg::kNoParams, true);
+    auto const& params2 = cluster2.GetParams(::cluster::ClusterParamsAlg::kNoParams, true);
+
+    if ( (params1.PolyObject.Size() < 3) or (params2.PolyObject.Size() < 3) )
       return false;
 
     //if either polygon is fully contained in other
     //then return true! --> MERGE!
-    if ( (cluster1.GetParams().PolyObject.Contained(cluster2.GetParams().PolyObject)) or
-	 (cluster2.GetParams().PolyObject.Contained(cluster1.GetParams().PolyObject)) )
+    if ( (params1.PolyObject.Contained(params2.PolyObject)) or
+	 (params2.PolyObject.Contained(params1.PolyObject)) )
       return true;
     else
       return false;
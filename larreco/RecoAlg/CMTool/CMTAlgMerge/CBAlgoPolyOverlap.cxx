@@ -23,33 +23,37 @@ namespace cmtool {
 			       const ::cluster::ClusterParamsAlg &cluster2)
   {
 
-    if( (cluster1.GetParams().N_Hits < _min_hits) ||
-	(cluster2.GetParams().N_Hits < _min_hits) )
+    // only the number of hits and the polygon are needed
+    auto const& params1 = cluster1.GetParams(::cluster::ClusterParamsAlg::kAverages, true);
+    auto const& params2 = cluster2.GetParams(::cluster::ClusterParamsAlg::kAverages, true);
+
+    if( (params1.N_Hits < _min_hits) ||
+	(params2.N_Hits < _min_hits) )
       return false;
 
     //if either has < 3 sides do not merge!
-    if ( (cluster1.GetParams().PolyObject.Size() < 2) or
-	 (cluster2.GetParams().PolyObject.Size() < 2) ){
+    if ( (params1.PolyObject.Size() < 2) or
+	 (params2.PolyObject.Size() < 2) ){
       return false;
     }
-    if (_debug and cluster1.GetParams().N_Hits > 10 and cluster2.GetParams().N_Hits > 10) {
+    if (_debug and params1.N_Hits > 10 and params2.N_Hits > 10) {
       std::cout << "Cluster 1:" << std::endl;
-      std::cout << "\tN_Hits: " << cluster1.GetParams().N_Hits << std::endl;
-      std::cout << "\tN Sides:" << cluster1.GetParams().PolyObject.Size() << std::endl;
-      for (unsigned int n=0; n < cluster1.GetParams().PolyObject.Size(); n++)
-	std::cout << "\t\t\t(" << cluster1.GetParams().PolyObject.Point(n).first << ", "
-		  << cluster1.GetParams().PolyObject.Point(n).second << ")" << std::endl;
+      std::cout << "\tN_Hits: " << params1.N_Hits << std::endl;
+      std::cout << "\tN Sides:" << params1.PolyObject.Size() << std::endl;
+      for (unsigned int n=0; n < params1.PolyObject.Size(); n++)
+	std::cout << "\t\t\t(" << params1.PolyObject.Point(n).first << ", "
+		  << params1.PolyObject.Point(n).second << ")" << std::endl;
       std::cout << "Cluster 2:" << std::endl;
-      std::cout << "\tN_Hits: " << cluster2.GetParams().N_Hits << std::endl;
-      std::cout << "\tN Sides:" << cluster2.GetParams().PolyObject.Size() << std::endl;
-      for (unsigned int n=0; n < cluster2.GetParams().PolyObject.Size(); n++)
-	std::cout << "\t\t\t(" << cluster2.GetParams().PolyObject.Point(n).first << ", "
-		  << cluster2.GetParams().PolyObject.Point(n).second << ")" << std::endl;
+      std::cout << "\tN_Hits: " << params2.N_Hits << std::endl;
+      std::cout << "\tN Sides:" << params2.PolyObject.Size() << std::endl;
+      for (unsigned int n=0; n < params2.PolyObject.Size(); n++)
+	std::cout << "\t\t\t(" << params2.PolyObject.Point(n).first << ", "
+		  << params2.PolyObject.Point(n).second << ")" << std::endl;
     }
 
     //if the two polygons overlap even partially
     //then return true! --> MERGE!
-    if ( cluster1.GetParams().PolyObject.PolyOverlapSegments(cluster2.GetParams().PolyObject) ){
+    if ( params1.PolyObject.PolyOverlapSegments(params2.PolyObject) ){
       if (_verbose) { std::cout << "Overlap...merging!" << std::endl; }
       return true;
     }
@@ -39,6 +39,16 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg &cluster1,
 		      const ::cluster::ClusterParamsAlg &cluster2);
 
+    /// Polygons far apart do not overlap
+    virtual double MaxPairDistance() const { return 0; }
+
+    /// Bool() only prints in debug or verbose mode
+    virtual bool ThreadSafe() const { return !(_debug || _verbose); }
+
+    /// Bool() only reads the number of hits and the polygon
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const
+    { return ::cluster::ClusterParamsAlg::kAverages; }
+
     void SetDebug(bool debug) { _debug = debug; }
 
     //both clusters must have > this # of hits to be considered for merging
@@ -39,21 +39,25 @@ namespace cmtool {
       return false;
     }
 
-    double w_start1 = cluster1.GetParams().start_point.w;// * _wire_2_cm;
-    double t_start1 = cluster1.GetParams().start_point.t;// * _time_2_cm;
-    double w_end1   = cluster1.GetParams().end_point.w;//   * _wire_2_cm;
-    double t_end1   = cluster1.GetParams().end_point.t;//   * _time_2_cm;
+    // only the start and end points are needed
+    auto const& params1 = cluster1.GetParams(::cluster::ClusterParamsAlg::kStartPointAndDirection);
+    auto const& params2 = cluster2.GetParams(::cluster::ClusterParamsAlg::kStartPointAndDirection);
 
-    double w_start2 = cluster2.GetParams().start_point.w;// * _wire_2_cm;
-    double t_start2 = cluster2.GetParams().start_point.t;// * _time_2_cm;
-    double w_end2   = cluster2.GetParams().end_point.w;//   * _wire_2_cm;
-    double t_end2   = cluster2.GetParams().end_point.t;//   * _time_2_cm;
+    double w_start1 = params1.start_point.w;// * _wire_2_cm;
+    double t_start1 = params1.start_point.t;// * _time_2_cm;
+    double w_end1   = params1.end_point.w;//   * _wire_2_cm;
+    double t_end1   = params1.end_point.t;//   * _time_2_cm;
+
+    double w_start2 = params2.start_point.w;// * _wire_2_cm;
+    double t_start2 = params2.start_point.t;// * _time_2_cm;
+    double w_end2   = params2.end_point.w;//   * _wire_2_cm;
+    double t_end2   = params2.end_point.t;//   * _time_2_cm;
 
     if (_debug){
-      std::cout << "Start point Cluster 1: (" << cluster1.GetParams().start_point.w << ", " << cluster1.GetParams().start_point.t << ")"  << std::endl;
-      std::cout << "End point Cluster 2: (" << cluster1.GetParams().end_point.w << ", " << cluster1.GetParams().end_point.t << ")"  << std::endl;
-      std::cout << "Start point Cluster 1: (" << cluster2.GetParams().start_point.w << ", " << cluster2.GetParams().start_point.t << ")"  << std::endl;
-      std::cout << "End point Cluster 2: (" << cluster2.GetParams().end_point.w << ", " << cluster2.GetParams().end_point.t << ")"  << std::endl;
+      std::cout << "Start point Cluster 1: (" << params1.start_point.w << ", " << params1.start_point.t << ")"  << std::endl;
+      std::cout << "End point Cluster 2: (" << params1.end_point.w << ", " << params1.end_point.t << ")"  << std::endl;
+      std::cout << "Start point Cluster 1: (" << params2.start_point.w << ", " << params2.start_point.t << ")"  << std::endl;
+      std::cout << "End point Cluster 2: (" << params2.end_point.w << ", " << params2.end_point.t << ")"  << std::endl;
     }
 
     //First, pretend the first cluster is a 2D line segment, from its start point to end point
@@ -14,6 +14,8 @@
 #ifndef RECOTOOL_CBALGOSHORTESTDIST_H
 #define RECOTOOL_CBALGOSHORTESTDIST_H
 
+#include <cmath>
+
 #include "larreco/RecoAlg/CMTool/CMToolBase/CBoolAlgoBase.h"
 #include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
 
@@ -37,6 +39,18 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg &cluster1,
 		      const ::cluster::ClusterParamsAlg &cluster2);
 
+    /// The clusters are compared through their start and end points only
+    virtual double MaxPairDistance() const { return std::sqrt(_max_2D_dist2); }
+
+    /// Bool() only prints in debug or verbose mode
+    virtual bool ThreadSafe() const { return !(_debug || _verbose); }
+
+    /// Bool() only reads the start and end points
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const
+    { return ::cluster::ClusterParamsAlg::kStartPointAndDirection; }
+
+    virtual bool UsesPolygon() const { return false; }
+
 
     /// Method to set cut value in cm^2 for distance compatibility test
     void SetSquaredDistanceCut(double d) { _max_2D_dist2 = d; }
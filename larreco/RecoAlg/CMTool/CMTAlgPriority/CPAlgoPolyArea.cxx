@@ -14,7 +14,7 @@ namespace cmtool {
   //------------------------------------------------------------------------------
   {
 
-    auto area = cluster.GetParams().PolyObject.Area();
+    auto area = cluster.GetParams(::cluster::ClusterParamsAlg::kNoParams, true).PolyObject.Area();
 
     return ( area < _area_cut ? -1 : area);
   }
@@ -13,9 +13,9 @@ namespace cmtool {
   float CPAlgoQSum::Priority(const ::cluster::ClusterParamsAlg &cluster)
   //------------------------------------------------------------------------------
   {
-    if(cluster.GetParams().sum_charge < _qsum_cut) return -1;
+    if(cluster.GetParams(::cluster::ClusterParamsAlg::kAverages).sum_charge < _qsum_cut) return -1;
 
-    return cluster.GetParams().sum_charge;
+    return cluster.GetParams(::cluster::ClusterParamsAlg::kAverages).sum_charge;
   }
 
 
@@ -14,6 +14,8 @@
 #ifndef RECOTOOL_CBOOLALGOBASE_H
 #define RECOTOOL_CBOOLALGOBASE_H
 
+#include <limits>
+
 #include "CMAlgoBase.h"
 
 namespace cmtool {
@@ -44,6 +46,15 @@ namespace cmtool {
       else return true;
     }
 
+    /**
+       Optional function: distance [cm] beyond which Bool() returns false, between the boxes
+       in the wire/time plane enclosing the hits of the two clusters, and their start/end
+       points and polygon if Bool() reads them (see ParamsStage() and UsesPolygon()).
+       CMergeManager does not call Bool() for the pairs farther apart.
+    */
+    virtual double MaxPairDistance() const
+    { return std::numeric_limits<double>::max(); }
+
   };
 
 }
@@ -80,6 +80,26 @@ namespace cmtool {
     /// Setter function for verbosity
     virtual void SetVerbose(bool doit=true) { _verbose = doit; }
 
+    /**
+       Optional function: whether Bool()/Float() may be called concurrently for different
+       sets of clusters, i.e. whether it only reads the clusters and the configuration.
+       If so, CMergeManager/CMatchManager evaluate all the sets before using the results,
+       unless run with verbosity level kPerMerging.
+     */
+    virtual bool ThreadSafe() const { return false; }
+
+    /**
+       Optional function: the stage of the cluster parameters Bool()/Float() read, and whether
+       they read the polygon (see cluster::ClusterParamsAlg::GetParams()). The clusters compute
+       their parameters only when needed: the managers compute these ones before a concurrent
+       evaluation, so that the threads only read the clusters, and CMergeManager bounds the
+       clusters with them (see CBoolAlgoBase::MaxPairDistance()).
+     */
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const
+    { return ::cluster::ClusterParamsAlg::kAllParams; }
+
+    virtual bool UsesPolygon() const { return true; }
+
   protected:
 
     /// TFile pointer to an output file
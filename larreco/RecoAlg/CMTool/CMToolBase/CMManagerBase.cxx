@@ -1,4 +1,5 @@
 #include "CMManagerBase.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CMAlgoBase.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CPriorityAlgoBase.h"
 
 #include "TStopwatch.h"
@@ -20,6 +21,7 @@ namespace cmtool {
     _priority_algo = nullptr;
     _min_nhits = 0;
     _merge_till_converge = false;
+    _concurrent = true;
     Reset();
     _time_report=false;
   }
@@ -57,13 +59,14 @@ namespace cmtool {
       if((*_in_clusters.rbegin()).SetHits(c) < 3) continue;
       (*_in_clusters.rbegin()).DisableFANN();
       //(*_in_clusters.rbegin()).FillParams(true,true,true,true,true,false);
-      (*_in_clusters.rbegin()).FillParams(false,false,false,false,false,false);
-      (*_in_clusters.rbegin()).FillPolygon();
+      // computed when the algorithms first need them
+      (*_in_clusters.rbegin()).ScheduleParams(false,false,false,false,false,false);
+      (*_in_clusters.rbegin()).SchedulePolygon();
 
     }
 
     if(_time_report) {
-      std::cout << Form("  CMManagerBase Time Report: SetClusters (CPAN computation) = %g [s]",
+      std::cout << Form("  CMManagerBase Time Report: SetClusters (CPAN scheduling) = %g [s]",
 			localWatch.RealTime())
 		<< " ... details below." << std::endl;
 
@@ -152,6 +155,26 @@ namespace cmtool {
 
   }
 
+  bool CMManagerBase::Concurrent(const CMAlgoBase& algo) const
+  {
+    // Verbose algorithms print per pair, which only makes sense in order
+    return _concurrent && _debug_mode > kPerMerging && algo.ThreadSafe();
+  }
+
+  void CMManagerBase::ReportCounters(const char* label, const CMAlgoCounters& counters) const
+  {
+    if(!_time_report) return;
+
+    std::cout << Form("  %s = %g [s] ... %zu pairs, %zu pruned, %zu evaluated, %zu accepted",
+		      label,
+		      counters.time,
+		      counters.pairs,
+		      counters.pruned,
+		      counters.calls,
+		      counters.accepted)
+	      << std::endl;
+  }
+
   void CMManagerBase::ComputePriority(const std::vector<cluster::ClusterParamsAlg> &clusters) {
 
     TStopwatch localWatch;
@@ -27,8 +27,25 @@ class TFile;
 
 namespace cmtool {
 
+  class CMAlgoBase;
   class CPriorityAlgoBase;
 
+  /// Counters of the work done by an algorithm run through CMergeManager/CMatchManager
+  struct CMAlgoCounters {
+    /// Cluster pairs (or combinations) the algorithm could have been asked about
+    size_t pairs = 0;
+    /// Pairs skipped because the clusters are too far apart for the algorithm
+    size_t pruned = 0;
+    /// Calls to Bool()/Float()
+    size_t calls = 0;
+    /// Pairs merged/separated/matched according to the algorithm
+    size_t accepted = 0;
+    /// Time spent running over the pairs [s]
+    double time = 0.;
+
+    void Reset() { *this = CMAlgoCounters(); }
+  };
+
   /**
      \class CMManagerBase
      A class that instantiates merging algorithm(s) and run.
@@ -73,6 +90,9 @@ namespace cmtool {
     /// Switch to continue merging till converges
     void MergeTillConverge(bool doit=true) {_merge_till_converge = doit;}
 
+    /// Switch to evaluate cluster pairs concurrently with algorithms that are ThreadSafe()
+    void EvaluateConcurrently(bool doit=true) {_concurrent = doit;}
+
     /// A simple method to add a cluster
     void SetClusters(const std::vector<std::vector<util::PxHit> > &clusters);
     //void SetClusters(const std::vector<std::vector<larutil::PxHit> > &clusters);
@@ -98,6 +118,12 @@ namespace cmtool {
     /// Function to compute priority
     void ComputePriority(const std::vector<cluster::ClusterParamsAlg>& clusters);
 
+    /// Whether the pairs for the algorithm are evaluated concurrently
+    bool Concurrent(const CMAlgoBase& algo) const;
+
+    /// Prints the counters of an algorithm if timings are reported
+    void ReportCounters(const char* label, const CMAlgoCounters& counters) const;
+
     /// FMWK function called @ beginning of Process()
     virtual void EventBegin(){}
 
@@ -139,6 +165,9 @@ namespace cmtool {
     /// Iteration loop switch
     bool _merge_till_converge;
 
+    /// Concurrent evaluation switch
+    bool _concurrent;
+
     /// A holder for # of unique planes in the clusters, computed in ComputePriority() function
     std::set<UChar_t> _planes;
 
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "TStopwatch.h"
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CFloatAlgoBase.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMManagerBase.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMTException.h"
@@ -36,10 +38,13 @@ namespace cmtool {
     if(_match_algo) _match_algo->Reset();
     if(_priority_algo) _priority_algo->Reset();
     _book_keeper.Reset();
+    _match_counters.Reset();
   }
 
   void CMatchManager::EventBegin()
   {
+    _match_counters.Reset();
+
     if(_debug_mode <= kPerMerging) {
       if(_match_algo)    _match_algo->SetVerbose(true);
       if(_priority_algo) _priority_algo->SetVerbose(true);
@@ -65,6 +70,8 @@ namespace cmtool {
   {
     _match_algo->EventEnd();
     if(_priority_algo) _priority_algo->EventEnd();
+
+    ReportCounters("CMatchManager Time Report: matching algorithm", _match_counters);
   }
 
   unsigned int CMFactorial(unsigned int n)
@@ -218,12 +225,20 @@ namespace cmtool {
 
     auto const& combinations = PlaneClusterCombinations(seed);
 
-    // Loop over combinations and call algorithm
-    for(auto const& comb : combinations) {
+    _match_counters.pairs += combinations.size();
+
+    TStopwatch algoWatch;
+
+    algoWatch.Start();
+
+    // Cluster indexes and pointers of a combination
+    auto fill_clusters = [&](const std::vector<std::pair<size_t,size_t> > &comb,
+			     std::vector<unsigned int> &tmp_index_v,
+			     std::vector<const cluster::ClusterParamsAlg*> &ptr_v) {
 
-      std::vector<const cluster::ClusterParamsAlg*> ptr_v;
+      tmp_index_v.clear();
 
-      std::vector<unsigned int> tmp_index_v;
+      ptr_v.clear();
 
       tmp_index_v.reserve(comb.size());
 
@@ -238,6 +253,54 @@ namespace cmtool {
 	ptr_v.push_back(&(_in_clusters.at(in_cluster_index)));
 
       }
+    };
+
+    // With a thread-safe algorithm all the combinations are scored first, then matched in order
+    std::vector<float> scores;
+    const bool concurrent = Concurrent(*_match_algo);
+    if(concurrent) {
+
+      scores.resize(combinations.size());
+
+      // The parameters the algorithm reads are computed here rather than in the threads
+      for(auto const& clusters_per_plane : cluster_array)
+	for(auto const& index : clusters_per_plane)
+	  _in_clusters.at(index).GetParams(_match_algo->ParamsStage(), _match_algo->UsesPolygon());
+
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, combinations.size()),
+			[&](const tbb::blocked_range<size_t> &range) {
+			  std::vector<unsigned int> tmp_index_v;
+			  std::vector<const cluster::ClusterParamsAlg*> ptr_v;
+			  for(size_t icomb = range.begin(); icomb != range.end(); ++icomb) {
+			    fill_clusters(combinations[icomb], tmp_index_v, ptr_v);
+			    scores[icomb] = _match_algo->Float(ptr_v);
+			  }
+			});
+
+      _match_counters.calls += combinations.size();
+    }
+
+    std::vector<const cluster::ClusterParamsAlg*> ptr_v;
+
+    std::vector<unsigned int> tmp_index_v;
+
+    // Loop over combinations and call algorithm
+    for(size_t icomb = 0; icomb < combinations.size(); ++icomb) {
+
+      if(concurrent) {
+
+	if(scores[icomb] > 0) {
+
+	  fill_clusters(combinations[icomb], tmp_index_v, ptr_v);
+
+	  _book_keeper.Match(tmp_index_v,scores[icomb]);
+
+	  _match_counters.accepted++;
+	}
+	continue;
+      }
+
+      fill_clusters(combinations[icomb], tmp_index_v, ptr_v);
 
       if(_debug_mode <= kPerMerging){
 
@@ -254,16 +317,23 @@ namespace cmtool {
 
       auto const& score = _match_algo->Float(ptr_v);
 
+      _match_counters.calls++;
+
       if(_debug_mode <= kPerMerging)
 
 	std::cout << " ... Time taken = " << localWatch.RealTime() << " [s]" << std::endl;
 
-      if(score>0)
+      if(score>0) {
 
 	_book_keeper.Match(tmp_index_v,score);
 
+	_match_counters.accepted++;
+      }
+
     }
 
+    _match_counters.time += algoWatch.RealTime();
+
     if(_debug_mode <= kPerIteration) {
       if(_match_algo) _match_algo->Report();
       if(_priority_algo) _priority_algo->Report();
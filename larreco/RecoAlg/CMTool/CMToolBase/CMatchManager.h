@@ -50,6 +50,9 @@ namespace cmtool {
     /// A method to obtain book keeper
     const CMatchBookKeeper& GetBookKeeper() const { return _book_keeper; }
 
+    /// A method to obtain the counters of the matching algorithm in the last Process() call
+    const CMAlgoCounters& GetMatchCounters() const { return _match_counters; }
+
   protected:
 
     //
@@ -79,6 +82,9 @@ namespace cmtool {
     /// Merging algorithm
     ::cmtool::CFloatAlgoBase* _match_algo;
 
+    /// Counters of the matching algorithm
+    CMAlgoCounters _match_counters;
+
     /// Number of planes
     size_t _nplanes;
 
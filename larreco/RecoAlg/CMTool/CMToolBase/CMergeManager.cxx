@@ -1,11 +1,20 @@
 #include "CMergeManager.h"
 
 #include "RtypesCore.h"
+#include "TStopwatch.h"
 #include "TString.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <numeric>
 #include <set>
 #include <string>
+#include <utility>
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 
 #include "lardata/Utilities/PxUtils.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CBoolAlgoBase.h"
@@ -14,6 +23,60 @@
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMergeBookKeeper.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CPriorityAlgoBase.h"
 
+namespace {
+
+  /// Box in the wire/time plane enclosing the hits of a cluster, and what the algorithm reads of it
+  struct ClusterBox {
+    double w_min, w_max, t_min, t_max;
+  };
+
+  ClusterBox MakeBox(const ::cluster::ClusterParamsAlg &cluster, const ::cmtool::CBoolAlgoBase &algo)
+  {
+    const double inf = std::numeric_limits<double>::infinity();
+    ClusterBox box { inf, -inf, inf, -inf };
+    bool defined = true;
+
+    auto add_point = [&box, &defined](double w, double t) {
+      if(std::isnan(w) || std::isnan(t)) defined = false;
+      box.w_min = std::min(box.w_min, w);
+      box.w_max = std::max(box.w_max, w);
+      box.t_min = std::min(box.t_min, t);
+      box.t_max = std::max(box.t_max, t);
+    };
+
+    for(auto const& hit : cluster.GetHitVector())
+
+      add_point(hit.w, hit.t);
+
+    // The start/end points and the polygon only if the algorithm reads them,
+    // so that the parameters it does not need are not computed
+    const bool points = (algo.ParamsStage() >= ::cluster::ClusterParamsAlg::kStartPointAndDirection);
+    const bool polygon = algo.UsesPolygon();
+    auto const& params = cluster.GetParams(points ? ::cluster::ClusterParamsAlg::kStartPointAndDirection
+					   : ::cluster::ClusterParamsAlg::kNoParams,
+					   polygon);
+
+    if(points) {
+      add_point(params.start_point.w, params.start_point.t);
+      add_point(params.end_point.w, params.end_point.t);
+    }
+
+    if(polygon)
+      for(unsigned int i=0; i<params.PolyObject.Size(); ++i)
+
+	add_point(params.PolyObject.Point(i).first, params.PolyObject.Point(i).second);
+
+    // A cluster with undefined parameters may be anywhere
+    if(!defined || !(box.w_min <= box.w_max) || !(box.t_min <= box.t_max)) {
+      box.w_min = box.t_min = -inf;
+      box.w_max = box.t_max =  inf;
+    }
+
+    return box;
+  }
+
+} // local namespace
+
 namespace cmtool {
 
   CMergeManager::CMergeManager() : CMManagerBase()
@@ -35,6 +98,8 @@ namespace cmtool {
     if(_merge_algo)    _merge_algo->Reset();
     if(_separate_algo) _separate_algo->Reset();
     _iter_ctr = 0;
+    _merge_counters.Reset();
+    _separate_counters.Reset();
   }
 
   /// FMWK function called @ beginning of Process()
@@ -74,6 +139,8 @@ namespace cmtool {
     _tmp_merged_clusters.clear();
     _tmp_merged_indexes.clear();
     _book_keeper_v.clear();
+    _merge_counters.Reset();
+    _separate_counters.Reset();
 
   }
 
@@ -161,6 +228,10 @@ namespace cmtool {
     _book_keeper_v.clear();
     _tmp_merged_clusters.clear();
     _tmp_merged_indexes.clear();
+
+    ReportCounters("CMergeManager Time Report: merging algorithm", _merge_counters);
+    if(_separate_algo)
+      ReportCounters("CMergeManager Time Report: separation algorithm", _separate_counters);
   }
 
   bool CMergeManager::IterationProcess()
@@ -170,7 +241,7 @@ namespace cmtool {
     CMergeBookKeeper bk;
 
     if(!_iter_ctr) _tmp_merged_clusters = _in_clusters;
-    else _tmp_merged_clusters = _out_clusters;
+    else _tmp_merged_clusters.swap(_out_clusters);
     _out_clusters.clear();
 
     bk.Reset(_tmp_merged_clusters.size());
@@ -205,8 +276,9 @@ namespace cmtool {
       _out_clusters.reserve(_tmp_merged_indexes.size());
       for(auto const& indexes_v : _tmp_merged_indexes) {
 
+	// only the number of the input clusters is used after this
 	if(indexes_v.size()==1) {
-	  _out_clusters.push_back(_tmp_merged_clusters.at(indexes_v.at(0)));
+	  _out_clusters.push_back(std::move(_tmp_merged_clusters.at(indexes_v.at(0))));
 	  continue;
 	}
 
@@ -226,8 +298,9 @@ namespace cmtool {
 	(*_out_clusters.rbegin()).DisableFANN();
 
 	if((*_out_clusters.rbegin()).SetHits(tmp_hits) < 1) continue;
-	(*_out_clusters.rbegin()).FillParams(true,true,true,true,true,false);
-	(*_out_clusters.rbegin()).FillPolygon();
+	// computed when the algorithms first need them
+	(*_out_clusters.rbegin()).ScheduleParams(true,true,true,true,true,false);
+	(*_out_clusters.rbegin()).SchedulePolygon();
       }
       _book_keeper_v.push_back(bk);
     }
@@ -245,7 +318,7 @@ namespace cmtool {
   }
 
   void CMergeManager::RunMerge(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
-			       CMergeBookKeeper &book_keeper) const
+			       CMergeBookKeeper &book_keeper)
   {
     RunMerge(in_clusters,
 	     std::vector<bool>(in_clusters.size(),true),
@@ -254,7 +327,7 @@ namespace cmtool {
 
   void CMergeManager::RunMerge(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
 			       const std::vector<bool> &merge_flag,
-			       CMergeBookKeeper &book_keeper) const
+			       CMergeBookKeeper &book_keeper)
   {
     if(merge_flag.size() != in_clusters.size())
       throw CMTException(Form("in_clusters (%zu) and merge_flag (%zu) vectors must be of same length!",
@@ -274,59 +347,82 @@ namespace cmtool {
     // Merging
     //
 
-    // Run over clusters and execute merging algorithms
-    for(auto citer1 = _priority.rbegin();
-	citer1 != _priority.rend();
-	++citer1) {
+    TStopwatch localWatch;
 
-      auto citer2 = citer1;
+    localWatch.Start();
 
-      UChar_t plane1 = in_clusters.at((*citer1).second).Plane();
+    // Clusters in the order of priority
+    std::vector<size_t> order;
+    order.reserve(_priority.size());
+    for(auto citer = _priority.rbegin(); citer != _priority.rend(); ++citer)
 
-      while(1) {
-	citer2++;
-	if(citer2 == _priority.rend()) break;
+      order.push_back((*citer).second);
 
-	// Skip if not on the same plane
-	UChar_t plane2 = in_clusters.at((*citer2).second).Plane();
-	if(plane1 != plane2) continue;
+    auto pairs = CandidatePairs(in_clusters, order, *_merge_algo, _merge_counters);
 
-	// Skip if this combination is not meant to be compared
-	if(!(merge_flag.at((*citer2).second)) && !(merge_flag.at((*citer1).second)) ) continue;
+    // Skip the combinations not meant to be compared or not allowed to merge:
+    // merging only adds prohibitions, so they are not inspected later either
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+			       [&](const std::pair<size_t,size_t> &p) {
+				 return ( (!(merge_flag.at(p.first)) && !(merge_flag.at(p.second))) ||
+					  !(book_keeper.MergeAllowed(p.first,p.second)) );
+			       }),
+		pairs.end());
 
-	// Skip if this combination is not allowed to merge
-	if(!(book_keeper.MergeAllowed((*citer1).second,(*citer2).second))) continue;
+    // With a thread-safe algorithm all the pairs are evaluated first, then merged in order
+    std::vector<char> result;
+    const bool concurrent = Concurrent(*_merge_algo);
+    if(concurrent) {
+      EvaluatePairs(in_clusters, pairs, *_merge_algo, result);
+      _merge_counters.calls += pairs.size();
+    }
 
-	if(_debug_mode <= kPerMerging){
+    // Run over cluster pairs and execute merging algorithms
+    for(size_t ipair = 0; ipair < pairs.size(); ++ipair) {
 
-	  std::cout
-	    << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",(*citer1).second, (*citer2).second)
-	    << std::endl;
-	}
+      auto const& index1 = pairs[ipair].first;
+      auto const& index2 = pairs[ipair].second;
 
-	bool merge = _merge_algo->Bool(in_clusters.at((*citer1).second),in_clusters.at((*citer2).second));
+      // Skip if this combination is not allowed to merge
+      if(!(book_keeper.MergeAllowed(index1,index2))) continue;
 
-	if(_debug_mode <= kPerMerging) {
+      if(_debug_mode <= kPerMerging){
 
-	  if(merge)
-	    std::cout << "    \033[93mfound to be merged!\033[00m "
-		      << std::endl
-		      << std::endl;
+	std::cout
+	  << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",index1, index2)
+	  << std::endl;
+      }
 
-	  else
-	    std::cout << "    \033[93mfound NOT to be merged...\033[00m"
-		      << std::endl
-		      << std::endl;
+      bool merge = false;
+      if(concurrent) merge = result[ipair];
+      else {
+	merge = _merge_algo->Bool(in_clusters.at(index1),in_clusters.at(index2));
+	_merge_counters.calls++;
+      }
 
-	} // end looping over all sets of algorithms
+      if(_debug_mode <= kPerMerging) {
 
 	if(merge)
+	  std::cout << "    \033[93mfound to be merged!\033[00m "
+		    << std::endl
+		    << std::endl;
+
+	else
+	  std::cout << "    \033[93mfound NOT to be merged...\033[00m"
+		    << std::endl
+		    << std::endl;
+
+      } // end looping over all sets of algorithms
 
-	  book_keeper.Merge((*citer1).second,(*citer2).second);
+      if(merge) {
+
+	book_keeper.Merge(index1,index2);
+	_merge_counters.accepted++;
+      }
 
-      } // end looping over all cluster pairs for citer1
+    } // end looping over all cluster pairs
 
-    } // end looping over clusters
+    _merge_counters.time += localWatch.RealTime();
 
     if(_debug_mode <= kPerIteration && book_keeper.GetResult().size() != in_clusters.size()) {
 
@@ -346,7 +442,7 @@ namespace cmtool {
   }
 
   void CMergeManager::RunSeparate(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
-				  CMergeBookKeeper &book_keeper) const
+				  CMergeBookKeeper &book_keeper)
   {
     /*
     if(separate_flag.size() != in_clusters.size())
@@ -368,51 +464,178 @@ namespace cmtool {
     // Separation
     //
 
-    // Run over clusters and execute merging algorithms
-    for(size_t cindex1 = 0; cindex1 < in_clusters.size(); ++cindex1) {
+    TStopwatch localWatch;
 
-      UChar_t plane1 = in_clusters.at(cindex1).Plane();
+    localWatch.Start();
 
-      for(size_t cindex2 = cindex1+1; cindex2 < in_clusters.size(); ++cindex2) {
+    // Clusters in the order of their indexes
+    std::vector<size_t> order(in_clusters.size());
+    std::iota(order.begin(), order.end(), 0);
 
-	// Skip if not on the same plane
-	UChar_t plane2 = in_clusters.at(cindex2).Plane();
-	if(plane1 != plane2) continue;
+    auto const pairs = CandidatePairs(in_clusters, order, *_separate_algo, _separate_counters);
 
-	// Skip if this combination is not meant to be compared
-	//if(!(separate_flag.at(cindex2))) continue;
-
-	if(_debug_mode <= kPerMerging){
+    std::vector<char> result;
+    const bool concurrent = Concurrent(*_separate_algo);
+    if(concurrent) {
+      EvaluatePairs(in_clusters, pairs, *_separate_algo, result);
+      _separate_counters.calls += pairs.size();
+    }
 
-	  std::cout
-	    << Form("    \033[93mInspecting a pair (%zu, %zu) for separation... \033[00m",cindex1,cindex2)
-	    << std::endl;
-	}
+    // Run over cluster pairs and execute separation algorithms
+    for(size_t ipair = 0; ipair < pairs.size(); ++ipair) {
 
-	bool separate = _separate_algo->Bool(in_clusters.at(cindex1),in_clusters.at(cindex2));
+      auto const& cindex1 = pairs[ipair].first;
+      auto const& cindex2 = pairs[ipair].second;
 
-	if(_debug_mode <= kPerMerging) {
+      if(_debug_mode <= kPerMerging){
 
-	  if(separate)
-	    std::cout << "    \033[93mfound to be separated!\033[00m "
-		      << std::endl
-		      << std::endl;
+	std::cout
+	  << Form("    \033[93mInspecting a pair (%zu, %zu) for separation... \033[00m",cindex1,cindex2)
+	  << std::endl;
+      }
 
-	  else
-	    std::cout << "    \033[93mfound NOT to be separated...\033[00m"
-		      << std::endl
-		      << std::endl;
+      bool separate = false;
+      if(concurrent) separate = result[ipair];
+      else {
+	separate = _separate_algo->Bool(in_clusters.at(cindex1),in_clusters.at(cindex2));
+	_separate_counters.calls++;
+      }
 
-	} // end looping over all sets of algorithms
+      if(_debug_mode <= kPerMerging) {
 
 	if(separate)
+	  std::cout << "    \033[93mfound to be separated!\033[00m "
+		    << std::endl
+		    << std::endl;
+
+	else
+	  std::cout << "    \033[93mfound NOT to be separated...\033[00m"
+		    << std::endl
+		    << std::endl;
+
+      } // end looping over all sets of algorithms
+
+      if(separate) {
+
+	book_keeper.ProhibitMerge(cindex1,cindex2);
+	_separate_counters.accepted++;
+      }
+
+    } // end looping over all cluster pairs
+
+    _separate_counters.time += localWatch.RealTime();
+
+  }
+
+  std::vector<std::pair<size_t,size_t> > CMergeManager::CandidatePairs(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
+									 const std::vector<size_t> &order,
+									 const CBoolAlgoBase &algo,
+									 CMAlgoCounters &counters) const
+  {
+    const double max_dist = algo.MaxPairDistance();
+
+    std::vector<std::pair<size_t,size_t> > pairs;
+
+    if(!(max_dist < std::numeric_limits<double>::max())) {
+
+      // No limit: all the pairs on the same plane
+      for(size_t i=0; i<order.size(); ++i) {
+
+	UChar_t plane1 = in_clusters.at(order[i]).Plane();
+
+	for(size_t j=i+1; j<order.size(); ++j)
+
+	  if(in_clusters.at(order[j]).Plane() == plane1) pairs.emplace_back(order[i], order[j]);
+      }
+      counters.pairs += pairs.size();
+
+      return pairs;
+    }
+
+    // Position of each cluster in the order of inspection
+    std::vector<size_t> rank(in_clusters.size(), in_clusters.size());
+    for(size_t i=0; i<order.size(); ++i) rank.at(order[i]) = i;
+
+    // Clusters of each plane, in the order of inspection
+    std::map<UChar_t, std::vector<size_t> > plane_clusters;
+    for(auto const& index : order)
+
+      plane_clusters[in_clusters.at(index).Plane()].push_back(index);
+
+    // Sweep the cluster boxes along the wire axis: the pairs beyond the distance are never compared
+    const double limit = max_dist * (1. + 1.e-6) + 1.e-6; // against rounding
+
+    for(auto const& plane_v : plane_clusters) {
+
+      auto const& indexes = plane_v.second;
 
-	  book_keeper.ProhibitMerge(cindex1,cindex2);
+      const size_t npairs = indexes.size() * (indexes.size() - 1) / 2;
+      const size_t nfound = pairs.size();
+      counters.pairs += npairs;
 
-      } // end looping over all cluster pairs for citer1
+      std::vector<ClusterBox> boxes;
+      boxes.reserve(indexes.size());
+      for(auto const& index : indexes) boxes.push_back(MakeBox(in_clusters.at(index), algo));
 
-    } // end looping over clusters
+      std::vector<size_t> sorted(indexes.size());
+      std::iota(sorted.begin(), sorted.end(), 0);
+      std::sort(sorted.begin(), sorted.end(),
+		[&boxes](size_t a, size_t b) { return boxes[a].w_min < boxes[b].w_min; });
+
+      for(size_t a=0; a<sorted.size(); ++a) {
+
+	auto const& box1 = boxes[sorted[a]];
+
+	for(size_t b=a+1; b<sorted.size(); ++b) {
+
+	  auto const& box2 = boxes[sorted[b]];
+
+	  const double dw = box2.w_min - box1.w_max;
+	  if(dw > limit) break;
+
+	  const double dt = std::max(box2.t_min - box1.t_max, box1.t_min - box2.t_max);
+	  const double dw2 = dw > 0 ? dw*dw : 0;
+	  const double dt2 = dt > 0 ? dt*dt : 0;
+	  if(dw2 + dt2 > limit*limit) continue;
+
+	  const size_t i = std::min(sorted[a], sorted[b]);
+	  const size_t j = std::max(sorted[a], sorted[b]);
+	  pairs.emplace_back(indexes[i], indexes[j]);
+	}
+      }
+
+      counters.pruned += npairs - (pairs.size() - nfound);
+    }
+
+    // Inspect the pairs in the order of the clusters
+    std::sort(pairs.begin(), pairs.end(),
+	      [&rank](const std::pair<size_t,size_t> &a, const std::pair<size_t,size_t> &b) {
+		return rank[a.first] < rank[b.first] ||
+		  (rank[a.first] == rank[b.first] && rank[a.second] < rank[b.second]);
+	      });
+
+    return pairs;
+  }
+
+  void CMergeManager::EvaluatePairs(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
+				    const std::vector<std::pair<size_t,size_t> > &pairs,
+				    CBoolAlgoBase &algo,
+				    std::vector<char> &result) const
+  {
+    result.assign(pairs.size(), false);
+
+    // The parameters the algorithm reads are computed here rather than in the threads
+    for(auto const& p : pairs) {
+      in_clusters.at(p.first).GetParams(algo.ParamsStage(), algo.UsesPolygon());
+      in_clusters.at(p.second).GetParams(algo.ParamsStage(), algo.UsesPolygon());
+    }
 
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pairs.size()),
+		      [&](const tbb::blocked_range<size_t> &range) {
+			for(size_t ipair = range.begin(); ipair != range.end(); ++ipair)
+			  result[ipair] = algo.Bool(in_clusters.at(pairs[ipair].first),
+						    in_clusters.at(pairs[ipair].second));
+		      });
   }
 
 }
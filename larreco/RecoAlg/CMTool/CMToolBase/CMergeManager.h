@@ -18,6 +18,8 @@
 #include "CMergeBookKeeper.h"
 
 #include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+#include <stddef.h>
+#include <utility>
 #include <vector>
 
 namespace cmtool {
@@ -54,6 +56,12 @@ namespace cmtool {
     /// A method to obtain book keeper
     const CMergeBookKeeper& GetBookKeeper() const { return _book_keeper; }
 
+    /// A method to obtain the counters of the merging algorithm in the last Process() call
+    const CMAlgoCounters& GetMergeCounters() const { return _merge_counters; }
+
+    /// A method to obtain the counters of the separation algorithm in the last Process() call
+    const CMAlgoCounters& GetSeparateCounters() const { return _separate_counters; }
+
   protected:
 
     //
@@ -78,14 +86,26 @@ namespace cmtool {
   protected:
 
     void RunMerge(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
-		  CMergeBookKeeper &book_keeper) const;
+		  CMergeBookKeeper &book_keeper);
 
     void RunMerge(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
 		  const std::vector<bool> &merge_flag,
-		  CMergeBookKeeper &book_keeper) const;
+		  CMergeBookKeeper &book_keeper);
 
     void RunSeparate(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
-		     CMergeBookKeeper &book_keeper) const;
+		     CMergeBookKeeper &book_keeper);
+
+    /// Pairs of clusters on the same plane that the algorithm may accept, in the order they are inspected
+    std::vector<std::pair<size_t,size_t> > CandidatePairs(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
+							    const std::vector<size_t> &order,
+							    const CBoolAlgoBase &algo,
+							    CMAlgoCounters &counters) const;
+
+    /// Evaluates the algorithm on the cluster pairs concurrently
+    void EvaluatePairs(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
+		       const std::vector<std::pair<size_t,size_t> > &pairs,
+		       CBoolAlgoBase &algo,
+		       std::vector<char> &result) const;
 
   protected:
 
@@ -101,6 +121,12 @@ namespace cmtool {
     /// Separation algorithm
     ::cmtool::CBoolAlgoBase* _separate_algo;
 
+    /// Counters of the merging algorithm
+    CMAlgoCounters _merge_counters;
+
+    /// Counters of the separation algorithm
+    CMAlgoCounters _separate_counters;
+
     size_t _iter_ctr;
 
     std::vector<CMergeBookKeeper> _book_keeper_v;
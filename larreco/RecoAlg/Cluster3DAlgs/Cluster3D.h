@@ -23,6 +23,7 @@
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "lardataobj/RecoBase/Hit.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Voronoi/DCEL.h"
 namespace recob { class Hit; }
 
@@ -331,21 +332,29 @@ public:
 /**
  *  @brief export some data structure definitions
  */
+/**
+ *  @brief The containers with a node per 3D hit, cluster member or edge allocate from the
+ *         event arena while the Cluster3D module runs (see EventArena.h)
+ */
+template <typename T> using ArenaList = std::list<T, lar_cluster3d::ArenaAllocator<T>>;
+template <typename K, typename V>
+using ArenaUnorderedMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, lar_cluster3d::ArenaAllocator<std::pair<const K, V>>>;
+
 using Hit2DListPtr             = std::list<const reco::ClusterHit2D*>;
-using HitPairListPtr           = std::list<const reco::ClusterHit3D*>;
+using HitPairListPtr           = ArenaList<const reco::ClusterHit3D*>;
 using HitPairSetPtr            = std::set<const reco::ClusterHit3D*>;
 using HitPairListPtrList       = std::list<HitPairListPtr>;
 using HitPairClusterMap        = std::map<int, HitPairListPtr>;
-using HitPairList              = std::list<reco::ClusterHit3D>;
+using HitPairList              = ArenaList<reco::ClusterHit3D>;
 //using HitPairList              = std::list<std::unique_ptr<reco::ClusterHit3D>>;
 
 using PCAHitPairClusterMapPair = std::pair<reco::PrincipalComponents, reco::HitPairClusterMap::iterator>;
 using PlaneToClusterParamsMap  = std::map<size_t, RecobClusterParameters>;
 using EdgeTuple                = std::tuple<const reco::ClusterHit3D*,const reco::ClusterHit3D*,double>;
-using EdgeList                 = std::list<EdgeTuple>;
+using EdgeList                 = ArenaList<EdgeTuple>;
 using Hit3DToEdgePair          = std::pair<const reco::ClusterHit3D*, reco::EdgeList>;
-using Hit3DToEdgeMap           = std::unordered_map<const reco::ClusterHit3D*, reco::EdgeList>;
-using Hit2DToHit3DListMap      = std::unordered_map<const reco::ClusterHit2D*, reco::HitPairListPtr>;
+using Hit3DToEdgeMap           = ArenaUnorderedMap<const reco::ClusterHit3D*, reco::EdgeList>;
+using Hit2DToHit3DListMap      = ArenaUnorderedMap<const reco::ClusterHit2D*, reco::HitPairListPtr>;
 //using VertexPoint              = Eigen::Vector3f;
 //using VertexPointList          = std::list<Eigen::Vector3f>;
 
@@ -0,0 +1,133 @@
+/**
+ *  @file   ClusterHit3DIO.cxx
+ *
+ *  @brief  Read and write 3D hits to a simple binary file
+ *
+ */
+
+// Framework Includes
+#include "cetlib_except/exception.h"
+
+// LArSoft includes
+#include "larreco/RecoAlg/Cluster3DAlgs/ClusterHit3DIO.h"
+
+// std includes
+#include <cstdint>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// implementation follows
+
+namespace {
+    constexpr char     kMagic[8] = {'L','A','R','H','I','T','3','D'};
+    constexpr uint32_t kVersion  = 1;
+
+    template <typename T>
+    void writeValue(std::ofstream& output, const T& value)
+    { output.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    template <typename T>
+    bool readValue(std::ifstream& input, T& value)
+    { return bool(input.read(reinterpret_cast<char*>(&value), sizeof(T))); }
+}
+
+namespace lar_cluster3d {
+
+ClusterHit3DWriter::ClusterHit3DWriter(const std::string& fileName) :
+    fOutput(fileName, std::ios::binary | std::ios::trunc)
+{
+    if (!fOutput)
+        throw cet::exception("ClusterHit3DIO") << "Cannot open 3D hit file " << fileName << " for writing\n";
+
+    fOutput.write(kMagic, sizeof(kMagic));
+    writeValue(fOutput, kVersion);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ClusterHit3DWriter::Write(const reco::HitPairList& hitPairList)
+{
+    writeValue(fOutput, uint32_t(hitPairList.size()));
+
+    for(const auto& hit3D : hitPairList)
+    {
+        const Eigen::Vector3f position = hit3D.getPosition();
+
+        writeValue(fOutput, uint64_t(hit3D.getID()));
+        writeValue(fOutput, position[0]);
+        writeValue(fOutput, position[1]);
+        writeValue(fOutput, position[2]);
+        writeValue(fOutput, hit3D.getTotalCharge());
+        writeValue(fOutput, hit3D.getAvePeakTime());
+        writeValue(fOutput, hit3D.getSigmaPeakTime());
+        writeValue(fOutput, uint32_t(hit3D.getWireIDs().size()));
+
+        for(const auto& wireID : hit3D.getWireIDs())
+        {
+            writeValue(fOutput, uint32_t(wireID.Cryostat));
+            writeValue(fOutput, uint32_t(wireID.TPC));
+            writeValue(fOutput, uint32_t(wireID.Plane));
+            writeValue(fOutput, uint32_t(wireID.Wire));
+        }
+    }
+
+    if (!fOutput) throw cet::exception("ClusterHit3DIO") << "Failed writing 3D hits of event " << fNWritten << "\n";
+
+    fNWritten++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::vector<reco::HitPairList> ReadClusterHit3Ds(const std::string& fileName, size_t maxEvents)
+{
+    std::ifstream input(fileName, std::ios::binary);
+
+    if (!input) throw cet::exception("ClusterHit3DIO") << "Cannot open 3D hit file " << fileName << "\n";
+
+    char     magic[sizeof(kMagic)];
+    uint32_t version(0);
+
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !readValue(input, version))
+        throw cet::exception("ClusterHit3DIO") << "File " << fileName << " is not a 3D hit file\n";
+
+    if (version != kVersion)
+        throw cet::exception("ClusterHit3DIO") << "File " << fileName << " has format version " << version << ", expected " << kVersion << "\n";
+
+    std::vector<reco::HitPairList> eventVec;
+    uint32_t                       nHits(0);
+
+    while((maxEvents == 0 || eventVec.size() < maxEvents) && readValue(input, nHits))
+    {
+        eventVec.emplace_back();
+
+        reco::HitPairList& hitPairList = eventVec.back();
+
+        for(uint32_t hitIdx = 0; hitIdx < nHits; hitIdx++)
+        {
+            uint64_t                 id(0);
+            float                    values[6];
+            uint32_t                 nWireIDs(0);
+            std::vector<geo::WireID> wireIDVec;
+
+            if (!readValue(input, id) || !readValue(input, values) || !readValue(input, nWireIDs))
+                throw cet::exception("ClusterHit3DIO") << "Truncated event in " << fileName << "\n";
+
+            for(uint32_t wireIdx = 0; wireIdx < nWireIDs; wireIdx++)
+            {
+                uint32_t wire[4];
+
+                if (!readValue(input, wire)) throw cet::exception("ClusterHit3DIO") << "Truncated event in " << fileName << "\n";
+
+                wireIDVec.emplace_back(wire[0], wire[1], wire[2], wire[3]);
+            }
+
+            hitPairList.emplace_back(id, 0, Eigen::Vector3f(values[0], values[1], values[2]),
+                                     values[3], values[4], 0., values[5], 0., 0., 0., 0., 0.,
+                                     reco::ClusterHit2DVec(), std::vector<float>(3, 0.), wireIDVec);
+        }
+    }
+
+    return eventVec;
+}
+
+} // namespace lar_cluster3d
@@ -0,0 +1,60 @@
+/**
+ *  @file   ClusterHit3DIO.h
+ *
+ *  @brief  Read and write the 3D hits of an event to a simple binary file, so that the
+ *          clustering data structures can be exercised on recorded events outside of art
+ *
+ *          Only the quantities used by the neighborhood searches are kept, the 2D hits are not.
+ *
+ *          File layout (native byte order):
+ *            header: 8 byte magic "LARHIT3D", uint32 format version
+ *            event:  uint32 number of hits, then for each hit
+ *                    uint64 id, float x, y, z, total charge, average peak time, sigma peak time,
+ *                    uint32 number of wire IDs, then uint32 cryostat, TPC, plane, wire for each
+ *
+ */
+#ifndef ClusterHit3DIO_h
+#define ClusterHit3DIO_h
+
+// Algorithm includes
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+
+// std includes
+#include <fstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_cluster3d
+{
+/**
+ *  @brief  ClusterHit3DWriter class definiton
+ */
+class ClusterHit3DWriter
+{
+public:
+    /**
+     *  @brief Opens the file and writes the header; throws cet::exception on failure
+     */
+    explicit ClusterHit3DWriter(const std::string& fileName);
+
+    /**
+     *  @brief Writes the hits of one event
+     */
+    void Write(const reco::HitPairList& hitPairList);
+
+    size_t NWritten() const {return fNWritten;}
+
+private:
+    std::ofstream fOutput;
+    size_t        fNWritten = 0;
+};
+
+/**
+ *  @brief Reads back up to maxEvents events (0 for all); throws cet::exception on failure
+ */
+std::vector<reco::HitPairList> ReadClusterHit3Ds(const std::string& fileName, size_t maxEvents = 0);
+
+} // namespace lar_cluster3d
+#endif
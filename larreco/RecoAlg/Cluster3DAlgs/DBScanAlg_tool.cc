@@ -16,6 +16,7 @@
 // LArSoft includes
 #include "larcore/Geometry/Geometry.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterParamsBuilder.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
@@ -73,6 +74,17 @@ public:
 
 private:
 
+    /**
+     *  @brief Build the tree to search, the returned top node is a null node if the flat tree is used
+     */
+    template <typename HitList>
+    kdTree::KdTreeNode BuildKdTree(const HitList&, kdTree::KdTreeNodeList&) const;
+
+    /**
+     *  @brief Find the epsilon neighborhood of a hit in the tree that was built
+     */
+    size_t FindNearestNeighbors(const reco::ClusterHit3D*, const kdTree::KdTreeNode&, kdTree::CandPairList&) const;
+
     /**
      *  @brief the main routine for DBScan
      */
@@ -90,6 +102,9 @@ private:
 
     std::unique_ptr<lar_cluster3d::IClusterParametersBuilder> m_clusterBuilder;        ///<  Common cluster builder tool
     kdTree                                                    m_kdTree;                // For the kdTree
+    bool                                                      m_useFlatKdTree;         ///< Search the neighborhoods in the FlatKdTree
+    mutable FlatKdTree                                        m_flatKdTree;            ///< The flat tree, if used
+    mutable FlatKdTree::NeighborVec                           m_neighbors;             ///< Buffer for the flat tree searches
 };
 
 DBScanAlg::DBScanAlg(fhicl::ParameterSet const &pset)
@@ -130,6 +145,10 @@ void DBScanAlg::configure(fhicl::ParameterSet const &pset)
     kdTreeParams.put_or_replace<float>("RefLeafBestDist", maxBestDist);
 
     m_kdTree = kdTree(kdTreeParams);
+
+    m_useFlatKdTree = pset.get<bool>("UseFlatKdTree", false);
+
+    if (m_useFlatKdTree) m_flatKdTree.configure(pset.get<fhicl::ParameterSet>("FlatKdTree"));
 }
 
 void DBScanAlg::Cluster3DHits(reco::HitPairList&           hitPairList,
@@ -147,9 +166,7 @@ void DBScanAlg::Cluster3DHits(reco::HitPairList&           hitPairList,
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
     kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode     topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
-
-    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
+    kdTree::KdTreeNode     topNode = BuildKdTree(hitPairList, kdTreeNodeContainer);
 
     if (m_enableMonitoring) theClockDBScan.start();
 
@@ -165,9 +182,8 @@ void DBScanAlg::Cluster3DHits(reco::HitPairList&           hitPairList,
 
         // Find the neighborhood for this hit
         kdTree::CandPairList candPairList;
-        float                bestDistance(std::numeric_limits<float>::max());
 
-        m_kdTree.FindNearestNeighbors(&hit, topNode, candPairList, bestDistance);
+        FindNearestNeighbors(&hit, topNode, candPairList);
 
         if (candPairList.size() < m_minPairPts)
         {
@@ -230,9 +246,7 @@ void DBScanAlg::Cluster3DHits(reco::HitPairListPtr&        hitPairList,
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
     kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode     topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
-
-    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
+    kdTree::KdTreeNode     topNode = BuildKdTree(hitPairList, kdTreeNodeContainer);
 
     if (m_enableMonitoring) theClockDBScan.start();
 
@@ -248,9 +262,8 @@ void DBScanAlg::Cluster3DHits(reco::HitPairListPtr&        hitPairList,
 
         // Find the neighborhood for this hit
         kdTree::CandPairList candPairList;
-        float                bestDistance(std::numeric_limits<float>::max());
 
-        m_kdTree.FindNearestNeighbors(hit, topNode, candPairList, bestDistance);
+        FindNearestNeighbors(hit, topNode, candPairList);
 
         if (candPairList.size() < m_minPairPts)
         {
@@ -298,6 +311,40 @@ void DBScanAlg::Cluster3DHits(reco::HitPairListPtr&        hitPairList,
     return;
 }
 
+template <typename HitList>
+kdTree::KdTreeNode DBScanAlg::BuildKdTree(const HitList& hitPairList, kdTree::KdTreeNodeList& kdTreeNodeContainer) const
+{
+    if (m_useFlatKdTree)
+    {
+        m_flatKdTree.BuildKdTree(hitPairList);
+
+        if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_flatKdTree.getTimeToExecute();
+
+        kdTreeNodeContainer.emplace_back();
+
+        return kdTreeNodeContainer.back();
+    }
+
+    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+
+    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
+
+    return topNode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+size_t DBScanAlg::FindNearestNeighbors(const reco::ClusterHit3D* hit, const kdTree::KdTreeNode& topNode, kdTree::CandPairList& candPairList) const
+{
+    if (m_useFlatKdTree) return m_kdTree.FindNearestNeighbors(hit, m_flatKdTree, m_neighbors, candPairList);
+
+    float bestDistance(std::numeric_limits<float>::max());
+
+    return m_kdTree.FindNearestNeighbors(hit, topNode, candPairList, bestDistance);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void DBScanAlg::expandCluster(const kdTree::KdTreeNode& topNode,
                               kdTree::CandPairList&     candPairList,
                               reco::ClusterParameters&  cluster,
@@ -319,9 +366,8 @@ void DBScanAlg::expandCluster(const kdTree::KdTreeNode& topNode,
 
             // get the neighborhood around this point
             kdTree::CandPairList neighborCandPairList;
-            float                bestDistance(std::numeric_limits<float>::max());
 
-            m_kdTree.FindNearestNeighbors(neighborHit, topNode, neighborCandPairList, bestDistance);
+            FindNearestNeighbors(neighborHit, topNode, neighborCandPairList);
 
             // If the epsilon neighborhood of this point is large enough then add its points to our list
             if (neighborCandPairList.size() >= minPts)
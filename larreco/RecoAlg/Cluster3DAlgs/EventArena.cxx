@@ -0,0 +1,169 @@
+/**
+ *  @file   EventArena.cxx
+ *
+ *  @brief  Event scoped memory arena for the node based containers of the 3D clustering
+ *
+ */
+
+// LArSoft includes
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
+
+// std includes
+#include <algorithm>
+#include <cstdlib>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// implementation follows
+
+namespace lar_cluster3d {
+
+namespace {
+    /**
+     *  @brief The part of a chunk this thread bump allocates from. It is only valid while the
+     *         arena's generation matches, generations are unique over all arenas
+     */
+    struct Cursor
+    {
+        const EventArena* arena      = nullptr;
+        uint64_t          generation = 0;
+        char*             current    = nullptr;
+        char*             end        = nullptr;
+    };
+
+    thread_local Cursor      threadCursor;
+    thread_local EventArena* threadArena = nullptr;
+
+    std::atomic<uint64_t>    lastGeneration{0};
+
+    char* alignUp(char* ptr, size_t alignment)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+
+        return ptr + (alignment - address % alignment) % alignment;
+    }
+}
+
+EventArena::EventArena(size_t chunkSize) :
+    fChunkSize(std::max(chunkSize, size_t(1024))),
+    fGeneration(++lastGeneration),
+    fNumScopes(0),
+    fFirstChunkFree(false),
+    fBytesReserved(0),
+    fHighWaterMark(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventArena::~EventArena()
+{
+    for(auto& chunk : fChunks) std::free(chunk.begin);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventArena::Scope::Scope(EventArena& arena) : fArena(arena), fPrevious(threadArena)
+{
+    threadArena = &fArena;
+
+    ++fArena.fNumScopes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventArena::Scope::~Scope()
+{
+    threadArena = fPrevious;
+
+    if (--fArena.fNumScopes == 0) fArena.release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventArena* EventArena::current()
+{
+    return threadArena;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void* EventArena::allocate(size_t bytes, size_t alignment)
+{
+    Cursor& cursor = threadCursor;
+
+    if (cursor.arena == this && cursor.generation == fGeneration.load(std::memory_order_relaxed))
+    {
+        char* start = alignUp(cursor.current, alignment);
+
+        if (start + bytes <= cursor.end)
+        {
+            cursor.current = start + bytes;
+            return start;
+        }
+    }
+
+    // This thread needs a new chunk, the rest of its current one is abandoned
+    std::lock_guard<std::mutex> lock(fChunkMutex);
+
+    Chunk* chunk = nullptr;
+
+    if (fFirstChunkFree && fChunks.front().size >= bytes + alignment)
+    {
+        chunk           = &fChunks.front();
+        fFirstChunkFree = false;
+    }
+    else chunk = &newChunk(bytes + alignment);
+
+    fBytesReserved += chunk->size;
+    fHighWaterMark  = std::max(fHighWaterMark, fBytesReserved);
+
+    char* start = alignUp(chunk->begin, alignment);
+
+    cursor.arena      = this;
+    cursor.generation = fGeneration.load(std::memory_order_relaxed);
+    cursor.current    = start + bytes;
+    cursor.end        = chunk->begin + chunk->size;
+
+    return start;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventArena::release()
+{
+    // Keep one chunk holding what this event needed so the next one typically needs no heap allocation at all
+    if (fChunks.size() > 1)
+    {
+        size_t bytesNeeded = fBytesReserved;
+
+        for(auto& chunk : fChunks) std::free(chunk.begin);
+
+        fChunks.clear();
+
+        newChunk(bytesNeeded);
+    }
+
+    fFirstChunkFree = !fChunks.empty();
+    fBytesReserved  = 0;
+
+    // Invalidate the cursors of all threads
+    fGeneration = ++lastGeneration;
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventArena::Chunk& EventArena::newChunk(size_t bytes)
+{
+    size_t size  = std::max(bytes, fChunkSize);
+    char*  begin = static_cast<char*>(std::malloc(size));
+
+    if (!begin) throw std::bad_alloc();
+
+    fChunks.push_back(Chunk{begin, size});
+
+    return fChunks.back();
+}
+
+} // namespace lar_cluster3d
@@ -0,0 +1,159 @@
+/**
+ *  @file   EventArena.h
+ *
+ *  @brief  Event scoped memory arena for the node based containers of the 3D clustering
+ *
+ *          The 3D clustering builds lists and maps with one heap node per 3D hit, per
+ *          cluster member and per edge, all of which die together at the end of the event.
+ *          An EventArena hands out that memory from a few large chunks with a simple bump
+ *          pointer and gets it all back in one go with release().
+ *
+ *          The containers of Cluster3D.h use ArenaAllocator, which allocates from the arena
+ *          made current on the calling thread by an EventArena::Scope and falls back to the
+ *          normal heap when there is none, so the containers behave as before outside of the
+ *          Cluster3D module. Containers allocated from an arena must not outlive its scope.
+ *
+ */
+#ifndef EventArena_h
+#define EventArena_h
+
+// std includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_cluster3d
+{
+/**
+ *  @brief  EventArena class definiton
+ */
+class EventArena
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  chunkSize  minimum size of the chunks requested from the heap
+     */
+    explicit EventArena(size_t chunkSize = 1 << 20);
+
+    ~EventArena();
+
+    EventArena(const EventArena&) = delete;
+    EventArena& operator=(const EventArena&) = delete;
+
+    /**
+     *  @brief Makes the arena the current one of this thread for its lifetime. When the
+     *         outermost scope of an arena ends everything allocated from it is released
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(EventArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        EventArena& fArena;
+        EventArena* fPrevious;
+    };
+
+    /**
+     *  @brief The arena of the innermost scope on this thread, nullptr if none
+     */
+    static EventArena* current();
+
+    /**
+     *  @brief Returns aligned memory for bytes, thread safe
+     */
+    void* allocate(size_t bytes, size_t alignment);
+
+    /**
+     *  @brief Gives up all memory allocated since the last release, keeping a single chunk
+     *         big enough for the event seen so far. Not thread safe
+     */
+    void release();
+
+    size_t bytesReserved() const {return fBytesReserved;}   ///< Memory held for this event
+    size_t highWaterMark()  const {return fHighWaterMark;}   ///< Largest bytesReserved() over the events
+
+private:
+
+    struct Chunk
+    {
+        char*  begin;
+        size_t size;
+    };
+
+    /**
+     *  @brief Allocate a new chunk of at least bytes and add it to the list
+     */
+    Chunk& newChunk(size_t bytes);
+
+    size_t                fChunkSize;              ///< Minimum chunk size
+    std::vector<Chunk>    fChunks;                 ///< The chunks handed out for this event, first is reused
+    std::mutex            fChunkMutex;             ///< Protects fChunks across threads
+    std::atomic<uint64_t> fGeneration;             ///< Incremented by release() to invalidate the thread cursors
+    std::atomic<int>      fNumScopes;              ///< Number of open scopes over all threads
+    bool                  fFirstChunkFree;         ///< The chunk kept by release() is not in use yet
+    size_t                fBytesReserved;          ///<
+    size_t                fHighWaterMark;          ///<
+};
+
+/**
+ *  @brief Stateless allocator for the Cluster3D containers, allocating from the current EventArena
+ *
+ *         Each allocation is preceded by the arena it came from (nullptr for the heap) so memory
+ *         can be given back from any thread and after the scope that made it current has changed.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        EventArena* arena = EventArena::current();
+        char*       memory;
+
+        if (arena) memory = static_cast<char*>(arena->allocate(headerSize + n * sizeof(T), headerSize));
+        else       memory = static_cast<char*>(::operator new(headerSize + n * sizeof(T)));
+
+        *reinterpret_cast<EventArena**>(memory) = arena;
+
+        return reinterpret_cast<T*>(memory + headerSize);
+    }
+
+    void deallocate(T* ptr, size_t) noexcept
+    {
+        char* memory = reinterpret_cast<char*>(ptr) - headerSize;
+
+        // Arena memory is only given back by EventArena::release()
+        if (!*reinterpret_cast<EventArena**>(memory)) ::operator delete(memory);
+    }
+
+private:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "ArenaAllocator does not support over-aligned types");
+
+    static constexpr size_t headerSize = alignof(T) > sizeof(EventArena*) ? alignof(T) : sizeof(EventArena*);
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) noexcept {return true;}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) noexcept {return false;}
+
+} // namespace lar_cluster3d
+#endif
@@ -0,0 +1,301 @@
+/**
+ *  @file   FlatKdTree.cxx
+ *
+ *  @brief  Contiguous kdTree with radius and k nearest neighbor queries
+ *
+ */
+
+// Framework Includes
+#include "cetlib/cpu_timer.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// LArSoft includes
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
+
+// std includes
+#include <algorithm>
+#include <numeric>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// implementation follows
+
+namespace lar_cluster3d {
+
+namespace {
+    bool closerThan(const FlatKdTree::Neighbor& left, const FlatKdTree::Neighbor& right) {return left.dist2 < right.dist2;}
+}
+
+FlatKdTree::FlatKdTree(fhicl::ParameterSet const &pset)
+{
+    this->configure(pset);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void FlatKdTree::configure(fhicl::ParameterSet const &pset)
+{
+    fEnableMonitoring = pset.get<bool>  ("EnableMonitoring", true);
+    fLeafSize         = pset.get<size_t>("LeafSize",         8   );
+
+    fLeafSize    = std::max(fLeafSize, size_t(1));
+    fTimeToBuild = 0;
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::BuildKdTree(const reco::HitPairList& hitPairList)
+{
+    Hit3DVec hit3DVec;
+
+    hit3DVec.reserve(hitPairList.size());
+
+    for(const auto& hit : hitPairList) hit3DVec.emplace_back(&hit);
+
+    BuildKdTree(hit3DVec);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::BuildKdTree(const reco::HitPairListPtr& hitPairList)
+{
+    BuildKdTree(Hit3DVec(hitPairList.begin(), hitPairList.end()));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::BuildKdTree(const Hit3DVec& hit3DVec)
+{
+    cet::cpu_timer theClockBuildTree;
+
+    if (fEnableMonitoring) theClockBuildTree.start();
+
+    // Copy the positions once, the hits are only read again to fill the coordinate arrays
+    std::vector<Eigen::Vector3f> positions;
+
+    positions.reserve(hit3DVec.size());
+
+    for(const auto& hit3D : hit3DVec) positions.emplace_back(hit3D->getPosition());
+
+    fIndex.resize(hit3DVec.size());
+    std::iota(fIndex.begin(), fIndex.end(), 0);
+
+    fNodes.clear();
+    fNodes.reserve(2 * (hit3DVec.size() / fLeafSize + 1));
+
+    if (!hit3DVec.empty()) BuildNode(0, hit3DVec.size(), positions);
+
+    // Now store the hits and their coordinates in tree order
+    fX.resize(hit3DVec.size());
+    fY.resize(hit3DVec.size());
+    fZ.resize(hit3DVec.size());
+    fHits.resize(hit3DVec.size());
+
+    for(size_t idx = 0; idx < fIndex.size(); idx++)
+    {
+        const Eigen::Vector3f& position = positions[fIndex[idx]];
+
+        fX[idx]    = position[0];
+        fY[idx]    = position[1];
+        fZ[idx]    = position[2];
+        fHits[idx] = hit3DVec[fIndex[idx]];
+    }
+
+    fIndex.clear();
+
+    if (fEnableMonitoring)
+    {
+        theClockBuildTree.stop();
+        fTimeToBuild = theClockBuildTree.accumulated_real_time();
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t FlatKdTree::BuildNode(uint32_t begin, uint32_t end, const std::vector<Eigen::Vector3f>& positions)
+{
+    uint32_t nodeIdx = fNodes.size();
+
+    fNodes.push_back(Node{Node::leafAxis, 0., begin, end, 0});
+
+    if (end - begin <= fLeafSize) return nodeIdx;
+
+    // Split along the axis with the largest range, as the original kdTree does
+    Eigen::Vector3f minPos = positions[fIndex[begin]];
+    Eigen::Vector3f maxPos = minPos;
+
+    for(uint32_t idx = begin + 1; idx < end; idx++)
+    {
+        minPos = minPos.cwiseMin(positions[fIndex[idx]]);
+        maxPos = maxPos.cwiseMax(positions[fIndex[idx]]);
+    }
+
+    Eigen::Vector3f::Index axis;
+
+    (maxPos - minPos).maxCoeff(&axis);
+
+    // Partition around the median, hits to the left are not above the split value and those to the right not below
+    uint32_t middle = begin + (end - begin) / 2;
+
+    std::nth_element(fIndex.begin() + begin, fIndex.begin() + middle, fIndex.begin() + end,
+                     [&positions,axis](uint32_t left, uint32_t right){return positions[left][axis] < positions[right][axis];});
+
+    fNodes[nodeIdx].axis  = axis;
+    fNodes[nodeIdx].value = positions[fIndex[middle]][axis];
+
+    // The left child follows its parent, so only the right one needs to be recorded
+    BuildNode(begin, middle, positions);
+
+    uint32_t rightIdx = BuildNode(middle, end, positions);
+
+    fNodes[nodeIdx].right = rightIdx;
+
+    return nodeIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t FlatKdTree::RadiusSearch(const Eigen::Vector3f& point, float radius, NeighborVec& neighbors) const
+{
+    neighbors.clear();
+
+    const float pointArr[] = {point[0], point[1], point[2]};
+
+    if (!fNodes.empty()) RadiusSearch(0, pointArr, radius * radius, neighbors);
+
+    return neighbors.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::RadiusSearch(const Hit3DVec& queries, float radius, OffsetVec& offsets, NeighborVec& neighbors) const
+{
+    offsets.resize(queries.size() + 1);
+    neighbors.clear();
+
+    offsets[0] = 0;
+
+    for(size_t queryIdx = 0; queryIdx < queries.size(); queryIdx++)
+    {
+        const Eigen::Vector3f position   = queries[queryIdx]->getPosition();
+        const float           pointArr[] = {position[0], position[1], position[2]};
+
+        if (!fNodes.empty()) RadiusSearch(0, pointArr, radius * radius, neighbors);
+
+        offsets[queryIdx + 1] = neighbors.size();
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::RadiusSearch(uint32_t nodeIdx, const float point[3], float radius2, NeighborVec& neighbors) const
+{
+    const Node& node = fNodes[nodeIdx];
+
+    if (node.axis == Node::leafAxis)
+    {
+        for(uint32_t idx = node.begin; idx < node.end; idx++)
+        {
+            float deltaX = fX[idx] - point[0];
+            float deltaY = fY[idx] - point[1];
+            float deltaZ = fZ[idx] - point[2];
+            float dist2  = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+
+            if (dist2 <= radius2) neighbors.push_back(Neighbor{dist2, fHits[idx]});
+        }
+
+        return;
+    }
+
+    float    delta    = point[node.axis] - node.value;
+    uint32_t nearNode = delta < 0. ? nodeIdx + 1 : node.right;
+    uint32_t farNode  = delta < 0. ? node.right  : nodeIdx + 1;
+
+    RadiusSearch(nearNode, point, radius2, neighbors);
+
+    // Nothing on the other side of the split can be closer than the split plane itself
+    if (delta * delta <= radius2) RadiusSearch(farNode, point, radius2, neighbors);
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t FlatKdTree::KNearest(const Eigen::Vector3f& point, size_t k, NeighborVec& neighbors) const
+{
+    neighbors.clear();
+
+    const float pointArr[] = {point[0], point[1], point[2]};
+
+    if (!fNodes.empty() && k > 0) KNearest(0, pointArr, k, 0, neighbors);
+
+    std::sort_heap(neighbors.begin(), neighbors.end(), closerThan);
+
+    return neighbors.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::KNearest(const Hit3DVec& queries, size_t k, OffsetVec& offsets, NeighborVec& neighbors) const
+{
+    offsets.resize(queries.size() + 1);
+    neighbors.clear();
+    neighbors.reserve(queries.size() * std::min(k, size()));
+
+    offsets[0] = 0;
+
+    for(size_t queryIdx = 0; queryIdx < queries.size(); queryIdx++)
+    {
+        const Eigen::Vector3f position   = queries[queryIdx]->getPosition();
+        const float           pointArr[] = {position[0], position[1], position[2]};
+        const size_t          first      = neighbors.size();
+
+        if (!fNodes.empty() && k > 0) KNearest(0, pointArr, k, first, neighbors);
+
+        std::sort_heap(neighbors.begin() + first, neighbors.end(), closerThan);
+
+        offsets[queryIdx + 1] = neighbors.size();
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+void FlatKdTree::KNearest(uint32_t nodeIdx, const float point[3], size_t k, size_t first, NeighborVec& neighbors) const
+{
+    const Node& node = fNodes[nodeIdx];
+
+    if (node.axis == Node::leafAxis)
+    {
+        for(uint32_t idx = node.begin; idx < node.end; idx++)
+        {
+            float deltaX = fX[idx] - point[0];
+            float deltaY = fY[idx] - point[1];
+            float deltaZ = fZ[idx] - point[2];
+            float dist2  = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+
+            // Keep a max heap of the k closest so far
+            if (neighbors.size() - first < k)
+            {
+                neighbors.push_back(Neighbor{dist2, fHits[idx]});
+                std::push_heap(neighbors.begin() + first, neighbors.end(), closerThan);
+            }
+            else if (dist2 < neighbors[first].dist2)
+            {
+                std::pop_heap(neighbors.begin() + first, neighbors.end(), closerThan);
+                neighbors.back() = Neighbor{dist2, fHits[idx]};
+                std::push_heap(neighbors.begin() + first, neighbors.end(), closerThan);
+            }
+        }
+
+        return;
+    }
+
+    float    delta    = point[node.axis] - node.value;
+    uint32_t nearNode = delta < 0. ? nodeIdx + 1 : node.right;
+    uint32_t farNode  = delta < 0. ? node.right  : nodeIdx + 1;
+
+    KNearest(nearNode, point, k, first, neighbors);
+
+    if (neighbors.size() - first < k || delta * delta < neighbors[first].dist2) KNearest(farNode, point, k, first, neighbors);
+
+    return;
+}
+
+} // namespace lar_cluster3d
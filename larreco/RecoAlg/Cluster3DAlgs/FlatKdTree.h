@@ -0,0 +1,154 @@
+/**
+ *  @file   FlatKdTree.h
+ *
+ *  @brief  Implements a contiguous, bucketed kdTree with radius and k nearest neighbor queries
+ *
+ *          The nodes are kept in one vector in depth first order (the left child of a node
+ *          is the next node), the leaves hold up to "LeafSize" hits and the hit coordinates
+ *          are stored as separate x, y and z arrays in tree order so the leaves are scanned
+ *          over contiguous memory. Queries write into caller provided buffers so repeated
+ *          queries do not allocate once the buffers have grown.
+ *
+ */
+#ifndef FlatKdTree_h
+#define FlatKdTree_h
+
+// Framework Includes
+#include "fhiclcpp/fwd.h"
+
+// Algorithm includes
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+
+// std includes
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_cluster3d
+{
+/**
+ *  @brief  FlatKdTree class definiton
+ */
+class FlatKdTree
+{
+public:
+    /**
+     *  @brief  Default Constructor
+     */
+    FlatKdTree() : fEnableMonitoring(false),
+                   fLeafSize(8),
+                   fTimeToBuild(0.) {}
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pset
+     */
+    FlatKdTree(fhicl::ParameterSet const &pset);
+
+    /**
+     *  @brief Configure our kdTree...
+     *
+     *  @param ParameterSet  The input set of parameters for configuration
+     */
+    void configure(fhicl::ParameterSet const &pset);
+
+    using Hit3DVec = std::vector<const reco::ClusterHit3D*>;
+
+    /**
+     *  @brief A hit found by a query and its squared distance to the query point
+     */
+    struct Neighbor
+    {
+        float                     dist2;
+        const reco::ClusterHit3D* hit;
+    };
+
+    using NeighborVec = std::vector<Neighbor>;
+    using OffsetVec   = std::vector<size_t>;
+
+    /**
+     *  @brief Given an input set of ClusterHit3D objects, build the tree (replacing any previous one)
+     */
+    void BuildKdTree(const reco::HitPairList&);
+    void BuildKdTree(const reco::HitPairListPtr&);
+    void BuildKdTree(const Hit3DVec&);
+
+    /**
+     *  @brief Find all hits within radius of the point (including a hit at the point itself)
+     *
+     *  @param point      The query position
+     *  @param radius     The search radius
+     *  @param neighbors  Cleared and filled with the hits found, in no particular order
+     *
+     *  @return the number of hits found
+     */
+    size_t RadiusSearch(const Eigen::Vector3f& point, float radius, NeighborVec& neighbors) const;
+
+    /**
+     *  @brief Find the k hits closest to the point (including a hit at the point itself)
+     *
+     *  @param point      The query position
+     *  @param k          The number of hits to find
+     *  @param neighbors  Cleared and filled with the hits found, closest first
+     *
+     *  @return the number of hits found, less than k only if the tree is smaller
+     */
+    size_t KNearest(const Eigen::Vector3f& point, size_t k, NeighborVec& neighbors) const;
+
+    /**
+     *  @brief Batched versions, with one query at the position of each input hit. The results
+     *         of query i are neighbors[offsets[i]] to neighbors[offsets[i+1]]
+     */
+    void RadiusSearch(const Hit3DVec& queries, float radius, OffsetVec& offsets, NeighborVec& neighbors) const;
+    void KNearest    (const Hit3DVec& queries, size_t k,     OffsetVec& offsets, NeighborVec& neighbors) const;
+
+    size_t size()     const {return fHits.size();}
+    size_t numNodes() const {return fNodes.size();}
+
+    float getTimeToExecute() const {return fTimeToBuild;}
+
+private:
+
+    /**
+     *  @brief A node of the tree. Leaves have axis == leafAxis and own the hits [begin,end),
+     *         other nodes split on axis at value with the right child at index right
+     */
+    struct Node
+    {
+        static constexpr uint32_t leafAxis = 3;
+
+        uint32_t axis;
+        float    value;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t right;
+    };
+
+    /**
+     *  @brief Recursively build the subtree of hits [begin,end) of fIndex, returns its node index
+     */
+    uint32_t BuildNode(uint32_t begin, uint32_t end, const std::vector<Eigen::Vector3f>&);
+
+    /**
+     *  @brief Query the subtree below node, appending to (radius) or keeping a max heap of the
+     *         closest k in (k nearest) the neighbors from index first on
+     */
+    void RadiusSearch(uint32_t node, const float point[3], float radius2,           NeighborVec&) const;
+    void KNearest    (uint32_t node, const float point[3], size_t k, size_t first, NeighborVec&) const;
+
+    bool               fEnableMonitoring;      ///<
+    size_t             fLeafSize;              ///< Maximum number of hits in a leaf
+    float              fTimeToBuild;           ///
+
+    std::vector<Node>     fNodes;              ///< The tree, root first
+    std::vector<uint32_t> fIndex;              ///< Input hit index of each hit in tree order, used while building
+    std::vector<float>    fX;                  ///< Hit coordinates in tree order
+    std::vector<float>    fY;
+    std::vector<float>    fZ;
+    Hit3DVec              fHits;               ///< The hits in tree order
+};
+
+} // namespace lar_cluster3d
+#endif
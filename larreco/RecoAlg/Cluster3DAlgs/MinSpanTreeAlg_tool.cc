@@ -21,6 +21,7 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PrincipalComponentsAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterParamsBuilder.h"
@@ -77,6 +78,16 @@ public:
 
 private:
 
+    /**
+     *  @brief Build the tree to search, the returned top node is a null node if the flat tree is used
+     */
+    kdTree::KdTreeNode BuildKdTree(const reco::HitPairList&, kdTree::KdTreeNodeList&) const;
+
+    /**
+     *  @brief Find the neighbors of a hit in the tree that was built
+     */
+    size_t FindNearestNeighbors(const reco::ClusterHit3D*, const kdTree::KdTreeNode&, kdTree::CandPairList&) const;
+
     /**
      *  @brief Driver for Prim's algorithm
      */
@@ -141,6 +152,9 @@ private:
 
     PrincipalComponentsAlg                                    m_pcaAlg;                // For running Principal Components Analysis
     kdTree                                                    m_kdTree;                // For the kdTree
+    bool                                                      m_useFlatKdTree;         ///< Search the neighbors in the FlatKdTree
+    mutable FlatKdTree                                        m_flatKdTree;            ///< The flat tree, if used
+    mutable FlatKdTree::NeighborVec                           m_neighbors;             ///< Buffer for the flat tree searches
 
     std::unique_ptr<lar_cluster3d::IClusterParametersBuilder> m_clusterBuilder;        ///<  Common cluster builder tool
 };
@@ -202,6 +216,10 @@ void MinSpanTreeAlg::configure(fhicl::ParameterSet const &pset)
 
     m_clusterBuilder = art::make_tool<lar_cluster3d::IClusterParametersBuilder>(pset.get<fhicl::ParameterSet>("ClusterParamsBuilder"));
 
+    m_useFlatKdTree = pset.get<bool>("UseFlatKdTree", false);
+
+    if (m_useFlatKdTree) m_flatKdTree.configure(pset.get<fhicl::ParameterSet>("FlatKdTree"));
+
     return;
 }
 
@@ -220,9 +238,7 @@ void MinSpanTreeAlg::Cluster3DHits(reco::HitPairList&           hitPairList,
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // The following call does this work
     kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode     topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
-
-    if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = m_kdTree.getTimeToExecute();
+    kdTree::KdTreeNode     topNode = BuildKdTree(hitPairList, kdTreeNodeContainer);
 
     // Run DBScan to get candidate clusters
     RunPrimsAlgorithm(hitPairList, topNode, clusterParametersList);
@@ -305,10 +321,9 @@ void MinSpanTreeAlg::RunPrimsAlgorithm(reco::HitPairList&           hitPairList,
 
         // Set up to find the list of nearest neighbors to the last used hit...
         kdTree::CandPairList CandPairList;
-        float                bestDistance(1.5); //std::numeric_limits<float>::max());
 
         // And find them... result will be an unordered list of neigbors
-        m_kdTree.FindNearestNeighbors(lastAddedHit, topNode, CandPairList, bestDistance);
+        FindNearestNeighbors(lastAddedHit, topNode, CandPairList);
 
         // Copy edges to the current list (but only for hits not already in a cluster)
 //        for(auto& pair : CandPairList)
@@ -373,6 +388,35 @@ void MinSpanTreeAlg::RunPrimsAlgorithm(reco::HitPairList&           hitPairList,
     return;
 }
 
+kdTree::KdTreeNode MinSpanTreeAlg::BuildKdTree(const reco::HitPairList& hitPairList, kdTree::KdTreeNodeList& kdTreeNodeContainer) const
+{
+    if (m_useFlatKdTree)
+    {
+        m_flatKdTree.BuildKdTree(hitPairList);
+
+        if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = m_flatKdTree.getTimeToExecute();
+
+        kdTreeNodeContainer.emplace_back();
+
+        return kdTreeNodeContainer.back();
+    }
+
+    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+
+    if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = m_kdTree.getTimeToExecute();
+
+    return topNode;
+}
+
+size_t MinSpanTreeAlg::FindNearestNeighbors(const reco::ClusterHit3D* hit, const kdTree::KdTreeNode& topNode, kdTree::CandPairList& candPairList) const
+{
+    if (m_useFlatKdTree) return m_kdTree.FindNearestNeighbors(hit, m_flatKdTree, m_neighbors, candPairList);
+
+    float bestDistance(1.5); //std::numeric_limits<float>::max());
+
+    return m_kdTree.FindNearestNeighbors(hit, topNode, candPairList, bestDistance);
+}
+
 void MinSpanTreeAlg::FindBestPathInCluster(reco::ClusterParameters& curCluster) const
 {
     reco::HitPairListPtr longestCluster;
@@ -29,15 +29,22 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IHit3DBuilder.h"
 
 // Eigen
 #include <Eigen/Core>
 
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 // std includes
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <optional>
 
 // Ack!
 #include "TH1F.h"
@@ -53,20 +60,10 @@ namespace lar_cluster3d {
  *          want to expose to the outside world
  */
 
-// forward declaration to define an ordering function for our hit set
-struct Hit2DSetCompare
-{
-    bool operator() (const reco::ClusterHit2D*, const reco::ClusterHit2D*) const;
-};
-
 using HitVector                   = std::vector<const reco::ClusterHit2D*>;
 using PlaneToHitVectorMap         = std::map<geo::PlaneID, HitVector>;
 using TPCToPlaneToHitVectorMap    = std::map<geo::TPCID, PlaneToHitVectorMap>;
 using Hit2DList                   = std::list<reco::ClusterHit2D>;
-using Hit2DSet                    = std::set<const reco::ClusterHit2D*, Hit2DSetCompare>;
-using WireToHitSetMap             = std::map<unsigned int, Hit2DSet>;
-using PlaneToWireToHitSetMap      = std::map<geo::PlaneID, WireToHitSetMap>;
-using TPCToPlaneToWireToHitSetMap = std::map<geo::TPCID, PlaneToWireToHitSetMap>;
 using HitVectorMap                = std::map<size_t, HitVector>;
 
 //using HitPairVector               = std::vector<std::unique_ptr<reco::ClusterHit3D>>;
@@ -186,16 +183,6 @@ private:
      */
     bool makeDeadChannelPair(reco::ClusterHit3D& pairOut, const reco::ClusterHit3D& pair, size_t maxStatus = 4, size_t minStatus = 0, float minOverlap=0.2) const;
 
-    /**
-     *  @brief A utility routine for finding a 2D hit closest in time to the given pair
-     */
-    const reco::ClusterHit2D* FindBestMatchingHit(const Hit2DSet& hit2DSet, const reco::ClusterHit3D& pair, float pairDeltaTimeLimits) const;
-
-    /**
-     *  @brief A utility routine for returning the number of 2D hits from the list in a given range
-     */
-    int FindNumberInRange(const Hit2DSet& hit2DSet, const reco::ClusterHit3D& pair, float range) const;
-
     /**
      *  @brief Jacket the calls to finding the nearest wire in order to intercept the exceptions if out of range
      */
@@ -209,7 +196,7 @@ private:
     /**
      *  @brief Create the internal channel status vector (assume will eventually be event-by-event)
      */
-    void BuildChannelStatusVec(PlaneToWireToHitSetMap& planeToWiretoHitSetMap) const;
+    void BuildChannelStatusVec() const;
 
     /**
      * @brief Perform charge integration between limits
@@ -238,6 +225,7 @@ private:
     float                                m_wirePitchScaleFactor;  ///< Scaling factor to determine max distance allowed between candidate pairs
     float                                m_maxHit3DChiSquare;     ///< Provide ability to select hits based on "chi square"
     bool                                 m_outputHistograms;      ///< Take the time to create and fill some histograms for diagnostics
+    bool                                 m_parallelTPCs;          ///< Build the 3D hits of each TPC concurrently
 
     bool                                 m_enableMonitoring;      ///<
     float                                m_wirePitch[3];
@@ -265,7 +253,6 @@ private:
     // Get instances of the primary data structures needed
     mutable Hit2DList                    m_clusterHit2DMasterList;
     mutable PlaneToHitVectorMap          m_planeToHitVectorMap;
-    mutable PlaneToWireToHitSetMap       m_planeToWireToHitSetMap;
 
 
     mutable ChannelStatusByPlaneVec      m_channelStatus;
@@ -312,6 +299,7 @@ void StandardHit3DBuilder::configure(fhicl::ParameterSet const &pset)
     m_wirePitchScaleFactor = pset.get<float                     >("WirePitchScaleFactor", 1.9 );
     m_maxHit3DChiSquare    = pset.get<float                     >("MaxHitChiSquare",      6.0 );
     m_outputHistograms     = pset.get<bool                      >("OutputHistograms",     false );
+    m_parallelTPCs         = pset.get<bool                      >("ParallelTPCs",         false );
 
     m_geometry = art::ServiceHandle<geo::Geometry const>{}.get();
     m_detector = lar::providerFrom<detinfo::DetectorPropertiesService>();
@@ -368,7 +356,7 @@ void StandardHit3DBuilder::clear()
     return;
 }
 
-void StandardHit3DBuilder::BuildChannelStatusVec(PlaneToWireToHitSetMap& planeToWireToHitSetMap) const
+void StandardHit3DBuilder::BuildChannelStatusVec() const
 {
     // This is called each event, clear out the previous version and start over
     if (!m_channelStatus.empty()) m_channelStatus.clear();
@@ -438,7 +426,6 @@ void StandardHit3DBuilder::Hit3DBuilder(art::Event& evt, reco::HitPairList& hitP
     // Clear the internal data structures
     m_clusterHit2DMasterList.clear();
     m_planeToHitVectorMap.clear();
-    m_planeToWireToHitSetMap.clear();
 
     m_timeVector.resize(NUMTIMEVALUES, 0.);
     
@@ -450,7 +437,7 @@ void StandardHit3DBuilder::Hit3DBuilder(art::Event& evt, reco::HitPairList& hitP
     this->CollectArtHits(evt);
     
     // If there are no hits in our view/wire data structure then do not proceed with the full analysis
-    if (!m_planeToWireToHitSetMap.empty())
+    if (!m_planeToHitVectorMap.empty())
     {
         // Call the algorithm that builds 3D hits
         this->BuildHit3D(hitPairList);
@@ -499,7 +486,7 @@ void StandardHit3DBuilder::BuildHit3D(reco::HitPairList& hitPairList) const
 
     // The first task is to take the lists of input 2D hits (a map of view to sorted lists of 2D hits)
     // and then to build a list of 3D hits to be used in downstream processing
-    BuildChannelStatusVec(m_planeToWireToHitSetMap);
+    BuildChannelStatusVec();
 
     size_t numHitPairs = BuildHitPairMap(m_planeToHitVectorMap, hitPairList);
 
@@ -588,7 +575,9 @@ size_t StandardHit3DBuilder::BuildHitPairMap(PlaneToHitVectorMap& planeToHitVect
     size_t nTriplets(0);
     size_t nDeadChanHits(0);
 
-    // Set up to loop over cryostats and tpcs...
+    // Set up to loop over cryostats and tpcs, collecting the plane hit vectors of those TPCs with hits in at least two planes
+    std::vector<std::vector<HitVector*>> tpcHitVectors;
+
     for(size_t cryoIdx = 0; cryoIdx < m_geometry->Ncryostats(); cryoIdx++)
     {
         for(size_t tpcIdx = 0; tpcIdx < m_geometry->NTPC(); tpcIdx++)
@@ -603,21 +592,62 @@ size_t StandardHit3DBuilder::BuildHitPairMap(PlaneToHitVectorMap& planeToHitVect
 
             if (nPlanesWithHits < 2) continue;
 
-            HitVector& hitVector0 = mapItr0->second;
-            HitVector& hitVector1 = mapItr1->second;
-            HitVector& hitVector2 = mapItr2->second;
+            tpcHitVectors.push_back({&mapItr0->second, &mapItr1->second, &mapItr2->second});
+        }
+    }
 
-            // We are going to resort the hits into "start time" order...
-            std::sort(hitVector0.begin(), hitVector0.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
-            std::sort(hitVector1.begin(), hitVector1.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
-            std::sort(hitVector2.begin(), hitVector2.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+    // The TPCs are independent (their 2D hits are distinct objects) so each one builds its own list of 3D hits
+    std::vector<reco::HitPairList> tpcHitPairLists(tpcHitVectors.size());
 
-            PlaneHitVectorItrPairVec hitItrVec = {HitVectorItrPair(hitVector0.begin(),hitVector0.end()),
-                                                  HitVectorItrPair(hitVector1.begin(),hitVector1.end()),
-                                                  HitVectorItrPair(hitVector2.begin(),hitVector2.end())};
+    auto buildTPC = [&](size_t tpcIdx)
+    {
+        HitVector& hitVector0 = *tpcHitVectors[tpcIdx][0];
+        HitVector& hitVector1 = *tpcHitVectors[tpcIdx][1];
+        HitVector& hitVector2 = *tpcHitVectors[tpcIdx][2];
 
-            totalNumHits += BuildHitPairMapByTPC(hitItrVec, hitPairList);
-        }
+        // We are going to resort the hits into "start time" order...
+        std::sort(hitVector0.begin(), hitVector0.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+        std::sort(hitVector1.begin(), hitVector1.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+        std::sort(hitVector2.begin(), hitVector2.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+
+        PlaneHitVectorItrPairVec hitItrVec = {HitVectorItrPair(hitVector0.begin(),hitVector0.end()),
+                                              HitVectorItrPair(hitVector1.begin(),hitVector1.end()),
+                                              HitVectorItrPair(hitVector2.begin(),hitVector2.end())};
+
+        BuildHitPairMapByTPC(hitItrVec, tpcHitPairLists[tpcIdx]);
+    };
+
+    // The diagnostic tuple vectors are shared so they are only filled in the serial mode
+    if (m_parallelTPCs && !m_outputHistograms && tpcHitVectors.size() > 1)
+    {
+        // Let the tasks allocate their 3D hits from the event arena too
+        EventArena* eventArena = EventArena::current();
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, tpcHitVectors.size(), 1),
+                          [&](const tbb::blocked_range<size_t>& range)
+                          {
+                              std::optional<EventArena::Scope> arenaScope;
+
+                              if (eventArena) arenaScope.emplace(*eventArena);
+
+                              for(size_t tpcIdx = range.begin(); tpcIdx != range.end(); tpcIdx++) buildTPC(tpcIdx);
+                          });
+    }
+    else
+    {
+        for(size_t tpcIdx = 0; tpcIdx < tpcHitVectors.size(); tpcIdx++) buildTPC(tpcIdx);
+    }
+
+    // Concatenate in TPC order, numbering the 3D hits as a single pass over the TPCs would
+    for(auto& tpcHitPairList : tpcHitPairLists)
+    {
+        size_t firstID = hitPairList.size();
+
+        for(const auto& hitPair : tpcHitPairList) hitPair.setID(firstID + hitPair.getID());
+
+        totalNumHits += tpcHitPairList.size();
+
+        hitPairList.splice(hitPairList.end(), tpcHitPairList);
     }
 
     // Return the hit pair list but sorted by z and y positions (faster traversal in next steps)
@@ -1299,58 +1329,6 @@ bool StandardHit3DBuilder::makeDeadChannelPair(reco::ClusterHit3D&       pairOut
     return result;
 }
 
-const reco::ClusterHit2D* StandardHit3DBuilder::FindBestMatchingHit(const Hit2DSet& hit2DSet, const reco::ClusterHit3D& pair, float pairDeltaTimeLimits) const
-{
-    static const float minCharge(0.);
-
-    const reco::ClusterHit2D* bestVHit(0);
-
-    float pairAvePeakTime(pair.getAvePeakTime());
-
-    // Idea is to loop through the input set of hits and look for the best combination
-    for (const auto& hit2D : hit2DSet)
-    {
-        if (hit2D->getHit()->Integral() < minCharge) continue;
-
-        float hitVPeakTime(hit2D->getTimeTicks());
-        float deltaPeakTime(pairAvePeakTime-hitVPeakTime);
-
-        if (deltaPeakTime >  pairDeltaTimeLimits) continue;
-
-        if (deltaPeakTime < -pairDeltaTimeLimits) break;
-
-        pairDeltaTimeLimits = fabs(deltaPeakTime);
-        bestVHit            = hit2D;
-    }
-
-    return bestVHit;
-}
-
-int StandardHit3DBuilder::FindNumberInRange(const Hit2DSet& hit2DSet, const reco::ClusterHit3D& pair, float range) const
-{
-    static const float minCharge(0.);
-
-    int    numberInRange(0);
-    float pairAvePeakTime(pair.getAvePeakTime());
-
-    // Idea is to loop through the input set of hits and look for the best combination
-    for (const auto& hit2D : hit2DSet)
-    {
-        if (hit2D->getHit()->Integral() < minCharge) continue;
-
-        float hitVPeakTime(hit2D->getTimeTicks());
-        float deltaPeakTime(pairAvePeakTime-hitVPeakTime);
-
-        if (deltaPeakTime >  range) continue;
-
-        if (deltaPeakTime < -range) break;
-
-        numberInRange++;
-    }
-
-    return numberInRange;
-}
-
 geo::WireID StandardHit3DBuilder::NearestWireID(const Eigen::Vector3f& position, const geo::WireID& wireIDIn) const
 {
     geo::WireID wireID = wireIDIn;
@@ -1423,11 +1401,6 @@ bool SetHitTimeOrder(const reco::ClusterHit2D* left, const reco::ClusterHit2D* r
     return left->getHit()->PeakTime() < right->getHit()->PeakTime();
 }
 
-bool Hit2DSetCompare::operator() (const reco::ClusterHit2D* left, const reco::ClusterHit2D* right) const
-{
-    return left->getHit()->PeakTime() < right->getHit()->PeakTime();
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 void StandardHit3DBuilder::CollectArtHits(const art::Event& evt) const
 {
@@ -1530,7 +1503,6 @@ void StandardHit3DBuilder::CollectArtHits(const art::Event& evt) const
             m_clusterHit2DMasterList.emplace_back(0, 0., 0., xPosition, hitPeakTime, wireID, recobHit);
 
             m_planeToHitVectorMap[planeID].push_back(&m_clusterHit2DMasterList.back());
-            m_planeToWireToHitSetMap[planeID][wireID.Wire].insert(&m_clusterHit2DMasterList.back());
         }
     }
 
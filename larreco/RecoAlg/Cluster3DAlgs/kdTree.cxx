@@ -204,6 +204,31 @@ size_t kdTree::FindNearestNeighbors(const reco::ClusterHit3D* refHit, const KdTr
     return CandPairList.size();
 }
 
+size_t kdTree::FindNearestNeighbors(const reco::ClusterHit3D* refHit, const FlatKdTree& flatKdTree, FlatKdTree::NeighborVec& neighbors, CandPairList& CandPairList) const
+{
+    // The hits closer than fRefLeafBestDist in x and in YZ are well inside this sphere
+    const Eigen::Vector3f& refPosition = refHit->getPosition();
+
+    flatKdTree.RadiusSearch(refPosition, std::sqrt(3.f) * fRefLeafBestDist, neighbors);
+
+    for(const auto& neighbor : neighbors)
+    {
+        const reco::ClusterHit3D* hit = neighbor.hit;
+
+        if (hit == refHit || std::fabs(hit->getPosition()[0] - refPosition[0]) >= fRefLeafBestDist) continue;
+
+        // The search above compares each hit with this distance once the reference leaf is found
+        float bestDist = fRefLeafBestDist;
+
+        if (consistentPairs(refHit, hit, bestDist)) CandPairList.emplace_back(bestDist, hit);
+    }
+
+    // Closest first, the sort keeps the flat tree order (fixed for given input hits) of equal separations
+    CandPairList.sort([](const auto& left, const auto& right){return left.first < right.first;});
+
+    return CandPairList.size();
+}
+
 bool kdTree::FindEntry(const reco::ClusterHit3D* refHit, const KdTreeNode& node, CandPairList& CandPairList, float& bestDist, bool& selfNotFound, int depth) const
 {
     bool foundEntry(false);
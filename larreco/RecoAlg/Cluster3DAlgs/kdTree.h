@@ -14,6 +14,7 @@
 
 // Algorithm includes
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
 
 // std includes
 #include <list>
@@ -82,6 +83,19 @@ public:
     bool   FindEntry(const reco::ClusterHit3D*, const KdTreeNode&, CandPairList&, float&, bool&, int) const;
     bool   FindEntryBrute(const reco::ClusterHit3D*, const KdTreeNode&, int) const;
 
+    /**
+     *  @brief Find the neighbors of a hit with a FlatKdTree of the same hits
+     *
+     *         Once the search above reaches the leaf of the reference hit it keeps the consistent hits
+     *         closer than RefLeafBestDist in YZ, and it reaches that leaf first. This returns those
+     *         that are also closer than RefLeafBestDist in x, closest first then in the order of the
+     *         flat tree. The search above always finds these too, and consistent hits farther in x
+     *         only when its own x splits do not separate them from the reference hit.
+     *
+     *  @param neighbors  Buffer for the radius search, so repeated calls do not allocate
+     */
+    size_t FindNearestNeighbors(const reco::ClusterHit3D*, const FlatKdTree&, FlatKdTree::NeighborVec& neighbors, CandPairList&) const;
+
     /**
      *  @brief Given an input HitPairList, build out the map of nearest neighbors
      */
@@ -240,6 +240,10 @@ namespace cluster{
 
     fParams.Clear();
 
+    // nothing scheduled
+    fSchedule.stage = kAllParams;
+    fSchedule.polygon = true;
+
     // Initialize the neural network:
     // enableFANN = false;
     fTimeRecord_ProcName.push_back("Initialize");
@@ -277,6 +281,9 @@ namespace cluster{
                                        bool override_DoGetFinalSlope    ,
                                        bool override_DoTrackShowerSep,
                                        bool override_DoEndCharge){
+    // what was scheduled before comes first
+    if (fSchedule.stage < kAllParams) RunSchedule(kAllParams, false);
+
     GetAverages      (override_DoGetAverages      );
     GetRoughAxis     (override_DoGetRoughAxis     );
     GetProfileInfo   (override_DoGetProfileInfo   );
@@ -288,6 +295,55 @@ namespace cluster{
     TrackShowerSeparation(override_DoTrackShowerSep);
   }
 
+  void ClusterParamsAlg::ScheduleParams(bool override_DoGetAverages      ,
+                                        bool override_DoGetRoughAxis     ,
+                                        bool override_DoGetProfileInfo   ,
+                                        bool override_DoStartPointsAndDirection,
+                                        bool override_DoGetFinalSlope    ,
+                                        bool override_DoTrackShowerSep,
+                                        bool override_DoEndCharge){
+    if (fSchedule.stage < kAllParams) RunSchedule(kAllParams, false);
+
+    // the override argument of each stage, in the order of ParamsStage_t
+    fSchedule.overrides[kAverages - 1]               = override_DoGetAverages;
+    fSchedule.overrides[kRoughAxis - 1]              = override_DoGetRoughAxis;
+    fSchedule.overrides[kProfileInfo - 1]            = override_DoGetProfileInfo;
+    fSchedule.overrides[kStartPointAndDirection - 1] = override_DoStartPointsAndDirection;
+    fSchedule.overrides[kFinalSlope - 1]             = override_DoGetFinalSlope;
+    fSchedule.overrides[kEndCharges - 1]             = override_DoEndCharge;
+    fSchedule.overrides[kAllParams - 1]              = override_DoTrackShowerSep;
+    fSchedule.stage = kNoParams;
+  }
+
+  void ClusterParamsAlg::SchedulePolygon(){
+    fSchedule.polygon = false;
+  }
+
+  void ClusterParamsAlg::RunSchedule(ParamsStage_t stage, bool polygon){
+    // GetParams() may get here from several threads at once
+    std::lock_guard<std::mutex> lock(fSchedule.mutex);
+
+    for(int next = fSchedule.stage + 1; next <= stage; ++next) {
+      const bool override = fSchedule.overrides[next - 1];
+      switch(next) {
+        case kAverages:               GetAverages(override);                  break;
+        case kRoughAxis:              GetRoughAxis(override);                 break;
+        case kProfileInfo:            GetProfileInfo(override);               break;
+        case kStartPointAndDirection: RefineStartPointAndDirection(override); break;
+        case kFinalSlope:             GetFinalSlope(override);                break;
+        case kEndCharges:             GetEndCharges(override);                break;
+        case kAllParams:              TrackShowerSeparation(override);        break;
+      }
+      // the variables of this stage are final from now on
+      fSchedule.stage = next;
+    }
+
+    if(polygon && !fSchedule.polygon) {
+      FillPolygon();
+      fSchedule.polygon = true;
+    }
+  }
+
   void ClusterParamsAlg::GetAverages(bool override){
     if(!override) { //Override being set, we skip all this logic.
       //OK, no override. Stop if we're already finshed.
@@ -1598,6 +1654,7 @@ namespace cluster{
       }
       fParams.PolyObject = Polygon2D( vertices );
     }
+    fSchedule.polygon = true;
 
     fTimeRecord_ProcName.push_back("FillPolygon");
     fTimeRecord_ProcTime.push_back(localWatch.RealTime());
@@ -10,6 +10,9 @@
 #define CLUSTERPARAMSALG_H
 
 //--- std/stl include ---//
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -95,8 +98,57 @@ namespace cluster {
                     bool override_DoTrackShowerSep   =false,
                     bool override_DoEndCharge = false);
 
+    /// Stages of the computation of the parameters, in the order FillParams() runs them
+    enum ParamsStage_t {
+      kNoParams,               ///< no parameter
+      kAverages,               ///< GetAverages(): N_Hits, charge and ADC sums and averages, wires, eigenvalues
+      kRoughAxis,              ///< GetRoughAxis(): rms_x, rms_y, RMS_charge, N_Hits_HC, cluster_angle_2d
+      kProfileInfo,            ///< GetProfileInfo(): width
+      kStartPointAndDirection, ///< RefineStartPointAndDirection(): start_point, end_point, length, hit densities, opening and closing angles, direction
+      kFinalSlope,             ///< GetFinalSlope(): angle_2d, modified_hit_density, modmeancharge
+      kEndCharges,             ///< GetEndCharges(): start_charge, end_charge
+      kAllParams               ///< TrackShowerSeparation()
+    };
+
+    /**
+      Schedules the computation FillParams() does, with the same arguments,
+      but runs each function only when GetParams() first needs its variables.
+      The functions still run in the order of FillParams(), so the parameters
+      are the same as with FillParams() as long as the hits and the settings
+      are not changed in between. Anything scheduled before is computed first.
+    */
+    void ScheduleParams(bool override_DoGetAverages      =false,
+                        bool override_DoGetRoughAxis     =false,
+                        bool override_DoGetProfileInfo   =false,
+                        bool override_DoRefineStartPointsAndDirection=false,
+                        bool override_DoGetFinalSlope    =false,
+                        bool override_DoTrackShowerSep   =false,
+                        bool override_DoEndCharge = false);
+
+    /**
+       Schedules FillPolygon(), run when GetParams() first needs PolyObject.
+       The polygon of merged clusters is computed again from all the hits:
+       SelectPolygonHitList() keeps the hits with the most charge up to a
+       fraction of the total, so it is not the hull of the merged polygons.
+    */
+    void SchedulePolygon();
+
+    /**
+       Returns the parameters after running the scheduled computation up to
+       the specified stage, and FillPolygon() if polygon is set.
+       Only the variables of the stages up to that one (and PolyObject, if
+       requested) are final. The object may be used from several threads.
+    */
+    const cluster_params& GetParams(ParamsStage_t stage, bool polygon = false) const
+    {
+      if (fSchedule.stage < stage || (polygon && !fSchedule.polygon))
+        const_cast<ClusterParamsAlg*>(this)->RunSchedule(stage, polygon);
+      return fParams;
+    }
+
+    /// Returns all the parameters, running all the scheduled computation
     const cluster_params& GetParams() const
-    { return fParams;}
+    { return GetParams(kAllParams, true);}
 
     /**
        Calculates the following variables:
@@ -349,6 +401,30 @@ namespace cluster {
     /// Returns the integral of f(x) = mx + q defined in [x1, x2]
     static double LinearIntegral(double m, double q, double x1, double x2);
 
+    /// Computation scheduled by ScheduleParams() and SchedulePolygon()
+    struct Schedule_t {
+      std::mutex mutex;         ///< serializes the scheduled computation
+      std::atomic<int> stage;   ///< stage the parameters are computed up to
+      std::atomic<bool> polygon;///< whether the polygon is computed
+      bool overrides[kAllParams]; ///< override argument of each stage
+
+      Schedule_t(): stage(kAllParams), polygon(true), overrides() {}
+      // copies get their own mutex
+      Schedule_t(Schedule_t const& from) { *this = from; }
+      Schedule_t& operator= (Schedule_t const& from)
+      {
+        stage = from.stage.load();
+        polygon = from.polygon.load();
+        std::copy(from.overrides, from.overrides + kAllParams, overrides);
+        return *this;
+      }
+    }; // Schedule_t
+
+    Schedule_t fSchedule;
+
+    /// Runs the scheduled computation up to the stage, and the polygon if requested
+    void RunSchedule(ParamsStage_t stage, bool polygon);
+
     public:
 
     cluster::cluster_params fParams;
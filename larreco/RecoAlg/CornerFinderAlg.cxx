@@ -22,6 +22,11 @@
 //  CornerScore_algorithm options:
 //     Noble  --- determinant / (trace + Noble_epsilon)
 //     Harris --- determinant - (trace)^2 * Harris_kappa
+//
+//  UseFlatImages (default true) runs all the steps on flat buffers of the
+//  images, with the blur weights applied to whole rows at a time, instead of on
+//  histograms. The results are the same; the histograms are only kept for
+//  debugging.
 ////////////////////////////////////////////////////////////////////////
 
 
@@ -34,6 +39,8 @@
 #include "larcorealg/Geometry/TPCGeo.h"
 #include "larcorealg/Geometry/PlaneGeo.h"
 
+#include <algorithm>
+
 // NOTE: In the .h file I assumed this would belong in the cluster class....if
 // we decide otherwise we will need to search and replace for this
 
@@ -96,6 +103,7 @@ void corner::CornerFinderAlg::reconfigure(fhicl::ParameterSet const& p)
   fMaxSuppress_threshold		 = p.get< int		 >("MaxSuppress_threshold");
   fIntegral_bin_threshold                = p.get< float          >("Integral_bin_threshold");
   fIntegral_fraction_threshold           = p.get< float          >("Integral_fraction_threshold");
+  fUseFlatImages                         = p.get< bool           >("UseFlatImages", true);
 
   int neighborhoods[] = { fConversion_func_neighborhood,
 			  fDerivative_neighborhood,
@@ -209,6 +217,17 @@ void corner::CornerFinderAlg::get_feature_points(std::vector<recob::EndPoint2D>
 
 }
 
+//-----------------------------------------------------------------------------------
+// This gives us the corners of a single image of wire data, e.g. one plane from GetWireDataHist
+void corner::CornerFinderAlg::get_feature_points(TH2F const& h_wire_data,
+						 std::vector<geo::WireID> const& wireIDs,
+						 geo::View_t view,
+						 std::vector<recob::EndPoint2D> & corner_vector){
+
+  attach_feature_points(h_wire_data,wireIDs,view,corner_vector);
+
+}
+
 //-----------------------------------------------------------------------------------
 // This gives us a vector of EndPoint2D objects that correspond to possible corners, but quickly!
 void corner::CornerFinderAlg::get_feature_points_fast(std::vector<recob::EndPoint2D> & corner_vector,
@@ -511,6 +530,11 @@ void corner::CornerFinderAlg::attach_feature_points( TH2F const& h_wire_data,
 						     int starty){
 
 
+  if(fUseFlatImages){
+    find_corners_flat(h_wire_data,wireIDs,view,corner_vector,startx,starty);
+    return;
+  }
+
   const int x_bins = h_wire_data.GetNbinsX();
   const float x_min = h_wire_data.GetXaxis()->GetBinLowEdge(1);
   const float x_max = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
@@ -571,42 +595,8 @@ void corner::CornerFinderAlg::attach_feature_points_LineIntegralScore(TH2F const
   const float y_min  = h_wire_data.GetYaxis()->GetBinLowEdge(1);
   const float y_max  = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
 
-  const int converted_y_bins = y_bins/fConversion_bins_per_input_y;
-  const int converted_x_bins = x_bins/fConversion_bins_per_input_x;
-
-  std::stringstream conversion_name;  conversion_name  << "h_conversion_"   << view << "_" << run_number << "_" << event_number;
-  std::stringstream dx_name;          dx_name          << "h_derivative_x_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dy_name;          dy_name          << "h_derivative_y_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream cornerScore_name; cornerScore_name << "h_cornerScore_"  << view << "_" << run_number << "_" << event_number;
-  std::stringstream maxSuppress_name; maxSuppress_name << "h_maxSuppress_"  << view << "_" << run_number << "_" << event_number;
-
-  TH2F h_conversion  ((conversion_name.str()).c_str(),
-		      "Image Conversion Histogram",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2F h_derivative_x((dx_name.str()).c_str(),
-		      "Partial Derivatives (x)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2F h_derivative_y((dy_name.str()).c_str(),
-		      "Partial Derivatives (y)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2D h_cornerScore ((cornerScore_name.str()).c_str(),
-		      "Feature Point Corner Score",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2D h_maxSuppress ((maxSuppress_name.str()).c_str(),
-		      "Corner Points (Maximum Suppressed)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-
-  create_image_histo(h_wire_data,h_conversion);
-  create_derivative_histograms(h_conversion,h_derivative_x,h_derivative_y);
-  create_cornerScore_histogram(h_derivative_x,h_derivative_y,h_cornerScore);
-
   std::vector<recob::EndPoint2D> corner_vector_tmp;
-  perform_maximum_suppression(h_cornerScore,corner_vector_tmp,wireIDs,view,h_maxSuppress);
+  attach_feature_points(h_wire_data,wireIDs,view,corner_vector_tmp);
 
   std::stringstream LI_name; LI_name << "h_lineIntegralScore_" << view << "_" << run_number << "_" << event_number;
   TH2F h_lineIntegralScore((LI_name.str()).c_str(),
@@ -677,6 +667,137 @@ void corner::CornerFinderAlg::create_image_histo(TH2F const& h_wire_data, TH2F &
 
 }
 
+//-----------------------------------------------------------------------------
+namespace {
+
+  //this is just a double Gaussian
+  void fill_blur_function(float func_blur[11][11]){
+    func_blur[0][0] = 0.000000;
+    func_blur[0][1] = 0.000000;
+    func_blur[0][2] = 0.000000;
+    func_blur[0][3] = 0.000001;
+    func_blur[0][4] = 0.000002;
+    func_blur[0][5] = 0.000004;
+    func_blur[0][6] = 0.000002;
+    func_blur[0][7] = 0.000001;
+    func_blur[0][8] = 0.000000;
+    func_blur[0][9] = 0.000000;
+    func_blur[0][10] = 0.000000;
+    func_blur[1][0] = 0.000000;
+    func_blur[1][1] = 0.000000;
+    func_blur[1][2] = 0.000004;
+    func_blur[1][3] = 0.000045;
+    func_blur[1][4] = 0.000203;
+    func_blur[1][5] = 0.000335;
+    func_blur[1][6] = 0.000203;
+    func_blur[1][7] = 0.000045;
+    func_blur[1][8] = 0.000004;
+    func_blur[1][9] = 0.000000;
+    func_blur[1][10] = 0.000000;
+    func_blur[2][0] = 0.000000;
+    func_blur[2][1] = 0.000004;
+    func_blur[2][2] = 0.000123;
+    func_blur[2][3] = 0.001503;
+    func_blur[2][4] = 0.006738;
+    func_blur[2][5] = 0.011109;
+    func_blur[2][6] = 0.006738;
+    func_blur[2][7] = 0.001503;
+    func_blur[2][8] = 0.000123;
+    func_blur[2][9] = 0.000004;
+    func_blur[2][10] = 0.000000;
+    func_blur[3][0] = 0.000001;
+    func_blur[3][1] = 0.000045;
+    func_blur[3][2] = 0.001503;
+    func_blur[3][3] = 0.018316;
+    func_blur[3][4] = 0.082085;
+    func_blur[3][5] = 0.135335;
+    func_blur[3][6] = 0.082085;
+    func_blur[3][7] = 0.018316;
+    func_blur[3][8] = 0.001503;
+    func_blur[3][9] = 0.000045;
+    func_blur[3][10] = 0.000001;
+    func_blur[4][0] = 0.000002;
+    func_blur[4][1] = 0.000203;
+    func_blur[4][2] = 0.006738;
+    func_blur[4][3] = 0.082085;
+    func_blur[4][4] = 0.367879;
+    func_blur[4][5] = 0.606531;
+    func_blur[4][6] = 0.367879;
+    func_blur[4][7] = 0.082085;
+    func_blur[4][8] = 0.006738;
+    func_blur[4][9] = 0.000203;
+    func_blur[4][10] = 0.000002;
+    func_blur[5][0] = 0.000004;
+    func_blur[5][1] = 0.000335;
+    func_blur[5][2] = 0.011109;
+    func_blur[5][3] = 0.135335;
+    func_blur[5][4] = 0.606531;
+    func_blur[5][5] = 1.000000;
+    func_blur[5][6] = 0.606531;
+    func_blur[5][7] = 0.135335;
+    func_blur[5][8] = 0.011109;
+    func_blur[5][9] = 0.000335;
+    func_blur[5][10] = 0.000004;
+    func_blur[6][0] = 0.000002;
+    func_blur[6][1] = 0.000203;
+    func_blur[6][2] = 0.006738;
+    func_blur[6][3] = 0.082085;
+    func_blur[6][4] = 0.367879;
+    func_blur[6][5] = 0.606531;
+    func_blur[6][6] = 0.367879;
+    func_blur[6][7] = 0.082085;
+    func_blur[6][8] = 0.006738;
+    func_blur[6][9] = 0.000203;
+    func_blur[6][10] = 0.000002;
+    func_blur[7][0] = 0.000001;
+    func_blur[7][1] = 0.000045;
+    func_blur[7][2] = 0.001503;
+    func_blur[7][3] = 0.018316;
+    func_blur[7][4] = 0.082085;
+    func_blur[7][5] = 0.135335;
+    func_blur[7][6] = 0.082085;
+    func_blur[7][7] = 0.018316;
+    func_blur[7][8] = 0.001503;
+    func_blur[7][9] = 0.000045;
+    func_blur[7][10] = 0.000001;
+    func_blur[8][0] = 0.000000;
+    func_blur[8][1] = 0.000004;
+    func_blur[8][2] = 0.000123;
+    func_blur[8][3] = 0.001503;
+    func_blur[8][4] = 0.006738;
+    func_blur[8][5] = 0.011109;
+    func_blur[8][6] = 0.006738;
+    func_blur[8][7] = 0.001503;
+    func_blur[8][8] = 0.000123;
+    func_blur[8][9] = 0.000004;
+    func_blur[8][10] = 0.000000;
+    func_blur[9][0] = 0.000000;
+    func_blur[9][1] = 0.000000;
+    func_blur[9][2] = 0.000004;
+    func_blur[9][3] = 0.000045;
+    func_blur[9][4] = 0.000203;
+    func_blur[9][5] = 0.000335;
+    func_blur[9][6] = 0.000203;
+    func_blur[9][7] = 0.000045;
+    func_blur[9][8] = 0.000004;
+    func_blur[9][9] = 0.000000;
+    func_blur[9][10] = 0.000000;
+    func_blur[10][0] = 0.000000;
+    func_blur[10][1] = 0.000000;
+    func_blur[10][2] = 0.000000;
+    func_blur[10][3] = 0.000001;
+    func_blur[10][4] = 0.000002;
+    func_blur[10][5] = 0.000004;
+    func_blur[10][6] = 0.000002;
+    func_blur[10][7] = 0.000001;
+    func_blur[10][8] = 0.000000;
+    func_blur[10][9] = 0.000000;
+    func_blur[10][10] = 0.000000;
+  }
+
+} // local namespace
+
+
 //-----------------------------------------------------------------------------
 // Derivative
 
@@ -754,129 +875,8 @@ void corner::CornerFinderAlg::create_derivative_histograms(TH2F const& h_convers
   }
 
 
-  //this is just a double Gaussian
   float func_blur[11][11];
-  func_blur[0][0] = 0.000000;
-  func_blur[0][1] = 0.000000;
-  func_blur[0][2] = 0.000000;
-  func_blur[0][3] = 0.000001;
-  func_blur[0][4] = 0.000002;
-  func_blur[0][5] = 0.000004;
-  func_blur[0][6] = 0.000002;
-  func_blur[0][7] = 0.000001;
-  func_blur[0][8] = 0.000000;
-  func_blur[0][9] = 0.000000;
-  func_blur[0][10] = 0.000000;
-  func_blur[1][0] = 0.000000;
-  func_blur[1][1] = 0.000000;
-  func_blur[1][2] = 0.000004;
-  func_blur[1][3] = 0.000045;
-  func_blur[1][4] = 0.000203;
-  func_blur[1][5] = 0.000335;
-  func_blur[1][6] = 0.000203;
-  func_blur[1][7] = 0.000045;
-  func_blur[1][8] = 0.000004;
-  func_blur[1][9] = 0.000000;
-  func_blur[1][10] = 0.000000;
-  func_blur[2][0] = 0.000000;
-  func_blur[2][1] = 0.000004;
-  func_blur[2][2] = 0.000123;
-  func_blur[2][3] = 0.001503;
-  func_blur[2][4] = 0.006738;
-  func_blur[2][5] = 0.011109;
-  func_blur[2][6] = 0.006738;
-  func_blur[2][7] = 0.001503;
-  func_blur[2][8] = 0.000123;
-  func_blur[2][9] = 0.000004;
-  func_blur[2][10] = 0.000000;
-  func_blur[3][0] = 0.000001;
-  func_blur[3][1] = 0.000045;
-  func_blur[3][2] = 0.001503;
-  func_blur[3][3] = 0.018316;
-  func_blur[3][4] = 0.082085;
-  func_blur[3][5] = 0.135335;
-  func_blur[3][6] = 0.082085;
-  func_blur[3][7] = 0.018316;
-  func_blur[3][8] = 0.001503;
-  func_blur[3][9] = 0.000045;
-  func_blur[3][10] = 0.000001;
-  func_blur[4][0] = 0.000002;
-  func_blur[4][1] = 0.000203;
-  func_blur[4][2] = 0.006738;
-  func_blur[4][3] = 0.082085;
-  func_blur[4][4] = 0.367879;
-  func_blur[4][5] = 0.606531;
-  func_blur[4][6] = 0.367879;
-  func_blur[4][7] = 0.082085;
-  func_blur[4][8] = 0.006738;
-  func_blur[4][9] = 0.000203;
-  func_blur[4][10] = 0.000002;
-  func_blur[5][0] = 0.000004;
-  func_blur[5][1] = 0.000335;
-  func_blur[5][2] = 0.011109;
-  func_blur[5][3] = 0.135335;
-  func_blur[5][4] = 0.606531;
-  func_blur[5][5] = 1.000000;
-  func_blur[5][6] = 0.606531;
-  func_blur[5][7] = 0.135335;
-  func_blur[5][8] = 0.011109;
-  func_blur[5][9] = 0.000335;
-  func_blur[5][10] = 0.000004;
-  func_blur[6][0] = 0.000002;
-  func_blur[6][1] = 0.000203;
-  func_blur[6][2] = 0.006738;
-  func_blur[6][3] = 0.082085;
-  func_blur[6][4] = 0.367879;
-  func_blur[6][5] = 0.606531;
-  func_blur[6][6] = 0.367879;
-  func_blur[6][7] = 0.082085;
-  func_blur[6][8] = 0.006738;
-  func_blur[6][9] = 0.000203;
-  func_blur[6][10] = 0.000002;
-  func_blur[7][0] = 0.000001;
-  func_blur[7][1] = 0.000045;
-  func_blur[7][2] = 0.001503;
-  func_blur[7][3] = 0.018316;
-  func_blur[7][4] = 0.082085;
-  func_blur[7][5] = 0.135335;
-  func_blur[7][6] = 0.082085;
-  func_blur[7][7] = 0.018316;
-  func_blur[7][8] = 0.001503;
-  func_blur[7][9] = 0.000045;
-  func_blur[7][10] = 0.000001;
-  func_blur[8][0] = 0.000000;
-  func_blur[8][1] = 0.000004;
-  func_blur[8][2] = 0.000123;
-  func_blur[8][3] = 0.001503;
-  func_blur[8][4] = 0.006738;
-  func_blur[8][5] = 0.011109;
-  func_blur[8][6] = 0.006738;
-  func_blur[8][7] = 0.001503;
-  func_blur[8][8] = 0.000123;
-  func_blur[8][9] = 0.000004;
-  func_blur[8][10] = 0.000000;
-  func_blur[9][0] = 0.000000;
-  func_blur[9][1] = 0.000000;
-  func_blur[9][2] = 0.000004;
-  func_blur[9][3] = 0.000045;
-  func_blur[9][4] = 0.000203;
-  func_blur[9][5] = 0.000335;
-  func_blur[9][6] = 0.000203;
-  func_blur[9][7] = 0.000045;
-  func_blur[9][8] = 0.000004;
-  func_blur[9][9] = 0.000000;
-  func_blur[9][10] = 0.000000;
-  func_blur[10][0] = 0.000000;
-  func_blur[10][1] = 0.000000;
-  func_blur[10][2] = 0.000000;
-  func_blur[10][3] = 0.000001;
-  func_blur[10][4] = 0.000002;
-  func_blur[10][5] = 0.000004;
-  func_blur[10][6] = 0.000002;
-  func_blur[10][7] = 0.000001;
-  func_blur[10][8] = 0.000000;
-  func_blur[10][9] = 0.000000;
-  func_blur[10][10] = 0.000000;
+  fill_blur_function(func_blur);
 
   double temp_integral_x = 0;
   double temp_integral_y = 0;
@@ -1046,6 +1046,368 @@ size_t corner::CornerFinderAlg::perform_maximum_suppression(TH2D const& h_corner
 }
 
 
+//-----------------------------------------------------------------------------
+// The same steps as attach_feature_points, on flat images instead of histograms
+void corner::CornerFinderAlg::find_corners_flat(TH2F const& h_wire_data,
+						std::vector<geo::WireID> const& wireIDs,
+						geo::View_t view,
+						std::vector<recob::EndPoint2D> & corner_vector,
+						int startx,
+						int starty){
+
+  const int converted_x_bins = h_wire_data.GetNbinsX()/fConversion_bins_per_input_x;
+  const int converted_y_bins = h_wire_data.GetNbinsY()/fConversion_bins_per_input_y;
+
+  // the border is wide enough for all the neighborhoods to be read without checks;
+  // its bins are zero, as the under/overflow bins of the histograms are
+  const int pad = std::max({5,fDerivative_neighborhood,fCornerScore_neighborhood,fMaxSuppress_neighborhood});
+
+  fConversion_image.reset(converted_x_bins,converted_y_bins,pad);
+  fCornerScore_image.reset(converted_x_bins,converted_y_bins,pad);
+
+  create_image_flat(h_wire_data,fConversion_image);
+  create_derivative_images(fConversion_image);
+  create_cornerScore_image(fDerivativeX_image,fDerivativeY_image,fCornerScore_image);
+  perform_maximum_suppression_flat(fCornerScore_image,corner_vector,wireIDs,view,startx,starty);
+}
+
+
+//-----------------------------------------------------------------------------
+// Convert to pixel, as create_image_histo
+void corner::CornerFinderAlg::create_image_flat(TH2F const& h_wire_data, FlatImage<float> & conversion) const {
+
+  enum { kBinary, kStandard, kFunction, kSkeleton, kSkeletonBinary } algorithm = kStandard;
+  if(fConversion_algorithm.compare("binary")==0)        algorithm = kBinary;
+  else if(fConversion_algorithm.compare("function")==0) algorithm = kFunction;
+  else if(fConversion_algorithm.compare("skeleton")==0) algorithm = kSkeleton;
+  else if(fConversion_algorithm.compare("sk_bin")==0)   algorithm = kSkeletonBinary;
+
+  // the wire data bins, under/overflow included; bins out of range read the
+  // under/overflow ones, as with TH2::GetBinContent
+  const int wire_x_bins = h_wire_data.GetNbinsX();
+  const int wire_y_bins = h_wire_data.GetNbinsY();
+  const size_t wire_stride = wire_x_bins+2;
+  Float_t const* wire_data = h_wire_data.GetArray();
+  auto wire_bin = [&](int jx, int jy) -> double {
+    jx = std::min(std::max(jx,0),wire_x_bins+1);
+    jy = std::min(std::max(jy,0),wire_y_bins+1);
+    return wire_data[jx + wire_stride*jy];
+  };
+
+  // the conversion function is evaluated once for each bin of the neighborhood
+  const int n = fConversion_func_neighborhood;
+  std::vector<double> func_table;
+  if(algorithm == kFunction){
+    const TF2 fConversion_TF2("fConversion_func",fConversion_func.c_str(),-20,20,-20,20);
+    for(int dx=-n; dx<=n; dx++)
+      for(int dy=-n; dy<=n; dy++)
+	func_table.push_back(fConversion_TF2.Eval(dx,dy));
+  }
+
+  const float low_value = fConversion_threshold;
+  const float high_value = 10*fConversion_threshold;
+
+  for(int iy=1; iy<=conversion.ny; iy++){
+
+    Float_t const* wire_row = wire_data + wire_stride*iy;
+    float* conversion_row = conversion.row(iy);
+
+    for(int ix=1; ix<=conversion.nx; ix++){
+
+      double temp_integral = wire_row[ix];
+
+      if(!(temp_integral > fConversion_threshold)){
+	conversion_row[ix] = low_value;
+	continue;
+      }
+
+      switch(algorithm){
+	case kBinary:
+	  conversion_row[ix] = high_value;
+	  break;
+	case kStandard:
+	  conversion_row[ix] = temp_integral;
+	  break;
+	case kFunction:
+	  temp_integral = 0;
+	  for(int jx=ix-n; jx<=ix+n; jx++)
+	    for(int jy=iy-n; jy<=iy+n; jy++)
+	      temp_integral += wire_bin(jx,jy)*func_table[(ix-jx+n)*(2*n+1)+(iy-jy+n)];
+	  conversion_row[ix] = temp_integral;
+	  break;
+	case kSkeleton:
+	case kSkeletonBinary:
+	  if( (temp_integral > wire_bin(ix-1,iy) && temp_integral > wire_bin(ix+1,iy))
+	      || (temp_integral > wire_bin(ix,iy-1) && temp_integral > wire_bin(ix,iy+1)))
+	    conversion_row[ix] = (algorithm == kSkeleton)? (float) temp_integral : high_value;
+	  else
+	    conversion_row[ix] = low_value;
+	  break;
+      }
+
+    }
+  }
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Derivative, as create_derivative_histograms; the results are left in
+// fDerivativeX_image and fDerivativeY_image
+void corner::CornerFinderAlg::create_derivative_images(FlatImage<float> const& conversion){
+
+  const int x_bins = conversion.nx;
+  const int y_bins = conversion.ny;
+
+  fDerivativeX_image.reset(x_bins,y_bins,conversion.pad);
+  fDerivativeY_image.reset(x_bins,y_bins,conversion.pad);
+
+  auto c = [&conversion](int ix, int iy) -> double { return conversion(ix,iy); };
+
+  const bool sobel = (fDerivative_method.compare("Sobel")==0);
+  if(sobel && fDerivative_neighborhood!=1 && fDerivative_neighborhood!=2){
+    mf::LogError("CornerFinderAlg") << "Sobel derivative not supported for neighborhoods > 2.";
+    return;
+  }
+  else if(!sobel && fDerivative_method.compare("local")==0 && fDerivative_neighborhood!=1){
+    mf::LogError("CornerFinderAlg") << "Local derivative not yet supported for neighborhoods > 1.";
+    return;
+  }
+  else if(!sobel && fDerivative_method.compare("local")!=0){
+    mf::LogError("CornerFinderAlg") << "Bad derivative algorithm! " << fDerivative_method;
+    return;
+  }
+
+  for(int iy=1+fDerivative_neighborhood; iy<=(y_bins-fDerivative_neighborhood); iy++){
+
+    float* derivative_x = fDerivativeX_image.row(iy);
+    float* derivative_y = fDerivativeY_image.row(iy);
+
+    for(int ix=1+fDerivative_neighborhood; ix<=(x_bins-fDerivative_neighborhood); ix++){
+
+      if(!sobel){
+	derivative_x[ix] = (c(ix+1,iy)-c(ix-1,iy));
+	derivative_y[ix] = (c(ix,iy+1)-c(ix,iy-1));
+      }
+      else if(fDerivative_neighborhood==1){
+	derivative_x[ix] =
+	  0.5*(c(ix+1,iy)-c(ix-1,iy))
+	  + 0.25*(c(ix+1,iy+1)-c(ix-1,iy+1))
+	  + 0.25*(c(ix+1,iy-1)-c(ix-1,iy-1));
+	derivative_y[ix] =
+	  0.5*(c(ix,iy+1)-c(ix,iy-1))
+	  + 0.25*(c(ix-1,iy+1)-c(ix-1,iy-1))
+	  + 0.25*(c(ix+1,iy+1)-c(ix+1,iy-1));
+      }
+      else{
+	derivative_x[ix] =
+	  12*(c(ix+1,iy)-c(ix-1,iy))
+	  + 8*(c(ix+1,iy+1)-c(ix-1,iy+1))
+	  + 8*(c(ix+1,iy-1)-c(ix-1,iy-1))
+	  + 2*(c(ix+1,iy+2)-c(ix-1,iy+2))
+	  + 2*(c(ix+1,iy-2)-c(ix-1,iy-2))
+	  + 6*(c(ix+2,iy)-c(ix-2,iy))
+	  + 4*(c(ix+2,iy+1)-c(ix-2,iy+1))
+	  + 4*(c(ix+2,iy-1)-c(ix-2,iy-1))
+	  + 1*(c(ix+2,iy+2)-c(ix-2,iy+2))
+	  + 1*(c(ix+2,iy-2)-c(ix-2,iy-2));
+	derivative_y[ix] =
+	  12*(c(ix,iy+1)-c(ix,iy-1))
+	  + 8*(c(ix-1,iy+1)-c(ix-1,iy-1))
+	  + 8*(c(ix+1,iy+1)-c(ix+1,iy-1))
+	  + 2*(c(ix-2,iy+1)-c(ix-2,iy-1))
+	  + 2*(c(ix+2,iy+1)-c(ix+2,iy-1))
+	  + 6*(c(ix,iy+2)-c(ix,iy-2))
+	  + 4*(c(ix-1,iy+2)-c(ix-1,iy-2))
+	  + 4*(c(ix+1,iy+2)-c(ix+1,iy-2))
+	  + 1*(c(ix-2,iy+2)-c(ix-2,iy-2))
+	  + 1*(c(ix+2,iy+2)-c(ix+2,iy-2));
+      }
+
+    }
+  }
+
+  if(fDerivative_BlurNeighborhood<=0) return;
+
+  if(fDerivative_BlurNeighborhood>10){
+    mf::LogWarning("CornerFinderAlg") << "WARNING...BlurNeighborhoods>10 not currently allowed. Shrinking to 10.";
+    fDerivative_BlurNeighborhood=10;
+  }
+
+  // the blur function is only tabulated up to 5 bins from the center
+  const int blur_neighborhood = std::min(fDerivative_BlurNeighborhood,5);
+
+  // the non-zero weights of the blur function, in the order the bins are summed
+  // by create_derivative_histograms, so that the sums are the same
+  float func_blur[11][11];
+  fill_blur_function(func_blur);
+
+  struct BlurWeight { int dx, dy; double weight; };
+  std::vector<BlurWeight> weights;
+  for(int dx=-blur_neighborhood; dx<=blur_neighborhood; dx++)
+    for(int dy=-blur_neighborhood; dy<=blur_neighborhood; dy++)
+      if(func_blur[5-dx][5-dy]!=0) weights.push_back({ dx, dy, func_blur[5-dx][5-dy] });
+
+  fBlurX_image.reset(x_bins,y_bins,conversion.pad);
+  fBlurY_image.reset(x_bins,y_bins,conversion.pad);
+  fBlur_sums.resize(2*x_bins);
+  double* sum_x = fBlur_sums.data();
+  double* sum_y = sum_x + x_bins;
+
+  // each weight is applied to a whole row at a time, which vectorizes
+  for(int iy=1; iy<=y_bins; iy++){
+
+    std::fill(fBlur_sums.begin(),fBlur_sums.end(),0.);
+
+    for(auto const& w : weights){
+      float const* derivative_x = fDerivativeX_image.row(iy+w.dy) + w.dx;
+      float const* derivative_y = fDerivativeY_image.row(iy+w.dy) + w.dx;
+      const double weight = w.weight;
+      for(int ix=1; ix<=x_bins; ix++){
+	sum_x[ix-1] += derivative_x[ix]*weight;
+	sum_y[ix-1] += derivative_y[ix]*weight;
+      }
+    }
+
+    float* blur_x = fBlurX_image.row(iy);
+    float* blur_y = fBlurY_image.row(iy);
+    for(int ix=1; ix<=x_bins; ix++){
+      blur_x[ix] = sum_x[ix-1];
+      blur_y[ix] = sum_y[ix-1];
+    }
+  }
+
+  std::swap(fDerivativeX_image,fBlurX_image);
+  std::swap(fDerivativeY_image,fBlurY_image);
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Corner Score, as create_cornerScore_histogram
+void corner::CornerFinderAlg::create_cornerScore_image(FlatImage<float> const& derivative_x,
+							FlatImage<float> const& derivative_y,
+							FlatImage<double> & cornerScore) const {
+
+  const bool noble = (fCornerScore_algorithm.compare("Noble")==0);
+  if(!noble && fCornerScore_algorithm.compare("Harris")!=0){
+    mf::LogError("CornerFinderAlg") << "BAD CORNER ALGORITHM: " << fCornerScore_algorithm;
+    return;
+  }
+
+  const int x_bins = derivative_x.nx;
+  const int y_bins = derivative_x.ny;
+  const int n = fCornerScore_neighborhood;
+
+  auto dx = [&derivative_x](int ix, int iy) -> double { return derivative_x(ix,iy); };
+  auto dy = [&derivative_y](int ix, int iy) -> double { return derivative_y(ix,iy); };
+
+  //the structure tensor elements
+  double st_xx = 0., st_xy = 0., st_yy = 0.;
+
+  for(int iy=1+n; iy<=(y_bins-n); iy++){
+
+    double* score = cornerScore.row(iy);
+
+    for(int ix=1+n; ix<=(x_bins-n); ix++){
+
+      if(ix==1+n){
+	st_xx=0.; st_xy=0.; st_yy=0.;
+
+	for(int jx=ix-n; jx<=ix+n; jx++){
+	  for(int jy=iy-n; jy<=iy+n; jy++){
+	    st_xx += dx(jx,jy)*dx(jx,jy);
+	    st_yy += dy(jx,jy)*dy(jx,jy);
+	    st_xy += dx(jx,jy)*dy(jx,jy);
+	  }
+	}
+      }
+
+      // we do it this way to reduce computation time
+      else{
+	for(int jy=iy-n; jy<=iy+n; jy++){
+	  st_xx -= dx(ix-n-1,jy)*dx(ix-n-1,jy);
+	  st_xx += dx(ix+n,jy)*dx(ix+n,jy);
+
+	  st_yy -= dy(ix-n-1,jy)*dy(ix-n-1,jy);
+	  st_yy += dy(ix+n,jy)*dy(ix+n,jy);
+
+	  st_xy -= dx(ix-n-1,jy)*dy(ix-n-1,jy);
+	  st_xy += dx(ix+n,jy)*dy(ix+n,jy);
+	}
+      }
+
+      if(noble)
+	score[ix] = (st_xx*st_yy-st_xy*st_xy) / (st_xx+st_yy + fCornerScore_Noble_epsilon);
+      else
+	score[ix] = (st_xx*st_yy-st_xy*st_xy) - ((st_xx+st_yy)*(st_xx+st_yy)*fCornerScore_Harris_kappa);
+
+    } // end for loop over x bins
+  } // end for loop over y bins
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Max Supress, as perform_maximum_suppression
+size_t corner::CornerFinderAlg::perform_maximum_suppression_flat(FlatImage<double> const& cornerScore,
+								 std::vector<recob::EndPoint2D> & corner_vector,
+								 std::vector<geo::WireID> const& wireIDs,
+								 geo::View_t view,
+								 int startx,
+								 int starty) const {
+
+  const int x_bins = cornerScore.nx;
+  const int y_bins = cornerScore.ny;
+  const int n = fMaxSuppress_neighborhood;
+
+  for(int iy=1; iy<=y_bins; iy++){
+
+    double const* score_row = cornerScore.row(iy);
+
+    for(int ix=1; ix<=x_bins; ix++){
+
+      const double score = score_row[ix];
+      if(score < fMaxSuppress_threshold || !(score > -1000))
+	continue;
+
+      // the center is the maximum found scanning the neighborhood if no bin
+      // before it is as large, and no bin after it is larger
+      bool temp_center_bin = true;
+      for(int jx=ix-n; jx<=ix+n && temp_center_bin; jx++){
+	for(int jy=iy-n; jy<=iy+n; jy++){
+	  if(jx==ix && jy==iy) continue;
+	  const bool before = (jx<ix || (jx==ix && jy<iy));
+	  if(before? (cornerScore(jx,jy) >= score) : (cornerScore(jx,jy) > score)){
+	    temp_center_bin = false;
+	    break;
+	  }
+	}
+      }
+
+      if(temp_center_bin){
+
+	float time_tick = 0.5 * (float)((2*(iy+starty)) * fConversion_bins_per_input_y);
+	int wire_number = ( (2*(ix+startx))*fConversion_bins_per_input_x ) / 2;
+	double totalQ = 0;
+	int id = 0;
+	recob::EndPoint2D corner(time_tick,
+				 wireIDs[wire_number],
+				 score,
+				 id,
+				 view,
+				 totalQ);
+	corner_vector.push_back(corner);
+      }
+
+    }
+  }
+
+  return corner_vector.size();
+
+}
+
+
 /* Silly little function for doing a line integral type thing. Needs improvement. */
 float corner::CornerFinderAlg::line_integral(TH2F const& hist, int begin_x, float begin_y, int end_x, float end_y, float threshold) const{
 
@@ -45,6 +45,11 @@ namespace corner { //<---Not sure if this is the right namespace
      void get_feature_points_fast(std::vector<recob::EndPoint2D> &,
 				  geo::Geometry const&);                         //here we get feature points with corner score
 
+     void get_feature_points(TH2F const& h_wire_data,
+			     std::vector<geo::WireID> const& wireIDs,
+			     geo::View_t view,
+			     std::vector<recob::EndPoint2D> &);                  //feature points of a single wire data image, with corner score
+
      float line_integral(TH2F const& hist, int x1, float y1, int x2, float y2, float threshold) const;
 
      TH2F const& GetWireDataHist(unsigned int) const;
@@ -83,6 +88,33 @@ namespace corner { //<---Not sure if this is the right namespace
      int            fMaxSuppress_threshold;
      float          fIntegral_bin_threshold;
      float          fIntegral_fraction_threshold;
+     bool           fUseFlatImages;
+
+     /// Image with a zero border of pad bins around its nx x ny bins, stored
+     /// row by row (x is contiguous) like the bins of a TH2; bins are numbered
+     /// from 1 as in TH2
+     template <typename T>
+     struct FlatImage {
+       int nx = 0, ny = 0, pad = 0, stride = 0;
+       std::vector<T> data;
+
+       void reset(int x, int y, int p) {
+	 nx = x; ny = y; pad = p; stride = nx + 2*pad;
+	 data.assign(size_t(stride)*(ny + 2*pad), T(0));
+       }
+       T* row(int iy) { return data.data() + size_t(iy - 1 + pad)*stride + (pad - 1); }
+       T const* row(int iy) const { return data.data() + size_t(iy - 1 + pad)*stride + (pad - 1); }
+       T operator() (int ix, int iy) const { return row(iy)[ix]; }
+     };
+
+     // working images of the flat implementation, kept to reuse their memory
+     FlatImage<float>   fConversion_image;
+     FlatImage<float>   fDerivativeX_image;
+     FlatImage<float>   fDerivativeY_image;
+     FlatImage<float>   fBlurX_image;
+     FlatImage<float>   fBlurY_image;
+     FlatImage<double>  fCornerScore_image;
+     std::vector<double> fBlur_sums;
 
      // Making a vector of histograms
      std::vector<TH2F> WireData_histos;
@@ -115,6 +147,22 @@ namespace corner { //<---Not sure if this is the right namespace
 					   std::vector<recob::EndPoint2D> & corner_lineIntegralScore_vector,
                                            TH2F & h_lineIntegralScore) const;
 
+     // flat implementation of the steps above, with the same results
+     void create_image_flat(TH2F const& h_wire_data, FlatImage<float> & conversion) const;
+     void create_derivative_images(FlatImage<float> const& conversion);
+     void create_cornerScore_image(FlatImage<float> const& derivative_x, FlatImage<float> const& derivative_y, FlatImage<double> & cornerScore) const;
+     size_t perform_maximum_suppression_flat(FlatImage<double> const& cornerScore,
+					     std::vector<recob::EndPoint2D> & corner_vector,
+					     std::vector<geo::WireID> const& wireIDs,
+					     geo::View_t view,
+					     int startx=0,
+					     int starty=0) const;
+     void find_corners_flat(TH2F const& h_wire_data,
+			    std::vector<geo::WireID> const& wireIDs,
+			    geo::View_t view,
+			    std::vector<recob::EndPoint2D>&,
+			    int startx=0,int starty=0);
+
      void attach_feature_points(TH2F const& h_wire_data,
 				std::vector<geo::WireID> wireIDs,
 				geo::View_t view,
@@ -27,12 +27,18 @@
 #include <vector>
 #include <stdint.h> // uint32_t
 #include <limits> // std::numeric_limits<>
+#include <numeric> // std::accumulate()
 
 // ROOT/CLHEP libraries
 #include "CLHEP/Random/RandFlat.h"
 #include <TStopwatch.h>
 
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 // art libraries
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "art/Framework/Principal/Event.h"
@@ -54,6 +60,7 @@
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
 #include "larreco/RecoAlg/ClusterRecoUtil/StandardClusterParamsAlg.h"
 #include "larreco/RecoAlg/ClusterParamsImportWrapper.h"
+#include "larreco/RecoAlg/HoughClusterIO.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
 
@@ -108,8 +115,8 @@ typename cluster::HoughTransformCounters<K, C, S, A, SC>::PairValue_t
     for (size_t index = 0; index < block.size(); ++index) {
       if (block[index] > max.second)
         max = { Base_t::make_const_iterator(iCBlock, index), block[index] };
-      ++iCBlock;
     } // for elements in this block
+    ++iCBlock;
   } // while blocks
   return max;
 } // cluster::HoughTransformCounters<>::get_max(SubCounter_t)
@@ -231,9 +238,42 @@ void cluster::HoughBaseAlg::reconfigure(fhicl::ParameterSet const& pset)
   fMissedHits                     = pset.get< int    >("MissedHits"                     );
   fMissedHitsDistance             = pset.get< float  >("MissedHitsDistance"             );
   fMissedHitsToLineSize           = pset.get< float  >("MissedHitsToLineSize"           );
+  fDenseAccumulator               = pset.get< bool   >("DenseAccumulator",        false  );
+  fMaxDenseAccumulatorSize        = pset.get< size_t >("MaxDenseAccumulatorSize", 1UL << 26);
+  fParallelClusters               = pset.get< bool   >("ParallelClusters",        false  );
+
+  std::string const dumpFile      = pset.get< std::string >("ClusterDumpFile",    ""     );
+  fClusterDump.reset();
+  if (!dumpFile.empty()) fClusterDump = std::make_shared<HoughClusterWriter>(dumpFile);
   return;
 }
 
+//------------------------------------------------------------------------------
+void cluster::HoughBaseAlg::InitAccumulator(
+  HoughTransform& c,
+  std::vector<art::Ptr<recob::Hit>> const& hits,
+  unsigned int dx, unsigned int dy
+) const {
+  // the box of the points that can be accumulated (see AddPointReturnMax())
+  int xMin = dx, xMax = 0, yMin = dy, yMax = 0;
+  for (art::Ptr<recob::Hit> const& hit: hits) {
+    int const x = hit->WireID().Wire;
+    int const y = (int)(hit->PeakTime());
+    if ((x > (int) dx) || (y > (int) dy) || (x < 0) || (y < 0)) continue;
+    xMin = std::min(xMin, x);
+    xMax = std::max(xMax, x);
+    yMin = std::min(yMin, y);
+    yMax = std::max(yMax, y);
+  } // for hits
+
+  if (!fDenseAccumulator || (xMin > xMax) || (yMin > yMax))
+    c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells);
+  else {
+    c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells,
+      xMin, xMax, yMin, yMax, fMaxDenseAccumulatorSize);
+  }
+} // cluster::HoughBaseAlg::InitAccumulator()
+
 //------------------------------------------------------------------------------
 cluster::HoughTransform::HoughTransform()
 {
@@ -372,7 +412,7 @@ size_t cluster::HoughBaseAlg::Transform(
 
   ///Init specifies the size of the two-dimensional accumulator
   ///(based on the arguments, number of wires and number of time samples).
-  c.Init(dx,dy,fRhoResolutionFactor,fNumAngleCells);
+  InitAccumulator(c, hits, dx, dy);
   /// Adds all of the hits to the accumulator
   //mf::LogInfo("HoughBaseAlg") << "Beginning PPHT";
 
@@ -785,7 +825,59 @@ cluster::HoughTransform::~HoughTransform()
 
 
 //------------------------------------------------------------------------------
-inline int cluster::HoughTransform::GetCell(int row, int col) const {
+size_t cluster::HoughTransformDenseCounters::RequiredSize
+  (std::vector<int> const& minDist, std::vector<int> const& maxDist)
+{
+  size_t size = 0;
+  for (size_t first = 0; first < minDist.size(); first += TileAngles) {
+    size_t const last = std::min(first + TileAngles, minDist.size());
+    int const groupMin
+      = *std::min_element(minDist.begin() + first, minDist.begin() + last);
+    int const groupMax
+      = *std::max_element(maxDist.begin() + first, maxDist.begin() + last);
+    size_t const nTiles = (groupMax - groupMin) / TileDistances + 1;
+    size += nTiles * TileAngles * TileDistances;
+  } // for angle groups
+  return size;
+} // cluster::HoughTransformDenseCounters::RequiredSize()
+
+
+void cluster::HoughTransformDenseCounters::Init
+  (std::vector<int> const& minDist, std::vector<int> const& maxDist)
+{
+  clear();
+  m_numAngles = minDist.size();
+  size_t offset = 0;
+  for (size_t first = 0; first < minDist.size(); first += TileAngles) {
+    size_t const last = std::min(first + TileAngles, minDist.size());
+    int const groupMin
+      = *std::min_element(minDist.begin() + first, minDist.begin() + last);
+    int const groupMax
+      = *std::max_element(maxDist.begin() + first, maxDist.begin() + last);
+    size_t const nTiles = (groupMax - groupMin) / TileDistances + 1;
+    m_groupMinDist.push_back(groupMin);
+    m_groupEndDist.push_back(groupMin + nTiles * TileDistances);
+    m_groupOffset.push_back(offset);
+    offset += nTiles * TileAngles * TileDistances;
+  } // for angle groups
+  m_counters.resize(offset, 0);
+} // cluster::HoughTransformDenseCounters::Init()
+
+
+void cluster::HoughTransformDenseCounters::clear()
+{
+  m_numAngles = 0;
+  m_groupMinDist.clear();
+  m_groupEndDist.clear();
+  m_groupOffset.clear();
+  // release the memory, that may be large
+  std::vector<Counter_t>().swap(m_counters);
+} // cluster::HoughTransformDenseCounters::clear()
+
+
+//------------------------------------------------------------------------------
+int cluster::HoughTransform::GetCell(int row, int col) const {
+  if (m_isDense) return m_dense.get(row, col);
   return m_accum[row][col];
 } // cluster::HoughTransform::GetCell()
 
@@ -793,24 +885,26 @@ inline int cluster::HoughTransform::GetCell(int row, int col) const {
 //------------------------------------------------------------------------------
 // returns a vector<int> where the first is the overall maximum,
 // the second is the max x value, and the third is the max y value.
-inline std::array<int, 3> cluster::HoughTransform::AddPointReturnMax(int x, int y)
+std::array<int, 3> cluster::HoughTransform::AddPointReturnMax(int x, int y)
 {
   if ((x > (int) m_dx) || (y > (int) m_dy) || x<0.0 || y<0.0) {
     std::array<int, 3> max;
     max.fill(0);
     return max;
   }
+  if (m_isDense) return DoAddPointReturnMaxDense(x, y, false); // false = add
   return DoAddPointReturnMax(x, y, false); // false = add
 }
 
 
 
 //------------------------------------------------------------------------------
-inline bool cluster::HoughTransform::SubtractPoint(int x, int y)
+bool cluster::HoughTransform::SubtractPoint(int x, int y)
 {
   if ((x > (int) m_dx) || (y > (int) m_dy) || x<0.0 || y<0.0)
     return false;
-  DoAddPointReturnMax(x, y, true); // true = subtract
+  if (m_isDense) DoAddPointReturnMaxDense(x, y, true); // true = subtract
+  else           DoAddPointReturnMax(x, y, true); // true = subtract
   return true;
 }
 
@@ -820,10 +914,82 @@ void cluster::HoughTransform::Init(unsigned int dx,
                                    unsigned int dy,
                                    float rhores,
                                    unsigned int numACells)
+{
+  InitTables(dx, dy, rhores, numACells);
+  m_accum.resize(m_numAngleCells);
+  //for(int i = 0; i < m_numAngleCells; i++)
+    //m_accum[i].resize((unsigned int)(m_rowLength));
+}
+
+
+//------------------------------------------------------------------------------
+void cluster::HoughTransform::Init(unsigned int dx,
+                                   unsigned int dy,
+                                   float rhores,
+                                   unsigned int numACells,
+                                   int xMin, int xMax, int yMin, int yMax,
+                                   size_t maxDenseCells)
+{
+  InitTables(dx, dy, rhores, numACells);
+
+  // The range of distances filled at angle a by a point spans from its
+  // distance at the previous angle to the one at a (see
+  // DoAddPointReturnMax()); the distance is monotonic in x and in y, so the
+  // extremes over the box are at its corners. This math must be coherent with
+  // the one in DoAddPointReturnMaxDense().
+  const int distCenter = (int)(m_rowLength/2.);
+  std::vector<int> minDist(m_numAngleCells), maxDist(m_numAngleCells);
+  for (int x: { xMin, xMax }) {
+    for (int y: { yMin, yMax }) {
+      int lastDist = (int)(distCenter + (m_rhoResolutionFactor*x));
+      for (size_t iAngleStep = 0; iAngleStep < m_numAngleCells; ++iAngleStep) {
+        const int dist = (iAngleStep == 0)? lastDist: (int) (distCenter
+          + m_rhoResolutionFactor
+          * (m_cosTable[iAngleStep]*x + m_sinTable[iAngleStep]*y)
+          );
+        const int low = std::min(dist, lastDist) - 1;
+        const int high = std::max(dist, lastDist) + 1;
+        if ((x == xMin) && (y == yMin)) {
+          minDist[iAngleStep] = low;
+          maxDist[iAngleStep] = high;
+        }
+        else {
+          minDist[iAngleStep] = std::min(minDist[iAngleStep], low);
+          maxDist[iAngleStep] = std::max(maxDist[iAngleStep], high);
+        }
+        lastDist = dist;
+      } // for angles
+    } // for y corners
+  } // for x corners
+
+  if (HoughTransformDenseCounters::RequiredSize(minDist, maxDist)
+    > maxDenseCells)
+  {
+    m_accum.resize(m_numAngleCells);
+    return;
+  }
+
+  m_isDense = true;
+  m_xMin = xMin;
+  m_xMax = xMax;
+  m_yMin = yMin;
+  m_yMax = yMax;
+  m_dense.Init(minDist, maxDist);
+  m_distances.resize(m_numAngleCells);
+}
+
+
+//------------------------------------------------------------------------------
+void cluster::HoughTransform::InitTables(unsigned int dx,
+                                         unsigned int dy,
+                                         float rhores,
+                                         unsigned int numACells)
 {
   m_numAngleCells=numACells;
   m_rhoResolutionFactor = rhores;
 
+  m_isDense = false;
+  m_dense.clear();
   m_accum.clear();
   //--- BEGIN issue #19494 -----------------------------------------------------
   // BulkAllocator.h is currently broken; see issue #19494 and comment in header.
@@ -857,9 +1023,6 @@ void cluster::HoughTransform::Init(unsigned int dx,
   m_dx = dx;
   m_dy = dy;
   m_rowLength = (unsigned int)(m_rhoResolutionFactor*2 * std::sqrt(dx*dx + dy*dy));
-  m_accum.resize(m_numAngleCells);
-  //for(int i = 0; i < m_numAngleCells; i++)
-    //m_accum[i].resize((unsigned int)(m_rowLength));
 
   // this math must be coherent with the one in GetEquation()
   double angleStep = PI/m_numAngleCells;
@@ -885,6 +1048,21 @@ void cluster::HoughTransform::GetEquation
 int cluster::HoughTransform::GetMax(int &xmax, int &ymax) const
 {
   int maxVal = -1;
+  if (m_isDense) {
+    for(unsigned int i = 0; i < m_numAngleCells; i++){
+      std::pair<int, int> const range = m_dense.range(i);
+      for (int dist = range.first; dist < range.second; ++dist) {
+        int const value = m_dense.get(i, dist);
+        if (value > maxVal) {
+          maxVal = value;
+          xmax = i;
+          ymax = dist;
+        }
+      } // for distances
+    } // for angle
+    return maxVal;
+  } // if dense
+
   for(unsigned int i = 0; i < m_accum.size(); i++){
 
     DistancesMap_t::PairValue_t max_counter = m_accum[i].get_max(maxVal);
@@ -1005,6 +1183,75 @@ std::array<int, 3> cluster::HoughTransform::DoAddPointReturnMax
 } // cluster::HoughTransform::DoAddPointReturnMax()
 
 
+//------------------------------------------------------------------------------
+// same as DoAddPointReturnMax(), on the dense accumulator
+std::array<int, 3> cluster::HoughTransform::DoAddPointReturnMaxDense
+  (int x, int y, bool bSubtract)
+{
+  if ((x < m_xMin) || (x > m_xMax) || (y < m_yMin) || (y > m_yMax)) {
+    throw cet::exception("HoughTransform")
+      << "Point (" << x << ", " << y << ") is out of the accumulator box ["
+      << m_xMin << ", " << m_xMax << "] x [" << m_yMin << ", " << m_yMax
+      << "]\n";
+  }
+
+  std::array<int, 3> max;
+  max.fill(-1);
+  int max_val = 2;
+
+  const int distCenter = (int)(m_rowLength/2.);
+  int lastDist = (int)(distCenter + (m_rhoResolutionFactor*x));
+
+  // the distances at all the angles at once, in a loop free of dependencies
+  // so that it is vectorised; the expression is the one in
+  // DoAddPointReturnMax(), which the result must match exactly
+  int* distances = m_distances.data();
+  double const* cosTable = m_cosTable.data();
+  double const* sinTable = m_sinTable.data();
+  const double rhoResolutionFactor = m_rhoResolutionFactor;
+  for (size_t iAngleStep = 1; iAngleStep < m_numAngleCells; ++iAngleStep) {
+    distances[iAngleStep] = (int) (distCenter + rhoResolutionFactor
+      * (cosTable[iAngleStep]*x + sinTable[iAngleStep]*y)
+      );
+  } // for angles
+
+  for (size_t iAngleStep = 1; iAngleStep < m_numAngleCells; ++iAngleStep) {
+    const int dist = distances[iAngleStep];
+
+    // same range of cells as in DoAddPointReturnMax()
+    int first_dist;
+    int end_dist;
+    if(lastDist == dist) {
+      first_dist = dist;
+      end_dist   = dist + 1;
+    }
+    else {
+      first_dist = dist > lastDist? lastDist: dist + 1;
+      end_dist   = dist > lastDist? dist: lastDist + 1;
+    }
+
+    if (bSubtract) {
+      for (int d = first_dist; d < end_dist; ++d)
+        --m_dense.counter(iAngleStep, d);
+    }
+    else {
+      for (int d = first_dist; d < end_dist; ++d) {
+        const int value = ++m_dense.counter(iAngleStep, d);
+        if (value > max_val) {
+          max = {{ value, d, (int) iAngleStep }};
+          max_val = value;
+        }
+      } // for distances
+    }
+    lastDist = dist;
+  } // for angles
+  if (bSubtract) --m_numAccumulated;
+  else           ++m_numAccumulated;
+
+  return max;
+} // cluster::HoughTransform::DoAddPointReturnMaxDense()
+
+
 //------------------------------------------------------------------------------
 //this method saves a BMP image of the Hough Accumulator, which can be viewed with gimp
 void cluster::HoughBaseAlg::HLSSaveBMPFile(const char *fileName, unsigned char *pix, int dx, int dy)
@@ -1055,11 +1302,15 @@ size_t cluster::HoughBaseAlg::FastTransform(const std::vector<art::Ptr<recob::Cl
   art::FindManyP<recob::Hit> fmh(clusIn, evt, label);
 
   geo::GeometryCore const* geom = lar::providerFrom<geo::Geometry>();
-  //  const detinfo::DetectorProperties* detprop = lar::providerFrom<detinfo::DetectorPropertiesService>();
-//  lariov::ChannelStatusProvider const* channelStatus
-//    = lar::providerFrom<lariov::ChannelStatusService>();
+  const detinfo::DetectorProperties* detprop = lar::providerFrom<detinfo::DetectorPropertiesService>();
+  lariov::ChannelStatusProvider const* channelStatus
+    = lar::providerFrom<lariov::ChannelStatusService>();
   HoughTransform c;
 
+  // the hits of each set to be transformed, and their view
+  std::vector<std::vector<art::Ptr<recob::Hit>>> clusterHits;
+  std::vector<geo::View_t> clusterViews;
+
   // prepare the algorithm to compute the cluster characteristics;
   // we use the "standard" one here; configuration would happen here,
   // but we are using the default configuration for that algorithm
@@ -1072,7 +1323,6 @@ size_t cluster::HoughBaseAlg::FastTransform(const std::vector<art::Ptr<recob::Cl
     MF_LOG_DEBUG("HoughBaseAlg") << "Analyzing view " << view;
 
     art::PtrVector<recob::Cluster>::const_iterator clusterIter = clusIn.begin();
-    int clusterID = 0;//the unique ID of the cluster
 
     size_t cinctr = 0;
     while(clusterIter != clusIn.end()) {
@@ -1357,10 +1607,114 @@ size_t cluster::HoughBaseAlg::FastTransform(const std::vector<art::Ptr<recob::Cl
 
       }// end loop over hits*/
 
+      if (fClusterDump) {
+        geo::WireID const& wireid = hit.front()->WireID();
+        HoughClusterPoints points;
+        points.dx = geom->Cryostat(wireid.Cryostat).TPC(wireid.TPC).Plane(wireid.Plane).Nwires();
+        points.dy = detprop->ReadOutWindowSize();
+        for (art::Ptr<recob::Hit> const& h: hit)
+          points.points.emplace_back(h->WireID().Wire, (int)(h->PeakTime()));
+        fClusterDump->Write(points);
+      }
+
+      clusterHits.push_back(hit);
+      clusterViews.push_back(view);
+
+      hit.clear();
+      //  lastHits.clear();
+      if(clusterIter != clusIn.end()){
+	clusterIter++;
+	++cinctr;
+      }
+      // listofxmax.clear();
+      // listofymax.clear();
+    }//end loop over clusters
+
+  }// end loop over views
+
+  //
+  // transform the hit sets
+  //
+  std::vector<std::vector<art::PtrVector<recob::Hit>>>
+    transformedHits(clusterHits.size());
+
+  if (!fParallelClusters || (clusterHits.size() < 2)) {
+    for (size_t iCluster = 0; iCluster < clusterHits.size(); ++iCluster) {
       std::vector<double> slopevec;
       std::vector<ChargeInfo_t> totalQvec;
-      std::vector< art::PtrVector<recob::Hit> >   planeClusHitsOut;
-      this->FastTransform(hit,planeClusHitsOut,engine, slopevec,totalQvec);
+      this->FastTransform(clusterHits[iCluster], transformedHits[iCluster],
+        engine, slopevec, totalQvec);
+    } // for
+  }
+  else {
+    // The result must not depend on the concurrency: each set must get the
+    // random numbers it would get from the engine when transformed in order.
+    // A set takes one number per hit, unless it stops early; the numbers are
+    // drawn in advance, and the sets are transformed concurrently assuming
+    // that none stops early. Each set transformed with the numbers it would
+    // have had in order is then accepted; if one set used fewer numbers, the
+    // following ones are transformed again with the correct ones. That is
+    // done concurrently only once: after a second set stops early, the rest
+    // is transformed in order, so that no set is transformed more than three
+    // times however many stop early.
+    std::vector<size_t> nHits(clusterHits.size());
+    for (size_t iCluster = 0; iCluster < clusterHits.size(); ++iCluster)
+      nHits[iCluster] = clusterHits[iCluster].size();
+
+    std::vector<unsigned long> const engineState = engine.put();
+    CLHEP::RandFlat flat(engine);
+    std::vector<double> randomNumbers(std::accumulate(nHits.begin(), nHits.end(), size_t(0)));
+    for (double& number: randomNumbers) number = flat.fire();
+
+    // transforms a set with the numbers from first on, returns how many it used
+    auto transformCluster = [&](size_t iCluster, size_t first) {
+      std::vector<double> slopevec;
+      std::vector<ChargeInfo_t> totalQvec;
+      size_t used = 0;
+      transformedHits[iCluster].clear();
+      DoFastTransform(clusterHits[iCluster], transformedHits[iCluster],
+        slopevec, totalQvec, *geom, *detprop, *channelStatus,
+        [&](){ return randomNumbers[first + used++]; });
+      return used;
+    };
+
+    std::vector<size_t> firstNumber(clusterHits.size()), usedNumbers(clusterHits.size());
+    size_t nAccepted = 0, nextNumber = 0;
+    for (unsigned int iPass = 0; (iPass < 2) && (nAccepted < clusterHits.size()); ++iPass) {
+      size_t number = nextNumber;
+      for (size_t iCluster = nAccepted; iCluster < clusterHits.size(); ++iCluster) {
+        firstNumber[iCluster] = number;
+        number += nHits[iCluster];
+      } // for
+
+      tbb::parallel_for(tbb::blocked_range<size_t>(nAccepted, clusterHits.size(), 1),
+        [&](const tbb::blocked_range<size_t>& range) {
+          for (size_t iCluster = range.begin(); iCluster != range.end(); ++iCluster)
+            usedNumbers[iCluster] = transformCluster(iCluster, firstNumber[iCluster]);
+        });
+
+      while ((nAccepted < clusterHits.size()) && (firstNumber[nAccepted] == nextNumber))
+        nextNumber += usedNumbers[nAccepted++];
+    } // for passes
+
+    for (; nAccepted < clusterHits.size(); ++nAccepted)
+      nextNumber += transformCluster(nAccepted, nextNumber);
+
+    // leave the engine where the transforms in order would have
+    engine.get(engineState);
+    for (size_t i = 0; i < nextNumber; ++i) flat.fire();
+  }
+
+  //
+  // create the clusters
+  //
+  int clusterID = 0;//the unique ID of the cluster (in its view)
+  for (size_t iCluster = 0; iCluster < clusterHits.size(); ++iCluster) {
+    if ((iCluster > 0) && (clusterViews[iCluster] != clusterViews[iCluster - 1]))
+      clusterID = 0;
+
+    std::vector< art::PtrVector<recob::Hit> > const& planeClusHitsOut
+      = transformedHits[iCluster];
 
       MF_LOG_DEBUG("HoughBaseAlg") << "Made it through FastTransform" << planeClusHitsOut.size();
 
@@ -1411,18 +1765,7 @@ size_t cluster::HoughBaseAlg::FastTransform(const std::vector<art::Ptr<recob::Cl
 	clusHitsOut.push_back(planeClusHitsOut.at(xx));
       }
 
-
-      hit.clear();
-      //  lastHits.clear();
-      if(clusterIter != clusIn.end()){
-	clusterIter++;
-	++cinctr;
-      }
-      // listofxmax.clear();
-      // listofymax.clear();
-    }//end loop over clusters
-
-  }// end loop over views
+  }// end loop over hit sets
 
   return ccol.size();
 
@@ -1447,10 +1790,6 @@ size_t cluster::HoughBaseAlg::FastTransform(std::vector<art::Ptr<recob::Hit>> co
                                             std::vector<double>& slopevec,
                                             std::vector<ChargeInfo_t>& totalQvec)
 {
-  std::vector<int> skip;
-
-  //art::FindManyP<recob::Hit> fmh(clusIn, evt, label);
-
   geo::GeometryCore const* geom = lar::providerFrom<geo::Geometry>();
   const detinfo::DetectorProperties* detprop = lar::providerFrom<detinfo::DetectorPropertiesService>();
   lariov::ChannelStatusProvider const* channelStatus
@@ -1458,6 +1797,30 @@ size_t cluster::HoughBaseAlg::FastTransform(std::vector<art::Ptr<recob::Hit>> co
 
   CLHEP::RandFlat flat(engine);
 
+  return DoFastTransform(clusIn, clusHitsOut, slopevec, totalQvec,
+    *geom, *detprop, *channelStatus, [&flat](){ return flat.fire(); });
+}
+
+
+//------------------------------------------------------------------------------
+size_t cluster::HoughBaseAlg::DoFastTransform(std::vector<art::Ptr<recob::Hit>> const& clusIn,
+                                              std::vector< art::PtrVector<recob::Hit> >      & clusHitsOut,
+                                              std::vector<double>& slopevec,
+                                              std::vector<ChargeInfo_t>& totalQvec,
+                                              geo::GeometryCore const& geometry,
+                                              detinfo::DetectorProperties const& detProp,
+                                              lariov::ChannelStatusProvider const& chanStatus,
+                                              std::function<double()> const& flat)
+{
+  std::vector<int> skip;
+
+  //art::FindManyP<recob::Hit> fmh(clusIn, evt, label);
+
+  // this may run concurrently on different clusters: services are not accessed
+  geo::GeometryCore const* geom = &geometry;
+  const detinfo::DetectorProperties* detprop = &detProp;
+  lariov::ChannelStatusProvider const* channelStatus = &chanStatus;
+
   std::vector< art::Ptr<recob::Hit> > hit;
 
 //   for(size_t cs = 0; cs < geom->Ncryostats(); ++cs){
@@ -1556,7 +1919,7 @@ size_t cluster::HoughBaseAlg::FastTransform(std::vector<art::Ptr<recob::Hit>> co
   //Init specifies the size of the two-dimensional accumulator
   //(based on the arguments, number of wires and number of time samples).
   //adds all of the hits (that have not yet been associated with a line) to the accumulator
-  c.Init(dx,dy,fRhoResolutionFactor,fNumAngleCells);
+  InitAccumulator(c, hit, dx, dy);
 
   // count is how many points are left to randomly insert
   unsigned int count = hit.size();
@@ -1569,7 +1932,7 @@ size_t cluster::HoughBaseAlg::FastTransform(std::vector<art::Ptr<recob::Hit>> co
 
 
     // The random hit we are examining
-    unsigned int randInd = (unsigned int)(flat.fire()*hit.size());
+    unsigned int randInd = (unsigned int)(flat()*hit.size());
 
     MF_LOG_DEBUG("HoughBaseAlg") << "randInd=" << randInd << " and size is " << hit.size();
 
@@ -1873,7 +2236,7 @@ size_t cluster::HoughBaseAlg::Transform(std::vector< art::Ptr<recob::Hit> > cons
   int dx = geom->Nwires(0);               //number of wires
   const int dy = detprop->ReadOutWindowSize(); // number of time samples.
 
-  c.Init(dx,dy,fRhoResolutionFactor,fNumAngleCells);
+  InitAccumulator(c, hits, dx, dy);
 
   for(unsigned int i=0;i < hits.size(); ++i){
     c.AddPointReturnMax(hits[i]->WireID().Wire, (int)(hits[i]->PeakTime()));
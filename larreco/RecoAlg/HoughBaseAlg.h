@@ -120,6 +120,23 @@
 // architectures. No check is performed for overflow; that can also be
 // implemented at a small cost.
 //
+// Dense accumulator
+// ----------------------------------------------------------------------------
+//
+// The transform is usually run on one cluster at a time, and the points of a
+// cluster span a small box of the plane. The distances reachable at each
+// angle by the points in that box are then a narrow band, and all the
+// counters of that band fit in a plain array of modest size. When so
+// configured (and when the band is not larger than a configured limit), the
+// accumulator is such an array (HoughTransformDenseCounters), that has no
+// look up nor insertion cost. Its counters are arranged in tiles of 8 angles
+// times 8 distances (a 64 byte cache line): the distance of a point changes
+// little from one angle to the next, so that the counters incremented for
+// consecutive angles are usually in the same tile.
+// The distances of a point at all the angles are computed in a single loop
+// the compiler can vectorise, before the counters are increased; the result
+// is the same as with the sparse accumulator, maxima included.
+//
 //
 ////////////////////////////////////////////////////////////////////////
 #ifndef HOUGHBASEALG_H
@@ -128,6 +145,8 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <functional> // std::function<>
+#include <memory> // std::shared_ptr<>
 #include <utility> // std::pair<>
 
 #include "canvas/Persistency/Common/Ptr.h"
@@ -147,6 +166,9 @@
 namespace CLHEP { class HepRandomEngine; }
 namespace art { class Event; }
 namespace fhicl { class ParameterSet; }
+namespace geo { class GeometryCore; }
+namespace detinfo { class DetectorProperties; }
+namespace lariov { class ChannelStatusProvider; }
 
 namespace recob {
   class Hit;
@@ -269,6 +291,8 @@ namespace recob {
 
 namespace cluster {
 
+  class HoughClusterWriter;
+
 
   /**
    * @brief CountersMap with access optimized for Hough Transform algorithm
@@ -475,6 +499,88 @@ namespace cluster {
   }; // class HoughTransformCounters
 
 
+  /**
+   * @brief Dense array of Hough transform counters in a band of distances
+   *
+   * The counters cover, for each angle, a range of distances; the range is
+   * set at initialization by the caller, who knows which distances can be
+   * reached. Consecutive groups of TileAngles angles share the union of their
+   * distance ranges, split in tiles of TileAngles x TileDistances counters
+   * stored contiguously, distance first.
+   * Counters outside the covered region read as 0 and can't be changed.
+   */
+  class HoughTransformDenseCounters {
+      public:
+
+    using Counter_t = signed char; ///< type of the counters (as the sparse ones)
+
+    static constexpr unsigned int TileAngles = 8; ///< angles in a tile
+    static constexpr unsigned int TileDistances = 8; ///< distances in a tile
+
+    /**
+     * @brief Returns the number of counters needed to cover the ranges
+     * @param minDist lowest distance covered at each angle
+     * @param maxDist highest distance covered at each angle (included)
+     */
+    static size_t RequiredSize
+      (std::vector<int> const& minDist, std::vector<int> const& maxDist);
+
+    /// Allocates the counters for the specified ranges (see RequiredSize()), all 0
+    void Init(std::vector<int> const& minDist, std::vector<int> const& maxDist);
+
+    /// Releases all the counters
+    void clear();
+
+    /// Number of counters (including the ones just padding the tiles)
+    size_t size() const { return m_counters.size(); }
+
+    /// Returns whether the counter (angle, dist) is covered
+    bool contains(unsigned int angle, int dist) const
+      {
+        if (angle >= m_numAngles) return false;
+        unsigned int const group = angle / TileAngles;
+        return (dist >= m_groupMinDist[group]) && (dist < m_groupEndDist[group]);
+      }
+
+    /// Returns the value of the counter (angle, dist), 0 if not covered
+    Counter_t get(unsigned int angle, int dist) const
+      { return contains(angle, dist)? m_counters[index(angle, dist)]: 0; }
+
+    /// Sets the value of the counter (angle, dist), if covered
+    void set(unsigned int angle, int dist, Counter_t value)
+      { if (contains(angle, dist)) m_counters[index(angle, dist)] = value; }
+
+    /// Returns the counter (angle, dist), that must be covered
+    Counter_t& counter(unsigned int angle, int dist)
+      { return m_counters[index(angle, dist)]; }
+
+    /// Returns the first and past-the-last distances covered at the angle
+    std::pair<int, int> range(unsigned int angle) const
+      {
+        unsigned int const group = angle / TileAngles;
+        return { m_groupMinDist[group], m_groupEndDist[group] };
+      }
+
+      private:
+    unsigned int m_numAngles = 0;
+    std::vector<int> m_groupMinDist; ///< lowest distance of each angle group
+    std::vector<int> m_groupEndDist; ///< past-the-highest distance of each group
+    std::vector<size_t> m_groupOffset; ///< first counter of each angle group
+    std::vector<Counter_t> m_counters; ///< all the counters, by tile
+
+    /// Position of the counter (angle, dist) in the tiled array
+    size_t index(unsigned int angle, int dist) const
+      {
+        unsigned int const group = angle / TileAngles;
+        unsigned int const d = dist - m_groupMinDist[group];
+        return m_groupOffset[group]
+          + (d / TileDistances) * (TileAngles * TileDistances)
+          + (angle % TileAngles) * TileDistances + d % TileDistances;
+      }
+
+  }; // class HoughTransformDenseCounters
+
+
 #define FC_DEVELOP 0
 
   class HoughTransform {
@@ -485,13 +591,29 @@ namespace cluster {
 
     void Init
       (unsigned int dx, unsigned int dy, float rhores, unsigned int numACells);
+    /**
+     * @brief Initializes the transform of points in [ xMin, xMax ] x [ yMin, yMax ]
+     * @param maxDenseCells largest number of counters of a dense accumulator
+     *
+     * As the other Init(), except that the accumulator is dense if it takes
+     * no more than maxDenseCells counters to cover the box; in that case,
+     * adding or subtracting a point outside the box throws cet::exception.
+     */
+    void Init(unsigned int dx, unsigned int dy, float rhores,
+              unsigned int numACells,
+              int xMin, int xMax, int yMin, int yMax, size_t maxDenseCells);
+    bool IsDense() const { return m_isDense; }
     std::array<int,3> AddPointReturnMax(int x, int y);
     bool SubtractPoint(int x, int y);
     int  GetCell(int row, int col) const;
-    void SetCell(int row, int col, int value) { m_accum[row].set(col, value); }
+    void SetCell(int row, int col, int value)
+    {
+      if (m_isDense) m_dense.set(row, col, value);
+      else           m_accum[row].set(col, value);
+    }
     void GetAccumSize(int &numRows, int &numCols)
     {
-      numRows = m_accum.size();
+      numRows = (int) m_numAngleCells;
       numCols  = (int) m_rowLength;
     }
     int NumAccumulated()                      { return m_numAccumulated; }
@@ -533,11 +655,18 @@ namespace cluster {
     // the vector elements are called by rho, theta is the container key,
     // the number of hits is the value corresponding to the key
     HoughImage_t m_accum;  ///< column (map key)=rho, row (vector index)=theta
+    bool m_isDense = false; ///< whether m_dense is used instead of m_accum
+    HoughTransformDenseCounters m_dense; ///< dense accumulator
+    int m_xMin = 0, m_xMax = 0, m_yMin = 0, m_yMax = 0; ///< box of m_dense
+    std::vector<int> m_distances; ///< distances of the current point (dense)
     int m_numAccumulated;
     std::vector<double> m_cosTable;
     std::vector<double> m_sinTable;
 
+    void InitTables
+      (unsigned int dx, unsigned int dy, float rhores, unsigned int numACells);
     std::array<int,3> DoAddPointReturnMax(int x, int y, bool bSubtract = false);
+    std::array<int,3> DoAddPointReturnMaxDense(int x, int y, bool bSubtract);
 
 
   }; // class HoughTransform
@@ -613,6 +742,23 @@ namespace cluster {
 
   private:
 
+    /// Initializes c for the hits, with a dense accumulator if so configured
+    void InitAccumulator(HoughTransform& c,
+                         std::vector<art::Ptr<recob::Hit>> const& hits,
+                         unsigned int dx, unsigned int dy) const;
+
+    /// FastTransform() on a set of hits with the given services and random numbers
+    size_t DoFastTransform(
+      std::vector<art::Ptr<recob::Hit>> const& clusIn,
+      std::vector<art::PtrVector<recob::Hit>>& clusHitsOut,
+      std::vector<double>                    & slope,
+      std::vector<ChargeInfo_t>              & totalQ,
+      geo::GeometryCore const& geom,
+      detinfo::DetectorProperties const& detprop,
+      lariov::ChannelStatusProvider const& channelStatus,
+      std::function<double()> const& flat
+      );
+
     int    fMaxLines;                      ///< Max number of lines that can be found
     int    fMinHits;                       ///< Min number of hits in the accumulator to consider
                                            ///< (number of hits required to be considered a line).
@@ -632,6 +778,10 @@ namespace cluster {
                                            ///< segments
     float  fMissedHitsDistance;            ///< Distance between hits in a hough line before a hit is considered missed
     float  fMissedHitsToLineSize;          ///< Ratio of missed hits to line size for a line to be considered a fake
+    bool   fDenseAccumulator;              ///< Use a dense accumulator for the clusters small enough
+    size_t fMaxDenseAccumulatorSize;       ///< Largest number of counters of a dense accumulator
+    bool   fParallelClusters;              ///< Transform the clusters of FastTransform() concurrently
+    std::shared_ptr<HoughClusterWriter> fClusterDump; ///< Writes the transformed clusters (if configured)
 
   protected:
 
@@ -0,0 +1,116 @@
+/**
+ * @file   HoughClusterIO.cxx
+ * @brief  Read and write the points given to the Hough transform to a binary file
+ * @see    HoughClusterIO.h
+ */
+
+// our header
+#include "larreco/RecoAlg/HoughClusterIO.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <cstdint>
+#include <cstring> // std::memcmp()
+
+
+namespace {
+
+  constexpr char kMagic[8] = { 'L', 'A', 'R', 'H', 'O', 'U', 'G', 'H' };
+  constexpr uint32_t kVersion = 1;
+
+  template <typename T>
+  void writeValue(std::ofstream& output, T const& value)
+    { output.write(reinterpret_cast<char const*>(&value), sizeof(T)); }
+
+  template <typename T>
+  bool readValue(std::ifstream& input, T& value)
+    { return bool(input.read(reinterpret_cast<char*>(&value), sizeof(T))); }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+cluster::HoughClusterWriter::HoughClusterWriter(std::string const& fileName)
+  : fOutput(fileName, std::ios::binary | std::ios::trunc)
+{
+  if (!fOutput) {
+    throw cet::exception("HoughClusterIO")
+      << "Cannot open Hough cluster file " << fileName << " for writing\n";
+  }
+  fOutput.write(kMagic, sizeof(kMagic));
+  writeValue(fOutput, kVersion);
+} // cluster::HoughClusterWriter::HoughClusterWriter()
+
+
+//------------------------------------------------------------------------------
+void cluster::HoughClusterWriter::Write(HoughClusterPoints const& cluster)
+{
+  writeValue(fOutput, uint32_t(cluster.dx));
+  writeValue(fOutput, uint32_t(cluster.dy));
+  writeValue(fOutput, uint32_t(cluster.points.size()));
+  for (auto const& point: cluster.points) {
+    writeValue(fOutput, int32_t(point.first));
+    writeValue(fOutput, int32_t(point.second));
+  }
+
+  if (!fOutput) {
+    throw cet::exception("HoughClusterIO")
+      << "Failed writing Hough cluster #" << fNWritten << "\n";
+  }
+  ++fNWritten;
+} // cluster::HoughClusterWriter::Write()
+
+
+//------------------------------------------------------------------------------
+std::vector<cluster::HoughClusterPoints> cluster::ReadHoughClusters
+  (std::string const& fileName, std::size_t maxClusters /* = 0 */)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  if (!input) {
+    throw cet::exception("HoughClusterIO")
+      << "Cannot open Hough cluster file " << fileName << "\n";
+  }
+
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0;
+  if (!input.read(magic, sizeof(magic))
+    || (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    || !readValue(input, version)
+  ) {
+    throw cet::exception("HoughClusterIO")
+      << "File " << fileName << " is not a Hough cluster file\n";
+  }
+  if (version != kVersion) {
+    throw cet::exception("HoughClusterIO")
+      << "File " << fileName << " has format version " << version
+      << ", expected " << kVersion << "\n";
+  }
+
+  std::vector<HoughClusterPoints> clusters;
+  uint32_t sizes[3]; // dx, dy, number of points
+  while (((maxClusters == 0) || (clusters.size() < maxClusters))
+    && readValue(input, sizes[0]))
+  {
+    if (!readValue(input, sizes[1]) || !readValue(input, sizes[2])) {
+      throw cet::exception("HoughClusterIO")
+        << "Truncated cluster in " << fileName << "\n";
+    }
+    clusters.emplace_back();
+    HoughClusterPoints& cluster = clusters.back();
+    cluster.dx = sizes[0];
+    cluster.dy = sizes[1];
+    cluster.points.reserve(sizes[2]);
+    for (uint32_t iPoint = 0; iPoint < sizes[2]; ++iPoint) {
+      int32_t point[2];
+      if (!readValue(input, point)) {
+        throw cet::exception("HoughClusterIO")
+          << "Truncated cluster in " << fileName << "\n";
+      }
+      cluster.points.emplace_back(point[0], point[1]);
+    } // for points
+  } // while
+
+  return clusters;
+} // cluster::ReadHoughClusters()
@@ -0,0 +1,61 @@
+/**
+ * @file   HoughClusterIO.h
+ * @brief  Read and write the points given to the Hough transform to a binary file
+ *
+ * HoughBaseAlg writes the (wire, tick) points of each cluster it transforms
+ * when its ClusterDumpFile parameter is set, so that the transform can be
+ * exercised on recorded clusters outside of art (see
+ * test/RecoAlg/HoughTransform_benchmark.cc).
+ *
+ * File layout (native byte order):
+ *   header:  8 byte magic "LARHOUGH", uint32 format version
+ *   cluster: uint32 plane size in wires (dx) and in ticks (dy),
+ *            uint32 number of points, then int32 wire, tick for each point
+ */
+
+#ifndef HOUGHCLUSTERIO_H
+#define HOUGHCLUSTERIO_H
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <fstream>
+#include <string>
+#include <utility> // std::pair<>
+#include <vector>
+
+
+namespace cluster {
+
+  /// The points of a cluster, as given to HoughTransform::AddPointReturnMax()
+  struct HoughClusterPoints {
+    unsigned int dx = 0; ///< number of wires of the plane
+    unsigned int dy = 0; ///< number of ticks of the plane
+    std::vector<std::pair<int, int>> points; ///< (wire, tick) of each hit
+  }; // HoughClusterPoints
+
+
+  /// Writes clusters to a file
+  class HoughClusterWriter {
+      public:
+    /// Opens the file and writes the header; throws cet::exception on failure
+    explicit HoughClusterWriter(std::string const& fileName);
+
+    /// Writes the points of one cluster
+    void Write(HoughClusterPoints const& cluster);
+
+    /// Number of clusters written so far
+    std::size_t NWritten() const { return fNWritten; }
+
+      private:
+    std::ofstream fOutput;
+    std::size_t fNWritten = 0;
+  }; // class HoughClusterWriter
+
+
+  /// Reads back up to maxClusters clusters (0 for all); throws cet::exception on failure
+  std::vector<HoughClusterPoints> ReadHoughClusters
+    (std::string const& fileName, std::size_t maxClusters = 0);
+
+} // namespace cluster
+
+#endif // HOUGHCLUSTERIO_H
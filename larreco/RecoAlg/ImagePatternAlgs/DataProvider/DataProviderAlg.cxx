@@ -19,9 +19,12 @@ namespace geo { class GeometryCore; }
 
 #include "CLHEP/Random/RandGauss.h"
 
+#include <algorithm>
+
 img::DataProviderAlg::DataProviderAlg(const Config& config) :
 	fCryo(9999), fTPC(9999), fPlane(9999),
 	fNWires(0), fNDrifts(0), fNScaledDrifts(0), fNCachedDrifts(0),
+	fWireStride(0),
 	fDownscaleMode(img::DataProviderAlg::kMax), fDriftWindow(10),
 	fCalorimetryAlg(config.CalorimetryAlg()),
 	fGeometry( &*(art::ServiceHandle<geo::Geometry const>()) ),
@@ -113,12 +116,8 @@ void img::DataProviderAlg::resizeView(size_t wires, size_t drifts)
     fWireChannels.resize(wires);
     std::fill(fWireChannels.begin(), fWireChannels.end(), raw::InvalidChannelID);
 
-    fWireDriftData.resize(wires);
-    for (auto & w : fWireDriftData)
-    {
-    	w.resize(fNCachedDrifts);
-    	std::fill(w.begin(), w.end(), fAdcZero);
-    }
+    fWireStride = (fNCachedDrifts + 15) & ~size_t(15); // full 64-byte lines per wire
+    fWireDriftData.assign(wires * fWireStride, fAdcZero);
 
     fLifetimeCorrFactors.resize(fNDrifts);
     if (fCalibrateLifetime)
@@ -144,14 +143,11 @@ float img::DataProviderAlg::poolMax(int wire, int drift, size_t r) const
     int w0 = wire - rw; if (w0 < 0) { w0 = 0; }
     int w1 = wire + rw; if (w1 >= (int)fNWires) { w1 = fNWires - 1; }
 
-    float adc, max_adc = 0;
+    float max_adc = 0;
     for (int w = w0; w <= w1; ++w)
     {
-        auto const * col = fWireDriftData[w].data();
-        for (int d = d0; d <= d1; ++d)
-        {
-            adc = col[d]; if (adc > max_adc) { max_adc = adc; }
-        }
+        auto const * col = wireRow(w);
+        for (int d = d0; d <= d1; ++d) { max_adc = std::max(max_adc, col[d]); }
     }
 
     return max_adc;
@@ -173,7 +169,7 @@ float img::DataProviderAlg::poolSum(int wire, int drift, size_t r) const
     float sum = 0;
     for (int w = w0; w <= w1; ++w)
     {
-        auto const * col = fWireDriftData[w].data();
+        auto const * col = wireRow(w);
         for (int d = d0; d <= d1; ++d) { sum += col[d]; }
     }
 
@@ -181,84 +177,88 @@ float img::DataProviderAlg::poolSum(int wire, int drift, size_t r) const
 }
 // ------------------------------------------------------
 
-void img::DataProviderAlg::downscaleMax(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const
+void img::DataProviderAlg::correctLifetime(float * adc, size_t size, size_t tick0) const
 {
-        size_t kStop = dst.size();
-        if (adc.size() < kStop) { kStop = adc.size(); }
-	for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow)
-	{
-		size_t k1 = k0 + fDriftWindow;
+    size_t n = 0;
+    if (tick0 < fLifetimeCorrFactors.size()) { n = std::min(size, fLifetimeCorrFactors.size() - tick0); }
 
-		float max_adc = adc[k0] * fLifetimeCorrFactors[k0 + tick0];
-		for (size_t k = k0 + 1; k < k1; ++k)
-		{
-			float ak = adc[k] * fLifetimeCorrFactors[k + tick0];
-			if (ak > max_adc) max_adc = ak;
-		}
+    float const * corr = fLifetimeCorrFactors.data() + tick0;
+    for (size_t k = 0; k < n; ++k) { adc[k] *= corr[k]; }
+
+    std::fill(adc + n, adc + size, 0.0F); // beyond the readout window
+}
+// ------------------------------------------------------
+
+// Downscaling loops run over the output pixels in the inner loop, for each offset in the drift
+// window, so the compiler can vectorize them; the lifetime correction is already applied.
+void img::DataProviderAlg::downscaleMax(float * dst, size_t size, float const * adc, size_t adc_size) const
+{
+	size_t kStop = std::min(size, adc_size / fDriftWindow);
 
-		dst[i] = max_adc;
+	for (size_t i = 0; i < kStop; ++i) { dst[i] = adc[i * fDriftWindow]; }
+	for (size_t k = 1; k < fDriftWindow; ++k)
+	{
+		for (size_t i = 0; i < kStop; ++i) { dst[i] = std::max(dst[i], adc[i * fDriftWindow + k]); }
 	}
-	scaleAdcSamples(dst);
+	scaleAdcSamples(dst, size);
 }
 
-void img::DataProviderAlg::downscaleMaxMean(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const
+void img::DataProviderAlg::downscaleMaxMean(float * dst, size_t size, float const * adc, size_t adc_size) const
 {
-        size_t kStop = dst.size();
-        if (adc.size() < kStop) { kStop = adc.size(); }
+	size_t kStop = std::min(size, adc_size / fDriftWindow);
 	for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow)
 	{
 		size_t k1 = k0 + fDriftWindow;
 
 		size_t max_idx = k0;
-		float max_adc = adc[k0] * fLifetimeCorrFactors[k0 + tick0];
+		float max_adc = adc[k0];
 		for (size_t k = k0 + 1; k < k1; ++k)
 		{
-			float ak = adc[k] * fLifetimeCorrFactors[k + tick0];
-			if (ak > max_adc) { max_adc = ak; max_idx = k; }
+			if (adc[k] > max_adc) { max_adc = adc[k]; max_idx = k; }
 		}
 
 		size_t n = 1;
-		if (max_idx > 0) { max_adc += adc[max_idx - 1] * fLifetimeCorrFactors[max_idx - 1 + tick0]; n++; }
-		if (max_idx + 1 < adc.size()) { max_adc += adc[max_idx + 1] * fLifetimeCorrFactors[max_idx + 1 + tick0]; n++; }
+		if (max_idx > 0) { max_adc += adc[max_idx - 1]; n++; }
+		if (max_idx + 1 < adc_size) { max_adc += adc[max_idx + 1]; n++; }
 
 		dst[i] = max_adc / n;
 	}
-	scaleAdcSamples(dst);
+	scaleAdcSamples(dst, size);
 }
 
-void img::DataProviderAlg::downscaleMean(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const
+void img::DataProviderAlg::downscaleMean(float * dst, size_t size, float const * adc, size_t adc_size) const
 {
-	size_t kStop = dst.size();
-	if (adc.size() < kStop) { kStop = adc.size(); }
-	for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow)
-	{
-		size_t k1 = k0 + fDriftWindow;
+	size_t kStop = std::min(size, adc_size / fDriftWindow);
 
-		float sum_adc = 0;
-		for (size_t k = k0; k < k1; ++k)
-		{
-                  if ( k + tick0 < fLifetimeCorrFactors.size()) sum_adc += adc[k] * fLifetimeCorrFactors[k + tick0];
-		}
-        dst[i] = sum_adc * fDriftWindowInv;
+	std::fill(dst, dst + kStop, 0.0F);
+	for (size_t k = 0; k < fDriftWindow; ++k)
+	{
+		for (size_t i = 0; i < kStop; ++i) { dst[i] += adc[i * fDriftWindow + k]; }
 	}
-	scaleAdcSamples(dst);
+	for (size_t i = 0; i < kStop; ++i) { dst[i] *= fDriftWindowInv; }
+	scaleAdcSamples(dst, size);
 }
 
 bool img::DataProviderAlg::setWireData(std::vector<float> const & adc, size_t wireIdx)
 {
-   	if (wireIdx >= fWireDriftData.size()) return false;
-   	auto & wData = fWireDriftData[wireIdx];
+   	if (wireIdx >= fNWires) return false;
+   	auto * wData = wireRow(wireIdx);
 
     if (fDownscaleFullView)
     {
-        if (!adc.empty()) { downscale(wData, adc, 0); }
+        if (!adc.empty())
+        {
+            fAdcBuffer.assign(adc.begin(), adc.end());
+            correctLifetime(fAdcBuffer.data(), fAdcBuffer.size(), 0);
+            downscale(wData, fNCachedDrifts, fAdcBuffer.data(), fAdcBuffer.size());
+        }
         else { return false; }
     }
     else
     {
         if (adc.empty()) { return false; }
-        else if (adc.size() <= wData.size()) { std::copy(adc.begin(), adc.end(), wData.begin()); }
-        else { std::copy(adc.begin(), adc.begin()+wData.size(), wData.begin()); }
+        else if (adc.size() <= fNCachedDrifts) { std::copy(adc.begin(), adc.end(), wData); }
+        else { std::copy(adc.begin(), adc.begin() + fNCachedDrifts, wData); }
     }
     return true;
 }
@@ -266,6 +266,15 @@ bool img::DataProviderAlg::setWireData(std::vector<float> const & adc, size_t wi
 
 bool img::DataProviderAlg::setWireDriftData(const std::vector<recob::Wire> & wires,
 	unsigned int plane, unsigned int tpc, unsigned int cryo)
+{
+    return setWireDriftData(wires, plane, tpc, cryo,
+        art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider());
+}
+// ------------------------------------------------------
+
+bool img::DataProviderAlg::setWireDriftData(const std::vector<recob::Wire> & wires,
+	unsigned int plane, unsigned int tpc, unsigned int cryo,
+	const lariov::ChannelStatusProvider & channelStatus)
 {
     mf::LogInfo("DataProviderAlg") << "Create image for cryo:"
         << cryo << " tpc:" << tpc << " plane:" << plane;
@@ -280,8 +289,6 @@ bool img::DataProviderAlg::setWireDriftData(const std::vector<recob::Wire> & wir
 
 	resizeView(nwires, ndrifts);
 
-    auto const & channelStatus = art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
-
     bool allWrong = true;
     for (auto const & wire : wires)
 	{
@@ -340,37 +347,17 @@ float img::DataProviderAlg::scaleAdcSample(float val) const
     return fAdcOffset + fAdcScale * (val - fAdcMin);  // shift and scale to the output range, shift to the output min
 }
 // ------------------------------------------------------
-void img::DataProviderAlg::scaleAdcSamples(std::vector< float > & values) const
+void img::DataProviderAlg::scaleAdcSamples(float * values, size_t size) const
 {
     float calib = fAmplCalibConst[fPlane];
-    auto * data = values.data();
+    float adcMin = fAdcMin, adcMax = fAdcMax, offset = fAdcOffset, scale = fAdcScale;
 
-    size_t k = 0, size4 = values.size() >> 2, size = values.size();
-    for (size_t i = 0; i < size4; ++i) // vectorize if you can
+    for (size_t k = 0; k < size; ++k) // branchless, vectorized by the compiler
     {
-        data[k] *= calib;  // prescale by plane-to-plane calibration factors
-        data[k+1] *= calib;
-        data[k+2] *= calib;
-        data[k+3] *= calib;
-
-        if (data[k] < fAdcMin) { data[k] = fAdcMin; }  // saturate min
-        if (data[k+1] < fAdcMin) { data[k+1] = fAdcMin; }
-        if (data[k+2] < fAdcMin) { data[k+2] = fAdcMin; }
-        if (data[k+3] < fAdcMin) { data[k+3] = fAdcMin; }
-
-        if (data[k] > fAdcMax) { data[k] = fAdcMax; }  // saturate max
-        if (data[k+1] > fAdcMax) { data[k+1] = fAdcMax; }
-        if (data[k+2] > fAdcMax) { data[k+2] = fAdcMax; }
-        if (data[k+3] > fAdcMax) { data[k+3] = fAdcMax; }
-
-        data[k] = fAdcOffset + fAdcScale * (data[k] - fAdcMin);  // shift and scale to the output range, shift to the output min
-        data[k+1] = fAdcOffset + fAdcScale * (data[k+1] - fAdcMin);
-        data[k+2] = fAdcOffset + fAdcScale * (data[k+2] - fAdcMin);
-        data[k+3] = fAdcOffset + fAdcScale * (data[k+3] - fAdcMin);
-
-        k += 4;
+        float v = values[k] * calib;                      // prescale by plane-to-plane calibration factors
+        v = std::min(std::max(v, adcMin), adcMax);        // saturate
+        values[k] = offset + scale * (v - adcMin);        // shift and scale to the output range, shift to the output min
     }
-    while (k < size) { data[k] = scaleAdcSample(data[k]); ++k; }  // do the tail
 }
 // ------------------------------------------------------
 
@@ -379,25 +366,59 @@ void img::DataProviderAlg::applyBlur()
     if (fBlurKernel.size() < 2) return;
 
     size_t margin_left = (fBlurKernel.size()-1) >> 1, margin_right = fBlurKernel.size() - margin_left - 1;
+    if (fNWires < fBlurKernel.size()) return;
 
-    std::vector< std::vector<float> > src(fWireDriftData.size());
-    for (size_t w = 0; w < fWireDriftData.size(); ++w) { src[w] = fWireDriftData[w]; }
+    auto const src(fWireDriftData);
 
-    for (size_t w = margin_left; w < fWireDriftData.size() - margin_right; ++w)
+    // weighted sum of whole neighbouring wires, contiguous along the drift
+    for (size_t w = margin_left; w < fNWires - margin_right; ++w)
     {
-        for (size_t d = 0; d < fWireDriftData[w].size(); ++d)
+        float * dst = wireRow(w);
+        std::fill(dst, dst + fNCachedDrifts, 0.0F);
+        for (size_t i = 0; i < fBlurKernel.size(); ++i)
         {
-            float sum = 0;
-            for (size_t i = 0; i < fBlurKernel.size(); ++i)
-            {
-                sum += fBlurKernel[i] * src[w + i - margin_left][d];
-            }
-            fWireDriftData[w][d] = sum;
+            float k = fBlurKernel[i];
+            float const * s = src.data() + (w + i - margin_left) * fWireStride;
+            for (size_t d = 0; d < fNCachedDrifts; ++d) { dst[d] += k * s[d]; }
         }
     }
 }
 // ------------------------------------------------------
 
+void img::DataProviderAlg::downsampledPatchRow(float * dst, int w, int d0, int d1) const
+{
+	int c0 = std::max(d0, 0), c1 = std::min(d1, (int)fNCachedDrifts); // drifts inside the view
+	if ((w >= 0) && (w < (int)fNWires) && (c0 < c1))
+	{
+		// copy the part inside the view in one go, pad the rest
+		std::fill(dst, dst + (c0 - d0), fAdcZero);
+		std::copy(wireRow(w) + c0, wireRow(w) + c1, dst + (c0 - d0));
+		std::fill(dst + (c1 - d0), dst + (d1 - d0), fAdcZero);
+	}
+	else
+	{
+		std::fill(dst, dst + (d1 - d0), fAdcZero);
+	}
+}
+
+void img::DataProviderAlg::originalPatchRow(float * dst, size_t size_d, int w, int d0, int d1, std::vector<float> & tmp) const
+{
+	int c0 = std::max(d0, 0), c1 = std::min(d1, (int)fNCachedDrifts);
+	if ((w >= 0) && (w < (int)fNWires) && (c0 < c1))
+	{
+		std::fill(tmp.begin(), tmp.begin() + (c0 - d0), fAdcZero);
+		std::copy(wireRow(w) + c0, wireRow(w) + c1, tmp.begin() + (c0 - d0));
+		std::fill(tmp.begin() + (c1 - d0), tmp.begin() + (d1 - d0), fAdcZero);
+	}
+	else
+	{
+		std::fill(tmp.begin(), tmp.end(), fAdcZero);
+	}
+
+	correctLifetime(tmp.data(), d1 - d0, d0);
+	downscale(dst, size_d, tmp.data(), tmp.size());
+}
+
 // MUST give the same result as get_patch() in scripts/utils.py
 bool img::DataProviderAlg::patchFromDownsampledView(size_t wire, float drift, size_t size_w, size_t size_d,
 	std::vector< std::vector<float> > & patch) const
@@ -412,30 +433,30 @@ bool img::DataProviderAlg::patchFromDownsampledView(size_t wire, float drift, si
 	int d0 = sd - halfSizeD;
 	int d1 = sd + halfSizeD;
 
-	int wsize = fWireDriftData.size();
 	for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch)
 	{
-		auto & dst = patch[wpatch];
-		if ((w >= 0) && (w < wsize))
-		{
-			auto & src = fWireDriftData[w];
-			int dsize = src.size();
-			for (int d = d0, dpatch = 0; d < d1; ++d, ++dpatch)
-			{
-				if ((d >= 0) && (d < dsize))
-				{
-					dst[dpatch] = src[d];
-				}
-				else
-				{
-					dst[dpatch] = fAdcZero;
-				}
-			}
-		}
-		else
-		{
-			std::fill(dst.begin(), dst.end(), fAdcZero);
-		}
+		downsampledPatchRow(patch[wpatch].data(), w, d0, d1);
+	}
+
+	return true;
+}
+
+bool img::DataProviderAlg::patchFromDownsampledView(size_t wire, float drift, size_t size_w, size_t size_d,
+	float * patch) const
+{
+	int halfSizeW = size_w / 2;
+	int halfSizeD = size_d / 2;
+
+	int w0 = wire - halfSizeW;
+	int w1 = wire + halfSizeW;
+
+	size_t sd = (size_t)(drift / fDriftWindow);
+	int d0 = sd - halfSizeD;
+	int d1 = sd + halfSizeD;
+
+	for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch)
+	{
+		downsampledPatchRow(patch + wpatch * size_d, w, d0, d1);
 	}
 
 	return true;
@@ -457,31 +478,33 @@ bool img::DataProviderAlg::patchFromOriginalView(size_t wire, float drift, size_
         if (d0<0) d0 = 0;
 
 	std::vector<float> tmp(dsize);
-	int wsize = fWireDriftData.size();
 	for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch)
 	{
-		if ((w >= 0) && (w < wsize))
-		{
-			auto & src = fWireDriftData[w];
-			int src_size = src.size();
-			for (int d = d0, dpatch = 0; d < d1; ++d, ++dpatch)
-			{
-				if ((d >= 0) && (d < src_size))
-				{
-					tmp[dpatch] = src[d];
-				}
-				else
-				{
-					tmp[dpatch] = fAdcZero;
-				}
-			}
-		}
-		else
-		{
-			std::fill(tmp.begin(), tmp.end(), fAdcZero);
-		}
+		originalPatchRow(patch[wpatch].data(), patch[wpatch].size(), w, d0, d1, tmp);
+	}
+
+	return true;
+}
+
+bool img::DataProviderAlg::patchFromOriginalView(size_t wire, float drift, size_t size_w, size_t size_d,
+	float * patch) const
+{
+	int dsize = fDriftWindow * size_d;
+	int halfSizeW = size_w / 2;
+	int halfSizeD = dsize / 2;
 
-		downscale(patch[wpatch], tmp, d0);
+	int w0 = wire - halfSizeW;
+	int w1 = wire + halfSizeW;
+
+	int d0 = int(drift) - halfSizeD;
+	int d1 = int(drift) + halfSizeD;
+
+        if (d0<0) d0 = 0;
+
+	std::vector<float> tmp(dsize);
+	for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch)
+	{
+		originalPatchRow(patch + wpatch * size_d, size_d, w, d0, d1, tmp);
 	}
 
 	return true;
@@ -497,10 +520,12 @@ void img::DataProviderAlg::addWhiteNoise()
 
     CLHEP::RandGauss gauss(fRndEngine);
     std::vector<double> noise(fNCachedDrifts);
-    for (auto & wire : fWireDriftData)
+    for (size_t w = 0; w < fNWires; ++w)
     {
         gauss.fireArray(fNCachedDrifts, noise.data(), 0., effectiveSigma);
-        for (size_t d = 0; d < wire.size(); ++d)
+
+        float * wire = wireRow(w);
+        for (size_t d = 0; d < fNCachedDrifts; ++d)
         {
             wire[d] += noise[d];
         }
@@ -516,14 +541,14 @@ void img::DataProviderAlg::addCoherentNoise()
     if (fDownscaleFullView) effectiveSigma /= fDriftWindow;
 
     CLHEP::RandGauss gauss(fRndEngine);
-    std::vector<double> amps1(fWireDriftData.size());
-    std::vector<double> amps2(1 + (fWireDriftData.size() / 32));
+    std::vector<double> amps1(fNWires);
+    std::vector<double> amps2(1 + (fNWires / 32));
     gauss.fireArray(amps1.size(), amps1.data(), 1., 0.1); // 10% wire-wire ampl. variation
     gauss.fireArray(amps2.size(), amps2.data(), 1., 0.1); // 10% group-group ampl. variation
 
     double group_amp = 1.0;
     std::vector<double> noise(fNCachedDrifts);
-    for (size_t w = 0; w < fWireDriftData.size(); ++w)
+    for (size_t w = 0; w < fNWires; ++w)
     {
         if ((w & 31) == 0)
         {
@@ -531,10 +556,11 @@ void img::DataProviderAlg::addCoherentNoise()
             gauss.fireArray(fNCachedDrifts, noise.data(), 0., effectiveSigma);
         } // every 32 wires
 
-        auto & wire = fWireDriftData[w];
-        for (size_t d = 0; d < wire.size(); ++d)
+        double amp = group_amp * amps1[w];
+        float * wire = wireRow(w);
+        for (size_t d = 0; d < fNCachedDrifts; ++d)
         {
-            wire[d] += group_amp * amps1[w] * noise[d];
+            wire[d] += amp * noise[d];
         }
     }
 }
@@ -23,6 +23,7 @@
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataobj/RecoBase/Wire.h"
 #include "larreco/Calorimetry/CalorimetryAlg.h"
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_aligned_allocator.h" // header only
 
 #include "CLHEP/Random/JamesRandom.h" // for testing on noise, not used by any reco
 
@@ -30,6 +31,8 @@
 #include <memory>
 //#include <functional>
 
+namespace lariov { class ChannelStatusProvider; }
+
 namespace img
 {
     class DataProviderAlg;
@@ -38,7 +41,9 @@ namespace img
 /// Base class providing data for training / running image based classifiers. It can be used
 /// also for any other algorithms where 2D projection image is useful. Currently the image
 /// is 32-bit fp / pixel, as sson as have time will template it so e.g. byte pixels would
-/// be possible.
+/// be possible. The image is kept in one contiguous buffer, wire after wire, with the wire
+/// stride padded to a multiple of 16 pixels (64 bytes); the buffer is 64-byte aligned, so every
+/// wire starts on a cache line.
 class img::DataProviderAlg
 {
 public:
@@ -102,7 +107,14 @@ public:
 	bool setWireDriftData(const std::vector<recob::Wire> & wires, // once per plane: setup ADC buffer, collect & downscale ADC's
 		unsigned int plane, unsigned int tpc, unsigned int cryo);
 
-	std::vector<float> const & wireData(size_t widx) const { return fWireDriftData[widx]; }
+	/// as above, with the channel status provider taken by the caller: it can be used on threads
+	/// other than the module one, where the services should not be accessed
+	bool setWireDriftData(const std::vector<recob::Wire> & wires,
+		unsigned int plane, unsigned int tpc, unsigned int cryo,
+		const lariov::ChannelStatusProvider & channelStatus);
+
+	/// ADC data of the wire, NCachedDrifts() values
+	float const * wireData(size_t widx) const { return wireRow(widx); }
 
 	/// Return patch of data centered on the wire and drift, witht the size in (downscaled) pixels givent
 	/// with patchSizeW and patchSizeD.  Pad with the zero-level calue if patch extends beyond the event
@@ -110,7 +122,7 @@ public:
 	std::vector< std::vector<float> > getPatch(size_t wire, float drift, size_t patchSizeW, size_t patchSizeD) const
 	{
 		bool ok = false;
-		std::vector< std::vector<float> > patch;
+		std::vector< std::vector<float> > patch(patchSizeW, std::vector<float>(patchSizeD));
 		if (fDownscaleFullView)
 		{
 			ok = patchFromDownsampledView(wire, drift, patchSizeW, patchSizeD, patch);
@@ -127,16 +139,24 @@ public:
 		}
 	}
 
+	/// Fill the patch centered on the wire and drift into the caller-owned buffer of patchSizeW x patchSizeD
+	/// values (wire after wire), e.g. one sample of a contiguous batch of patches. Pad as getPatch().
+	bool getPatch(size_t wire, float drift, size_t patchSizeW, size_t patchSizeD, float * patch) const
+	{
+		if (fDownscaleFullView) { return patchFromDownsampledView(wire, drift, patchSizeW, patchSizeD, patch); }
+		else { return patchFromOriginalView(wire, drift, patchSizeW, patchSizeD, patch); }
+	}
+
     /// Return value from the ADC buffer, or zero if coordinates are out of the view;
     /// will scale the drift according to the downscale settings.
     float getPixelOrZero(int wire, int drift) const
     {
         size_t didx = getDriftIndex(drift), widx = (size_t)wire;
 
-        if ((widx < fWireDriftData.size()) &&
+        if ((widx < fNWires) &&
             (didx < fNCachedDrifts))
         {
-            return fWireDriftData[widx][didx];
+            return wireRow(widx)[didx];
         }
         else { return 0; }
     }
@@ -169,7 +189,8 @@ protected:
 	unsigned int fNWires, fNDrifts, fNScaledDrifts, fNCachedDrifts;
 
 	std::vector< raw::ChannelID_t > fWireChannels;              // wire channels (may need this connection...), InvalidChannelID if not used
-	std::vector< std::vector<float> > fWireDriftData;           // 2D data for entire projection, drifts scaled down
+	std::vector< float, keras::AlignedAllocator<float> > fWireDriftData; // 2D data for entire projection, drifts scaled down, wire after wire
+	size_t fWireStride;                                         // distance between wires in fWireDriftData, >= fNCachedDrifts
 	std::vector<float> fLifetimeCorrFactors;                    // precalculated correction factors along full drift
 
    	EDownscaleMode fDownscaleMode;
@@ -179,16 +200,23 @@ protected:
 	bool fDownscaleFullView;
 	float fDriftWindowInv;
 
-	void downscaleMax(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const;
-	void downscaleMaxMean(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const;
-	void downscaleMean(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const;
-	void downscale(std::vector<float> & dst, std::vector<float> const & adc, size_t tick0) const
+	float * wireRow(size_t widx) { return fWireDriftData.data() + widx * fWireStride; }
+	float const * wireRow(size_t widx) const { return fWireDriftData.data() + widx * fWireStride; }
+
+	/// multiply adc samples starting at tick0 by the electron lifetime correction, in place
+	void correctLifetime(float * adc, size_t size, size_t tick0) const;
+
+	// downscale lifetime corrected adc into size pixels of dst
+	void downscaleMax(float * dst, size_t size, float const * adc, size_t adc_size) const;
+	void downscaleMaxMean(float * dst, size_t size, float const * adc, size_t adc_size) const;
+	void downscaleMean(float * dst, size_t size, float const * adc, size_t adc_size) const;
+	void downscale(float * dst, size_t size, float const * adc, size_t adc_size) const
 	{
 	    switch (fDownscaleMode)
 	    {
-	        case img::DataProviderAlg::kMean: downscaleMean(dst, adc, tick0); break;
-	        case img::DataProviderAlg::kMaxMean: downscaleMaxMean(dst, adc, tick0); break;
-	        case img::DataProviderAlg::kMax: downscaleMax(dst, adc, tick0); break;
+	        case img::DataProviderAlg::kMean: downscaleMean(dst, size, adc, adc_size); break;
+	        case img::DataProviderAlg::kMaxMean: downscaleMaxMean(dst, size, adc, adc_size); break;
+	        case img::DataProviderAlg::kMax: downscaleMax(dst, size, adc, adc_size); break;
 	        default:throw cet::exception("img::DataProviderAlg") << "Downscale mode not supported." << std::endl; break;
 	    }
 	}
@@ -204,6 +232,10 @@ protected:
 	bool patchFromDownsampledView(size_t wire, float drift, size_t size_w, size_t size_d, std::vector< std::vector<float> > & patch) const;
 	bool patchFromOriginalView(size_t wire, float drift, size_t size_w, size_t size_d, std::vector< std::vector<float> > & patch) const;
 
+	// the same into a contiguous buffer of size_w x size_d values
+	bool patchFromDownsampledView(size_t wire, float drift, size_t size_w, size_t size_d, float * patch) const;
+	bool patchFromOriginalView(size_t wire, float drift, size_t size_w, size_t size_d, float * patch) const;
+
 	virtual void resizeView(size_t wires, size_t drifts);
 
 	// Calorimetry needed to equalize ADC amplitude along drift:
@@ -215,7 +247,13 @@ protected:
 
 private:
     float scaleAdcSample(float val) const;
-    void scaleAdcSamples(std::vector< float > & values) const;
+    void scaleAdcSamples(float * values, size_t size) const;
+
+    // one wire of a patch, drifts [d0, d1) of the view, padded with the zero level
+    void downsampledPatchRow(float * dst, int w, int d0, int d1) const;
+    void originalPatchRow(float * dst, size_t size_d, int w, int d0, int d1, std::vector<float> & tmp) const;
+
+    std::vector<float> fAdcBuffer;  // lifetime corrected ADC of the wire being downscaled
     std::vector<float> fAmplCalibConst;
     bool fCalibrateAmpl, fCalibrateLifetime;
 
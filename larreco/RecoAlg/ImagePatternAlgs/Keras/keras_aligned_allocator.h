@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Class:       AlignedAllocator
+//
+//
+// Allocator of cache line (64-byte) aligned memory for std::vector, used for the tensors of
+// FlatKerasModel and the image buffer of img::DataProviderAlg. Header only.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef KERAS_ALIGNED_ALLOCATOR__H
+#define KERAS_ALIGNED_ALLOCATOR__H
+
+#include <cstddef>
+#include <new>
+
+namespace keras
+{
+	template <typename T> class AlignedAllocator;
+}
+
+/// Allocator of cache line aligned memory, so the tensor rows start on a SIMD boundary.
+template <typename T>
+class keras::AlignedAllocator {
+public:
+  using value_type = T;
+  static constexpr std::size_t alignment = 64;
+
+  AlignedAllocator(void) noexcept { }
+  template <typename U> AlignedAllocator(const AlignedAllocator<U> &) noexcept { }
+
+  T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment))); }
+  void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, std::align_val_t(alignment)); }
+
+  template <typename U> bool operator==(const AlignedAllocator<U> &) const noexcept { return true; }
+  template <typename U> bool operator!=(const AlignedAllocator<U> &) const noexcept { return false; }
+};
+
+#endif
@@ -0,0 +1,593 @@
+#include "keras_flat_model.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <math.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+namespace {
+  const char binary_magic[8] = { 'K', 'E', 'R', 'A', 'S', 'B', 'I', 'N' };
+  const uint32_t binary_version = 1;
+  const uint32_t binary_byte_order = 0x01020304;
+  const size_t binary_alignment = 64;
+
+  size_t align_offset(size_t offset) { return (offset + binary_alignment - 1) / binary_alignment * binary_alignment; }
+
+  /// true if the patch has rows rows of cols values
+  bool is_rectangular(std::vector< std::vector<float> > const & patch, size_t rows, size_t cols) {
+    if (patch.size() != rows) { return false; }
+    for(auto const & row : patch) { if (row.size() != cols) { return false; } }
+    return true;
+  }
+
+  /// true if cnt floats from offset are within the file, without overflowing
+  bool in_file(uint64_t offset, uint64_t cnt, size_t size) {
+    return (offset <= size) && (cnt <= (size - offset) / sizeof(float));
+  }
+
+  /// unmaps the file unless released, so that a refused file is not left mapped
+  struct MappingGuard {
+    void *addr = nullptr;
+    size_t size = 0;
+    ~MappingGuard() { if (addr) { munmap(addr, size); } }
+    void *release() { void *a = addr; addr = nullptr; return a; }
+  };
+}
+
+
+keras::FlatKerasModel::FlatKerasModel(const string &input_fname, bool map_file) :
+  m_flat_output(false),
+  m_plan_rows(0), m_plan_cols(0), m_plan_samples(0),
+  m_mapped(nullptr), m_mapped_size(0),
+  m_input_depth(1), m_output_length(0)
+{
+  if (is_binary(input_fname)) { load_binary(input_fname, map_file); }
+  else { load_weights(input_fname); }
+}
+
+keras::FlatKerasModel::~FlatKerasModel() {
+  if (m_mapped) { munmap(m_mapped, m_mapped_size); }
+}
+
+bool keras::FlatKerasModel::is_binary(const string &fname) {
+  char magic[sizeof(binary_magic)] = { 0 };
+  ifstream fin(fname.c_str(), ios::binary);
+  fin.read(magic, sizeof(magic));
+  return fin && (memcmp(magic, binary_magic, sizeof(magic)) == 0);
+}
+
+// Weights are read with the layer parsers of KerasModel, so both engines accept exactly
+// the same files, and then rearranged into the flat layouts.
+void keras::FlatKerasModel::load_weights(const string &input_fname) {
+  cout << "Reading model from " << input_fname << endl;
+  ifstream fin(input_fname.c_str());
+  if (!fin) { throw runtime_error("Cannot open Keras model file " + input_fname); }
+
+  string layer_type = "";
+  string tmp_str = "";
+  int tmp_int = 0;
+  int layers_cnt = 0;
+
+  fin >> tmp_str >> layers_cnt;
+  cout << "Layers " << layers_cnt << endl;
+
+  for(int layer = 0; layer < layers_cnt; ++layer) { // iterate over layers
+    fin >> tmp_str >> tmp_int >> layer_type;
+    cout << "Layer " << tmp_int << " " << layer_type << endl;
+
+    if(layer_type == "Convolution2D") {
+      keras::LayerConv2D src;
+      src.load_weights(fin);
+
+      FlatLayer l;
+      l.op = Op::Conv2D;
+      l.k_cnt = src.m_kernels_cnt; l.k_depth = src.m_depth;
+      l.k_rows = src.m_rows; l.k_cols = src.m_cols;
+      if (src.m_border_mode == "same") {
+        l.same = true;
+        l.pad_rows = (l.k_rows - 1) >> 1;
+        l.pad_cols = (l.k_cols - 1) >> 1;
+      }
+
+      // flip kernels, as conv_single_depth_* apply them, and make kernel index the fastest
+      l.weights.resize(l.k_rows * l.k_cols * l.k_depth * l.k_cnt);
+      for(size_t k1 = 0, i = 0; k1 < l.k_rows; ++k1) {
+        for(size_t k2 = 0; k2 < l.k_cols; ++k2) {
+          for(size_t m = 0; m < l.k_depth; ++m) {
+            for(size_t k = 0; k < l.k_cnt; ++k, ++i) {
+              l.weights[i] = src.m_kernels[k][m][l.k_rows - k1 - 1][l.k_cols - k2 - 1];
+            }
+          }
+        }
+      }
+      l.bias.assign(src.m_bias.begin(), src.m_bias.end());
+
+      if (m_layers.empty()) { m_input_depth = l.k_depth; }
+      m_layers.push_back(std::move(l));
+    } else if(layer_type == "Activation") {
+      keras::LayerActivation src;
+      src.load_weights(fin);
+      add_activation(src.m_activation_type);
+    } else if(layer_type == "MaxPooling2D") {
+      keras::LayerMaxPooling src;
+      src.load_weights(fin);
+
+      FlatLayer l;
+      l.op = Op::MaxPooling;
+      l.pool_rows = src.m_pool_x; l.pool_cols = src.m_pool_y;
+      m_layers.push_back(std::move(l));
+    } else if(layer_type == "Flatten") {
+      FlatLayer l;
+      l.op = Op::Flatten;
+      m_layers.push_back(std::move(l));
+      m_flat_output = true;
+    } else if(layer_type == "Dense") {
+      keras::LayerDense src;
+      src.load_weights(fin);
+
+      FlatLayer l;
+      l.op = Op::Dense;
+      l.k_depth = src.m_input_cnt; l.k_cnt = src.m_neurons;
+      l.weights.resize(l.k_depth * l.k_cnt);
+      for(size_t j = 0; j < l.k_depth; ++j) {
+        std::copy(src.m_weights[j].begin(), src.m_weights[j].end(), l.weights.begin() + j * l.k_cnt);
+      }
+      l.bias.assign(src.m_bias.begin(), src.m_bias.end());
+
+      m_output_length = l.k_cnt;
+      m_layers.push_back(std::move(l));
+      m_flat_output = true;
+    } else if(layer_type == "Dropout") {
+      continue; // we dont need dropout layer in prediciton mode
+    } else {
+      throw runtime_error("Layer " + layer_type + " is not supported, cannot define network.");
+    }
+  }
+
+  fin.close();
+
+  if (m_layers.empty()) { throw runtime_error("No layers read from " + input_fname); }
+
+  for(auto & l : m_layers) {
+    l.w = l.weights.data(); l.w_cnt = l.weights.size();
+    l.b = l.bias.data(); l.b_cnt = l.bias.size();
+  }
+}
+
+// The file is taken in one piece, with a single read or mmap, and the layers point to
+// their weights inside it: there is nothing to parse or rearrange.
+void keras::FlatKerasModel::load_binary(const string &input_fname, bool map_file) {
+  cout << "Reading binary model from " << input_fname << (map_file ? " (mapped)" : "") << endl;
+
+  int fd = open(input_fname.c_str(), O_RDONLY);
+  struct stat st;
+  if ((fd < 0) || (fstat(fd, &st) != 0)) {
+    if (fd >= 0) close(fd);
+    throw runtime_error("Cannot open Keras model file " + input_fname);
+  }
+  size_t size = st.st_size;
+
+  const char *data = nullptr;
+  MappingGuard mapping;
+  if (map_file) {
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) { close(fd); throw runtime_error("Cannot map Keras model file " + input_fname); }
+    mapping.addr = addr; mapping.size = size;
+    madvise(addr, size, MADV_WILLNEED);
+    data = static_cast<const char*>(addr);
+  }
+  else {
+    m_file_data.resize((size + sizeof(float) - 1) / sizeof(float));
+    char *dst = reinterpret_cast<char*>(m_file_data.data());
+    size_t done = 0;
+    while (done < size) {
+      ssize_t n = read(fd, dst + done, size - done);
+      if (n <= 0) { close(fd); throw runtime_error("Cannot read Keras model file " + input_fname); }
+      done += n;
+    }
+    data = dst;
+  }
+  close(fd);
+
+  BinaryHeader header;
+  if (size < sizeof(header)) { throw runtime_error("Keras model file " + input_fname + " is truncated."); }
+  memcpy(&header, data, sizeof(header));
+  if ((header.version != binary_version) || (header.byte_order != binary_byte_order)) {
+    throw runtime_error("Keras model file " + input_fname + " has unsupported version or byte order.");
+  }
+  if (header.layers_cnt > (size - sizeof(header)) / sizeof(LayerRecord)) {
+    throw runtime_error("Keras model file " + input_fname + " is truncated.");
+  }
+  m_input_depth = header.input_depth;
+
+  const LayerRecord *records = reinterpret_cast<const LayerRecord*>(data + sizeof(header));
+  for(size_t i = 0; i < header.layers_cnt; ++i) {
+    LayerRecord const & r = records[i];
+
+    FlatLayer l;
+    l.op = static_cast<Op>(r.op); l.act = static_cast<Act>(r.act);
+    l.k_rows = r.k_rows; l.k_cols = r.k_cols; l.k_depth = r.k_depth; l.k_cnt = r.k_cnt;
+    l.same = r.same; l.pad_rows = r.pad_rows; l.pad_cols = r.pad_cols;
+    l.pool_rows = r.pool_rows; l.pool_cols = r.pool_cols;
+
+    size_t expected_w = 0, expected_b = 0;
+    if (l.op == Op::Conv2D) { expected_w = l.k_rows * l.k_cols * l.k_depth * l.k_cnt; expected_b = l.k_cnt; }
+    else if (l.op == Op::Dense) { expected_w = l.k_depth * l.k_cnt; expected_b = l.k_cnt; }
+
+    if ((r.op > uint32_t(Op::Activation)) || (r.act > uint32_t(Act::Softmax)) ||
+        (r.w_cnt != expected_w) || (r.b_cnt != expected_b) ||
+        (r.w_offset % binary_alignment) || (r.b_offset % binary_alignment) ||
+        !in_file(r.w_offset, r.w_cnt, size) || !in_file(r.b_offset, r.b_cnt, size) ||
+        ((l.op == Op::MaxPooling) && ((r.pool_rows == 0) || (r.pool_cols == 0)))) {
+      throw runtime_error("Keras model file " + input_fname + " has a corrupted layer record.");
+    }
+    l.w = reinterpret_cast<const float*>(data + r.w_offset); l.w_cnt = r.w_cnt;
+    l.b = reinterpret_cast<const float*>(data + r.b_offset); l.b_cnt = r.b_cnt;
+
+    if (l.op == Op::Dense) { m_output_length = l.k_cnt; }
+    m_layers.push_back(std::move(l));
+  }
+  cout << "Layers " << m_layers.size() << endl;
+
+  if (m_layers.empty()) { throw runtime_error("No layers read from " + input_fname); }
+
+  m_mapped_size = mapping.size;
+  m_mapped = mapping.release();
+}
+
+void keras::FlatKerasModel::save_binary(const string &output_fname) const {
+  BinaryHeader header;
+  memcpy(header.magic, binary_magic, sizeof(binary_magic));
+  header.version = binary_version;
+  header.byte_order = binary_byte_order;
+  header.layers_cnt = m_layers.size();
+  header.input_depth = m_input_depth;
+
+  std::vector<LayerRecord> records;
+  size_t offset = align_offset(sizeof(header) + m_layers.size() * sizeof(LayerRecord));
+  for(auto const & l : m_layers) {
+    LayerRecord r;
+    memset(&r, 0, sizeof(r));
+    r.op = uint32_t(l.op); r.act = uint32_t(l.act);
+    r.k_rows = l.k_rows; r.k_cols = l.k_cols; r.k_depth = l.k_depth; r.k_cnt = l.k_cnt;
+    r.same = l.same; r.pad_rows = l.pad_rows; r.pad_cols = l.pad_cols;
+    r.pool_rows = l.pool_rows; r.pool_cols = l.pool_cols;
+    r.w_offset = offset; r.w_cnt = l.w_cnt;
+    offset = align_offset(offset + l.w_cnt * sizeof(float));
+    r.b_offset = offset; r.b_cnt = l.b_cnt;
+    offset = align_offset(offset + l.b_cnt * sizeof(float));
+    records.push_back(r);
+  }
+
+  ofstream fout(output_fname.c_str(), ios::binary);
+  const char zeros[binary_alignment] = { 0 };
+  auto pad_to = [&](size_t pos) { fout.write(zeros, pos - fout.tellp()); };
+
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  fout.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(LayerRecord));
+  for(size_t i = 0; i < m_layers.size(); ++i) {
+    pad_to(records[i].w_offset);
+    fout.write(reinterpret_cast<const char*>(m_layers[i].w), m_layers[i].w_cnt * sizeof(float));
+    pad_to(records[i].b_offset);
+    fout.write(reinterpret_cast<const char*>(m_layers[i].b), m_layers[i].b_cnt * sizeof(float));
+  }
+  pad_to(offset);
+
+  if (!fout) { throw runtime_error("Cannot write Keras model file " + output_fname); }
+}
+
+void keras::FlatKerasModel::add_activation(const string &type) {
+  Act act = Act::None;
+  if (type == "relu") act = Act::Relu;
+  else if (type == "tanh") act = Act::Tanh;
+  else if (m_flat_output && (type == "sigmoid")) act = Act::Sigmoid;
+  else if (m_flat_output && (type == "softmax")) act = Act::Softmax;
+  else keras::missing_activation_impl(type); // same set of activations as LayerActivation
+
+  if (!m_layers.empty() && (m_layers.back().act == Act::None) &&
+      ((m_layers.back().op == Op::Conv2D) || (m_layers.back().op == Op::Dense))) {
+    m_layers.back().act = act; // fused
+  }
+  else {
+    FlatLayer l;
+    l.op = Op::Activation;
+    l.act = act;
+    m_layers.push_back(std::move(l));
+  }
+}
+
+void keras::FlatKerasModel::plan(size_t rows, size_t cols, size_t samples) {
+  if ((rows == m_plan_rows) && (cols == m_plan_cols) && (samples <= m_plan_samples)) return;
+
+  Shape s = { rows, cols, m_input_depth };
+  size_t max_size = 0;
+
+  std::vector<Shape> shapes; // the plan in use is kept if the input does not fit the model
+  shapes.push_back(s);
+  for(auto const & l : m_layers) {
+    switch (l.op) {
+      case Op::Conv2D:
+        if ((s.depth != l.k_depth) || (!l.same && ((s.rows < l.k_rows) || (s.cols < l.k_cols)))) {
+          throw runtime_error("Conv2D input does not match the kernel size.");
+        }
+        if (!l.same) { s.rows -= l.k_rows - 1; s.cols -= l.k_cols - 1; }
+        s.depth = l.k_cnt;
+        break;
+      case Op::MaxPooling:
+        s.rows /= l.pool_rows; s.cols /= l.pool_cols;
+        break;
+      case Op::Flatten:
+        s = { 1, 1, s.size() };
+        break;
+      case Op::Dense:
+        if (s.size() != l.k_depth) { throw runtime_error("Dense input does not match the number of weights."); }
+        s = { 1, 1, l.k_cnt };
+        break;
+      case Op::Activation:
+        break;
+    }
+    max_size = std::max(max_size, s.size());
+    shapes.push_back(s);
+  }
+
+  m_ping.resize(samples * max_size);
+  m_pong.resize(samples * max_size);
+
+  m_shapes.swap(shapes);
+  m_output_length = s.size();
+  m_plan_rows = rows; m_plan_cols = cols;
+  m_plan_samples = samples; // the workspace holds this many samples of this shape, not more
+}
+
+void keras::FlatKerasModel::activate(Act act, float *y, size_t size) {
+  switch (act) {
+    case Act::None:
+      break;
+    case Act::Relu:
+      for(size_t k = 0; k < size; ++k) { if (y[k] < 0) y[k] = 0; }
+      break;
+    case Act::Tanh:
+      for(size_t k = 0; k < size; ++k) { y[k] = tanh(y[k]); }
+      break;
+    case Act::Sigmoid:
+      for(size_t k = 0; k < size; ++k) { y[k] = 1.0F / (1.0F + exp(-y[k])); }
+      break;
+    case Act::Softmax:
+    {
+      float max = *std::max_element(y, y + size), sum = 0.0;
+      for(size_t k = 0; k < size; ++k) { y[k] = exp(y[k] - max); sum += y[k]; }
+      for(size_t k = 0; k < size; ++k) { y[k] /= sum; }
+      break;
+    }
+  }
+}
+
+// Direct convolution: each output pixel starts with the biases and accumulates the input
+// depth values times contiguous rows of all kernels, the loop over kernels vectorizes.
+void keras::FlatKerasModel::run_conv2d(FlatLayer const & l, Shape const & in, Shape const & out,
+                                       const float *x, float *y, size_t samples) const
+{
+  const size_t kcnt = l.k_cnt, depth = l.k_depth;
+  const float *weights = l.w;
+  const float *bias = l.b;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, samples * out.rows), [&](tbb::blocked_range<size_t> const & range) {
+    for(size_t idx = range.begin(); idx != range.end(); ++idx) {
+      size_t s = idx / out.rows, r = idx % out.rows;
+
+      const float *xs = x + s * in.size();
+      float *yr = y + s * out.size() + r * out.cols * kcnt;
+
+      // kernel rows overlapping the input, the rest is zero padding
+      size_t k1_lo = (l.pad_rows > r) ? l.pad_rows - r : 0;
+      size_t k1_hi = std::min(l.k_rows, in.rows + l.pad_rows - r);
+
+      for(size_t c = 0; c < out.cols; ++c) {
+        float *yc = yr + c * kcnt;
+        std::copy(bias, bias + kcnt, yc);
+
+        size_t k2_lo = (l.pad_cols > c) ? l.pad_cols - c : 0;
+        size_t k2_hi = std::min(l.k_cols, in.cols + l.pad_cols - c);
+
+        for(size_t k1 = k1_lo; k1 < k1_hi; ++k1) {
+          const float *xrow = xs + (r + k1 - l.pad_rows) * in.cols * depth;
+          for(size_t k2 = k2_lo; k2 < k2_hi; ++k2) {
+            const float *xp = xrow + (c + k2 - l.pad_cols) * depth;
+            const float *w = weights + (k1 * l.k_cols + k2) * depth * kcnt;
+            for(size_t m = 0; m < depth; ++m, w += kcnt) {
+              float p = xp[m];
+              for(size_t k = 0; k < kcnt; ++k) { yc[k] += w[k] * p; }
+            }
+          }
+        }
+      }
+      activate(l.act, yr, out.cols * kcnt);
+    }
+  });
+}
+
+void keras::FlatKerasModel::run_max_pooling(FlatLayer const & l, Shape const & in, Shape const & out,
+                                            const float *x, float *y, size_t samples) const
+{
+  const size_t depth = in.depth;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, samples * out.rows), [&](tbb::blocked_range<size_t> const & range) {
+    for(size_t idx = range.begin(); idx != range.end(); ++idx) {
+      size_t s = idx / out.rows, r = idx % out.rows;
+
+      const float *xs = x + s * in.size();
+      float *yr = y + s * out.size() + r * out.cols * depth;
+
+      for(size_t c = 0; c < out.cols; ++c) {
+        float *yc = yr + c * depth;
+        const float *x0 = xs + (r * l.pool_rows * in.cols + c * l.pool_cols) * depth;
+        std::copy(x0, x0 + depth, yc);
+
+        for(size_t i = 0; i < l.pool_rows; ++i) {
+          for(size_t j = 0; j < l.pool_cols; ++j) {
+            const float *xp = x0 + (i * in.cols + j) * depth;
+            for(size_t d = 0; d < depth; ++d) { yc[d] = std::max(yc[d], xp[d]); }
+          }
+        }
+      }
+    }
+  });
+}
+
+// NHWC to the depth, rows, cols order of LayerFlatten, expected by the Dense weights
+void keras::FlatKerasModel::run_flatten(Shape const & in, const float *x, float *y, size_t samples) const
+{
+  const size_t pixels = in.rows * in.cols, depth = in.depth;
+
+  tbb::parallel_for(size_t(0), samples, [&](size_t s) {
+    const float *xs = x + s * in.size();
+    float *ys = y + s * in.size();
+    for(size_t d = 0; d < depth; ++d) {
+      for(size_t p = 0; p < pixels; ++p) { ys[d * pixels + p] = xs[p * depth + d]; }
+    }
+  });
+}
+
+// Samples are processed in blocks, so each row of weights is read from memory once per block.
+void keras::FlatKerasModel::run_dense(FlatLayer const & l, const float *x, float *y, size_t samples) const
+{
+  const size_t inputs = l.k_depth, neurons = l.k_cnt;
+  const size_t block = 16;
+  const float *weights = l.w;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, samples, block), [&](tbb::blocked_range<size_t> const & range) {
+    for(size_t s0 = range.begin(); s0 < range.end(); s0 += block) {
+      size_t s1 = std::min(s0 + block, range.end());
+
+      for(size_t s = s0; s < s1; ++s) { std::copy(l.b, l.b + neurons, y + s * neurons); }
+
+      for(size_t j = 0; j < inputs; ++j) { // iter over input
+        const float *w = weights + j * neurons;
+        for(size_t s = s0; s < s1; ++s) {
+          float p = x[s * inputs + j];
+          if (p == 0) continue;             // frequent after relu
+          float *ys = y + s * neurons;
+          for(size_t k = 0; k < neurons; ++k) { ys[k] += w[k] * p; }
+        }
+      }
+
+      for(size_t s = s0; s < s1; ++s) { activate(l.act, y + s * neurons, neurons); }
+    }
+  });
+}
+
+void keras::FlatKerasModel::compute_output(const float *input, size_t samples, size_t rows, size_t cols, float *output) {
+  if (!samples) return;
+
+  plan(rows, cols, samples);
+
+  const float *x = input;  // current layer input
+  float *x_rw = nullptr;   // the same if in the workspace (so it can be modified in place)
+  float *buffers[2] = { m_ping.data(), m_pong.data() };
+  size_t next = 0;
+
+  for(size_t i = 0; i < m_layers.size(); ++i) {
+    auto const & l = m_layers[i];
+    auto const & in = m_shapes[i];
+    auto const & out = m_shapes[i+1];
+
+    if (l.op == Op::Activation) {
+      if (!x_rw) {
+        x_rw = buffers[next]; next ^= 1;
+        std::copy(x, x + samples * in.size(), x_rw);
+        x = x_rw;
+      }
+      tbb::parallel_for(size_t(0), samples, [&](size_t s) { activate(l.act, x_rw + s * in.size(), in.size()); });
+      continue;
+    }
+    if ((l.op == Op::Flatten) && ((in.depth == 1) || (in.rows * in.cols == 1))) {
+      continue; // NHWC is already in the flat order
+    }
+
+    float *y = buffers[next]; next ^= 1;
+    switch (l.op) {
+      case Op::Conv2D:     run_conv2d(l, in, out, x, y, samples); break;
+      case Op::MaxPooling: run_max_pooling(l, in, out, x, y, samples); break;
+      case Op::Flatten:    run_flatten(in, x, y, samples); break;
+      case Op::Dense:      run_dense(l, x, y, samples); break;
+      case Op::Activation: break;
+    }
+    x = x_rw = y;
+  }
+
+  std::copy(x, x + samples * m_shapes.back().size(), output);
+}
+
+std::vector< std::vector<float> > keras::FlatKerasModel::compute_output(std::vector< std::vector< std::vector<float> > > const & patches, size_t samples) {
+  samples = std::min(samples, patches.size());
+  if (!samples || patches.front().empty() || patches.front().front().empty()) return std::vector< std::vector<float> >();
+  if (m_input_depth != 1) { throw runtime_error("Model input depth is not 1, cannot run on 2D patches."); }
+
+  size_t rows = patches.front().size(), cols = patches.front().front().size();
+
+  for(size_t s = 0; s < samples; ++s) {
+    if (!is_rectangular(patches[s], rows, cols)) { throw runtime_error("Patches of a batch differ in size."); }
+  }
+
+  m_input.resize(samples * rows * cols);
+  float *dst = m_input.data();
+  for(size_t s = 0; s < samples; ++s) {
+    for(auto const & row : patches[s]) { dst = std::copy(row.begin(), row.end(), dst); }
+  }
+
+  plan(rows, cols, samples);
+  FlatBuffer out(samples * m_output_length);
+  compute_output(m_input.data(), samples, rows, cols, out.data());
+
+  std::vector< std::vector<float> > results(samples);
+  for(size_t s = 0; s < samples; ++s) {
+    results[s].assign(out.begin() + s * m_output_length, out.begin() + (s + 1) * m_output_length);
+  }
+  return results;
+}
+
+std::vector<float> keras::FlatKerasModel::compute_output(std::vector< std::vector<float> > const & patch) {
+  if (patch.empty() || patch.front().empty()) return std::vector<float>();
+  if (m_input_depth != 1) { throw runtime_error("Model input depth is not 1, cannot run on a 2D patch."); }
+
+  size_t rows = patch.size(), cols = patch.front().size();
+  if (!is_rectangular(patch, rows, cols)) { throw runtime_error("Patch rows differ in size."); }
+
+  m_input.resize(rows * cols);
+  float *dst = m_input.data();
+  for(auto const & row : patch) { dst = std::copy(row.begin(), row.end(), dst); }
+
+  plan(rows, cols, 1);
+  std::vector<float> out(m_output_length);
+  compute_output(m_input.data(), 1, rows, cols, out.data());
+  return out;
+}
+
+std::vector<float> keras::FlatKerasModel::compute_output(keras::DataChunk *dc) {
+  auto const & im = dc->get_3d(); // depth, rows, cols
+  if (im.size() != m_input_depth) { throw runtime_error("Input depth does not match the model."); }
+
+  size_t depth = im.size(), rows = im[0].size(), cols = im[0][0].size();
+
+  m_input.resize(rows * cols * depth);
+  for(size_t d = 0; d < depth; ++d) {
+    for(size_t r = 0; r < rows; ++r) {
+      for(size_t c = 0; c < cols; ++c) { m_input[(r * cols + c) * depth + d] = im[d][r][c]; }
+    }
+  }
+
+  plan(rows, cols, 1);
+  std::vector<float> out(m_output_length);
+  compute_output(m_input.data(), 1, rows, cols, out.data());
+  return out;
+}
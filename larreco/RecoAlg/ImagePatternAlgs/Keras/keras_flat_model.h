@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Class:       FlatKerasModel
+//
+//
+// Inference engine for the same Keras models as KerasModel (text files made with
+// dump_to_simple_cpp.py), working on flat, 64-byte aligned NHWC tensors:
+//  - conv kernels are stored flipped as [row][col][input depth][kernel], so the innermost
+//    loop runs over contiguous output channels and is vectorized by the compiler,
+//  - activations following Convolution2D/Dense layers are fused into them,
+//  - the ping-pong workspace is allocated once for the input shape and batch size,
+//  - compute_output runs over a whole batch of patches, in parallel with TBB.
+// Results are equal to KerasModel within float rounding (summation order differs).
+//
+// Models can be saved in a binary format holding the weights already in these layouts
+// (see keras_to_binary.cc), which is loaded with a single read or memory-mapped:
+//   header:  char[8] "KERASBIN", uint32 version, uint32 0x01020304 (byte order),
+//            uint32 number of layers, uint32 input depth
+//   layers:  one LayerRecord per layer
+//   data:    weights and biases of each layer, every block 64-byte aligned in the file
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef KERAS_FLAT_MODEL__H
+#define KERAS_FLAT_MODEL__H
+
+#include "keras_model.h"
+#include "keras_aligned_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace keras
+{
+	using FlatBuffer = std::vector< float, AlignedAllocator<float> >;
+
+	class FlatKerasModel;
+}
+
+class keras::FlatKerasModel {
+public:
+  /// reads a text (dump_to_simple_cpp.py) or binary model, binary files are memory-mapped if map_file is set
+  FlatKerasModel(const std::string &input_fname, bool map_file = false);
+  ~FlatKerasModel();
+
+  FlatKerasModel(const FlatKerasModel &) = delete;
+  FlatKerasModel & operator=(const FlatKerasModel &) = delete;
+
+  /// writes the model in the binary format
+  void save_binary(const std::string &output_fname) const;
+
+  static bool is_binary(const std::string &fname);
+
+  /// single 2D patch [rows][cols], the model input depth has to be 1
+  std::vector<float> compute_output(std::vector< std::vector<float> > const & patch);
+
+  /// drop-in replacement of KerasModel::compute_output, data in DataChunk2D is [depth][rows][cols]
+  std::vector<float> compute_output(keras::DataChunk *dc);
+
+  /// first samples patches of the batch, each [rows][cols], returns one output vector per patch
+  std::vector< std::vector<float> > compute_output(std::vector< std::vector< std::vector<float> > > const & patches, size_t samples);
+
+  /// batch of samples NHWC tensors [samples][rows][cols][input depth] in, [samples][output length] out
+  void compute_output(const float *input, size_t samples, size_t rows, size_t cols, float *output);
+
+  unsigned int get_input_depth() const { return m_input_depth; }
+  int get_output_length() const { return m_output_length; }
+
+private:
+
+  enum class Op { Conv2D, MaxPooling, Flatten, Dense, Activation };
+  enum class Act { None, Relu, Tanh, Sigmoid, Softmax };
+
+  struct Shape {
+    size_t rows, cols, depth;
+    size_t size(void) const { return rows * cols * depth; }
+  };
+
+  struct FlatLayer {
+    Op op = Op::Activation;
+    Act act = Act::None;      // applied to the output, fused for Conv2D and Dense
+    size_t k_rows = 0, k_cols = 0, k_depth = 0, k_cnt = 0; // Conv2D: kernel shape; Dense: k_depth inputs, k_cnt neurons
+    bool same = false;        // Conv2D: border mode "same", output of the input size
+    size_t pad_rows = 0, pad_cols = 0; // Conv2D: zero padding before the first row/col
+    size_t pool_rows = 0, pool_cols = 0;
+    FlatBuffer weights;       // Conv2D: [row][col][depth][kernel] flipped; Dense: [input][neuron]
+    FlatBuffer bias;
+    const float *w = nullptr; // weights and biases in use, in the buffers above or in the binary file
+    const float *b = nullptr;
+    size_t w_cnt = 0, b_cnt = 0;
+  };
+
+  /// layer description in the binary format, followed by the data of all layers
+  struct LayerRecord {
+    uint32_t op, act, k_rows, k_cols, k_depth, k_cnt, same, pad_rows, pad_cols, pool_rows, pool_cols, reserved;
+    uint64_t w_offset, w_cnt, b_offset, b_cnt; // offsets from the file begin, in bytes
+  };
+
+  struct BinaryHeader {
+    char magic[8];
+    uint32_t version, byte_order, layers_cnt, input_depth;
+  };
+
+  void load_weights(const std::string &input_fname);
+  void load_binary(const std::string &input_fname, bool map_file);
+  void add_activation(const std::string &type);
+
+  /// shapes of all layer outputs and the workspace for a batch of given input size
+  void plan(size_t rows, size_t cols, size_t samples);
+
+  void run_conv2d(FlatLayer const & l, Shape const & in, Shape const & out, const float *x, float *y, size_t samples) const;
+  void run_max_pooling(FlatLayer const & l, Shape const & in, Shape const & out, const float *x, float *y, size_t samples) const;
+  void run_flatten(Shape const & in, const float *x, float *y, size_t samples) const;
+  void run_dense(FlatLayer const & l, const float *x, float *y, size_t samples) const;
+  static void activate(Act act, float *y, size_t size);
+
+  std::vector<FlatLayer> m_layers;
+  std::vector<Shape> m_shapes;   // m_shapes[i] is the input of layer i, the last one the model output
+  bool m_flat_output;            // last layer produces 1D data
+
+  FlatBuffer m_input;            // input repacked from nested vectors
+  FlatBuffer m_ping, m_pong;     // workspace, layer outputs alternate between them
+  size_t m_plan_rows, m_plan_cols, m_plan_samples;
+
+  FlatBuffer m_file_data;        // binary model file read in one go
+  void *m_mapped;                // or memory-mapped
+  size_t m_mapped_size;
+
+  unsigned int m_input_depth;
+  int m_output_length;
+};
+
+#endif
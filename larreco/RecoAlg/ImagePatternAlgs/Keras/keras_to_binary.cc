@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Converts a Keras model dumped to text with dump_to_simple_cpp.py into the binary format of
+// FlatKerasModel (see keras_flat_model.h), which loads without parsing.
+//
+// Usage: keras_to_binary <model.nnet> [<model.nnetb>]
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "keras_flat_model.h"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <model.nnet> [<model.nnetb>]" << std::endl;
+    return 1;
+  }
+
+  std::string input = argv[1];
+  std::string output = (argc > 2) ? argv[2] : input + "b";
+
+  try {
+    keras::FlatKerasModel model(input);
+    model.save_binary(output);
+
+    // read it back, so a broken file is never left behind silently
+    keras::FlatKerasModel check(output);
+  }
+  catch (std::exception const & e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Binary model written to " << output << std::endl;
+  return 0;
+}
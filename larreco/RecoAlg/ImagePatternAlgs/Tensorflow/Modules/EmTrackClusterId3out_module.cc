@@ -32,7 +32,10 @@
 #include "lardataobj/RecoBase/Track.h"
 #include "lardata/Utilities/AssociationUtil.h"
 
-#include "larreco/RecoAlg/ImagePatternAlgs/Tensorflow/PointIdAlg/PointIdAlg.h"
+#include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
+#include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
+
+#include "larreco/RecoAlg/ImagePatternAlgs/Tensorflow/PointIdAlg/ViewClassifier.h"
 #include "lardata/ArtDataHelper/MVAWriter.h"
 
 #include <memory>
@@ -47,18 +50,10 @@ public:
 	typedef std::unordered_map< unsigned int, view_keymap > tpc_view_keymap;
 	typedef std::unordered_map< unsigned int, tpc_view_keymap > cryo_tpc_view_keymap;
 
-	struct Config {
+	struct Config : public nnet::ViewClassifier::Config {
 		using Name = fhicl::Name;
 		using Comment = fhicl::Comment;
 
-		fhicl::Table<nnet::PointIdAlg::Config> PointIdAlg {
-			Name("PointIdAlg")
-		};
-                fhicl::Atom<size_t> BatchSize {
-                        Name("BatchSize"),
-                        Comment("number of samples processed in one batch")
-                };
-
 		fhicl::Atom<art::InputTag> WireLabel {
 			Name("WireLabel"),
 			Comment("tag of deconvoluted ADC on wires (recob::Wire)")
@@ -94,11 +89,11 @@ public:
 
 private:
 	void produce(art::Event & e) override;
+	void endJob() override;
 
 	bool isViewSelected(int view) const;
 
-        size_t fBatchSize;
-	PointIdAlg fPointIdAlg;
+	ViewClassifier fViewClassifier; // PointIdAlg workers classifying the views
 	anab::MVAWriter<3> fMVAWriter; // <-------------- using 3-output CNN model
 
 	art::InputTag fWireProducerLabel;
@@ -115,8 +110,7 @@ private:
 
 EmTrackClusterId::EmTrackClusterId(EmTrackClusterId::Parameters const& config) :
         EDProducer{config},
-	fBatchSize(config().BatchSize()),
-        fPointIdAlg(config().PointIdAlg()),
+	fViewClassifier(config(), "EmTrackClusterId"),
         fMVAWriter(producesCollector(), "emtrack"),
 	fWireProducerLabel(config().WireLabel()),
 	fHitModuleLabel(config().HitModuleLabel()),
@@ -149,6 +143,12 @@ EmTrackClusterId::EmTrackClusterId(EmTrackClusterId::Parameters const& config) :
 }
 // ------------------------------------------------------
 
+void EmTrackClusterId::endJob()
+{
+    fViewClassifier.logThroughput();
+}
+// ------------------------------------------------------
+
 void EmTrackClusterId::produce(art::Event & evt)
 {
     mf::LogVerbatim("EmTrackClusterId") << "next event: " << evt.run() << " / " << evt.id().event();
@@ -175,55 +175,42 @@ void EmTrackClusterId::produce(art::Event & evt)
 	}
 
     // ********************* classify hits **********************
-    auto hitID = fMVAWriter.initOutputs<recob::Hit>(fHitModuleLabel, hitPtrList.size(), fPointIdAlg.outputLabels());
+    auto hitID = fMVAWriter.initOutputs<recob::Hit>(fHitModuleLabel, hitPtrList.size(), fViewClassifier.pointIdAlg().outputLabels());
 
     std::vector< char > hitInFA(hitPtrList.size(), 0); // tag hits in fid. area as 1, use 0 for hits close to the projectrion edges
+
+    std::vector< ViewClassifier::ViewHits > views; // in the fixed order of the hit map
     for (auto const & pcryo : hitMap)
     {
-        cryo = pcryo.first;
         for (auto const & ptpc : pcryo.second)
         {
-            tpc = ptpc.first;
             for (auto const & pview : ptpc.second)
             {
-                view = pview.first;
-                if (!isViewSelected(view)) continue; // should not happen, hits were selected
-
-                fPointIdAlg.setWireDriftData(*wireHandle, view, tpc, cryo);
-
-                // (1) do all hits in this plane ------------------------------------------------
-                for (size_t idx = 0; idx < pview.second.size(); idx += fBatchSize)
-                {
-                    std::vector< std::pair<unsigned int, float> > points;
-                    std::vector< size_t > keys;
-                    for (size_t k = 0; k < fBatchSize; ++k)
-                    {
-                        if (idx + k >= pview.second.size()) { break; } // careful about the tail
+                if (!isViewSelected(pview.first)) continue; // should not happen, hits were selected
 
-                        size_t h = pview.second[idx+k]; // h is the Ptr< recob::Hit >::key()
-                        const recob::Hit & hit = *(hitPtrList[h]);
-                        points.emplace_back(hit.WireID().Wire, hit.PeakTime());
-                        keys.push_back(h);
-                    }
-
-                    auto batch_out = fPointIdAlg.predictIdVectors(points);
-                    if (points.size() != batch_out.size())
-                    {
-                        throw cet::exception("EmTrackClusterId") << "hits processing failed" << std::endl;
-                    }
-
-                    for (size_t k = 0; k < points.size(); ++k)
-                    {
-                        size_t h = keys[k];
-                        fMVAWriter.setOutput(hitID, h, batch_out[k]);
-                        if (fPointIdAlg.isInsideFiducialRegion(points[k].first, points[k].second))
-                        { hitInFA[h] = 1; }
-                    }
-                } // hits done ------------------------------------------------------------------
+                views.emplace_back();
+                views.back().cryo = pcryo.first;
+                views.back().tpc = ptpc.first;
+                views.back().view = pview.first;
+                views.back().keys = pview.second;
             }
         }
     }
 
+    // (1) do all hits, views concurrently if configured ---------------------------------------
+    auto const & channelStatus = art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
+    fViewClassifier.classify(views, *wireHandle, hitPtrList, channelStatus);
+
+    // merge outputs view after view, so the result does not depend on the scheduling
+    for (auto const & vh : views)
+    {
+        for (size_t k = 0; k < vh.keys.size(); ++k)
+        {
+            fMVAWriter.setOutput(hitID, vh.keys[k], vh.outputs[k]);
+            hitInFA[vh.keys[k]] = vh.inFA[k];
+        }
+    } // hits done ------------------------------------------------------------------------------
+
     // (2) do clusters when hits are ready in all planes ----------------------------------------
     if (fDoClusters)
     {
@@ -248,7 +235,7 @@ void EmTrackClusterId::produce(art::Event & evt)
 	    	cluMap[cryo][tpc][view].push_back(c.key());
 	    }
 
-        auto cluID = fMVAWriter.initOutputs<recob::Cluster>(fNewClustersTag, fPointIdAlg.outputLabels());
+        auto cluID = fMVAWriter.initOutputs<recob::Cluster>(fNewClustersTag, fViewClassifier.pointIdAlg().outputLabels());
 
         unsigned int cidx = 0; // new clusters index
         art::FindManyP< recob::Hit > hitsFromClusters(cluListHandle, evt, fClusterModuleLabel);
@@ -349,7 +336,7 @@ void EmTrackClusterId::produce(art::Event & evt)
             }
         }
 
-        auto trkID = fMVAWriter.initOutputs<recob::Track>(fTrackModuleLabel, trkHitPtrList.size(), fPointIdAlg.outputLabels());
+        auto trkID = fMVAWriter.initOutputs<recob::Track>(fTrackModuleLabel, trkHitPtrList.size(), fViewClassifier.pointIdAlg().outputLabels());
         for (size_t t = 0; t < trkHitPtrList.size(); ++t) // t is the Ptr< recob::Track >::key()
         {
             auto vout = fMVAWriter.getOutput<recob::Hit>(trkHitPtrList[t],
@@ -14,6 +14,7 @@
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Principal/Run.h"
 #include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/Table.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -43,6 +44,12 @@ public:
 			Name("PointIdAlg")
 		};
 
+		fhicl::Atom<size_t> BatchSize {
+			Name("BatchSize"),
+			Comment("number of hits classified by the CNN in one batch (at least 1)"),
+			256
+		};
+
 		fhicl::Atom<art::InputTag> WireLabel {
 			Name("WireLabel"),
 			Comment("tag of deconvoluted ADC on wires (recob::Wire)")
@@ -78,6 +85,7 @@ public:
 
 private:
 	void produce(art::Event & e) override;
+	void endJob() override;
 
     bool DetectDecay(
         const std::vector<recob::Wire> & wires,
@@ -85,6 +93,7 @@ private:
         std::map< size_t, TVector3 > & spoints,
         std::vector< std::pair<TVector3, double> > & result);
 
+	size_t fBatchSize;
 	PointIdAlg fPointIdAlg;
 
 	art::InputTag fWireProducerLabel;
@@ -98,6 +107,7 @@ private:
 
 ParticleDecayId::ParticleDecayId(ParticleDecayId::Parameters const& config) :
         EDProducer{config},
+	fBatchSize(config().BatchSize()),
 	fPointIdAlg(config().PointIdAlg()),
 	fWireProducerLabel(config().WireLabel()),
 	fTrackModuleLabel(config().TrackModuleLabel()),
@@ -105,11 +115,19 @@ ParticleDecayId::ParticleDecayId(ParticleDecayId::Parameters const& config) :
 	fPointThreshold(config().PointThreshold()),
 	fSkipView(config().SkipView())
 {
+	if (fBatchSize == 0) { throw cet::exception("ParticleDecayId") << "BatchSize must be at least 1." << std::endl; }
+
 	produces< std::vector<recob::Vertex> >();
 	produces< art::Assns<recob::Vertex, recob::Track> >();
 }
 // ------------------------------------------------------
 
+void ParticleDecayId::endJob()
+{
+    fPointIdAlg.logThroughput("ParticleDecayId");
+}
+// ------------------------------------------------------
+
 void ParticleDecayId::produce(art::Event & evt)
 {
     std::cout << std::endl << "event " << evt.id().event() << std::endl;
@@ -184,18 +202,40 @@ bool ParticleDecayId::DetectDecay(
     }
 
     std::vector< float > outputs[nviews];
-    for (size_t v = 0; v < nviews; ++v)      // calculate nn outputs for each view (hopefully not changing cryo/tpc many times)
+    for (size_t v = 0; v < nviews; ++v)      // calculate nn outputs for each view, in batches of hits from the same cryo/tpc
     {
         outputs[v].resize(wire_drift[v].size(), 0);
+
+        std::map< std::pair<int, int>, std::vector< size_t > > tpcHits; // hit indexes in each [cryo, tpc]
         for (size_t i = 0; i < wire_drift[v].size(); ++i)
         {
-    		int tpc = wire_drift[v][i]->WireID().TPC;
-	    	int cryo = wire_drift[v][i]->WireID().Cryostat;
+            tpcHits[std::make_pair(wire_drift[v][i]->WireID().Cryostat, wire_drift[v][i]->WireID().TPC)].push_back(i);
+        }
 
-	    	fPointIdAlg.setWireDriftData(wires, v, tpc, cryo);
+        for (const auto & entry : tpcHits)
+        {
+            int cryo = entry.first.first;
+            int tpc = entry.first.second;
+            const auto & idxs = entry.second;
 
-	        outputs[v][i] = fPointIdAlg.predictIdVector(wire_drift[v][i]->WireID().Wire, wire_drift[v][i]->PeakTime())[0]; // p(decay)
-	    }
+            fPointIdAlg.setWireDriftData(wires, v, tpc, cryo);
+
+            for (size_t b = 0; b < idxs.size(); b += fBatchSize)
+            {
+                std::vector< std::pair<unsigned int, float> > points;
+                for (size_t k = b; (k < b + fBatchSize) && (k < idxs.size()); ++k)
+                {
+                    const auto & h = wire_drift[v][idxs[k]];
+                    points.emplace_back(h->WireID().Wire, h->PeakTime());
+                }
+
+                auto batch_out = fPointIdAlg.predictIdVectors(points);
+                for (size_t k = 0; k < batch_out.size(); ++k)
+                {
+                    outputs[v][idxs[b + k]] = batch_out[k][0]; // p(decay)
+                }
+            }
+        }
     }
 
     std::vector< std::pair<size_t, float> > candidates2d[nviews];
@@ -28,6 +28,7 @@
 #include "CLHEP/Random/RandGauss.h"
 
 #include <sys/stat.h>
+#include <chrono>
 
 // ------------------------------------------------------
 // -------------------ModelInterface---------------------
@@ -47,7 +48,22 @@ std::vector< std::vector<float> > nnet::ModelInterface::Run(std::vector< std::ve
     }
   return results;
 }
+// ------------------------------------------------------
 
+std::vector< std::vector<float> > nnet::ModelInterface::Run(const float * batch, size_t samples, size_t rows, size_t cols)
+{
+  std::vector< std::vector< std::vector<float> > > inps(samples, std::vector< std::vector<float> >(rows));
+  for (size_t s = 0; s < samples; ++s)
+    {
+      for (size_t r = 0; r < rows; ++r)
+        {
+          const float * row = batch + (s * rows + r) * cols;
+          inps[s][r].assign(row, row + cols);
+        }
+    }
+  return Run(inps, samples);
+}
+// ------------------------------------------------------
 
 std::string nnet::ModelInterface::findFile(const char* fileName) const
 {
@@ -71,21 +87,59 @@ std::string nnet::ModelInterface::findFile(const char* fileName) const
 // ----------------KerasModelInterface-------------------
 // ------------------------------------------------------
 
-nnet::KerasModelInterface::KerasModelInterface(const char* modelFileName) :
-  m(nnet::ModelInterface::findFile(modelFileName).c_str())
+nnet::KerasModelInterface::KerasModelInterface(const char* modelFileName, bool flatEngine, bool mapFile)
+{
+  std::string fname = nnet::ModelInterface::findFile(modelFileName);
+  if (flatEngine) { fm = std::make_unique<keras::FlatKerasModel>(fname, mapFile); }
+  else { m = std::make_unique<keras::KerasModel>(fname); }
+
+  mf::LogInfo("KerasModelInterface") << "Keras model loaded" << (flatEngine ? " to the flat engine." : ".");
+}
+// ------------------------------------------------------
+
+std::vector< std::vector<float> > nnet::KerasModelInterface::Run(std::vector< std::vector< std::vector<float> > > const & inps, int samples)
 {
-  mf::LogInfo("KerasModelInterface") << "Keras model loaded.";
+  if (!fm) { return nnet::ModelInterface::Run(inps, samples); }
+
+  if ((samples == 0) || inps.empty() || inps.front().empty() || inps.front().front().empty())
+    return std::vector< std::vector<float> >();
+
+  if ((samples == -1) || (samples > (int)inps.size())) { samples = inps.size(); }
+
+  return fm->compute_output(inps, samples);
+}
+// ------------------------------------------------------
+
+std::vector< std::vector<float> > nnet::KerasModelInterface::Run(const float * batch, size_t samples, size_t rows, size_t cols)
+{
+  if (!fm) { return nnet::ModelInterface::Run(batch, samples, rows, cols); }
+
+  if (!samples || !rows || !cols) { return std::vector< std::vector<float> >(); }
+
+  // single channel patches: [samples][rows][cols] is already the NHWC layout of the flat engine
+  size_t nout = fm->get_output_length();
+  std::vector<float> out(samples * nout);
+  fm->compute_output(batch, samples, rows, cols, out.data());
+
+  std::vector< std::vector<float> > results(samples);
+  for (size_t s = 0; s < samples; ++s)
+    {
+      results[s].assign(out.begin() + s * nout, out.begin() + (s + 1) * nout);
+    }
+  return results;
 }
 // ------------------------------------------------------
 
 std::vector<float> nnet::KerasModelInterface::Run(std::vector< std::vector<float> > const & inp2d)
 {
+  if (fm) { return fm->compute_output(inp2d); }
+
   std::vector< std::vector< std::vector<float> > > inp3d;
   inp3d.push_back(inp2d); // lots of copy, should add 2D to keras...
 
   keras::DataChunk *sample = new keras::DataChunk2D();
   sample->set_data(inp3d); // and more copy...
-  std::vector<float> out = m.compute_output(sample);
+  std::vector<float> out = m->compute_output(sample);
   delete sample;
   return out;
 }
@@ -129,6 +183,17 @@ std::vector< std::vector<float> > nnet::TfModelInterface::Run(std::vector< std::
 }
 // ------------------------------------------------------
 
+std::vector< std::vector<float> > nnet::TfModelInterface::Run(const float * batch, size_t samples, size_t rows, size_t cols)
+{
+  if (!samples || !rows || !cols) { return std::vector< std::vector<float> >(); }
+
+  tensorflow::Tensor _x(tensorflow::DT_FLOAT, tensorflow::TensorShape({ (long long int)samples, (long long int)rows, (long long int)cols, 1 }));
+  std::copy(batch, batch + samples * rows * cols, _x.flat<float>().data()); // same row-major layout, single copy
+
+  return g->run(_x);
+}
+// ------------------------------------------------------
+
 std::vector<float> nnet::TfModelInterface::Run(std::vector< std::vector<float> > const & inp2d)
 {
   long long int rows = inp2d.size(), cols = inp2d.front().size();
@@ -155,6 +220,7 @@ std::vector<float> nnet::TfModelInterface::Run(std::vector< std::vector<float> >
 nnet::PointIdAlg::PointIdAlg(const Config& config) : img::DataProviderAlg(config),
                                                      fNNet(0),
                                                      fPatchSizeW(config.PatchSizeW()), fPatchSizeD(config.PatchSizeD()),
+                                                     fBatchedPatches(0), fPatchFillTime(0), fModelRunTime(0),
                                                      fCurrentWireIdx(99999), fCurrentScaledDrift(99999)
 {
   fNNetModelFilePath = config.NNetModelFile();
@@ -165,7 +231,13 @@ nnet::PointIdAlg::PointIdAlg(const Config& config) : img::DataProviderAlg(config
   if ((fNNetModelFilePath.length() > 5) &&
       (fNNetModelFilePath.compare(fNNetModelFilePath.length() - 5, 5, ".nnet") == 0))
     {
-      fNNet = new nnet::KerasModelInterface(fNNetModelFilePath.c_str());
+      fNNet = new nnet::KerasModelInterface(fNNetModelFilePath.c_str(), config.FlatKerasEngine());
+    }
+  else if ((fNNetModelFilePath.length() > 6) &&
+           (fNNetModelFilePath.compare(fNNetModelFilePath.length() - 6, 6, ".nnetb") == 0))
+    {
+      // binary format, only read by the flat engine
+      fNNet = new nnet::KerasModelInterface(fNNetModelFilePath.c_str(), true, config.MapModelFile());
     }
   else if ((fNNetModelFilePath.length() > 3) &&
            (fNNetModelFilePath.compare(fNNetModelFilePath.length() - 3, 3, ".pb") == 0))
@@ -243,25 +315,45 @@ std::vector<float> nnet::PointIdAlg::predictIdVector(unsigned int wire, float dr
 }
 // ------------------------------------------------------
 
-std::vector< std::vector<float> > nnet::PointIdAlg::predictIdVectors(std::vector< std::pair<unsigned int, float> > points) const
+std::vector< std::vector<float> > nnet::PointIdAlg::predictIdVectors(std::vector< std::pair<unsigned int, float> > const & points) const
 {
   if (points.empty() || !fNNet) { return std::vector< std::vector<float> >(); }
 
-  std::vector< std::vector< std::vector<float> > > inps(
-                                                        points.size(), std::vector< std::vector<float> >(
-                                                                                                         fPatchSizeW, std::vector<float>(fPatchSizeD)));
+  auto t0 = std::chrono::steady_clock::now();
+
+  size_t patchSize = fPatchSizeW * fPatchSizeD;
+  if (fBatchPatches.size() < points.size() * patchSize) { fBatchPatches.resize(points.size() * patchSize); }
+
   for (size_t i = 0; i < points.size(); ++i)
     {
       unsigned int wire = points[i].first;
       float drift = points[i].second;
-      if (!bufferPatch(wire, drift, inps[i]))
+      if (!getPatch(wire, drift, fPatchSizeW, fPatchSizeD, fBatchPatches.data() + i * patchSize))
         {
           throw cet::exception("PointIdAlg") << "Patch buffering failed" << std::endl;
         }
-
     }
 
-  return fNNet->Run(inps);
+  auto t1 = std::chrono::steady_clock::now();
+
+  auto results = fNNet->Run(fBatchPatches.data(), points.size(), fPatchSizeW, fPatchSizeD);
+
+  auto t2 = std::chrono::steady_clock::now();
+
+  fBatchedPatches += points.size();
+  fPatchFillTime += std::chrono::duration<double>(t1 - t0).count();
+  fModelRunTime += std::chrono::duration<double>(t2 - t1).count();
+
+  return results;
+}
+// ------------------------------------------------------
+
+void nnet::PointIdAlg::logThroughput(const std::string & label) const
+{
+  double total = fPatchFillTime + fModelRunTime;
+  mf::LogInfo(label) << "CNN applied to " << fBatchedPatches << " patches in " << total << " s ("
+    << fPatchFillTime << " s filling patches, " << fModelRunTime << " s in the model), "
+    << (total > 0 ? fBatchedPatches / total : 0) << " patches/s.";
 }
 // ------------------------------------------------------
 
@@ -28,6 +28,7 @@
 
 #include "larreco/RecoAlg/ImagePatternAlgs/DataProvider/DataProviderAlg.h"
 #include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_model.h"
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_flat_model.h"
 #include "larreco/RecoAlg/ImagePatternAlgs/Tensorflow/TF/tf_graph.h"
 
 // ROOT & C++
@@ -53,6 +54,9 @@ public:
 	virtual std::vector<float> Run(std::vector< std::vector<float> > const & inp2d) = 0;
 	virtual std::vector< std::vector<float> > Run(std::vector< std::vector< std::vector<float> > > const & inps, int samples = -1);
 
+	/// batch of patches stored contiguously as [samples][rows][cols], by default unpacked to the nested vectors
+	virtual std::vector< std::vector<float> > Run(const float * batch, size_t samples, size_t rows, size_t cols);
+
 protected:
 	ModelInterface(void) { }
 
@@ -63,12 +67,15 @@ protected:
 class nnet::KerasModelInterface : public nnet::ModelInterface
 {
 public:
-	KerasModelInterface(const char* modelFileName);
+	KerasModelInterface(const char* modelFileName, bool flatEngine = false, bool mapFile = false);
 
+	std::vector< std::vector<float> > Run(std::vector< std::vector< std::vector<float> > > const & inps, int samples = -1) override;
+	std::vector< std::vector<float> > Run(const float * batch, size_t samples, size_t rows, size_t cols) override;
 	std::vector<float> Run(std::vector< std::vector<float> > const & inp2d) override;
 
 private:
-	keras::KerasModel m; // network model
+	std::unique_ptr<keras::KerasModel> m;      // network model
+	std::unique_ptr<keras::FlatKerasModel> fm; // or the same model in the flat, batched engine
 };
 // ------------------------------------------------------
 
@@ -78,6 +85,7 @@ public:
 	TfModelInterface(const char* modelFileName);
 
 	std::vector< std::vector<float> > Run(std::vector< std::vector< std::vector<float> > > const & inps, int samples = -1) override;
+	std::vector< std::vector<float> > Run(const float * batch, size_t samples, size_t rows, size_t cols) override;
 	std::vector<float> Run(std::vector< std::vector<float> > const & inp2d) override;
 
 private:
@@ -108,6 +116,14 @@ public:
 		fhicl::Atom<unsigned int> PatchSizeD {
 			Name("PatchSizeD"), Comment("How many downsampled ADC entries in patch")
 		};
+
+		fhicl::Atom<bool> FlatKerasEngine {
+			Name("FlatKerasEngine"), Comment("Run Keras (.nnet) models with the flat, batched inference engine."), false
+		};
+
+		fhicl::Atom<bool> MapModelFile {
+			Name("MapModelFile"), Comment("Memory-map binary Keras models (.nnetb) instead of reading them."), true
+		};
     };
 
 	PointIdAlg(const fhicl::ParameterSet& pset) :
@@ -127,7 +143,17 @@ public:
 	/// calculate multi-class probabilities for [wire, drift] point
 	std::vector<float> predictIdVector(unsigned int wire, float drift) const;
 
-	std::vector< std::vector<float> > predictIdVectors(std::vector< std::pair<unsigned int, float> > points) const;
+	/// calculate multi-class probabilities for a batch of [wire, drift] points, patches are filled
+	/// straight from the view into one contiguous tensor and the model is run once on all of them
+	std::vector< std::vector<float> > predictIdVectors(std::vector< std::pair<unsigned int, float> > const & points) const;
+
+	/// patches classified by predictIdVectors so far, and the time [s] spent on filling them and in the model
+	size_t batchedPatches(void) const { return fBatchedPatches; }
+	double patchFillTime(void) const { return fPatchFillTime; }
+	double modelRunTime(void) const { return fModelRunTime; }
+
+	/// print the predictIdVectors throughput, in patches per second
+	void logThroughput(const std::string & label) const;
 
 	static std::vector<float> flattenData2D(std::vector< std::vector<float> > const & patch);
 
@@ -151,6 +177,10 @@ private:
 	mutable std::vector< std::vector<float> > fWireDriftPatch;  // patch data around the identified point
 	size_t fPatchSizeW, fPatchSizeD;
 
+	mutable std::vector<float> fBatchPatches;  // contiguous [samples][wires][drifts] input of predictIdVectors
+	mutable size_t fBatchedPatches;
+	mutable double fPatchFillTime, fModelRunTime;
+
 	mutable size_t fCurrentWireIdx, fCurrentScaledDrift;
 	bool bufferPatch(size_t wire, float drift, std::vector< std::vector<float> > & patch) const
 	{
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class:       ViewClassifier
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "larreco/RecoAlg/ImagePatternAlgs/Tensorflow/PointIdAlg/ViewClassifier.h"
+
+#include "cetlib_except/exception.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+nnet::ViewClassifier::ViewClassifier(const Config& config, const std::string & label) :
+	fLabel(label),
+	fBatchSize(config.BatchSize()),
+	fPointIdAlg(config.PointIdAlg())
+{
+    if (fBatchSize == 0) { throw cet::exception(fLabel) << "BatchSize must be at least 1." << std::endl; }
+
+    for (size_t i = 1; i < config.ConcurrentViews(); ++i)
+    {
+        fViewAlgs.push_back(std::make_unique<PointIdAlg>(config.PointIdAlg()));
+    }
+}
+// ------------------------------------------------------
+
+void nnet::ViewClassifier::logThroughput(void) const
+{
+    fPointIdAlg.logThroughput(fLabel);
+    for (auto const & alg : fViewAlgs) { alg->logThroughput(fLabel); }
+}
+// ------------------------------------------------------
+
+void nnet::ViewClassifier::classify(std::vector< ViewHits > & views, const std::vector<recob::Wire> & wires,
+    const std::vector< art::Ptr<recob::Hit> > & hitPtrList,
+    const lariov::ChannelStatusProvider & channelStatus)
+{
+    // each worker takes every n-th view (just one worker if not concurrent)
+    size_t nWorkers = 1 + fViewAlgs.size();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nWorkers, 1),
+        [&](const tbb::blocked_range<size_t>& range)
+        {
+            for (size_t w = range.begin(); w < range.end(); ++w)
+            {
+                PointIdAlg & alg = (w == 0) ? fPointIdAlg : *fViewAlgs[w - 1];
+                for (size_t v = w; v < views.size(); v += nWorkers)
+                {
+                    classifyView(alg, wires, hitPtrList, channelStatus, views[v]);
+                }
+            }
+        });
+}
+// ------------------------------------------------------
+
+void nnet::ViewClassifier::classifyView(PointIdAlg & alg, const std::vector<recob::Wire> & wires,
+    const std::vector< art::Ptr<recob::Hit> > & hitPtrList,
+    const lariov::ChannelStatusProvider & channelStatus, ViewHits & vh) const
+{
+    alg.setWireDriftData(wires, vh.view, vh.tpc, vh.cryo, channelStatus);
+
+    vh.outputs.clear();
+    vh.outputs.reserve(vh.keys.size());
+    vh.inFA.assign(vh.keys.size(), 0);
+    for (size_t idx = 0; idx < vh.keys.size(); idx += fBatchSize)
+    {
+        std::vector< std::pair<unsigned int, float> > points;
+        for (size_t k = idx; (k < idx + fBatchSize) && (k < vh.keys.size()); ++k) // careful about the tail
+        {
+            const recob::Hit & hit = *(hitPtrList[vh.keys[k]]);
+            points.emplace_back(hit.WireID().Wire, hit.PeakTime());
+        }
+
+        auto batch_out = alg.predictIdVectors(points);
+        if (points.size() != batch_out.size())
+        {
+            throw cet::exception(fLabel) << "hits processing failed" << std::endl;
+        }
+
+        for (size_t k = 0; k < points.size(); ++k)
+        {
+            vh.outputs.push_back(std::move(batch_out[k]));
+            if (alg.isInsideFiducialRegion(points[k].first, points[k].second))
+            { vh.inFA[idx + k] = 1; }
+        }
+    }
+}
+// ------------------------------------------------------
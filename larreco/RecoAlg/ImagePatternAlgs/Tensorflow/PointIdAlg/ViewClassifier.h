@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class:       ViewClassifier
+//
+// Classifies the hits of all the (cryostat, TPC, view) images of an event with PointIdAlg, as
+// done by EmTrackMichelId and EmTrackClusterId(2out). Views can be prepared and classified
+// concurrently, each worker with its own PointIdAlg (image buffer and model); the outputs are
+// kept per view, so they do not depend on the scheduling.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ViewClassifier_h
+#define ViewClassifier_h
+
+#include "larreco/RecoAlg/ImagePatternAlgs/Tensorflow/PointIdAlg/PointIdAlg.h"
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/RecoBase/Wire.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lariov { class ChannelStatusProvider; }
+
+namespace nnet
+{
+	class ViewClassifier;
+}
+
+class nnet::ViewClassifier
+{
+public:
+
+    /// parameters of the modules using the classifier, at the top level of their configuration
+    struct Config
+    {
+	    using Name = fhicl::Name;
+	    using Comment = fhicl::Comment;
+
+		fhicl::Table<nnet::PointIdAlg::Config> PointIdAlg {
+			Name("PointIdAlg")
+		};
+		fhicl::Atom<size_t> BatchSize {
+		    Name("BatchSize"), Comment("number of samples processed in one batch")
+		};
+
+		fhicl::Atom<size_t> ConcurrentViews {
+			Name("ConcurrentViews"),
+			Comment("number of (TPC, plane) views prepared and classified concurrently, each worker with its own image buffer and model; 1: views one after another"),
+			1
+		};
+    };
+
+    /// hits of one (cryo, tpc, view) and their CNN outputs
+    struct ViewHits
+    {
+		unsigned int cryo, tpc, view;
+		std::vector< size_t > keys;                  // Ptr< recob::Hit >::key() of hits
+		std::vector< std::vector<float> > outputs;   // outputs for each hit in keys
+		std::vector< char > inFA;                    // 1 if hit is inside the fiducial area
+    };
+
+	ViewClassifier(const Config& config, const std::string & label);
+
+	/// the algorithm of the first worker, e.g. for the network output labels
+	PointIdAlg const & pointIdAlg(void) const { return fPointIdAlg; }
+
+	/// classify the hits of all the views; the channel status is taken by the caller on the
+	/// module thread, the workers do not access any service
+	void classify(std::vector< ViewHits > & views, const std::vector<recob::Wire> & wires,
+		const std::vector< art::Ptr<recob::Hit> > & hitPtrList,
+		const lariov::ChannelStatusProvider & channelStatus);
+
+	/// print the throughput of all the workers
+	void logThroughput(void) const;
+
+private:
+	void classifyView(PointIdAlg & alg, const std::vector<recob::Wire> & wires,
+		const std::vector< art::Ptr<recob::Hit> > & hitPtrList,
+		const lariov::ChannelStatusProvider & channelStatus, ViewHits & vh) const;
+
+	std::string fLabel;  // module name, for the messages
+	size_t fBatchSize;
+	PointIdAlg fPointIdAlg;
+	std::vector< std::unique_ptr<PointIdAlg> > fViewAlgs; // more workers if views are done concurrently
+};
+// ------------------------------------------------------
+
+#endif
@@ -13,10 +13,15 @@
 #include <cmath>
 #include <map>
 #include <algorithm>
+#include <numeric>
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 #include "cetlib_except/exception.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "larreco/RecoAlg/SpacePointAlg.h"
 #include "larcore/Geometry/Geometry.h"
+#include "larcore/CoreUtils/ServiceUtil.h"
+#include "larcorealg/Geometry/GeometryCore.h"
 #include "larcorealg/Geometry/CryostatGeo.h"
 #include "larcorealg/Geometry/TPCGeo.h"
 #include "larcorealg/Geometry/PlaneGeo.h"
@@ -45,6 +50,7 @@ namespace  trkf{
     fFilter(false),
     fMerge(false),
     fPreferColl(false),
+    fParallelTPCs(false),
     fTickOffsetU(0.),
     fTickOffsetV(0.),
     fTickOffsetW(0.)
@@ -70,6 +76,7 @@ namespace  trkf{
         fFilter = pset.get<bool>("Filter");
         fMerge = pset.get<bool>("Merge");
         fPreferColl = pset.get<bool>("PreferColl");
+        fParallelTPCs = pset.get<bool>("ParallelTPCs", false);
         fTickOffsetU = pset.get<double>("TickOffsetU", 0.);
         fTickOffsetV = pset.get<double>("TickOffsetV", 0.);
         fTickOffsetW = pset.get<double>("TickOffsetW", 0.);
@@ -91,6 +98,7 @@ namespace  trkf{
 		  << "  Filter = " << fFilter << "\n"
 		  << "  Merge = " << fMerge << "\n"
 		  << "  PreferColl = " << fPreferColl << "\n"
+		  << "  ParallelTPCs = " << fParallelTPCs << "\n"
 		  << "  TickOffsetU = " << fTickOffsetU << "\n"
 		  << "  TickOffsetV = " << fTickOffsetV << "\n"
 		  << "  TickOffsetW = " << fTickOffsetW << std::endl;
@@ -862,6 +870,371 @@ namespace  trkf{
         makeSpacePoints(hits, spts, true);
     }
 
+    //----------------------------------------------------------------------
+    // Find the compatible combinations of hits of one TPC.
+    // Combinations are found in the same order as by plain loops over
+    // the hits of each plane sorted by wire, but only the hits in the
+    // time window of the hits already chosen are looked at, and the
+    // wire geometry is computed once per wire.  The cuts are the same
+    // as those of method compatible, which is only called for the
+    // mc truth test.
+    //
+    void SpacePointAlg::findCandidates(const geo::GeometryCore& geom,
+                                       unsigned int cstat, unsigned int tpc,
+                                       const std::vector<PlaneHits>& planes,
+                                       bool useMC,
+                                       TPCCandidates& cands) const
+    {
+        geo::TPCID tpcid(cstat, tpc);
+        const geo::TPCGeo& tpcgeom = geom.Cryostat(cstat).TPC(tpc);
+
+        // Sort planes in increasing order of number of hits.
+        // This is so that we can do the outer loops over hits
+        // over the views with fewer hits.
+        //
+        // If config parameter PreferColl is true, treat the colleciton
+        // plane as if it had the most hits, regardless of how many
+        // hits it actually has.  This will force space points to be
+        // filtered and merged with respect to the collection plane
+        // wires.  It will also force space points to be sorted by
+        // collection plane wire.
+
+        int nplane = planes.size();
+        std::vector<int> index(nplane);
+
+        for(int i=0; i<nplane; ++i)
+            index[i] = i;
+
+        for(int i=0; i<nplane-1; ++i) {
+
+            for(int j=i+1; j<nplane; ++j) {
+                bool icoll = fPreferColl &&
+                geom.SignalType(geo::PlaneID(tpcid, index[i])) == geo::kCollection;
+                bool jcoll = fPreferColl &&
+                geom.SignalType(geo::PlaneID(tpcid, index[j])) == geo::kCollection;
+                if((planes[index[i]].hits.size() > planes[index[j]].hits.size() &&
+                    !jcoll) || icoll) {
+                    int temp = index[i];
+                    index[i] = index[j];
+                    index[j] = temp;
+                }
+            }
+        }// end loop over i
+
+        // how many views with hits?
+        // This will allow for the special case where we might have only 2 planes of information and
+        // still want space points even if a three plane TPC
+        int nViewsWithHits(0);
+
+        for(int i = 0; i < nplane; i++)
+        {
+            if (planes[index[i]].hits.size() > 0) nViewsWithHits++;
+        }
+
+        // Angle, pitch, and offset of the wires of a plane.
+
+        struct PlaneConstants { double s, c, dist, pitch; };
+        auto planeConstants = [&](unsigned int plane)
+            {
+                const geo::WireGeo& wgeo = tpcgeom.Plane(plane).Wire(0);
+                double hl = wgeo.HalfL();
+                double xyz1[3];
+                double xyz2[3];
+                wgeo.GetCenter(xyz1, -hl);
+                wgeo.GetCenter(xyz2, hl);
+                PlaneConstants pc;
+                pc.s = (xyz2[1] - xyz1[1]) / (2.*hl);
+                pc.c = (xyz2[2] - xyz1[2]) / (2.*hl);
+                pc.dist = -xyz1[1] * pc.c + xyz1[2] * pc.s;
+                pc.pitch = geom.WirePitch(plane, tpc, cstat);
+                return pc;
+            };
+
+        // Range of plane2 wires crossing a plane1 wire, from the
+        // endpoints of the plane1 wire.  Cached by plane1 wire.
+
+        auto wireRange = [&](std::vector<std::pair<int, int> >& cache,
+                             const geo::WireID& wireid,
+                             const PlaneConstants& pc2)
+            {
+                if(wireid.Wire >= cache.size())
+                    cache.resize(wireid.Wire + 1, std::make_pair(-1, -1));
+                std::pair<int, int>& range = cache[wireid.Wire];
+                if(range.first < 0) {
+                    const geo::WireGeo& wgeo = geom.WireIDToWireGeo(wireid);
+                    double hl1 = wgeo.HalfL();
+                    double xyz1[3];
+                    double xyz2[3];
+                    wgeo.GetCenter(xyz1, -hl1);
+                    wgeo.GetCenter(xyz2, hl1);
+
+                    // Find the plane2 wire numbers corresponding to the endpoints.
+
+                    double wire21 = (-xyz1[1] * pc2.c + xyz1[2] * pc2.s - pc2.dist) / pc2.pitch;
+                    double wire22 = (-xyz2[1] * pc2.c + xyz2[2] * pc2.s - pc2.dist) / pc2.pitch;
+
+                    range.first = std::max(0., std::min(wire21, wire22));
+                    range.second = std::max(0., std::max(wire21, wire22) + 1.);
+                }
+                return range;
+            };
+
+        // Angles and distance from origin of a wire, as used for the
+        // spatial cut of method compatible.  Cached by plane and wire.
+
+        struct WireCoords { bool valid; double s, c, dist; };
+        std::vector<std::vector<WireCoords> > wirecoords(nplane);
+        auto wireCoords = [&](const geo::WireID& wireid)
+            {
+                std::vector<WireCoords>& cache = wirecoords[wireid.Plane];
+                if(wireid.Wire >= cache.size())
+                    cache.resize(wireid.Wire + 1, WireCoords{false, 0., 0., 0.});
+                WireCoords& wc = cache[wireid.Wire];
+                if(!wc.valid) {
+                    const geo::WireGeo& wgeom = geom.WireIDToWireGeo(wireid);
+                    double hl = wgeom.HalfL();
+                    double xyz[3];
+                    double xyz1[3];
+                    wgeom.GetCenter(xyz);
+                    wgeom.GetCenter(xyz1, hl);
+                    wc.s = (xyz1[1] - xyz[1]) / hl;
+                    wc.c = (xyz1[2] - xyz[2]) / hl;
+                    wc.dist = xyz[2] * wc.s - xyz[1] * wc.c;
+                    wc.valid = true;
+                }
+                return wc;
+            };
+
+        // Positions of the hits of a plane on wires [wmin, wmax] with
+        // time in [tmin, tmax], in the order of the hit list.  Callers
+        // widen the time window a little and apply the exact cut.
+
+        const double tmargin = 1.e-6 * (1. + fMaxDT);
+        auto findHits = [](const PlaneHits& ph, int wmin, int wmax,
+                           double tmin, double tmax, std::vector<unsigned int>& found)
+            {
+                found.clear();
+                if(wmax < wmin)
+                    return;
+                std::vector<unsigned int>::const_iterator
+                iw = std::lower_bound(ph.wires.begin(), ph.wires.end(), (unsigned int) wmin),
+                iwend = std::upper_bound(iw, ph.wires.end(), (unsigned int) wmax);
+                while(iw != iwend) {
+
+                    // Hits on this wire occupy the same positions in byTime.
+
+                    std::vector<unsigned int>::const_iterator iwnext = std::upper_bound(iw, iwend, *iw);
+                    std::vector<unsigned int>::const_iterator
+                    it = ph.byTime.begin() + (iw - ph.wires.begin()),
+                    itend = ph.byTime.begin() + (iwnext - ph.wires.begin());
+                    it = std::partition_point(it, itend,
+                                              [&ph, tmin](unsigned int k) { return ph.times[k] < tmin; });
+                    for(; it != itend && ph.times[*it] <= tmax; ++it)
+                        found.push_back(*it);
+                    iw = iwnext;
+                }
+                std::sort(found.begin(), found.end());
+            };
+
+        std::vector<unsigned int> found2;
+        std::vector<unsigned int> found3;
+
+        // If two-view space points are allowed, make a double loop
+        // over hits and find compatible hit-pairs.
+
+        if((nViewsWithHits == 2 || nplane == 2) && fMinViews <= 2) {
+
+            // Loop over pairs of views.
+            for(int i=0; i<nplane-1; ++i) {
+                unsigned int plane1 = index[i];
+                const PlaneHits& ph1 = planes[plane1];
+
+                if (ph1.hits.empty()) continue;
+
+                for(int j=i+1; j<nplane; ++j) {
+                    unsigned int plane2 = index[j];
+                    const PlaneHits& ph2 = planes[plane2];
+
+                    if (ph2.hits.empty()) continue;
+
+                    PlaneConstants pc2 = planeConstants(plane2);
+
+                    if(!fPreferColl && ph1.hits.size() > ph2.hits.size())
+                        throw cet::exception("SpacePointAlg") << "makeSpacePoints(): hitmaps with incompatible size\n";
+
+                    // Loop over pairs of hits.
+
+                    std::vector<std::pair<int, int> > ranges;
+                    art::PtrVector<recob::Hit> hitvec;
+                    hitvec.reserve(2);
+
+                    for(unsigned int k1 = 0; k1 < ph1.hits.size(); ++k1) {
+                        const recob::Hit& hit1 = *ph1.phits[k1];
+                        double t1 = ph1.times[k1];
+                        std::pair<int, int> range = wireRange(ranges, hit1.WireID(), pc2);
+                        findHits(ph2, range.first, range.second,
+                                 t1 - fMaxDT - tmargin, t1 + fMaxDT + tmargin, found2);
+
+                        for(unsigned int k2 : found2) {
+                            const recob::Hit& hit2 = *ph2.phits[k2];
+
+                            // Check current pair of hits for compatibility.
+
+                            bool ok = hit1.View() != hit2.View() && std::abs(t1 - ph2.times[k2]) <= fMaxDT;
+                            if(!ok)
+                                continue;
+                            hitvec.clear();
+                            hitvec.push_back(ph1.hits[k1]);
+                            hitvec.push_back(ph2.hits[k2]);
+                            if(useMC && !compatible(hitvec, useMC))
+                                continue;
+                            cands.pairs.push_back(hitvec);
+                        }
+                    }
+                }
+            }
+        }// end if fMinViews <= 2
+
+        // If three-view space points are allowed, make a triple loop
+        // over hits and find compatible triplets.
+
+        if(nplane >= 3 && fMinViews <= 3) {
+
+            art::PtrVector<recob::Hit> hitvec;
+            hitvec.reserve(3);
+
+            unsigned int plane1 = index[0];
+            unsigned int plane2 = index[1];
+            unsigned int plane3 = index[2];
+            const PlaneHits& ph1 = planes[plane1];
+            const PlaneHits& ph2 = planes[plane2];
+            const PlaneHits& ph3 = planes[plane3];
+
+            PlaneConstants pc1 = planeConstants(plane1);
+            PlaneConstants pc2 = planeConstants(plane2);
+            PlaneConstants pc3 = planeConstants(plane3);
+
+            // Get sine of angle differences.
+
+            double s12 = pc1.s * pc2.c - pc2.s * pc1.c;   // sin(theta1 - theta2).
+            double s23 = pc2.s * pc3.c - pc3.s * pc2.c;   // sin(theta2 - theta3).
+            double s31 = pc3.s * pc1.c - pc1.s * pc3.c;   // sin(theta3 - theta1).
+
+            std::vector<std::pair<int, int> > ranges;
+
+            // Loop over hits in plane1.
+
+            for(unsigned int k1 = 0; k1 < ph1.hits.size(); ++k1) {
+
+                unsigned int wire1 = ph1.wires[k1];
+                const recob::Hit& hit1 = *ph1.phits[k1];
+                assert(hit1.WireID().Plane == plane1);
+                assert(hit1.WireID().Wire == wire1);
+
+                // Get corrected time and oblique coordinate of first hit.
+
+                double t1 = ph1.times[k1];
+                double u1 = wire1 * pc1.pitch + pc1.dist;
+
+                std::pair<int, int> range = wireRange(ranges, hit1.WireID(), pc2);
+                findHits(ph2, range.first, range.second,
+                         t1 - fMaxDT - tmargin, t1 + fMaxDT + tmargin, found2);
+
+                for(unsigned int k2 : found2) {
+
+                    int wire2 = ph2.wires[k2];
+                    const recob::Hit& hit2 = *ph2.phits[k2];
+
+                    // Get corrected time of second hit and check maximum
+                    // time difference with first hit.
+
+                    double t2 = ph2.times[k2];
+                    bool h12ok = std::abs(t1-t2) <= fMaxDT && hit1.View() != hit2.View();
+                    if(!h12ok)
+                        continue;
+
+                    // Test first two hits for compatibility before looping
+                    // over third hit.
+
+                    if(useMC) {
+                        hitvec.clear();
+                        hitvec.push_back(ph1.hits[k1]);
+                        hitvec.push_back(ph2.hits[k2]);
+                        if(!compatible(hitvec, useMC))
+                            continue;
+                    }
+
+                    // Get oblique coordinate of second hit.
+
+                    double u2 = wire2 * pc2.pitch + pc2.dist;
+
+                    // Predict plane3 oblique coordinate and wire number.
+
+                    double u3pred = (-u1*s23 - u2*s31) / s12;
+                    double w3pred = (u3pred - pc3.dist) / pc3.pitch;
+                    double w3delta = std::abs(fMaxS / (s12 * pc3.pitch));
+                    int w3min = std::max(0., std::ceil(w3pred - w3delta));
+                    int w3max = std::max(0., std::floor(w3pred + w3delta));
+
+                    findHits(ph3, w3min, w3max,
+                             std::max(t1, t2) - fMaxDT - tmargin, std::min(t1, t2) + fMaxDT + tmargin, found3);
+
+                    for(unsigned int k3 : found3) {
+
+                        int wire3 = ph3.wires[k3];
+                        const recob::Hit& hit3 = *ph3.phits[k3];
+
+                        // Check time difference of third hit compared to first two hits.
+
+                        double t3 = ph3.times[k3];
+                        bool dt123ok = std::abs(t1-t3) <= fMaxDT && std::abs(t2-t3) <= fMaxDT;
+                        if(!dt123ok)
+                            continue;
+
+                        // Get oblique coordinate of third hit and check spatial separation.
+
+                        double u3 = wire3 * pc3.pitch + pc3.dist;
+                        double S = s23 * u1 + s31 * u2 + s12 * u3;
+                        bool sok = std::abs(S) <= fMaxS;
+                        if(!sok)
+                            continue;
+
+                        // Test triplet for compatibility (different views
+                        // and spatial cut of method compatible).
+
+                        if(hit3.View() == hit1.View() || hit3.View() == hit2.View())
+                            continue;
+
+                        double dist[3] = {0., 0., 0.};
+                        double sinth[3] = {0., 0., 0.};
+                        double costh[3] = {0., 0., 0.};
+                        const recob::Hit* triplet[3] = {&hit1, &hit2, &hit3};
+                        for(int i=0; i<3; ++i) {
+                            const geo::WireID& wireid = triplet[i]->WireID();
+                            WireCoords wc = wireCoords(wireid);
+                            sinth[wireid.Plane] = wc.s;
+                            costh[wireid.Plane] = wc.c;
+                            dist[wireid.Plane] = wc.dist;
+                        }
+                        double Sgeo = ((sinth[1] * costh[2] - costh[1] * sinth[2]) * dist[0]
+                                       +(sinth[2] * costh[0] - costh[2] * sinth[0]) * dist[1]
+                                       +(sinth[0] * costh[1] - costh[0] * sinth[1]) * dist[2]);
+                        if(!(std::abs(Sgeo) < fMaxS))
+                            continue;
+
+                        hitvec.clear();
+                        hitvec.push_back(ph1.hits[k1]);
+                        hitvec.push_back(ph2.hits[k2]);
+                        hitvec.push_back(ph3.hits[k3]);
+                        if(useMC && !compatible(hitvec, useMC))
+                            continue;
+                        cands.triplets.push_back(hitvec);
+                    }
+                }
+            }
+        }// end if fMinViews <= 3
+    }
+
     //----------------------------------------------------------------------
     // Fill a vector of space points for all compatible combinations of hits
     // from an input vector of hits (general version).
@@ -1040,358 +1413,116 @@ namespace  trkf{
         std::multimap<sptkey_type, recob::SpacePoint> sptmap;
         std::set<sptkey_type> sptkeys;              // Keys of multimap.
 
-        // Loop over TPCs.
-        for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
-            for(unsigned int tpc = 0; tpc < geom->Cryostat(cstat).NTPC(); ++tpc) {
-
-                geo::TPCID tpcid(cstat, tpc);
+        // Index the hits of each plane by wire and, on each wire, by
+        // corrected time.
 
-                // Sort maps in increasing order of number of hits.
-                // This is so that we can do the outer loops over hits
-                // over the views with fewer hits.
-                //
-                // If config parameter PreferColl is true, treat the colleciton
-                // plane as if it had the most hits, regardless of how many
-                // hits it actually has.  This will force space points to be
-                // filtered and merged with respect to the collection plane
-                // wires.  It will also force space points to be sorted by
-                // collection plane wire.
+        std::vector<std::vector<std::vector<PlaneHits> > > planehits(ncstat);
+        std::vector<std::pair<unsigned int, unsigned int> > tpcs;   // (cryostat, tpc)
 
+        for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
+            unsigned int ntpc = geom->Cryostat(cstat).NTPC();
+            planehits[cstat].resize(ntpc);
+            for(unsigned int tpc = 0; tpc < ntpc; ++tpc) {
                 int nplane = hitmap[cstat][tpc].size();
-                std::vector<int> index(nplane);
-
-                for(int i=0; i<nplane; ++i)
-                    index[i] = i;
-
-                for(int i=0; i<nplane-1; ++i) {
-
-                    for(int j=i+1; j<nplane; ++j) {
-                        bool icoll = fPreferColl &&
-                        geom->SignalType(geo::PlaneID(tpcid, index[i])) == geo::kCollection;
-                        bool jcoll = fPreferColl &&
-                        geom->SignalType(geo::PlaneID(tpcid, index[j])) == geo::kCollection;
-                        if((hitmap[cstat][tpc][index[i]].size() > hitmap[cstat][tpc][index[j]].size() &&
-                            !jcoll) || icoll) {
-                            int temp = index[i];
-                            index[i] = index[j];
-                            index[j] = temp;
-                        }
+                planehits[cstat][tpc].resize(nplane);
+                for(int plane = 0; plane < nplane; ++plane) {
+                    const std::multimap<unsigned int, art::Ptr<recob::Hit> >& wirehits = hitmap[cstat][tpc][plane];
+                    PlaneHits& ph = planehits[cstat][tpc][plane];
+                    const double TicksOffset = detprop->GetXTicksOffset(plane,tpc,cstat);
+                    ph.hits.reserve(wirehits.size());
+                    ph.phits.reserve(wirehits.size());
+                    ph.wires.reserve(wirehits.size());
+                    ph.times.reserve(wirehits.size());
+                    for(std::multimap<unsigned int, art::Ptr<recob::Hit> >::const_iterator ihit = wirehits.begin();
+                        ihit != wirehits.end(); ++ihit) {
+                        ph.hits.push_back(ihit->second);
+                        ph.phits.push_back(&*ihit->second);
+                        ph.wires.push_back(ihit->first);
+                        ph.times.push_back(ihit->second->PeakTime() - TicksOffset);
                     }
-                }// end loop over i
-
-                // how many views with hits?
-                // This will allow for the special case where we might have only 2 planes of information and
-                // still want space points even if a three plane TPC
-                std::vector<std::multimap<unsigned int, art::Ptr<recob::Hit>>>& hitsByPlaneVec = hitmap[cstat][tpc];
-                int nViewsWithHits(0);
-
-                for(int i = 0; i < nplane; i++)
-                {
-                    if (hitsByPlaneVec[index[i]].size() > 0) nViewsWithHits++;
+                    ph.byTime.resize(ph.hits.size());
+                    std::iota(ph.byTime.begin(), ph.byTime.end(), 0u);
+                    std::sort(ph.byTime.begin(), ph.byTime.end(),
+                              [&ph](unsigned int a, unsigned int b)
+                              {
+                                  return ph.wires[a] < ph.wires[b] ||
+                                      (ph.wires[a] == ph.wires[b] && ph.times[a] < ph.times[b]);
+                              });
                 }
+                tpcs.push_back(std::make_pair(cstat, tpc));
+            }
+        }
 
-                // If two-view space points are allowed, make a double loop
-                // over hits and produce space points for compatible hit-pairs.
-
-                if((nViewsWithHits == 2 || nplane == 2) && fMinViews <= 2) {
-
-                    // Loop over pairs of views.
-                    for(int i=0; i<nplane-1; ++i) {
-                        unsigned int plane1 = index[i];
-
-                        if (hitmap[cstat][tpc][plane1].empty()) continue;
-
-                        for(int j=i+1; j<nplane; ++j) {
-                            unsigned int plane2 = index[j];
-
-                            if (hitmap[cstat][tpc][plane2].empty()) continue;
-
-                            // Get angle, pitch, and offset of plane2 wires.
-                            const geo::WireGeo& wgeo2 = geom->Cryostat(cstat).TPC(tpc).Plane(plane2).Wire(0);
-                            double hl2 = wgeo2.HalfL();
-                            double xyz21[3];
-                            double xyz22[3];
-                            wgeo2.GetCenter(xyz21, -hl2);
-                            wgeo2.GetCenter(xyz22, hl2);
-                            double s2 = (xyz22[1] - xyz21[1]) / (2.*hl2);
-                            double c2 = (xyz22[2] - xyz21[2]) / (2.*hl2);
-                            double dist2 = -xyz21[1] * c2 + xyz21[2] * s2;
-                            double pitch2 = geom->WirePitch(plane2, tpc, cstat);
-
-                            if(!fPreferColl && hitmap[cstat][tpc][plane1].size() > hitmap[cstat][tpc][plane2].size())
-                                throw cet::exception("SpacePointAlg") << "makeSpacePoints(): hitmaps with incompatible size\n";
-
-
-                            // Loop over pairs of hits.
-
-                            art::PtrVector<recob::Hit> hitvec;
-                            hitvec.reserve(2);
-
-                            for(std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                ihit1 = hitmap[cstat][tpc][plane1].begin();
-                                ihit1 != hitmap[cstat][tpc][plane1].end(); ++ihit1) {
-
-                                const art::Ptr<recob::Hit>& phit1 = ihit1->second;
-                                geo::WireID phit1WireID = phit1->WireID();
-                                const geo::WireGeo& wgeo = geom->WireIDToWireGeo(phit1WireID);
-
-                                // Get endpoint coordinates of this wire.
-                                // (kept as assertions for performance reasons)
-                                assert(phit1WireID.Cryostat == cstat);
-                                assert(phit1WireID.TPC == tpc);
-                                assert(phit1WireID.Plane == plane1);
-                                double hl1 = wgeo.HalfL();
-                                double xyz1[3];
-                                double xyz2[3];
-                                wgeo.GetCenter(xyz1, -hl1);
-                                wgeo.GetCenter(xyz2, hl1);
-
-                                // Find the plane2 wire numbers corresponding to the endpoints.
-
-                                double wire21 = (-xyz1[1] * c2 + xyz1[2] * s2 - dist2) / pitch2;
-                                double wire22 = (-xyz2[1] * c2 + xyz2[2] * s2 - dist2) / pitch2;
-
-                                int wmin = std::max(0., std::min(wire21, wire22));
-                                int wmax = std::max(0., std::max(wire21, wire22) + 1.);
-
-                                std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                ihit2 = hitmap[cstat][tpc][plane2].lower_bound(wmin),
-                                ihit2end = hitmap[cstat][tpc][plane2].upper_bound(wmax);
-
-                                for(; ihit2 != ihit2end; ++ihit2) {
-
-                                    const art::Ptr<recob::Hit>& phit2 = ihit2->second;
-
-                                    // Check current pair of hits for compatibility.
-                                    // By construction, hits should always have compatible views
-                                    // and times, but may not have compatible mc information.
-
-                                    hitvec.clear();
-                                    hitvec.push_back(phit1);
-                                    hitvec.push_back(phit2);
-                                    bool ok = compatible(hitvec,  useMC);
-                                    if(ok) {
-
-                                        // Add a space point.
-
-                                        ++n2;
-
-                                        // make a dummy vector of recob::SpacePoints
-                                        // as we are filtering or merging and don't want to
-                                        // add the created SpacePoint to the final collection just yet
-                                        // This dummy vector will hold just one recob::SpacePoint,
-                                        // which will go into the multimap and then the vector
-                                        // will go out of scope.
-
-                                        std::vector<recob::SpacePoint> sptv;
-                                        fillSpacePoint(hitvec, sptv, sptmap.size());
-                                        sptkey_type key = &*phit2;
-                                        sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
-                                        sptkeys.insert(key);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }// end if fMinViews <= 2
-
-                // If three-view space points are allowed, make a triple loop
-                // over hits and produce space points for compatible triplets.
-
-                if(nplane >= 3 && fMinViews <= 3) {
-
-                    // Loop over triplets of hits.
-
-                    art::PtrVector<recob::Hit> hitvec;
-                    hitvec.reserve(3);
-
-                    unsigned int plane1 = index[0];
-                    unsigned int plane2 = index[1];
-                    unsigned int plane3 = index[2];
-
-                    // Get angle, pitch, and offset of plane1 wires.
-
-                    const geo::WireGeo& wgeo1 = geom->Cryostat(cstat).TPC(tpc).Plane(plane1).Wire(0);
-                    double hl1 = wgeo1.HalfL();
-                    double xyz11[3];
-                    double xyz12[3];
-                    wgeo1.GetCenter(xyz11, -hl1);
-                    wgeo1.GetCenter(xyz12, hl1);
-                    double s1 = (xyz12[1] - xyz11[1]) / (2.*hl1);
-                    double c1 = (xyz12[2] - xyz11[2]) / (2.*hl1);
-                    double dist1 = -xyz11[1] * c1 + xyz11[2] * s1;
-                    double pitch1 = geom->WirePitch(plane1, tpc, cstat);
-                    const double TicksOffset1 = detprop->GetXTicksOffset(plane1,tpc,cstat);
-
-                    // Get angle, pitch, and offset of plane2 wires.
-
-                    const geo::WireGeo& wgeo2 = geom->Cryostat(cstat).TPC(tpc).Plane(plane2).Wire(0);
-                    double hl2 = wgeo2.HalfL();
-                    double xyz21[3];
-                    double xyz22[3];
-                    wgeo2.GetCenter(xyz21, -hl2);
-                    wgeo2.GetCenter(xyz22, hl2);
-                    double s2 = (xyz22[1] - xyz21[1]) / (2.*hl2);
-                    double c2 = (xyz22[2] - xyz21[2]) / (2.*hl2);
-                    double dist2 = -xyz21[1] * c2 + xyz21[2] * s2;
-                    double pitch2 = geom->WirePitch(plane2, tpc, cstat);
-                    const double TicksOffset2 = detprop->GetXTicksOffset(plane2,tpc,cstat);
-
-                    // Get angle, pitch, and offset of plane3 wires.
-
-                    const geo::WireGeo& wgeo3 = geom->Cryostat(cstat).TPC(tpc).Plane(plane3).Wire(0);
-                    double hl3 = wgeo3.HalfL();
-                    double xyz31[3];
-                    double xyz32[3];
-                    wgeo3.GetCenter(xyz31, -hl3);
-                    wgeo3.GetCenter(xyz32, hl3);
-                    double s3 = (xyz32[1] - xyz31[1]) / (2.*hl3);
-                    double c3 = (xyz32[2] - xyz31[2]) / (2.*hl3);
-                    double dist3 = -xyz31[1] * c3 + xyz31[2] * s3;
-                    double pitch3 = geom->WirePitch(plane3, tpc, cstat);
-                    const double TicksOffset3 = detprop->GetXTicksOffset(plane3,tpc,cstat);
-
-                    // Get sine of angle differences.
-
-                    double s12 = s1 * c2 - s2 * c1;   // sin(theta1 - theta2).
-                    double s23 = s2 * c3 - s3 * c2;   // sin(theta2 - theta3).
-                    double s31 = s3 * c1 - s1 * c3;   // sin(theta3 - theta1).
-
-                    // Loop over hits in plane1.
-
-                    std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                    ihit1 = hitmap[cstat][tpc][plane1].begin(),
-                    ihit1end = hitmap[cstat][tpc][plane1].end();
-                    for(; ihit1 != ihit1end; ++ihit1) {
-
-                        unsigned int wire1 = ihit1->first;
-                        const art::Ptr<recob::Hit>& phit1 = ihit1->second;
-                        geo::WireID phit1WireID = phit1->WireID();
-                        const geo::WireGeo& wgeo = geom->WireIDToWireGeo(phit1WireID);
-
-                        // Get endpoint coordinates of this wire from plane1.
-                        // (kept as assertions for performance reasons)
-                        assert(phit1WireID.Cryostat == cstat);
-                        assert(phit1WireID.TPC == tpc);
-                        assert(phit1WireID.Plane == plane1);
-                        assert(phit1WireID.Wire == wire1);
-                        double hl1 = wgeo.HalfL();
-                        double xyz1[3];
-                        double xyz2[3];
-                        wgeo.GetCenter(xyz1, -hl1);
-                        wgeo.GetCenter(xyz2, hl1);
-
-                        // Get corrected time and oblique coordinate of first hit.
-
-                        double t1 = phit1->PeakTime() - TicksOffset1;
-                        double u1 = wire1 * pitch1 + dist1;
-
-                        // Find the plane2 wire numbers corresponding to the endpoints.
-
-                        double wire21 = (-xyz1[1] * c2 + xyz1[2] * s2 - dist2) / pitch2;
-                        double wire22 = (-xyz2[1] * c2 + xyz2[2] * s2 - dist2) / pitch2;
-
-                        int wmin = std::max(0., std::min(wire21, wire22));
-                        int wmax = std::max(0., std::max(wire21, wire22) + 1.);
-
-                        std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                        ihit2 = hitmap[cstat][tpc][plane2].lower_bound(wmin),
-                        ihit2end = hitmap[cstat][tpc][plane2].upper_bound(wmax);
-
-                        for(; ihit2 != ihit2end; ++ihit2) {
-
-                            int wire2 = ihit2->first;
-                            const art::Ptr<recob::Hit>& phit2 = ihit2->second;
-
-                            // Get corrected time of second hit.
-
-                            double t2 = phit2->PeakTime() - TicksOffset2;
-
-                            // Check maximum time difference with first hit.
-
-                            bool dt12ok = std::abs(t1-t2) <= fMaxDT;
-                            if(dt12ok) {
-
-                                // Test first two hits for compatibility before looping
-                                // over third hit.
-
-                                hitvec.clear();
-                                hitvec.push_back(phit1);
-                                hitvec.push_back(phit2);
-                                bool h12ok = compatible(hitvec, useMC);
-                                if(h12ok) {
-
-                                    // Get oblique coordinate of second hit.
-
-                                    double u2 = wire2 * pitch2 + dist2;
-
-                                    // Predict plane3 oblique coordinate and wire number.
-
-                                    double u3pred = (-u1*s23 - u2*s31) / s12;
-                                    double w3pred = (u3pred - dist3) / pitch3;
-                                    double w3delta = std::abs(fMaxS / (s12 * pitch3));
-                                    int w3min = std::max(0., std::ceil(w3pred - w3delta));
-                                    int w3max = std::max(0., std::floor(w3pred + w3delta));
-
-                                    std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                    ihit3 = hitmap[cstat][tpc][plane3].lower_bound(w3min),
-                                    ihit3end = hitmap[cstat][tpc][plane3].upper_bound(w3max);
-
-                                    for(; ihit3 != ihit3end; ++ihit3) {
+        // Find the compatible hit combinations of each TPC.
+        // TPCs are independent, so they can be searched concurrently.
+        // Space points are filled below in TPC order, so their ids and
+        // order are the same either way.  With mc truth the search
+        // uses fHitMCMap and services, so it stays serial.
+
+        const geo::GeometryCore& geocore = *lar::providerFrom<geo::Geometry>();
+        std::vector<TPCCandidates> cands(tpcs.size());
+
+        auto searchTPC = [&](size_t i)
+            {
+                unsigned int cstat = tpcs[i].first;
+                unsigned int tpc = tpcs[i].second;
+                findCandidates(geocore, cstat, tpc, planehits[cstat][tpc], useMC, cands[i]);
+            };
+
+        if(fParallelTPCs && !useMC) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, tpcs.size(), 1),
+                              [&](const tbb::blocked_range<size_t>& r)
+                              {
+                                  for(size_t i = r.begin(); i != r.end(); ++i) searchTPC(i);
+                              });
+        }
+        else {
+            for(size_t i = 0; i < tpcs.size(); ++i) searchTPC(i);
+        }
 
-                                        int wire3 = ihit3->first;
-                                        const art::Ptr<recob::Hit>& phit3 = ihit3->second;
+        // Loop over TPCs.
+        size_t itpc = 0;
+        for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
+            for(unsigned int tpc = 0; tpc < geom->Cryostat(cstat).NTPC(); ++tpc, ++itpc) {
 
-                                        // Get corrected time of third hit.
+                const TPCCandidates& tpccands = cands[itpc];
 
-                                        double t3 = phit3->PeakTime() - TicksOffset3;
+                // Produce space points for compatible hit-pairs.
 
-                                        // Check time difference of third hit compared to first two hits.
+                for(const art::PtrVector<recob::Hit>& hitvec : tpccands.pairs) {
 
-                                        bool dt123ok = std::abs(t1-t3) <= fMaxDT && std::abs(t2-t3) <= fMaxDT;
-                                        if(dt123ok) {
+                    // Add a space point.
 
-                                            // Get oblique coordinate of third hit and check spatial separation.
+                    ++n2;
 
-                                            double u3 = wire3 * pitch3 + dist3;
-                                            double S = s23 * u1 + s31 * u2 + s12 * u3;
-                                            bool sok = std::abs(S) <= fMaxS;
-                                            if(sok) {
+                    // make a dummy vector of recob::SpacePoints
+                    // as we are filtering or merging and don't want to
+                    // add the created SpacePoint to the final collection just yet
+                    // This dummy vector will hold just one recob::SpacePoint,
+                    // which will go into the multimap and then the vector
+                    // will go out of scope.
 
-                                                // Test triplet for compatibility.
+                    std::vector<recob::SpacePoint> sptv;
+                    fillSpacePoint(hitvec, sptv, sptmap.size());
+                    sptkey_type key = &*hitvec[1];
+                    sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
+                    sptkeys.insert(key);
+                }
 
-                                                hitvec.clear();
-                                                hitvec.push_back(phit1);
-                                                hitvec.push_back(phit2);
-                                                hitvec.push_back(phit3);
-                                                bool h123ok = compatible(hitvec,  useMC);
-                                                if(h123ok) {
+                // Produce space points for compatible triplets.
 
-                                                    // Add a space point.
+                for(const art::PtrVector<recob::Hit>& hitvec : tpccands.triplets) {
 
-                                                    ++n3;
+                    // Add a space point.
 
-                                                    // make a dummy vector of recob::SpacePoints
-                                                    // as we are filtering or merging and don't want to
-                                                    // add the created SpacePoint to the final collection just yet
-                                                    // This dummy vector will hold just one recob::SpacePoint,
-                                                    // which will go into the multimap and then the vector
-                                                    // will go out of scope.
+                    ++n3;
 
-                                                    std::vector<recob::SpacePoint> sptv;
-                                                    fillSpacePoint(hitvec, sptv, sptmap.size()-1);
-                                                    sptkey_type key = &*phit3;
-                                                    sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
-                                                    sptkeys.insert(key);
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }// end if fMinViews <= 3
+                    std::vector<recob::SpacePoint> sptv;
+                    fillSpacePoint(hitvec, sptv, sptmap.size()-1);
+                    sptkey_type key = &*hitvec[2];
+                    sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
+                    sptkeys.insert(key);
+                }
 
                 // Do Filtering.
 
@@ -22,6 +22,8 @@
 /// Merge - Merge space points flag.
 /// PreferColl - Collection view will be used for filtering and merging, and
 ///              space points will be sorted by collection wire.
+/// ParallelTPCs - Search the hit combinations of each TPC concurrently
+///                (not with mc truth).
 ///
 /// The parameters fMaxDT and fMaxS are used to implement a notion of whether
 /// the input hits are compatible with being a space point.  Parameter
@@ -37,6 +39,12 @@
 /// comparing times in different planes, and before converting time
 /// to distance.
 ///
+/// Within each plane, hits are indexed by wire and, on each wire, by
+/// corrected time, so that only hits inside the time window of a
+/// candidate are tested.  Wire geometry used by the compatibility
+/// test is computed once per wire.  The space points (and their ids)
+/// are the same as from the plain loops over all hit combinations.
+///
 /// If enabled, filtering eliminates multiple space points with similar
 /// times on the same wire of the most popluated plane.
 ///
@@ -60,6 +68,7 @@
 
 #include "canvas/Persistency/Common/PtrVector.h"
 namespace fhicl { class ParameterSet; }
+namespace geo { class GeometryCore; }
 
 namespace trkf{
   class KHitTrack;
@@ -87,6 +96,7 @@ namespace trkf {
     bool enableU() const {return fEnableU;}
     bool enableV() const {return fEnableV;}
     bool enableW() const {return fEnableW;}
+    bool parallelTPCs() const {return fParallelTPCs;}
 
     // Update configuration parameters.
     void reconfigure(const fhicl::ParameterSet& pset);
@@ -143,6 +153,32 @@ namespace trkf {
 
   private:
 
+    // Hits of one plane of one TPC, ordered by wire (hits on the same
+    // wire keep their input order), with a time index on each wire.
+    struct PlaneHits
+    {
+      std::vector<art::Ptr<recob::Hit> > hits;   ///< Hits, ordered by wire.
+      std::vector<const recob::Hit*> phits;      ///< Hit pointers (same order).
+      std::vector<unsigned int> wires;           ///< Wire number of each hit.
+      std::vector<double> times;                 ///< Peak time minus plane tick offset.
+      std::vector<unsigned int> byTime;          ///< Hit positions ordered by wire, then time.
+    };
+
+    // Compatible hit combinations of one TPC, in search order.
+    struct TPCCandidates
+    {
+      std::vector<art::PtrVector<recob::Hit> > pairs;     ///< Two-view combinations.
+      std::vector<art::PtrVector<recob::Hit> > triplets;  ///< Three-view combinations.
+    };
+
+    // Find the compatible combinations of hits of one TPC.
+    // Does not use any service unless useMC is true.
+    void findCandidates(const geo::GeometryCore& geom,
+                        unsigned int cstat, unsigned int tpc,
+                        const std::vector<PlaneHits>& planes,
+                        bool useMC,
+                        TPCCandidates& cands) const;
+
     // This is the real method for calculating space points (each of
     // the public make*SpacePoints methods comes here).
     void makeSpacePoints(const art::PtrVector<recob::Hit>& hits,
@@ -160,6 +196,7 @@ namespace trkf {
     bool fFilter;           ///< Filter flag.
     bool fMerge;            ///< Merge flag.
     bool fPreferColl;       ///< Sort by collection wire.
+    bool fParallelTPCs;     ///< Search TPCs concurrently.
     double fTickOffsetU;    ///< Tick offset for plane U.
     double fTickOffsetV;    ///< Tick offset for plane V.
     double fTickOffsetW;    ///< Tick offset for plane W.
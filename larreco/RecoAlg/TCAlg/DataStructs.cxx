@@ -1,16 +1,40 @@
 #include "larreco/RecoAlg/TCAlg/DataStructs.h"
 
+#include <utility>
 #include <vector>
 
 namespace tca {
 
-  TCEvent evt;
-  TCConfig tcc;
-  std::vector<TjForecast> tjfs;
+  thread_local TCEvent evt;
+  thread_local TCConfig tcc;
+  thread_local std::vector<TjForecast> tjfs;
   ShowerTreeVars stv;
   // vector of hits, tjs, etc in each slice
-  std::vector<TCSlice> slices;
-  std::vector<TrajPoint> seeds;
+  thread_local std::vector<TCSlice> slices;
+  thread_local std::vector<TrajPoint> seeds;
+
+  ////////////////////////////////////////////////
+  TCContextScope::TCContextScope(TCContext& context) : fContext(context)
+  {
+    Swap();
+  } // TCContextScope
+
+  ////////////////////////////////////////////////
+  TCContextScope::~TCContextScope()
+  {
+    Swap();
+  } // ~TCContextScope
+
+  ////////////////////////////////////////////////
+  void TCContextScope::Swap()
+  {
+    // only the vector buffers change hands so this is cheap
+    std::swap(evt, fContext.evt);
+    std::swap(tcc, fContext.tcc);
+    tjfs.swap(fContext.tjfs);
+    slices.swap(fContext.slices);
+    seeds.swap(fContext.seeds);
+  } // Swap
 
   const std::vector<std::string> AlgBitNames {
     "MaskHits",
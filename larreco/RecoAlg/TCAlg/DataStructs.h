@@ -620,15 +620,45 @@ namespace tca {
     bool isValid {false};                 // set false if this slice failed reconstruction
    };
 
-  extern TCEvent evt;
-  extern TCConfig tcc;
-  extern ShowerTreeVars stv;
-  extern std::vector<TjForecast> tjfs;
+  // The working state of the algorithm. Each thread has its own copy of evt, tcc, tjfs,
+  // slices and seeds so that independent slices can be reconstructed concurrently.
+  // TrajClusterAlg keeps its state in a TCContext and installs it on the calling thread
+  // with a TCContextScope
+  extern thread_local TCEvent evt;
+  extern thread_local TCConfig tcc;
+  extern thread_local std::vector<TjForecast> tjfs;
 
   // vector of hits, tjs, etc in each slice
-  extern std::vector<TCSlice> slices;
+  extern thread_local std::vector<TCSlice> slices;
   // vector of seed TPs
-  extern std::vector<TrajPoint> seeds;
+  extern thread_local std::vector<TrajPoint> seeds;
+
+  // Shower tree variables are only filled when the tree is saved, which requires
+  // slices to be reconstructed serially, so they are shared by all threads
+  extern ShowerTreeVars stv;
+
+  // working state of the algorithm that is not in use by a thread
+  struct TCContext {
+    TCEvent evt;
+    TCConfig tcc;
+    std::vector<TjForecast> tjfs;
+    std::vector<TCSlice> slices;
+    std::vector<TrajPoint> seeds;
+  };
+
+  // Swaps the state in a TCContext with the state of the current thread for the
+  // lifetime of the scope. Scopes on one thread must be nested and a context must
+  // not be installed twice
+  class TCContextScope {
+    public:
+    explicit TCContextScope(TCContext& context);
+    ~TCContextScope();
+    TCContextScope(TCContextScope const&) = delete;
+    TCContextScope& operator= (TCContextScope const&) = delete;
+    private:
+    void Swap();
+    TCContext& fContext;
+  };
 
 } // namespace tca
 
@@ -20,6 +20,7 @@
 #include <iomanip>
 #include <iostream>
 #include <limits.h>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,6 +35,11 @@ struct SortEntry{
 bool greaterThan (SortEntry c1, SortEntry c2) { return (c1.length > c2.length);}
 bool lessThan (SortEntry c1, SortEntry c2) { return (c1.length < c2.length);}
 
+namespace {
+  // the MVA reader is shared by all threads that reconstruct slices
+  std::mutex showerParentReaderMutex;
+}
+
 namespace tca {
 
   ////////////////////////////////////////////////
@@ -1857,7 +1863,13 @@ namespace tca {
       tcc.showerParentVars[6] = acos(costh2);
       tcc.showerParentVars[7] = chgFrac;
       tcc.showerParentVars[8] = prob;
-      float candParFOM = tcc.showerParentReader->EvaluateMVA("BDT");
+      float candParFOM = 0;
+      {
+        // pass the variables explicitly since the reader is bound to the variables
+        // of the thread that configured it
+        std::lock_guard<std::mutex> lock(showerParentReaderMutex);
+        candParFOM = tcc.showerParentReader->EvaluateMVA(tcc.showerParentVars, "BDT");
+      }
 /*
       // use the overall pfp direction instead of the starting direction. It may not be so
       // good if the shower develops quickly
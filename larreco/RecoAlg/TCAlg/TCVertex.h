@@ -18,12 +18,6 @@
 
 namespace tca {
 
-  extern TCEvent evt;
-  extern TCConfig tcc;
-//  extern HistStuff hist;
-  // vector of hits, tjs, etc in each slice
-  extern std::vector<TCSlice> slices;
-
   void MakeJunkVertices(TCSlice& slc, const CTP_t& inCTP);
   void Find2DVertices(TCSlice& slc, const CTP_t& inCTP, unsigned short pass);
   void MakeJunkTjVertices(TCSlice& slc, const CTP_t& inCTP);
@@ -35,7 +35,7 @@
 
 bool trkf::TrackKalmanFitter::fitTrack(const recob::TrackTrajectory& traj, const int tkID, const SMatrixSym55& covVtx, const SMatrixSym55& covEnd,
 				       const std::vector<art::Ptr<recob::Hit> >& hits, const double pval, const int pdgid, const bool flipDirection,
-				       recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const {
+				       recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals, Workspace& ws) const {
   auto position = traj.Vertex();
   auto direction = traj.VertexDirection();
 
@@ -44,13 +44,13 @@ bool trkf::TrackKalmanFitter::fitTrack(const recob::TrackTrajectory& traj, const
     std::vector<art::Ptr<recob::Hit> > fwdHits;
     trkmkr::OptionalOutputs fwdoptionals;
     SMatrixSym55 fwdcov = covVtx;
-    bool okfwd = fitTrack(position, direction, fwdcov, hits, traj.Flags(), tkID, pval, pdgid, fwdTrack, fwdHits, fwdoptionals);
+    bool okfwd = fitTrack(position, direction, fwdcov, hits, traj.Flags(), tkID, pval, pdgid, fwdTrack, fwdHits, fwdoptionals, ws);
 
     recob::Track bwdTrack;
     std::vector<art::Ptr<recob::Hit> > bwdHits;
     trkmkr::OptionalOutputs bwdoptionals;
     SMatrixSym55 bwdcov = covEnd;
-    bool okbwd = fitTrack(position, -direction, bwdcov, hits, traj.Flags(), tkID, pval, pdgid, bwdTrack, bwdHits, bwdoptionals);
+    bool okbwd = fitTrack(position, -direction, bwdcov, hits, traj.Flags(), tkID, pval, pdgid, bwdTrack, bwdHits, bwdoptionals, ws);
 
     if (okfwd==false && okbwd==false) {
       return false;
@@ -82,14 +82,15 @@ bool trkf::TrackKalmanFitter::fitTrack(const recob::TrackTrajectory& traj, const
 
     auto trackStateCov = (flipDirection ? covEnd : covVtx );
 
-    return fitTrack(position, direction, trackStateCov, hits, traj.Flags(), tkID, pval, pdgid, outTrack, outHits, optionals);
+    return fitTrack(position, direction, trackStateCov, hits, traj.Flags(), tkID, pval, pdgid, outTrack, outHits, optionals, ws);
   }
 }
 
 bool trkf::TrackKalmanFitter::fitTrack(const Point_t& position, const Vector_t& direction, SMatrixSym55& trackStateCov,
 				       const std::vector<art::Ptr<recob::Hit> >& hits, const std::vector<recob::TrajectoryPointFlags>& flags,
 				       const int tkID, const double pval, const int pdgid,
-				       recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const {
+				       recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals, Workspace& ws) const {
+  ws.counters.fits++;
   if (dumpLevel_>1) std::cout << "Fitting track with tkID=" << tkID
                              << " start pos=" << position << " dir=" << direction
                              << " nHits=" << hits.size()
@@ -98,6 +99,7 @@ bool trkf::TrackKalmanFitter::fitTrack(const Point_t& position, const Vector_t&
                              << std::endl;
   if (hits.size()<4) {
     mf::LogWarning("TrackKalmanFitter") << "Fit failure at " << __FILE__ << " " << __LINE__;
+    ws.counters.failedFits++;
     return false;
   }
 
@@ -105,32 +107,33 @@ bool trkf::TrackKalmanFitter::fitTrack(const Point_t& position, const Vector_t&
   KFTrackState trackState = setupInitialTrackState(position, direction, trackStateCov, pval, pdgid);
 
   // setup vector of HitStates and flags, with either same or inverse order as input hit vector
-  // this is what we'll loop over during the fit
-  std::vector<HitState>                            hitstatev;
-  std::vector<recob::TrajectoryPointFlags::Mask_t> hitflagsv;
-  bool inputok = setupInputStates(hits, flags, trackState, hitstatev, hitflagsv);
-  if (!inputok) return false;
-
-  // track and index vectors we use to store the fit results
-  std::vector<KFTrackState> fwdPrdTkState;
-  std::vector<KFTrackState> fwdUpdTkState;
-  std::vector<unsigned int> hitstateidx;
-  std::vector<unsigned int> rejectedhsidx;
-  std::vector<unsigned int> sortedtksidx;
+  // this is what we'll loop over during the fit; the vectors of the workspace keep their capacity from previous tracks
+  ws.hitstatev.clear();
+  ws.hitflagsv.clear();
+  ws.hitstatev.reserve(hits.size());
+  ws.hitflagsv.reserve(hits.size());
+  bool inputok = setupInputStates(hits, flags, trackState, ws.hitstatev, ws.hitflagsv);
+  if (!inputok) {
+    ws.counters.failedFits++;
+    return false;
+  }
 
   // do the actual fit
-  bool fitok = doFitWork(trackState, hitstatev, hitflagsv, fwdPrdTkState, fwdUpdTkState, hitstateidx, rejectedhsidx, sortedtksidx);
+  bool fitok = doFitWork(trackState, ws);
   if (!fitok && (skipNegProp_ || cleanZigzag_) && tryNoSkipWhenFails_) {
     mf::LogWarning("TrackKalmanFitter") << "Trying to recover with skipNegProp = false and cleanZigzag = false\n";
-    fitok = doFitWork(trackState, hitstatev, hitflagsv, fwdPrdTkState, fwdUpdTkState, hitstateidx, rejectedhsidx, sortedtksidx, false);
+    fitok = doFitWork(trackState, ws, false);
   }
   if (!fitok) {
     mf::LogWarning("TrackKalmanFitter") << "Fit failed for track with ID=" << tkID << "\n";
+    ws.counters.failedFits++;
     return false;
   }
 
   // fill the track, the output hit vector, and the optional output products
-  bool fillok = fillResult(hits, tkID, pdgid, hitstatev, hitflagsv, fwdPrdTkState, fwdUpdTkState, hitstateidx, rejectedhsidx, sortedtksidx, outTrack, outHits, optionals);
+  bool fillok = fillResult(hits, tkID, pdgid, ws, outTrack, outHits, optionals);
+  if (fillok) ws.counters.rejectedHits += ws.rejectedhsidx.size();
+  else ws.counters.failedFits++;
   return fillok;
 }
 
@@ -191,6 +194,35 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
 					std::vector<KFTrackState>& fwdPrdTkState, std::vector<KFTrackState>& fwdUpdTkState,
 					std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx, std::vector<unsigned int>& sortedtksidx,
 					bool applySkipClean) const {
+  // move the vectors in and out of a workspace
+  Workspace ws;
+  ws.hitstatev.swap(hitstatev);
+  ws.hitflagsv.swap(hitflagsv);
+  ws.fwdPrdTkState.swap(fwdPrdTkState);
+  ws.fwdUpdTkState.swap(fwdUpdTkState);
+  ws.hitstateidx.swap(hitstateidx);
+  ws.rejectedhsidx.swap(rejectedhsidx);
+  ws.sortedtksidx.swap(sortedtksidx);
+  const bool fitok = doFitWork(trackState, ws, applySkipClean);
+  hitstatev.swap(ws.hitstatev);
+  hitflagsv.swap(ws.hitflagsv);
+  fwdPrdTkState.swap(ws.fwdPrdTkState);
+  fwdUpdTkState.swap(ws.fwdUpdTkState);
+  hitstateidx.swap(ws.hitstateidx);
+  rejectedhsidx.swap(ws.rejectedhsidx);
+  sortedtksidx.swap(ws.sortedtksidx);
+  return fitok;
+}
+
+bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, Workspace& ws, bool applySkipClean) const {
+
+  auto& hitstatev = ws.hitstatev;
+  auto& hitflagsv = ws.hitflagsv;
+  auto& fwdPrdTkState = ws.fwdPrdTkState;
+  auto& fwdUpdTkState = ws.fwdUpdTkState;
+  auto& hitstateidx = ws.hitstateidx;
+  auto& rejectedhsidx = ws.rejectedhsidx;
+  auto& sortedtksidx = ws.sortedtksidx;
 
   fwdPrdTkState.clear();
   fwdUpdTkState.clear();
@@ -208,7 +240,9 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
   if (sortHitsByPlane_) {
     //array of hit indices in planes, keeping the original sorting by plane
     const unsigned int nplanes = geom->MaxPlanes();
-    std::vector<std::vector<unsigned int> > hitsInPlanes(nplanes);
+    auto& hitsInPlanes = ws.hitsInPlanes;
+    hitsInPlanes.resize(nplanes);
+    for (auto& hitsInPlane : hitsInPlanes) hitsInPlane.clear();
     for (unsigned int ihit = 0; ihit<hitstatev.size(); ihit++) {
       hitsInPlanes[hitstatev[ihit].wireId().Plane].push_back(ihit);
     }
@@ -216,13 +250,13 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
       for (unsigned int iplane=0; iplane<nplanes; ++iplane) {
 	if ( geom->Plane(iplane).GetIncreasingWireDirection<Vector_t>().Dot(trackState.momentum())>0 ) {
          std::sort(hitsInPlanes[iplane].begin(), hitsInPlanes[iplane].end(),
-                   [hitstatev](const unsigned int& a, const unsigned int& b) -> bool
+                   [&hitstatev](const unsigned int& a, const unsigned int& b) -> bool
                    {
                      return hitstatev[a].wireId().Wire < hitstatev[b].wireId().Wire;
                    });
        } else {
          std::sort(hitsInPlanes[iplane].begin(), hitsInPlanes[iplane].end(),
-                   [hitstatev](const unsigned int& a, const unsigned int& b) -> bool
+                   [&hitstatev](const unsigned int& a, const unsigned int& b) -> bool
                    {
                      return hitstatev[a].wireId().Wire > hitstatev[b].wireId().Wire;
                    });
@@ -233,7 +267,7 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
     //dump hits sorted in each plane
     if (dumpLevel_>1) {
       int ch = 0;
-      for (auto p : hitsInPlanes) {
+      for (const auto& p : hitsInPlanes) {
 	for (auto h : p) {
 	  std::cout << "hit #/Plane/Wire/x/mask: " << ch++ << " " << hitstatev[h].wireId().Plane << " " << hitstatev[h].wireId().Wire << " " << hitstatev[h].hitMeas() << " " << hitflagsv[h] << std::endl;
 	}
@@ -241,7 +275,8 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
     }
 
     //array of indices, where iterHitsInPlanes[i] is the iterator over hitsInPlanes[i]
-    std::vector<unsigned int> iterHitsInPlanes(nplanes,0);
+    auto& iterHitsInPlanes = ws.iterHitsInPlanes;
+    iterHitsInPlanes.assign(nplanes,0);
     for (unsigned int p = 0; p<hitstatev.size(); ++p) {
       if (dumpLevel_>1) std::cout << std::endl << "processing hit #" << p << std::endl;
       if (dumpLevel_>1) std::cout << "hit sizes: rej=" << rejectedhsidx.size() << " good=" << hitstateidx.size() << " input=" <<  hitstatev.size() << std::endl;
@@ -300,9 +335,11 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
       //propagate to measurement surface
       bool propok = true;
       trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate->plane(), true, true, TrackStatePropagator::FORWARD);
+      ws.counters.propagations++;
       if (!propok && !(applySkipClean && fwdUpdTkState.size()>0 && skipNegProp_)) {
 	if (dumpLevel_>1) std::cout << "attempt backward prop" << std::endl;
 	trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate->plane(), true, true, TrackStatePropagator::BACKWARD);
+	ws.counters.propagations++;
       }
       if (dumpLevel_>1) {
 	std::cout << "hit state " << std::endl; hitstate->dump();
@@ -381,6 +418,7 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
 	}
 	//now update the forward fitted track
 	bool upok = trackState.updateWithHitState(*hitstate);
+	ws.counters.updates++;
 	if (upok==0) {
 	  mf::LogWarning("TrackKalmanFitter") << "Fit failure at " << __FILE__ << " " << __LINE__;
 	  return false;
@@ -424,7 +462,11 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
       //propagate to measurement surface
       bool propok = true;
       trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::FORWARD);
-      if (!propok && !(applySkipClean && skipNegProp_)) trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::BACKWARD);
+      ws.counters.propagations++;
+      if (!propok && !(applySkipClean && skipNegProp_)) {
+	trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::BACKWARD);
+	ws.counters.propagations++;
+      }
       if (propok) {
 	hitstateidx.push_back(ihit);
 	fwdPrdTkState.push_back(trackState);
@@ -449,6 +491,7 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
 	}
 	//
 	bool upok = trackState.updateWithHitState(hitstate);
+	ws.counters.updates++;
 	if (upok==0) {
 	  mf::LogWarning("TrackKalmanFitter") << "Fit failure at " << __FILE__ << " " << __LINE__;
 	  return false;
@@ -490,7 +533,11 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
     }
     bool propok = true;
     trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::BACKWARD);
-    if (!propok) trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::FORWARD);//do we want this?
+    ws.counters.propagations++;
+    if (!propok) {
+      trackState = propagator->propagateToPlane(propok, trackState.trackState(), hitstate.plane(), true, true, TrackStatePropagator::FORWARD);//do we want this?
+      ws.counters.propagations++;
+    }
     //
     if (dumpLevel_>1) {
       std::cout << "propagation result=" << propok << std::endl;
@@ -518,6 +565,7 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
 	  std::cout << "combined upd state " << std::endl; fwdUpdTrackState.dump();
 	}
 	bool upok = trackState.updateWithHitState(hitstate);
+	ws.counters.updates++;
 	if (upok==0) {
 	  mf::LogWarning("TrackKalmanFitter") << "Fit failure at " << __FILE__ << " " << __LINE__;
 	  return false;
@@ -552,7 +600,7 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
   if (dumpLevel_>1) std::cout << "sort output with nvalidhits=" << nvalidhits << std::endl;
 
   // sort output states
-  sortOutput(hitstatev, fwdUpdTkState, hitstateidx, rejectedhsidx, sortedtksidx, hitflagsv, applySkipClean);
+  sortOutput(ws, applySkipClean);
   size_t nsortvalid = 0;
   for (auto& idx : sortedtksidx) {
     auto& hitflags = hitflagsv[hitstateidx[idx]];
@@ -567,26 +615,33 @@ bool trkf::TrackKalmanFitter::doFitWork(KFTrackState& trackState, std::vector<Hi
   return true;
 }
 
-void trkf::TrackKalmanFitter::sortOutput(std::vector<HitState>& hitstatev, std::vector<KFTrackState>& fwdUpdTkState,
-					 std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx,
-					 std::vector<unsigned int>& sortedtksidx, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv, bool applySkipClean) const {
+void trkf::TrackKalmanFitter::sortOutput(Workspace& ws, bool applySkipClean) const {
+  //
+  auto& hitstatev = ws.hitstatev;
+  auto& hitflagsv = ws.hitflagsv;
+  auto& fwdUpdTkState = ws.fwdUpdTkState;
+  auto& hitstateidx = ws.hitstateidx;
+  auto& rejectedhsidx = ws.rejectedhsidx;
+  auto& sortedtksidx = ws.sortedtksidx;
   //
   if (sortOutputHitsMinLength_) {
     //sort hits keeping fixed the order on planes and picking the closest next plane
     const unsigned int nplanes = geom->MaxPlanes();
-    std::vector<std::vector<unsigned int> > tracksInPlanes(nplanes);
+    auto& tracksInPlanes = ws.tracksInPlanes;
+    tracksInPlanes.resize(nplanes);
+    for (auto& tracksInPlane : tracksInPlanes) tracksInPlane.clear();
     for (unsigned int p = 0; p<hitstateidx.size(); ++p) {
       const auto& hitstate = hitstatev[hitstateidx[p]];
       tracksInPlanes[hitstate.wireId().Plane].push_back(p);
     }
     if (dumpLevel_>2) {
-      for (auto s : fwdUpdTkState) {
+      for (const auto& s : fwdUpdTkState) {
 	std::cout << "state pos=" << s.position() << std::endl;
       }
     }
     //find good starting point
-    std::vector<unsigned int> iterTracksInPlanes;
-    for (auto it : tracksInPlanes) iterTracksInPlanes.push_back(0);
+    auto& iterTracksInPlanes = ws.iterTracksInPlanes;
+    iterTracksInPlanes.assign(nplanes,0);
     auto pos = fwdUpdTkState.front().position();
     auto dir = fwdUpdTkState.front().momentum();
     unsigned int p = 0;
@@ -641,7 +696,6 @@ void trkf::TrackKalmanFitter::sortOutput(std::vector<HitState>& hitstatev, std::
   }
   //
   if (applySkipClean && cleanZigzag_) {
-    std::vector<unsigned int> itoerase;
     bool clean = false;
     while (!clean) {
       bool broken = false;
@@ -671,11 +725,15 @@ void trkf::TrackKalmanFitter::sortOutput(std::vector<HitState>& hitstatev, std::
 }
 
 
-bool trkf::TrackKalmanFitter::fillResult(const std::vector<art::Ptr<recob::Hit> >& inHits, const int tkID, const int pdgid,
-					 std::vector<HitState>& hitstatev, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv,
-					 std::vector<KFTrackState>& fwdPrdTkState, std::vector<KFTrackState>& fwdUpdTkState,
-					 std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx, std::vector<unsigned int>& sortedtksidx,
+bool trkf::TrackKalmanFitter::fillResult(const std::vector<art::Ptr<recob::Hit> >& inHits, const int tkID, const int pdgid, Workspace& ws,
 					 recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const {
+  const auto& hitstatev = ws.hitstatev;
+  auto& hitflagsv = ws.hitflagsv;
+  const auto& fwdPrdTkState = ws.fwdPrdTkState;
+  auto& fwdUpdTkState = ws.fwdUpdTkState;
+  const auto& hitstateidx = ws.hitstateidx;
+  const auto& rejectedhsidx = ws.rejectedhsidx;
+  const auto& sortedtksidx = ws.sortedtksidx;
   // fill output trajectory objects with smoothed track and its hits
   int nvalidhits = 0;
   trkmkr::TrackCreationBookKeeper tcbk(outHits, optionals, tkID, pdgid, true);
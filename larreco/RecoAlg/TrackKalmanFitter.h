@@ -10,6 +10,8 @@
 #include "lardata/RecoObjects/KFTrackState.h"
 #include "lardataobj/RecoBase/TrajectoryPointFlags.h"
 
+#include "tbb/enumerable_thread_specific.h"
+
 namespace recob {
   class Hit;
   class Track;
@@ -39,6 +41,10 @@ namespace trkf {
    *
    * For configuration options see TrackKalmanFitter#Config
    *
+   * The buffers used during the fit are kept in a TrackKalmanFitter::Workspace, which is reused across tracks.
+   * Unless the caller provides its own, each thread fitting tracks gets one, so that concurrent calls to fitTrack are safe.
+   * The workspaces also count the operations of the fits, see TrackKalmanFitter::counters().
+   *
    * @author  G. Cerati (FNAL, MicroBooNE)
    * @date    2017
    * @version 1.0
@@ -144,6 +150,37 @@ namespace trkf {
     };
     using Parameters = fhicl::Table<Config>;
 
+    /// Counters of the fit operations
+    struct FitCounters {
+      size_t fits = 0;          ///< calls to fitTrack with a starting position and direction
+      size_t failedFits = 0;    ///< fits returning false
+      size_t propagations = 0;  ///< propagations of the track state to a hit plane, forward and backward
+      size_t updates = 0;       ///< updates of the track state with a hit, forward and backward
+      size_t rejectedHits = 0;  ///< hits rejected from successful fits
+      FitCounters& operator+=(const FitCounters& other) {
+	fits += other.fits; failedFits += other.failedFits; propagations += other.propagations;
+	updates += other.updates; rejectedHits += other.rejectedHits;
+	return *this;
+      }
+    };
+
+    /// Buffers used during the fit of one track, kept from one track to the next so that they are not reallocated.
+    /// A workspace can be used by one fit at a time.
+    struct Workspace {
+      std::vector<HitState>                            hitstatev;
+      std::vector<recob::TrajectoryPointFlags::Mask_t> hitflagsv;
+      std::vector<KFTrackState> fwdPrdTkState;
+      std::vector<KFTrackState> fwdUpdTkState;
+      std::vector<unsigned int> hitstateidx;
+      std::vector<unsigned int> rejectedhsidx;
+      std::vector<unsigned int> sortedtksidx;
+      std::vector<std::vector<unsigned int> > hitsInPlanes;   // used when sorting hits by plane
+      std::vector<unsigned int>               iterHitsInPlanes;
+      std::vector<std::vector<unsigned int> > tracksInPlanes; // used when sorting the output
+      std::vector<unsigned int>               iterTracksInPlanes;
+      FitCounters counters;
+    };
+
     /// Constructor from TrackStatePropagator and values of configuration parameters
     TrackKalmanFitter(const TrackStatePropagator* prop, bool useRMS, bool sortHitsByPlane, bool sortHitsByWire, bool sortOutputHitsMinLength, bool skipNegProp, bool cleanZigzag,
 		      bool rejectHighMultHits, bool rejectHitsNegativeGOF, float hitErr2ScaleFact, bool tryNoSkipWhenFails, bool tryBothDirs, bool pickBestHitOnWire,
@@ -179,20 +216,42 @@ namespace trkf {
     /// Fit track starting from TrackTrajectory
     bool fitTrack(const recob::TrackTrajectory& traj, int tkID,  const SMatrixSym55& covVtx, const SMatrixSym55& covEnd,
 		  const std::vector<art::Ptr<recob::Hit> >& hits, const double pval, const int pdgid, const bool flipDirection,
-		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const;
+		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const {
+      return fitTrack(traj, tkID, covVtx, covEnd, hits, pval, pdgid, flipDirection, outTrack, outHits, optionals, workspaces_.local());
+    }
+    bool fitTrack(const recob::TrackTrajectory& traj, int tkID,  const SMatrixSym55& covVtx, const SMatrixSym55& covEnd,
+		  const std::vector<art::Ptr<recob::Hit> >& hits, const double pval, const int pdgid, const bool flipDirection,
+		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals, Workspace& ws) const;
 
     /// Fit track starting from intial position, direction, and flags
     bool fitTrack(const Point_t& position, const Vector_t& direction, SMatrixSym55& trackStateCov,
 		  const std::vector<art::Ptr<recob::Hit> >& hits, const std::vector<recob::TrajectoryPointFlags>& flags,
 		  const int tkID, const double pval, const int pdgid,
-		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const;
+		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const {
+      return fitTrack(position, direction, trackStateCov, hits, flags, tkID, pval, pdgid, outTrack, outHits, optionals, workspaces_.local());
+    }
+    bool fitTrack(const Point_t& position, const Vector_t& direction, SMatrixSym55& trackStateCov,
+		  const std::vector<art::Ptr<recob::Hit> >& hits, const std::vector<recob::TrajectoryPointFlags>& flags,
+		  const int tkID, const double pval, const int pdgid,
+		  recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals, Workspace& ws) const;
+
+    /// Function where the core of the fit is performed, on the input states in the workspace
+    bool doFitWork(KFTrackState& trackState, Workspace& ws, bool applySkipClean = true) const;
 
-    /// Function where the core of the fit is performed
+    /// Function where the core of the fit is performed (on a temporary workspace made of the vectors given)
     bool doFitWork(KFTrackState& trackState, std::vector<HitState>& hitstatev, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv,
 		   std::vector<KFTrackState>& fwdPrdTkState, std::vector<KFTrackState>& fwdUpdTkState,
 		   std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx, std::vector<unsigned int>& sortedtksidx,
 		   bool applySkipClean = true) const;
 
+    /// Sum of the counters of the workspaces owned by the fitter (i.e. of the fits not given a workspace by the caller)
+    FitCounters counters() const {
+      FitCounters sum;
+      for (const auto& ws : workspaces_) sum += ws.counters;
+      return sum;
+    }
+    void resetCounters() { for (auto& ws : workspaces_) ws.counters = FitCounters(); }
+
   private:
     /// Return track state from intial position, direction, and covariance
     KFTrackState setupInitialTrackState(const Point_t& position, const Vector_t& direction, SMatrixSym55& trackStateCov, const double pval, const int pdgid) const;
@@ -203,15 +262,10 @@ namespace trkf {
 			  std::vector<HitState>& hitstatev, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv) const;
 
     /// Sort the output states
-    void sortOutput(std::vector<HitState>& hitstatev, std::vector<KFTrackState>& fwdUpdTkState,
-		    std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx,
-		    std::vector<unsigned int>& sortedtksidx, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv, bool applySkipClean = true) const;
+    void sortOutput(Workspace& ws, bool applySkipClean = true) const;
 
     /// Fill the output objects
-    bool fillResult(const std::vector<art::Ptr<recob::Hit> >& inHits, const int tkID, const int pdgid,
-		    std::vector<HitState>& hitstatev, std::vector<recob::TrajectoryPointFlags::Mask_t>& hitflagsv,
-		    std::vector<KFTrackState>& fwdPrdTkState, std::vector<KFTrackState>& fwdUpdTkState,
-		    std::vector<unsigned int>& hitstateidx, std::vector<unsigned int>& rejectedhsidx, std::vector<unsigned int>& sortedtksidx,
+    bool fillResult(const std::vector<art::Ptr<recob::Hit> >& inHits, const int tkID, const int pdgid, Workspace& ws,
 		    recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits, trkmkr::OptionalOutputs& optionals) const;
 
     art::ServiceHandle<geo::Geometry const> geom;
@@ -235,6 +289,7 @@ namespace trkf {
     float maxDist_;
     float negDistTolerance_;
     int dumpLevel_;
+    mutable tbb::enumerable_thread_specific<Workspace> workspaces_; // one per thread fitting with this fitter
   };
 
 }
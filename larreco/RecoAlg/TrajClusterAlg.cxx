@@ -19,6 +19,10 @@
 
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+
 namespace tca {
 
   //------------------------------------------------------------------------------
@@ -26,6 +30,8 @@ namespace tca {
   TrajClusterAlg::TrajClusterAlg(fhicl::ParameterSet const& pset)
   :fCaloAlg(pset.get<fhicl::ParameterSet>("CaloAlg")), fMVAReader("Silent")
   {
+    // configure the state that is installed whenever the algorithm is used
+    TCContextScope scope(fContext);
     tcc.showerParentReader = &fMVAReader;
     reconfigure(pset);
     tcc.caloAlg = &fCaloAlg;
@@ -102,6 +108,8 @@ namespace tca {
     tcc.vtxScoreWeights = pset.get< std::vector<float> >("VertexScoreWeights");
     tcc.match3DCuts       = pset.get< std::vector<float >>("Match3DCuts", {-1, -1, -1, -1, -1});
     tcc.pfpStitchCuts     = pset.get< std::vector<float >>("PFPStitchCuts", {-1});
+    fParallelSlices       = pset.get< bool >("ParallelSlices", false);
+    fCheckParallelSlices  = pset.get< bool >("CheckParallelSlices", false);
     // don't search for a neutrino vertex in test beam mode
     tcc.modes[kTestBeam] = pset.get<bool>("TestBeam", false);
     pset.get_if_present<std::vector<float>>("NeutralVxCuts", tcc.neutralVxCuts);
@@ -287,14 +295,203 @@ namespace tca {
     // Reconstruct everything using the hits in a slice
 
     if(slices.empty()) ++evt.eventsProcessed;
-    if(hitsInSlice.size() < 2) return;
+    if(ReconstructSlice(hitsInSlice, sliceID)) CountAlgMods(slices[slices.size() - 1]);
+  } // RunTrajClusterAlg
+
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::RunTrajClusterAlg(std::vector<std::vector<unsigned int>>& slHitsVec, std::vector<int> const& sliceIDs)
+  {
+    // Reconstruct a set of independent slices
+    if(slHitsVec.size() != sliceIDs.size()) throw art::Exception(art::errors::LogicError)<<"RunTrajClusterAlg: slice hits and slice IDs vectors have different sizes";
+
+    if(!fParallelSlices || !CanRunParallel()) {
+      for(unsigned short isl = 0; isl < slHitsVec.size(); ++isl) RunTrajClusterAlg(slHitsVec[isl], sliceIDs[isl]);
+      return;
+    }
+
+    if(slices.empty()) ++evt.eventsProcessed;
+
+    // Keep a copy of the starting state to repeat the reconstruction serially
+    TCContext serial;
+    if(fCheckParallelSlices) {
+      serial.evt = evt;
+      serial.tcc = tcc;
+      serial.slices = slices;
+    }
+
+    ReconstructSlicesInParallel(slHitsVec, sliceIDs);
+
+    if(!fCheckParallelSlices) return;
+
+    {
+      TCContextScope scope(serial);
+      // don't count the algorithm usage twice
+      auto algModCount = fAlgModCount;
+      for(unsigned short isl = 0; isl < slHitsVec.size(); ++isl) {
+        if(ReconstructSlice(slHitsVec[isl], sliceIDs[isl])) CountAlgMods(slices[slices.size() - 1]);
+      } // isl
+      fAlgModCount = algModCount;
+    }
+
+    // compare the results
+    std::string diff;
+    if(serial.slices.size() != slices.size()) diff = "number of slices";
+    if(serial.evt.globalT_UID != evt.globalT_UID || serial.evt.globalP_UID != evt.globalP_UID ||
+       serial.evt.global2V_UID != evt.global2V_UID || serial.evt.global3V_UID != evt.global3V_UID ||
+       serial.evt.global2S_UID != evt.global2S_UID || serial.evt.global3S_UID != evt.global3S_UID) diff = "UID counters";
+    for(std::size_t isl = 0; isl < slices.size() && diff.empty(); ++isl) {
+      auto const& pslc = slices[isl];
+      auto const& sslc = serial.slices[isl];
+      if(pslc.ID != sslc.ID || pslc.isValid != sslc.isValid) diff = "slice ID or validity";
+      if(diff.empty() && pslc.slHits.size() != sslc.slHits.size()) diff = "slice hits";
+      for(std::size_t iht = 0; iht < pslc.slHits.size() && diff.empty(); ++iht) {
+        if(pslc.slHits[iht].InTraj != sslc.slHits[iht].InTraj) diff = "hit -> trajectory assignment";
+      } // iht
+      if(diff.empty() && pslc.tjs.size() != sslc.tjs.size()) diff = "number of trajectories";
+      for(std::size_t itj = 0; itj < pslc.tjs.size() && diff.empty(); ++itj) {
+        auto const& ptj = pslc.tjs[itj];
+        auto const& stj = sslc.tjs[itj];
+        if(ptj.UID != stj.UID || ptj.AlgMod != stj.AlgMod || ptj.EndPt != stj.EndPt || ptj.VtxID != stj.VtxID) diff = "trajectory T" + std::to_string(stj.UID);
+      } // itj
+      if(diff.empty() && pslc.vtxs.size() != sslc.vtxs.size()) diff = "number of 2D vertices";
+      for(std::size_t ivx = 0; ivx < pslc.vtxs.size() && diff.empty(); ++ivx) {
+        if(pslc.vtxs[ivx].UID != sslc.vtxs[ivx].UID || pslc.vtxs[ivx].Pos != sslc.vtxs[ivx].Pos) diff = "2D vertex 2V" + std::to_string(sslc.vtxs[ivx].UID);
+      } // ivx
+      if(diff.empty() && pslc.vtx3s.size() != sslc.vtx3s.size()) diff = "number of 3D vertices";
+      for(std::size_t ivx = 0; ivx < pslc.vtx3s.size() && diff.empty(); ++ivx) {
+        auto const& pvx = pslc.vtx3s[ivx];
+        auto const& svx = sslc.vtx3s[ivx];
+        if(pvx.UID != svx.UID || pvx.X != svx.X || pvx.Y != svx.Y || pvx.Z != svx.Z) diff = "3D vertex 3V" + std::to_string(svx.UID);
+      } // ivx
+      if(diff.empty() && pslc.pfps.size() != sslc.pfps.size()) diff = "number of PFParticles";
+      for(std::size_t ipfp = 0; ipfp < pslc.pfps.size() && diff.empty(); ++ipfp) {
+        auto const& ppfp = pslc.pfps[ipfp];
+        auto const& spfp = sslc.pfps[ipfp];
+        if(ppfp.UID != spfp.UID || ppfp.TjIDs != spfp.TjIDs || ppfp.ParentUID != spfp.ParentUID ||
+           ppfp.DtrUIDs != spfp.DtrUIDs || ppfp.PDGCode != spfp.PDGCode) diff = "PFParticle P" + std::to_string(spfp.UID);
+      } // ipfp
+      if(diff.empty() && (pslc.cots.size() != sslc.cots.size() || pslc.showers.size() != sslc.showers.size())) diff = "number of showers";
+      for(std::size_t iss = 0; iss < pslc.showers.size() && diff.empty(); ++iss) {
+        if(pslc.showers[iss].UID != sslc.showers[iss].UID || pslc.showers[iss].Hits != sslc.showers[iss].Hits) diff = "shower 3S" + std::to_string(sslc.showers[iss].UID);
+      } // iss
+      if(!diff.empty()) diff += " in slice " + std::to_string(sslc.ID);
+    } // isl
+    if(!diff.empty()) throw art::Exception(art::errors::LogicError)<<"CheckParallelSlices: concurrent and serial reconstruction differ in "<<diff<<" in event "<<evt.event;
+    mf::LogVerbatim("TC")<<"CheckParallelSlices: concurrent and serial results of "<<slices.size()<<" slices agree in event "<<evt.event;
+  } // RunTrajClusterAlg
+
+  ////////////////////////////////////////////////
+  bool TrajClusterAlg::CanRunParallel() const
+  {
+    // The debug, study and tree-filling modes as well as the ChkInTraj algorithm use
+    // shared state so the slices must be reconstructed serially
+    if(tcc.modes[kDebug] || tcc.modes[kStudy1] || tcc.modes[kStudy2] || tcc.modes[kStudy3] || tcc.modes[kStudy4]) return false;
+    if(tcc.modes[kSaveCRTree] || tcc.modes[kSaveShowerTree]) return false;
+    if(tcc.useAlg[kChkInTraj]) return false;
+    return true;
+  } // CanRunParallel
+
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::ReconstructSlicesInParallel(std::vector<std::vector<unsigned int>>& slHitsVec, std::vector<int> const& sliceIDs)
+  {
+    // Each slice is reconstructed by a worker thread in a private copy of the event state
+    // with UID counters that start at a large offset. The slices are then appended in order
+    // with the UIDs shifted to the values they would have in a serial reconstruction. Stored
+    // values below the offset are IDs that are local to the slice and are left unchanged
+    constexpr int kWorkUID = 1 << 24;
+
+    struct SliceResult {
+      std::vector<TCSlice> slices;
+      std::array<int, 6> nUID {{0, 0, 0, 0, 0, 0}};
+      bool done {false};
+    };
+    std::vector<SliceResult> results(slHitsVec.size());
+
+    TCContext prototype;
+    prototype.evt = evt;
+    prototype.tcc = tcc;
+    tbb::enumerable_thread_specific<TCContext> workers(prototype);
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, slHitsVec.size(), 1),
+      [&](tbb::blocked_range<std::size_t> const& range) {
+        auto& work = workers.local();
+        for(std::size_t isl = range.begin(); isl != range.end(); ++isl) {
+          work.slices.clear();
+          work.evt.WorkID = 0;
+          work.evt.globalT_UID = kWorkUID;
+          work.evt.globalP_UID = kWorkUID;
+          work.evt.global2V_UID = kWorkUID;
+          work.evt.global3V_UID = kWorkUID;
+          work.evt.global2S_UID = kWorkUID;
+          work.evt.global3S_UID = kWorkUID;
+          auto& result = results[isl];
+          {
+            TCContextScope scope(work);
+            result.done = ReconstructSlice(slHitsVec[isl], sliceIDs[isl]);
+          }
+          result.slices.swap(work.slices);
+          result.nUID = {{work.evt.globalT_UID - kWorkUID, work.evt.globalP_UID - kWorkUID,
+                          work.evt.global2V_UID - kWorkUID, work.evt.global3V_UID - kWorkUID,
+                          work.evt.global2S_UID - kWorkUID, work.evt.global3S_UID - kWorkUID}};
+        } // isl
+      });
+
+    auto shift = [](auto& uid, int offset) { if((long)uid > kWorkUID) uid = (long)uid - kWorkUID + offset; };
+    for(auto& result : results) {
+      for(auto& slc : result.slices) {
+        for(auto& tj : slc.tjs) shift(tj.UID, evt.globalT_UID);
+        for(auto& vx2 : slc.vtxs) shift(vx2.UID, evt.global2V_UID);
+        for(auto& vx3 : slc.vtx3s) shift(vx3.UID, evt.global3V_UID);
+        for(auto& pfp : slc.pfps) {
+          shift(pfp.UID, evt.globalP_UID);
+          shift(pfp.ParentUID, evt.globalP_UID);
+          for(auto& uid : pfp.DtrUIDs) shift(uid, evt.globalP_UID);
+          for(auto& uid : pfp.TjUIDs) shift(uid, evt.globalT_UID);
+        } // pfp
+        for(auto& ss : slc.cots) shift(ss.UID, evt.global2S_UID);
+        for(auto& ss3 : slc.showers) shift(ss3.UID, evt.global3S_UID);
+        if(result.done) CountAlgMods(slc);
+        slices.push_back(std::move(slc));
+      } // slc
+      evt.globalT_UID += result.nUID[0];
+      evt.globalP_UID += result.nUID[1];
+      evt.global2V_UID += result.nUID[2];
+      evt.global3V_UID += result.nUID[3];
+      evt.global2S_UID += result.nUID[4];
+      evt.global3S_UID += result.nUID[5];
+    } // result
+
+    // leave the per-TPC event state as the serial reconstruction would
+    for(auto ii = results.size(); ii > 0; --ii) {
+      auto const& result = results[ii - 1];
+      if(result.slices.empty()) continue;
+      FillWireHitRange(result.slices.back().TPCID);
+      break;
+    } // ii
+  } // ReconstructSlicesInParallel
+
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::CountAlgMods(TCSlice const& slc)
+  {
+    // count algorithm usage
+    for(auto& tj : slc.tjs) {
+      for(unsigned short ib = 0; ib < AlgBitNames.size(); ++ib) if(tj.AlgMod[ib]) ++fAlgModCount[ib];
+    } // tj
+  } // CountAlgMods
+
+  ////////////////////////////////////////////////
+  bool TrajClusterAlg::ReconstructSlice(std::vector<unsigned int>& hitsInSlice, int sliceID)
+  {
+    // Reconstruct everything using the hits in a slice. Returns true if all steps were done
+
+    if(hitsInSlice.size() < 2) return false;
     if(tcc.recoSlice > 0) {
-      if(sliceID != tcc.recoSlice) return;
+      if(sliceID != tcc.recoSlice) return false;
     }
     
     if(!CreateSlice(hitsInSlice, sliceID)) {
 //      std::cout<<"CreateSlice failed\n";
-      return;
+      return false;
     }
     // get a reference to the stored slice
     auto& slc = slices[slices.size() - 1];
@@ -303,7 +500,7 @@ namespace tca {
     for(unsigned short plane = 0; plane < slc.nPlanes; ++plane) {
       CTP_t inCTP = EncodeCTP(slc.TPCID.Cryostat, slc.TPCID.TPC, plane);
       ReconstructAllTraj(slc, inCTP);
-      if(!slc.isValid) return;
+      if(!slc.isValid) return false;
     } // plane
 
     Find3DVertices(slc);
@@ -348,7 +545,7 @@ namespace tca {
 
     if(!slc.isValid) {
       mf::LogVerbatim("TC")<<"RunTrajCluster failed in MakeAllTrajClusters";
-      return;
+      return false;
     }
 
     // dump a trajectory?
@@ -358,15 +555,10 @@ namespace tca {
 
     Finish3DShowers(slc);
 
-    // count algorithm usage
-    for(auto& tj : slc.tjs) {
-      for(unsigned short ib = 0; ib < AlgBitNames.size(); ++ib) if(tj.AlgMod[ib]) ++fAlgModCount[ib];
-    } // tj
-
     // clear vectors that are not needed later
     slc.mallTraj.resize(0);
-    
-  } // RunTrajClusterAlg
+    return true;
+  } // ReconstructSlice
 
   ////////////////////////////////////////////////
   void TrajClusterAlg::ReconstructAllTraj(TCSlice& slc, CTP_t inCTP)
@@ -41,6 +41,11 @@ namespace tca {
 
     TrajClusterAlg(fhicl::ParameterSet const& pset);
 
+    /// The working state of the algorithm. Except for the constructor, the methods of
+    /// this class (and the tca functions) must be called with this context installed
+    /// on the calling thread using a TCContextScope
+    TCContext& Context() { return fContext; }
+
     void reconfigure(fhicl::ParameterSet const& pset);
 
     void SetMCPHandle(std::vector<simb::MCParticle> const& mcpHandle) { evt.mcpHandle = &mcpHandle; }
@@ -48,6 +53,9 @@ namespace tca {
     void SetInputSpts(std::vector<recob::SpacePoint> const& inputSpts) { evt.sptHandle = &inputSpts; }
     void ExpectSlicedHits() { evt.expectSlicedHits = true; }
     void RunTrajClusterAlg(std::vector<unsigned int>& hitsInSlice, int sliceID);
+    /// Reconstructs independent slices with the same results as calling RunTrajClusterAlg
+    /// on each one in order. The slices are reconstructed concurrently if ParallelSlices is set
+    void RunTrajClusterAlg(std::vector<std::vector<unsigned int>>& slHitsVec, std::vector<int> const& sliceIDs);
     bool CreateSlice(std::vector<unsigned int>& hitsInSlice, int sliceID);
     void FinishEvent();
 
@@ -83,6 +91,15 @@ namespace tca {
 
     std::vector<unsigned int> fAlgModCount;
 
+    TCContext fContext;
+    bool fParallelSlices {false};       ///< reconstruct slices concurrently
+    bool fCheckParallelSlices {false};  ///< compare concurrent results with a serial reconstruction
+
+    // reconstructs one slice, returns true if all the steps were done
+    bool ReconstructSlice(std::vector<unsigned int>& hitsInSlice, int sliceID);
+    void CountAlgMods(TCSlice const& slc);
+    bool CanRunParallel() const;
+    void ReconstructSlicesInParallel(std::vector<std::vector<unsigned int>>& slHitsVec, std::vector<int> const& sliceIDs);
     void ReconstructAllTraj(TCSlice& slc, CTP_t inCTP);
     // Finds junk trajectories using unassigned hits
     void FindJunkTraj(TCSlice& slc, CTP_t inCTP);
@@ -3,6 +3,9 @@
 #include "TMatrixDSym.h"
 #include "TMatrixDSymEigen.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 using namespace std;
 using namespace trkf;
 using namespace recob::tracking;
@@ -55,6 +58,24 @@ recob::MCSFitResult TrajectoryMCSFitter::fitMcs(const recob::TrackTrajectory& tr
 			     segradlengths,dtheta);
 }
 
+vector<recob::MCSFitResult> TrajectoryMCSFitter::fitMcs(const vector<recob::TrackTrajectory>& trajs, int pid, bool momDepConst) const {
+  vector<recob::MCSFitResult> results(trajs.size());
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, trajs.size(), 1),
+    [&](const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); ++i) results[i] = fitMcs(trajs[i],pid,momDepConst);
+    });
+  return results;
+}
+
+vector<recob::MCSFitResult> TrajectoryMCSFitter::fitMcs(const vector<recob::Track>& tracks, int pid, bool momDepConst) const {
+  vector<recob::MCSFitResult> results(tracks.size());
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, tracks.size(), 1),
+    [&](const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); ++i) results[i] = fitMcs(tracks[i],pid,momDepConst);
+    });
+  return results;
+}
+
 void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj, vector<size_t>& breakpoints, vector<float>& segradlengths, vector<float>& cumseglens) const {
   //
   const double trajlen = traj.Length();
@@ -95,39 +116,55 @@ void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj
 }
 
 const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid) const {
+  //
+  // The likelihood is evaluated lazily on the grid of pStep_: first every pCoarseStepFactor_ points,
+  // then at all points around the coarse minimum, and finally where needed by the uncertainty scans.
+  //
+  std::vector<double> ptest;
+  for (double p_test = pMin_; p_test <= pMax_; p_test+=pStep_) ptest.push_back(p_test);
+  if (ptest.empty()) return ScanResult(-1.0, -1.0, std::numeric_limits<double>::max());
+  const int np = ptest.size();
+  std::vector<double> vlogL(np, std::numeric_limits<double>::quiet_NaN());
+  auto logL = [&](int i) {
+    if (std::isnan(vlogL[i])) vlogL[i] = mcsLikelihood(ptest[i], angResol_, dtheta, seg_nradlengths, cumLen, fwdFit, momDepConst, pid);
+    return vlogL[i];
+  };
+  //
+  int coarse_idx = 0;
+  for (int i = 0; i < np; i += pCoarseStepFactor_) {
+    if (logL(i) < logL(coarse_idx)) coarse_idx = i;
+  }
+  if (logL(np-1) < logL(coarse_idx)) coarse_idx = np-1;
+  const int fine_end = std::min(coarse_idx+pCoarseStepFactor_, np);
+  for (int i = std::max(coarse_idx-pCoarseStepFactor_+1, 0); i < fine_end; i++) logL(i);
+  //
   int    best_idx  = -1;
   double best_logL = std::numeric_limits<double>::max();
   double best_p    = -1.0;
-  std::vector<float> vlogL;
-  for (double p_test = pMin_; p_test <= pMax_; p_test+=pStep_) {
-    double logL = mcsLikelihood(p_test, angResol_, dtheta, seg_nradlengths, cumLen, fwdFit, momDepConst, pid);
-    if (logL < best_logL) {
-      best_p    = p_test;
-      best_logL = logL;
-      best_idx  = vlogL.size();
+  for (int i = 0; i < np; i++) {
+    if (!std::isnan(vlogL[i]) && vlogL[i] < best_logL) {
+      best_p    = ptest[i];
+      best_logL = vlogL[i];
+      best_idx  = i;
     }
-    vlogL.push_back(logL);
   }
+  if (best_idx<0) return ScanResult(best_p, -1.0, best_logL);
   //
   //uncertainty from left side scan
   double lunc = -1.0;
-  if (best_idx>0) {
-    for (int j=best_idx-1;j>=0;j--) {
-      double dLL = vlogL[j]-vlogL[best_idx];
-      if ( dLL<0.5 ) {
-	lunc = (best_idx-j)*pStep_;
-      } else break;
-    }
+  for (int j=best_idx-1;j>=0;j--) {
+    double dLL = logL(j)-vlogL[best_idx];
+    if ( dLL<0.5 ) {
+      lunc = (best_idx-j)*pStep_;
+    } else break;
   }
   //uncertainty from right side scan
   double runc = -1.0;
-  if (best_idx<int(vlogL.size()-1)) {
-    for (unsigned int j=best_idx+1;j<vlogL.size();j++) {
-      double dLL = vlogL[j]-vlogL[best_idx];
-      if ( dLL<0.5 ) {
-	runc = (j-best_idx)*pStep_;
-      } else break;
-    }
+  for (int j=best_idx+1;j<np;j++) {
+    double dLL = logL(j)-vlogL[best_idx];
+    if ( dLL<0.5 ) {
+      runc = (j-best_idx)*pStep_;
+    } else break;
   }
   return ScanResult(best_p, std::max(lunc,runc), best_logL);
 }
@@ -280,6 +317,8 @@ double TrajectoryMCSFitter::energyLossBetheBloch(const double mass,const double
 }
 //
 double TrajectoryMCSFitter::GetE(const double initial_E, const double length_travelled, const double m) const {
+  //
+  if (const ElossTable* table = elossTable(m)) return GetETabulated(initial_E,length_travelled,*table);
   //
   const double step_size = length_travelled / nElossSteps_;
   //
@@ -301,3 +340,82 @@ double TrajectoryMCSFitter::GetE(const double initial_E, const double length_tra
   }
   return current_E;
 }
+//
+void TrajectoryMCSFitter::buildElossTables() {
+  //
+  // Coefficients of energyLossLandau and energyLossBetheBloch as they are called by GetE, tabulated from
+  // a kinetic energy of 20 MeV up to the energy at pMax_; GetE computes them directly below the table.
+  //
+  constexpr double eStep = 0.001;
+  constexpr double tMin = 0.020;
+  constexpr double Iinv2 = 1./(188.E-6*188.E-6);
+  constexpr double matConst = 1.4*18./40.;//density*Z/A
+  constexpr double me = 0.511;
+  constexpr double kappa = 0.307075;
+  constexpr double j = 0.200;
+  constexpr double c = 0.5*kappa*matConst;
+  //
+  elossTables_.clear();
+  for (int pid : {13, 211, 321, 2212}) {
+    ElossTable table;
+    table.mass = mass(pid);
+    table.eMin = table.mass + tMin;
+    table.eStepInv = 1./eStep;
+    const double eMax = std::sqrt(pMax_*pMax_ + table.mass*table.mass) + eStep;
+    const size_t n = std::max(size_t(2), size_t((eMax - table.eMin)*table.eStepInv) + 2);
+    table.landauA.resize(n);
+    table.landauB.resize(n);
+    table.betheBloch.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      const double e = table.eMin + i*eStep;
+      const double e2 = e*e;
+      const double beta2 = (e2-table.mass*table.mass)/e2;
+      const double gamma2 = 1./(1.0 - beta2);
+      table.landauB[i] = 0.001*c/beta2;
+      table.landauA[i] = table.landauB[i]*( log(2.*me*gamma2*c*Iinv2) + j - beta2 );
+      table.betheBloch[i] = energyLossBetheBloch(table.mass,e);
+    }
+    elossTables_.push_back(std::move(table));
+  }
+}
+//
+const TrajectoryMCSFitter::ElossTable* TrajectoryMCSFitter::elossTable(const double m) const {
+  for (const auto& table : elossTables_) {
+    if (table.mass==m) return &table;
+  }
+  return nullptr;
+}
+//
+double TrajectoryMCSFitter::GetETabulated(const double initial_E, const double length_travelled, const ElossTable& table) const {
+  //
+  const double step_size = length_travelled / nElossSteps_;
+  const double log_step = (step_size>0. ? log(step_size) : 0.);
+  const size_t nbins = table.landauA.size() - 1;
+  //
+  double current_E = initial_E;
+  const double m = table.mass;
+  const double m2 = m*m;
+  //
+  for (auto i = 0; i < nElossSteps_; ++i) {
+    const double u = (current_E - table.eMin)*table.eStepInv;
+    const bool inTable = (u >= 0. && u < nbins);
+    const size_t bin = (inTable ? size_t(u) : 0);
+    const double f = u - bin;
+    if (eLossMode_==2) {
+      const double dedx = (inTable ? table.betheBloch[bin] + f*(table.betheBloch[bin+1]-table.betheBloch[bin]) : energyLossBetheBloch(m,current_E));
+      current_E -= (dedx * step_size);
+    } else if (inTable) {
+      if (step_size>0.) {
+	const double a = table.landauA[bin] + f*(table.landauA[bin+1]-table.landauA[bin]);
+	const double b = table.landauB[bin] + f*(table.landauB[bin+1]-table.landauB[bin]);
+	current_E -= step_size*(a + b*log_step);
+      }
+    } else {
+      current_E -= energyLossLandau(m2,current_E*current_E,step_size);
+    }
+    if ( current_E <= m ) {
+      return 0.;
+    }
+  }
+  return current_E;
+}
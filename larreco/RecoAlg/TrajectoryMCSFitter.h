@@ -9,6 +9,9 @@
 #include "lardataobj/RecoBase/Track.h"
 #include "lardata/RecoObjects/TrackState.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace trkf {
   /**
    * @file  larreco/RecoAlg/TrajectoryMCSFitter.h
@@ -87,10 +90,20 @@ namespace trkf {
 	Comment("Angular resolution parameter used in modified Highland formula. Unit is mrad."),
 	3.0
       };
+      fhicl::Atom<int> pCoarseStepFactor {
+        Name("pCoarseStepFactor"),
+	Comment("Likelihood is first scanned in steps of pCoarseStepFactor*pStep, then in pStep around the coarse minimum. Choose 1 for the full scan in pStep."),
+	10
+      };
+      fhicl::Atom<bool> eLossTable {
+        Name("eLossTable"),
+	Comment("Use energy loss coefficients tabulated in energy for each particle hypothesis, instead of computing them at each step."),
+	true
+      };
     };
     using Parameters = fhicl::Table<Config>;
     //
-    TrajectoryMCSFitter(int pIdHyp, int minNSegs, double segLen, int minHitsPerSegment, int nElossSteps, int eLossMode, double pMin, double pMax, double pStep, double angResol){
+    TrajectoryMCSFitter(int pIdHyp, int minNSegs, double segLen, int minHitsPerSegment, int nElossSteps, int eLossMode, double pMin, double pMax, double pStep, double angResol, int pCoarseStepFactor = 10, bool eLossTable = true){
       pIdHyp_ = pIdHyp;
       minNSegs_ = minNSegs;
       segLen_ = segLen;
@@ -101,9 +114,11 @@ namespace trkf {
       pMax_ = pMax;
       pStep_ = pStep;
       angResol_ = angResol;
+      pCoarseStepFactor_ = std::max(pCoarseStepFactor,1);
+      if (eLossTable) buildElossTables();
     }
     explicit TrajectoryMCSFitter(const Parameters & p)
-      : TrajectoryMCSFitter(p().pIdHypothesis(),p().minNumSegments(),p().segmentLength(),p().minHitsPerSegment(),p().nElossSteps(),p().eLossMode(),p().pMin(),p().pMax(),p().pStep(),p().angResol()) {}
+      : TrajectoryMCSFitter(p().pIdHypothesis(),p().minNumSegments(),p().segmentLength(),p().minHitsPerSegment(),p().nElossSteps(),p().eLossMode(),p().pMin(),p().pMax(),p().pStep(),p().angResol(),p().pCoarseStepFactor(),p().eLossTable()) {}
     //
     recob::MCSFitResult fitMcs(const recob::TrackTrajectory& traj, bool momDepConst = true) const { return fitMcs(traj,pIdHyp_,momDepConst); }
     recob::MCSFitResult fitMcs(const recob::Track& track,          bool momDepConst = true) const { return fitMcs(track,pIdHyp_,momDepConst); }
@@ -117,6 +132,12 @@ namespace trkf {
       return fitMcs(tt,pid,momDepConst);
     }
     //
+    /// Fit a batch of tracks or trajectories concurrently, results are in the input order.
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::TrackTrajectory>& trajs, bool momDepConst = true) const { return fitMcs(trajs,pIdHyp_,momDepConst); }
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::Track>& tracks,          bool momDepConst = true) const { return fitMcs(tracks,pIdHyp_,momDepConst); }
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::TrackTrajectory>& trajs, int pid, bool momDepConst = true) const;
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::Track>& tracks,          int pid, bool momDepConst = true) const;
+    //
     void breakTrajInSegments(const recob::TrackTrajectory& traj, std::vector<size_t>& breakpoints, std::vector<float>& segradlengths, std::vector<float>& cumseglens) const;
     void linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, recob::tracking::Vector_t& pcdir) const;
     double mcsLikelihood(double p, double theta0x, std::vector<float>& dthetaij, std::vector<float>& seg_nradl, std::vector<float>& cumLen, bool fwd, bool momDepConst, int pid) const;
@@ -148,6 +169,17 @@ namespace trkf {
     double GetE(const double initial_E, const double length_travelled, const double mass) const;
     //
   private:
+    //
+    /// Energy loss coefficients of one particle hypothesis on a uniform energy grid. The MPV of the
+    /// Landau loss in a step x is x*(landauA(E)+landauB(E)*log(x)), the Bethe-Bloch loss is betheBloch(E)*x.
+    struct ElossTable {
+      double mass, eMin, eStepInv;
+      std::vector<double> landauA, landauB, betheBloch;
+    };
+    void buildElossTables();
+    const ElossTable* elossTable(const double mass) const;
+    double GetETabulated(const double initial_E, const double length_travelled, const ElossTable& table) const;
+    //
     int    pIdHyp_;
     int    minNSegs_;
     double segLen_;
@@ -158,6 +190,8 @@ namespace trkf {
     double pMax_;
     double pStep_;
     double angResol_;
+    int    pCoarseStepFactor_;
+    std::vector<ElossTable> elossTables_; // empty if energy loss is not tabulated
   };
 }
 
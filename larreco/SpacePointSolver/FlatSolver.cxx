@@ -0,0 +1,417 @@
+#include "FlatSolver.h"
+
+#include "Solver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+namespace
+{
+  template<class T> T sqr(T x){return x*x;}
+
+  double WireMetric(double q, double p){return sqr(q-p);}
+  QuadExpr WireMetric(double q, QuadExpr p){return sqr(q-p);}
+}
+
+// ---------------------------------------------------------------------------
+FlatSolver::FlatSolver(const std::vector<CollectionWireHit*>& cwires,
+                       const std::vector<SpaceCharge*>& orphanSCs)
+  : fNMetricIWires(0)
+{
+  fCWireBegin.reserve(cwires.size()+1);
+  fCWireBegin.push_back(0);
+  for(const CollectionWireHit* cwire: cwires){
+    fSCs.insert(fSCs.end(), cwire->fCrossings.begin(), cwire->fCrossings.end());
+    fCWireBegin.push_back(fSCs.size());
+  }
+  const size_t nCWireSCs = fSCs.size();
+  fSCs.insert(fSCs.end(), orphanSCs.begin(), orphanSCs.end());
+
+  std::unordered_map<const SpaceCharge*, unsigned int> scIdx;
+  for(unsigned int i = 0; i < fSCs.size(); ++i) scIdx[fSCs[i]] = i;
+
+  std::unordered_map<const InductionWireHit*, int> iwireIdx;
+  auto IWireIdx = [&](InductionWireHit* iwire) -> int
+    {
+      if(!iwire) return -1;
+      auto it = iwireIdx.find(iwire);
+      if(it != iwireIdx.end()) return it->second;
+      fIWires.push_back(iwire);
+      fIWireCharge.push_back(iwire->fCharge);
+      fIWirePred.push_back(iwire->fPred);
+      return iwireIdx[iwire] = fIWires.size()-1;
+    };
+
+  const size_t nSC = fSCs.size();
+  fPred.reserve(nSC);
+  fNeiPotential.reserve(nSC);
+  fWire1.reserve(nSC);
+  fWire2.reserve(nSC);
+  fNeiBegin.reserve(nSC+1);
+  fNeiBegin.push_back(0);
+
+  for(unsigned int i = 0; i < nSC; ++i){
+    // Induction wires reached from the collection wires come first
+    if(i == nCWireSCs) fNMetricIWires = fIWires.size();
+
+    const SpaceCharge* sc = fSCs[i];
+    fPred.push_back(sc->fPred);
+    fNeiPotential.push_back(sc->fNeiPotential);
+    fWire1.push_back(IWireIdx(sc->fWire1));
+    fWire2.push_back(IWireIdx(sc->fWire2));
+
+    for(const Neighbour& nei: sc->fNeighbours){
+      fNeiSC.push_back(scIdx.at(nei.fSC));
+      fNeiCoupling.push_back(nei.fCoupling);
+    }
+    fNeiBegin.push_back(fNeiSC.size());
+  }
+  if(nSC == nCWireSCs) fNMetricIWires = fIWires.size();
+}
+
+// ---------------------------------------------------------------------------
+size_t FlatSolver::MemoryUsage() const
+{
+  size_t ret = (fPred.capacity() + fNeiPotential.capacity() +
+                fNeiCoupling.capacity() +
+                fIWireCharge.capacity() + fIWirePred.capacity())*sizeof(double);
+  ret += (fWire1.capacity() + fWire2.capacity())*sizeof(int);
+  ret += (fNeiBegin.capacity() + fNeiSC.capacity() +
+          fCWireBegin.capacity())*sizeof(unsigned int);
+  for(const std::vector<unsigned int>& col: fColours)
+    ret += col.capacity()*sizeof(unsigned int);
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::WriteBack() const
+{
+  for(unsigned int i = 0; i < fSCs.size(); ++i){
+    fSCs[i]->fPred = fPred[i];
+    fSCs[i]->fNeiPotential = fNeiPotential[i];
+  }
+  for(unsigned int i = 0; i < fIWires.size(); ++i)
+    fIWires[i]->fPred = fIWirePred[i];
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::AddCharge(unsigned int sc, double dq)
+{
+  fPred[sc] += dq;
+
+  for(unsigned int k = fNeiBegin[sc]; k < fNeiBegin[sc+1]; ++k)
+    fNeiPotential[fNeiSC[k]] += dq * fNeiCoupling[k];
+
+  if(fWire1[sc] >= 0) fIWirePred[fWire1[sc]] += dq;
+  if(fWire2[sc] >= 0) fIWirePred[fWire2[sc]] += dq;
+}
+
+// ---------------------------------------------------------------------------
+double FlatSolver::Metric(double alpha) const
+{
+  double ret = 0;
+
+  // The space charges of the collection wires, and the induction wires they
+  // reach, are each at the front of their arrays
+  if(alpha != 0){
+    const unsigned int nSC = fCWireBegin.back();
+    const double* pred = fPred.data();
+    const double* nei = fNeiPotential.data();
+    for(unsigned int i = 0; i < nSC; ++i){
+      ret -= alpha*sqr(pred[i]);
+      // "Double-counting" of the two ends of the connection is
+      // intentional. Otherwise we'd have a half in the line above.
+      ret -= alpha * pred[i] * nei[i];
+    }
+  }
+
+  const double* q = fIWireCharge.data();
+  const double* p = fIWirePred.data();
+  for(unsigned int i = 0; i < fNMetricIWires; ++i) ret += sqr(q[i]-p[i]);
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+QuadExpr FlatSolver::PairMetric(unsigned int sci, unsigned int scj,
+                                double alpha) const
+{
+  QuadExpr ret = 0;
+
+  // How much charge moves from scj to sci
+  QuadExpr x = QuadExpr::X();
+
+  if(alpha != 0){
+    const double scip = fPred[sci];
+    const double scjp = fPred[scj];
+
+    // Self energy. SpaceCharges are never the same object
+    ret -= alpha*sqr(scip + x);
+    ret -= alpha*sqr(scjp - x);
+
+    // Interaction. We're only seeing one end of the double-ended connection
+    // here, so multiply by two.
+    ret -= 2 * alpha * (scip + x) * fNeiPotential[sci];
+    ret -= 2 * alpha * (scjp - x) * fNeiPotential[scj];
+
+    // This miscounts if i and j are neighbours of each other
+    for(unsigned int k = fNeiBegin[sci]; k < fNeiBegin[sci+1]; ++k){
+      if(fNeiSC[k] == scj){
+        const double coupling = fNeiCoupling[k];
+        // If we detect that case, remove the erroneous terms
+        ret += 2 * alpha * (scip + x) * scjp * coupling;
+        ret += 2 * alpha * (scjp - x) * scip * coupling;
+
+        // And replace with the correct interaction terms
+        ret -= 2 * alpha * (scip + x) * (scjp - x) * coupling;
+        break;
+      }
+    }
+  }
+
+  const int iwires[2][2] = {{fWire1[sci], fWire1[scj]},
+                            {fWire2[sci], fWire2[scj]}};
+
+  for(const auto& w: iwires){
+    const int iwire = w[0];
+    const int jwire = w[1];
+
+    const double qi = iwire >= 0 ? fIWireCharge[iwire] : 0;
+    const double pi = iwire >= 0 ? fIWirePred[iwire] : 0;
+
+    const double qj = jwire >= 0 ? fIWireCharge[jwire] : 0;
+    const double pj = jwire >= 0 ? fIWirePred[jwire] : 0;
+
+    if(iwire == jwire){
+      // Same wire means movement of charge cancels itself out
+      if(iwire >= 0) ret += WireMetric(qi, pi);
+    }
+    else{
+      if(iwire >= 0) ret += WireMetric(qi, pi + x);
+      if(jwire >= 0) ret += WireMetric(qj, pj - x);
+    }
+  }
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+QuadExpr FlatSolver::OrphanMetric(unsigned int sc, double alpha) const
+{
+  QuadExpr ret = 0;
+
+  // How much charge is added to sc
+  QuadExpr x = QuadExpr::X();
+
+  if(alpha != 0){
+    const double scp = fPred[sc];
+
+    // Self energy
+    ret -= alpha*sqr(scp + x);
+
+    // Interaction. We're only seeing one end of the double-ended connection
+    // here, so multiply by two.
+    ret -= 2 * alpha * (scp + x) * fNeiPotential[sc];
+  }
+
+  // Prediction of the induction wires. Orphans always have both
+  ret += WireMetric(fIWireCharge[fWire1[sc]], fIWirePred[fWire1[sc]] + x);
+  ret += WireMetric(fIWireCharge[fWire2[sc]], fIWirePred[fWire2[sc]] + x);
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+double FlatSolver::SolvePair(unsigned int sci, unsigned int scj,
+                             double alpha) const
+{
+  const QuadExpr chisq = PairMetric(sci, scj, alpha);
+  const double chisq0 = chisq.Eval(0);
+
+  // Find the minimum of a quadratic expression
+  double x = -chisq.Linear()/(2*chisq.Quadratic());
+
+  // Don't allow either SpaceCharge to go negative
+  const double xmin = -fPred[sci];
+  const double xmax =  fPred[scj];
+
+  // Clamp to allowed range
+  x = std::min(xmax, x);
+  x = std::max(xmin, x);
+
+  const double chisq_new = chisq.Eval(x);
+
+  // Should try these too, because the function might be convex not concave, so
+  // d/dx=0 gives the max not the min, and the true min is at one extreme of
+  // the range.
+  const double chisq_p = chisq.Eval(xmax);
+  const double chisq_n = chisq.Eval(xmin);
+
+  if(std::min(std::min(chisq_p, chisq_n), chisq_new) > chisq0+1){
+    std::cout << "Solution at " << x << " is worse than current state! Scan from " << xmin << " to " << xmax << std::endl;
+    std::cout << "Soln, original, up edge, low edge:" << std::endl;
+    std::cout << chisq_new << " " << chisq0 << " " << chisq_p << " " << chisq_n << std::endl;
+    abort();
+  }
+
+  if(std::min(chisq_n, chisq_p) < chisq_new){
+    if(chisq_n < chisq_p) return xmin;
+    return xmax;
+  }
+
+  return x;
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::IterateWire(unsigned int cwire, double alpha)
+{
+  // Consider all pairs of crossings
+  const unsigned int begin = fCWireBegin[cwire];
+  const unsigned int end = fCWireBegin[cwire+1];
+
+  for(unsigned int i = begin; i+1 < end; ++i){
+    for(unsigned int j = i+1; j < end; ++j){
+      const double x = SolvePair(i, j, alpha);
+
+      if(x == 0) continue;
+
+      // Actually make the update
+      AddCharge(i, +x);
+      AddCharge(j, -x);
+    } // end for j
+  } // end for i
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::IterateOrphan(unsigned int sc, double alpha)
+{
+  const QuadExpr chisq = OrphanMetric(sc, alpha);
+
+  // Find the minimum of a quadratic expression
+  double x = -chisq.Linear()/(2*chisq.Quadratic());
+
+  // Don't allow the SpaceCharge to go negative
+  const double xmin = -fPred[sc];
+
+  // Clamp to allowed range
+  x = std::max(xmin, x);
+
+  const double chisq_new = chisq.Eval(x);
+
+  // Should try here too, because the function might be convex not concave, so
+  // d/dx=0 gives the max not the min, and the true min is at one extreme of
+  // the range.
+  const double chisq_n = chisq.Eval(xmin);
+
+  if(chisq_n < chisq_new)
+    AddCharge(sc, xmin);
+  else
+    AddCharge(sc, x);
+}
+
+// ---------------------------------------------------------------------------
+std::vector<unsigned int> FlatSolver::VisitOrder() const
+{
+  const unsigned int nCWires = NCollectionWires();
+
+  std::vector<unsigned int> ret;
+  ret.reserve(nCWires);
+
+  // Visiting in a "random" order helps prevent local artefacts that are slow
+  // to break up.
+  unsigned int cwireIdx = 0;
+  if(nCWires != 0){
+    do{
+      ret.push_back(cwireIdx);
+
+      const unsigned int prime = 1299827;
+      cwireIdx = (cwireIdx+prime)%nCWires;
+    } while(cwireIdx != 0);
+  }
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::Iterate(double alpha)
+{
+  for(unsigned int cwire: VisitOrder()) IterateWire(cwire, alpha);
+
+  for(unsigned int sc = fCWireBegin.back(); sc < fPred.size(); ++sc)
+    IterateOrphan(sc, alpha);
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::Colour()
+{
+  const unsigned int nCWires = NCollectionWires();
+  const unsigned int nCWireSCs = fCWireBegin.back();
+
+  // The resources a wire reads or writes are its own crossings, the crossings
+  // (or orphans) whose neighbour potential it updates and its induction
+  // wires. The space charges are grouped by collection wire, each orphan is a
+  // group of its own.
+  auto Group = [&](unsigned int sc) -> unsigned int
+    {
+      if(sc < nCWireSCs){
+        return std::upper_bound(fCWireBegin.begin(), fCWireBegin.end(), sc) - fCWireBegin.begin() - 1;
+      }
+      return nCWires + sc - nCWireSCs;
+    };
+  const unsigned int iwireOffset = nCWires + fPred.size() - nCWireSCs;
+
+  // The colours already given to wires using each resource
+  std::vector<std::vector<unsigned int>> resColours(iwireOffset + fIWireCharge.size());
+
+  std::vector<unsigned int> res;
+  std::vector<bool> taken;
+
+  for(unsigned int cwire: VisitOrder()){
+    res.clear();
+    res.push_back(cwire);
+    for(unsigned int sc = fCWireBegin[cwire]; sc < fCWireBegin[cwire+1]; ++sc){
+      for(unsigned int k = fNeiBegin[sc]; k < fNeiBegin[sc+1]; ++k)
+        res.push_back(Group(fNeiSC[k]));
+      if(fWire1[sc] >= 0) res.push_back(iwireOffset + fWire1[sc]);
+      if(fWire2[sc] >= 0) res.push_back(iwireOffset + fWire2[sc]);
+    }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+
+    taken.assign(fColours.size()+1, false);
+    for(unsigned int r: res)
+      for(unsigned int col: resColours[r]) taken[col] = true;
+
+    const unsigned int col = std::find(taken.begin(), taken.end(), false) - taken.begin();
+    if(col == fColours.size()) fColours.emplace_back();
+    fColours[col].push_back(cwire);
+
+    for(unsigned int r: res) resColours[r].push_back(col);
+  }
+}
+
+// ---------------------------------------------------------------------------
+void FlatSolver::IterateParallel(double alpha)
+{
+  if(fColours.empty()) Colour();
+
+  // No two wires of one colour touch the same induction wire or space charge,
+  // so they can be solved in any order
+  for(const std::vector<unsigned int>& col: fColours){
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, col.size()),
+                      [&](const tbb::blocked_range<size_t>& r)
+                      {
+                        for(size_t i = r.begin(); i != r.end(); ++i)
+                          IterateWire(col[i], alpha);
+                      });
+  }
+
+  // The orphans share induction wires with everything else
+  for(unsigned int sc = fCWireBegin.back(); sc < fPred.size(); ++sc)
+    IterateOrphan(sc, alpha);
+}
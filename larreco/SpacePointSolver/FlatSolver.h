@@ -0,0 +1,106 @@
+// Christopher Backhouse - bckhouse@fnal.gov
+
+#ifndef RECO3D_FLATSOLVER_H
+#define RECO3D_FLATSOLVER_H
+
+#include <vector>
+
+#include "QuadExpr.h"
+
+class CollectionWireHit;
+class InductionWireHit;
+class SpaceCharge;
+
+/// \brief The system of Solver.h, held in index-based arrays
+///
+/// The space charges are numbered in collection wire order, so the crossings
+/// of each collection wire are a contiguous range, followed by the orphans.
+/// The predictions, neighbour potentials, induction wire incidence and the
+/// neighbour couplings (compressed sparse row) are each stored in one
+/// contiguous array. Iterate() and Metric() repeat the arithmetic of the free
+/// functions of Solver.h, visiting the collection wires in the same order.
+/// The summation order is not the same everywhere (Metric() adds up the
+/// induction wires in array order rather than in pointer order), so the
+/// results agree within rounding, not bit by bit, and the convergence test
+/// of the minimization may stop at a different iteration.
+///
+/// IterateParallel() instead colours the collection wires so that no two
+/// wires of the same colour share an induction wire or a space charge that
+/// either of them updates, and solves all the wires of one colour
+/// concurrently. The result does not depend on the number of threads, but
+/// differs from Iterate() since the wires are visited colour by colour.
+class FlatSolver
+{
+public:
+  /// Copies the current state of the system, which must already have its
+  /// neighbours. The objects must outlive the FlatSolver
+  FlatSolver(const std::vector<CollectionWireHit*>& cwires,
+             const std::vector<SpaceCharge*>& orphanSCs);
+
+  /// Equivalent to Metric(cwires, alpha)
+  double Metric(double alpha) const;
+
+  /// Equivalent to Iterate(cwires, orphanSCs, alpha)
+  void Iterate(double alpha);
+
+  /// Solves the collection wires of each colour concurrently
+  void IterateParallel(double alpha);
+
+  /// Copies the predictions back into the SpaceCharge and InductionWireHit
+  /// objects the system was made from
+  void WriteBack() const;
+
+  size_t NSpaceCharges() const {return fPred.size();}
+  size_t NCollectionWires() const {return fCWireBegin.size()-1;}
+  size_t NInductionWires() const {return fIWireCharge.size();}
+  /// Zero until the first call to IterateParallel()
+  size_t NColours() const {return fColours.size();}
+
+  /// Bytes allocated for the arrays
+  size_t MemoryUsage() const;
+
+protected:
+  void AddCharge(unsigned int sc, double dq);
+
+  QuadExpr PairMetric(unsigned int sci, unsigned int scj, double alpha) const;
+  QuadExpr OrphanMetric(unsigned int sc, double alpha) const;
+
+  double SolvePair(unsigned int sci, unsigned int scj, double alpha) const;
+
+  void IterateWire(unsigned int cwire, double alpha);
+  void IterateOrphan(unsigned int sc, double alpha);
+
+  /// The collection wires in the "random" order Iterate() visits them
+  std::vector<unsigned int> VisitOrder() const;
+
+  /// Greedy colouring of the collection wires, fills fColours
+  void Colour();
+
+  // Per space charge
+  std::vector<double> fPred;
+  std::vector<double> fNeiPotential;
+  std::vector<int> fWire1, fWire2; ///< induction wire indices, -1 for none
+
+  // Neighbours of space charge i are [fNeiBegin[i], fNeiBegin[i+1])
+  std::vector<unsigned int> fNeiBegin;
+  std::vector<unsigned int> fNeiSC;
+  std::vector<double> fNeiCoupling;
+
+  // Crossings of collection wire i are [fCWireBegin[i], fCWireBegin[i+1])
+  std::vector<unsigned int> fCWireBegin;
+
+  // Per induction wire. The first fNMetricIWires are the ones crossing a
+  // collection wire, which are the only ones counted by Metric()
+  std::vector<double> fIWireCharge;
+  std::vector<double> fIWirePred;
+  unsigned int fNMetricIWires;
+
+  /// Collection wires of each colour, in visiting order
+  std::vector<std::vector<unsigned int>> fColours;
+
+  // The objects to write the results back to
+  std::vector<SpaceCharge*> fSCs;
+  std::vector<InductionWireHit*> fIWires;
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "NeighbourSearch.h"
+
+#include "Solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+  template<class T> T sqr(T x){return x*x;}
+
+  /// Integer coordinates of the cell containing a space charge. Truncation
+  /// towards zero, as in the original search, so the cells either side of
+  /// zero are twice as wide.
+  struct IntCoord
+  {
+    IntCoord(const SpaceCharge& sc, double critDist)
+      : fX(sc.fX/critDist), fY(sc.fY/critDist), fZ(sc.fZ/critDist)
+    {
+    }
+
+    IntCoord(int x, int y, int z) : fX(x), fY(y), fZ(z) {}
+
+    bool operator<(const IntCoord& i) const
+    {
+      return std::tie(fX, fY, fZ) < std::tie(i.fX, i.fY, i.fZ);
+    }
+
+    int fX, fY, fZ;
+  };
+
+  // -------------------------------------------------------------------------
+  void TestPair(SpaceCharge* sc1, SpaceCharge* sc2, double critDist,
+                NeighbourList& neighbours, NeighbourSearchStats& stats)
+  {
+    ++stats.nTests;
+
+    if(sc1 == sc2) return;
+    const double dist2 = sqr(sc1->fX-sc2->fX) + sqr(sc1->fY-sc2->fY) + sqr(sc1->fZ-sc2->fZ);
+
+    if(dist2 > sqr(critDist)) return;
+
+    if(dist2 == 0){
+      std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
+      std::cout << sc1->fCWire << " " << sc1->fWire1 << " " << sc1->fWire2 << std::endl;
+      std::cout << sc2->fCWire << " " << sc2->fWire1 << " " << sc2->fWire2 << std::endl;
+      std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " " << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
+      return;
+    }
+
+    ++stats.nNeighbours;
+
+    // This is a pretty random guess
+    const double coupling = exp(-sqrt(dist2)/2);
+    neighbours.Add(sc2, coupling);
+
+    if(std::isnan(1/sqrt(dist2)) || std::isinf(1/sqrt(dist2))){
+      std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " " << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
+      abort();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+void FindNeighboursCellList(const std::vector<SpaceCharge*>& spaceCharges,
+                            double critDist,
+                            NeighbourList& neighbours,
+                            NeighbourSearchStats& stats)
+{
+  const size_t N = spaceCharges.size();
+
+  std::vector<IntCoord> coords;
+  coords.reserve(N);
+  for(const SpaceCharge* sc: spaceCharges) coords.emplace_back(*sc, critDist);
+
+  // Stable, so each cell lists its space charges in their original order
+  std::vector<unsigned int> order(N);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&coords](unsigned int a, unsigned int b){return coords[a] < coords[b];});
+
+  // The occupied cells, and where their space charges start in order
+  std::vector<IntCoord> cells;
+  std::vector<unsigned int> cellStart;
+  for(unsigned int i = 0; i < N; ++i){
+    const IntCoord& ic = coords[order[i]];
+    if(cells.empty() || cells.back() < ic){
+      cells.push_back(ic);
+      cellStart.push_back(i);
+    }
+  }
+  cellStart.push_back(N);
+
+  stats.nCells += cells.size();
+
+  for(unsigned int i = 0; i < N; ++i){
+    SpaceCharge* sc1 = spaceCharges[i];
+    const IntCoord& ic = coords[i];
+
+    for(int dx = -1; dx <= +1; ++dx){
+      for(int dy = -1; dy <= +1; ++dy){
+        // The three cells along z are adjacent in the sorted list
+        const IntCoord lo(ic.fX+dx, ic.fY+dy, ic.fZ-1);
+        const IntCoord hi(ic.fX+dx, ic.fY+dy, ic.fZ+1);
+
+        for(auto it = std::lower_bound(cells.begin(), cells.end(), lo);
+            it != cells.end() && !(hi < *it); ++it){
+          const unsigned int cellIdx = it - cells.begin();
+          for(unsigned int j = cellStart[cellIdx]; j < cellStart[cellIdx+1]; ++j){
+            TestPair(sc1, spaceCharges[order[j]], critDist, neighbours, stats);
+          }
+        } // end for cell
+      } // end for dy
+    } // end for dx
+
+    neighbours.Close(sc1);
+  } // end for i
+}
+
+// ---------------------------------------------------------------------------
+void FindNeighboursMap(const std::vector<SpaceCharge*>& spaceCharges,
+                       double critDist,
+                       NeighbourList& neighbours,
+                       NeighbourSearchStats& stats)
+{
+  std::map<IntCoord, std::vector<SpaceCharge*>> scMap;
+  for(SpaceCharge* sc: spaceCharges){
+    scMap[IntCoord(*sc, critDist)].push_back(sc);
+  }
+
+  stats.nCells += scMap.size();
+
+  for(SpaceCharge* sc1: spaceCharges){
+    const IntCoord ic(*sc1, critDist);
+    for(int dx = -1; dx <= +1; ++dx){
+      for(int dy = -1; dy <= +1; ++dy){
+        for(int dz = -1; dz <= +1; ++dz){
+          const auto it = scMap.find(IntCoord(ic.fX+dx, ic.fY+dy, ic.fZ+dz));
+          if(it == scMap.end()) continue;
+          for(SpaceCharge* sc2: it->second){
+            TestPair(sc1, sc2, critDist, neighbours, stats);
+          }
+        } // end for dz
+      } // end for dy
+    } // end for dx
+
+    neighbours.Close(sc1);
+  } // end for sc1
+}
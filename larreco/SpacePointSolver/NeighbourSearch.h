@@ -0,0 +1,36 @@
+#ifndef RECO3D_NEIGHBOURSEARCH_H
+#define RECO3D_NEIGHBOURSEARCH_H
+
+#include <vector>
+
+class SpaceCharge;
+class NeighbourList;
+
+/// Counters filled by the neighbour searches
+struct NeighbourSearchStats
+{
+  long nTests = 0;      ///< pairs of space charges whose distance was computed
+  long nNeighbours = 0; ///< pairs closer than the critical distance
+  long nCells = 0;      ///< occupied cells
+};
+
+/// \brief Finds all pairs of space charges closer than \a critDist and adds
+/// them to each other's neighbours, with a coupling exp(-dist/2)
+///
+/// The space charges are sorted by the cube of side \a critDist containing
+/// them, and each one is tested against the contents of the 27 surrounding
+/// cubes, found by binary search in the sorted cell list. The neighbours are
+/// added in the same order as FindNeighboursMap() does.
+void FindNeighboursCellList(const std::vector<SpaceCharge*>& spaceCharges,
+                            double critDist,
+                            NeighbourList& neighbours,
+                            NeighbourSearchStats& stats);
+
+/// The original search, with the cells held in a std::map. Kept to validate
+/// FindNeighboursCellList()
+void FindNeighboursMap(const std::vector<SpaceCharge*>& spaceCharges,
+                       double critDist,
+                       NeighbourList& neighbours,
+                       NeighbourSearchStats& stats);
+
+#endif
@@ -43,6 +43,36 @@ void SpaceCharge::AddCharge(double dq)
   if(fWire2) fWire2->fPred += dq;
 }
 
+// ---------------------------------------------------------------------------
+void NeighbourList::Close(SpaceCharge* sc)
+{
+  fEnds.emplace_back(sc, fNeighbours.size());
+}
+
+// ---------------------------------------------------------------------------
+void NeighbourList::Finalize()
+{
+  // Trim first, since the ranges point into the storage
+  fNeighbours.shrink_to_fit();
+
+  size_t begin = 0;
+  for(const std::pair<SpaceCharge*, size_t>& end: fEnds){
+    end.first->fNeighbours.fBegin = fNeighbours.data() + begin;
+    end.first->fNeighbours.fEnd = fNeighbours.data() + end.second;
+    begin = end.second;
+  }
+
+  fEnds.clear();
+  fEnds.shrink_to_fit();
+}
+
+// ---------------------------------------------------------------------------
+size_t NeighbourList::MemoryUsage() const
+{
+  return fNeighbours.capacity()*sizeof(Neighbour) +
+    fEnds.capacity()*sizeof(std::pair<SpaceCharge*, size_t>);
+}
+
 // ---------------------------------------------------------------------------
 CollectionWireHit::CollectionWireHit(int chan, double q,
                                      const std::vector<SpaceCharge*>& cross)
@@ -3,6 +3,7 @@
 #ifndef RECO3D_SOLVER_H
 #define RECO3D_SOLVER_H
 
+#include <utility>
 #include <vector>
 
 #include "QuadExpr.h"
@@ -37,6 +38,20 @@ public:
   double fCoupling;
 };
 
+/// The neighbours of one SpaceCharge, a range inside the contiguous storage
+/// of a NeighbourList
+class NeighbourRange
+{
+public:
+  Neighbour* begin() const {return fBegin;}
+  Neighbour* end() const {return fEnd;}
+  size_t size() const {return fEnd-fBegin;}
+  bool empty() const {return fBegin == fEnd;}
+
+  Neighbour* fBegin = nullptr;
+  Neighbour* fEnd = nullptr;
+};
+
 class CollectionWireHit;
 
 class SpaceCharge
@@ -53,12 +68,39 @@ public:
   CollectionWireHit* fCWire;
   InductionWireHit *fWire1, *fWire2;
 
-  std::vector<Neighbour> fNeighbours;
+  NeighbourRange fNeighbours;
 
   double fPred;
   double fNeiPotential; ///< Neighbour-induced potential
 };
 
+/// Owns the neighbours of all the space charges in one contiguous array
+/// (compressed sparse row layout) rather than one vector per SpaceCharge.
+/// Must outlive the use of the space charges it was filled for.
+class NeighbourList
+{
+public:
+  /// Appends a neighbour to the list of the space charge being filled
+  void Add(SpaceCharge* sc, double coupling){fNeighbours.emplace_back(sc, coupling);}
+
+  /// The neighbours added since the previous call belong to \a sc
+  void Close(SpaceCharge* sc);
+
+  /// Points the space charges at their neighbours. No more can be added
+  void Finalize();
+
+  size_t size() const {return fNeighbours.size();}
+
+  /// Bytes allocated for the neighbours
+  size_t MemoryUsage() const;
+
+protected:
+  std::vector<Neighbour> fNeighbours;
+
+  /// Each space charge with the end of its neighbours in fNeighbours
+  std::vector<std::pair<SpaceCharge*, size_t>> fEnds;
+};
+
 class CollectionWireHit: public WireHit
 {
 public:
@@ -5,6 +5,7 @@
 // C/C++ standard libraries
 #include <string>
 #include <iostream>
+#include <memory>
 
 // framework libraries
 #include "fhiclcpp/ParameterSet.h"
@@ -15,6 +16,8 @@
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art/Utilities/make_tool.h"
 #include "canvas/Persistency/Common/Ptr.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 // LArSoft libraries
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
@@ -29,6 +32,8 @@
 
 #include "larreco/SpacePointSolver/HitReaders/IHitReader.h"
 
+#include "FlatSolver.h"
+#include "NeighbourSearch.h"
 #include "Solver.h"
 #include "TripletFinder.h"
 
@@ -59,7 +64,8 @@ private:
   void produce(art::Event& evt) override;
   void beginJob() override;
 
-  void AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const;
+  void AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges,
+                     NeighbourList& neighbours) const;
 
   typedef std::map<const WireHit*, const recob::Hit*> HitMap_t;
 
@@ -68,6 +74,7 @@ private:
                    std::vector<InductionWireHit*>& iwires,
                    std::vector<SpaceCharge*>& orphanSCs,
                    bool incNei,
+                   NeighbourList& neighbours,
                    HitMap_t& hitmap) const;
 
   void Minimize(const std::vector<CollectionWireHit*>& cwires,
@@ -75,6 +82,12 @@ private:
                 double alpha,
                 int maxiterations);
 
+  void Minimize(FlatSolver& solver, double alpha, int maxiterations);
+
+  /// The convergence criteria shared by both solvers
+  template<class MetricFunc, class IterateFunc>
+  void Minimize(MetricFunc metric, IterateFunc iterate, int maxiterations);
+
   /// return whether the point was inserted (only happens when it has charge)
   bool AddSpacePoint(const SpaceCharge& sc,
                      int id,
@@ -106,6 +119,13 @@ private:
 
   double fXHitOffset;
 
+  bool fMapNeighbourSearch; ///< use the original std::map neighbour search
+
+  bool fFlatSolver;      ///< minimize with the array-based FlatSolver
+  bool fParallelIterate; ///< FlatSolver solves independent wires concurrently
+
+  bool fParallelTPCs; ///< find the triplets of each TPC concurrently
+
   const detinfo::DetectorProperties* detprop;
   const geo::GeometryCore* geom;
   std::unique_ptr<reco3d::IHitReader> fHitReader; ///<  Expt specific tool for reading hits
@@ -125,8 +145,17 @@ SpacePointSolver::SpacePointSolver(const fhicl::ParameterSet& pset) :
     fDistThreshDrift(pset.get<double>("WireIntersectThresholdDriftDir")),
     fMaxIterationsNoReg(pset.get<int>("MaxIterationsNoReg")),
     fMaxIterationsReg(pset.get<int>("MaxIterationsReg")),
-    fXHitOffset(pset.get<double>("XHitOffset"))
+    fXHitOffset(pset.get<double>("XHitOffset")),
+    fMapNeighbourSearch(pset.get<bool>("MapNeighbourSearch", false)),
+    fFlatSolver(pset.get<bool>("FlatSolver", false)),
+    fParallelIterate(pset.get<bool>("ParallelIterate", false)),
+    fParallelTPCs(pset.get<bool>("ParallelTPCs", false))
 {
+  if(fParallelIterate && !fFlatSolver){
+    throw cet::exception("SpacePointSolver")
+      << "ParallelIterate is only implemented for the FlatSolver\n";
+  }
+
   recob::ChargedSpacePointCollectionCreator::produces(producesCollector(), "pre");
   if(fFit){
     recob::ChargedSpacePointCollectionCreator::produces(producesCollector());
@@ -146,92 +175,19 @@ void SpacePointSolver::beginJob()
 
 // ---------------------------------------------------------------------------
 void SpacePointSolver::
-AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
+AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges,
+              NeighbourList& neighbours) const
 {
   static const double kCritDist = 5;
 
-  // Could use a QuadTree or VPTree etc, but seems like overkill
-  class IntCoord
-  {
-  public:
-    IntCoord(const SpaceCharge& sc)
-      : fX(sc.fX/kCritDist),
-        fY(sc.fY/kCritDist),
-        fZ(sc.fZ/kCritDist)
-    {
-    }
-
-    bool operator<(const IntCoord& i) const
-    {
-      return std::make_tuple(fX, fY, fZ) < std::make_tuple(i.fX, i.fY, i.fZ);
-    }
-
-    std::vector<IntCoord> Neighbours() const
-    {
-      std::vector<IntCoord> ret;
-      for(int dx = -1; dx <= +1; ++dx){
-        for(int dy = -1; dy <= +1; ++dy){
-          for(int dz = -1; dz <= +1; ++dz){
-            ret.push_back(IntCoord(fX+dx, fY+dy, fZ+dz));
-          }
-        }
-      }
-      return ret;
-    }
-  protected:
-    IntCoord(int x, int y, int z) : fX(x), fY(y), fZ(z) {}
-
-    int fX, fY, fZ;
-  };
-
-  std::map<IntCoord, std::vector<SpaceCharge*>> scMap;
-  for(SpaceCharge* sc: spaceCharges){
-    scMap[IntCoord(*sc)].push_back(sc);
-  }
-
-  std::cout << "Neighbour search..." << std::endl;
-
-  // Now that we know all the space charges, can go through and assign neighbours
-
-  int Ntests = 0;
-  int Nnei = 0;
-  for(SpaceCharge* sc1: spaceCharges){
-    IntCoord ic(*sc1);
-    for(IntCoord icn: ic.Neighbours()){
-      for(SpaceCharge* sc2: scMap[icn]){
-
-        ++Ntests;
-
-        if(sc1 == sc2) continue;
-        /*const*/ double dist2 = sqr(sc1->fX-sc2->fX) + sqr(sc1->fY-sc2->fY) + sqr(sc1->fZ-sc2->fZ);
-
-        if(dist2 > sqr(kCritDist)) continue;
-
-        if(dist2 == 0){
-          std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
-          std::cout << sc1->fCWire << " " << sc1->fWire1 << " " << sc1->fWire2 << std::endl;
-          std::cout << sc2->fCWire << " " << sc2->fWire1 << " " << sc2->fWire2 << std::endl;
-          std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " " << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-          continue;
-          dist2 = sqr(kCritDist);
-        }
-
-        ++Nnei;
+  NeighbourSearchStats stats;
+  if(fMapNeighbourSearch)
+    FindNeighboursMap(spaceCharges, kCritDist, neighbours, stats);
+  else
+    FindNeighboursCellList(spaceCharges, kCritDist, neighbours, stats);
 
-        // This is a pretty random guess
-        const double coupling = exp(-sqrt(dist2)/2);
-        sc1->fNeighbours.emplace_back(sc2, coupling);
-
-        if(isnan(1/sqrt(dist2)) || isinf(1/sqrt(dist2))){
-          std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " " << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-          abort();
-        }
-      } // end for sc2
-    } // end for icn
-
-      // The neighbours lists use the most memory, so be careful to trim
-    sc1->fNeighbours.shrink_to_fit();
-  } // end for sc1
+  const size_t neiMem = neighbours.MemoryUsage();
+  neighbours.Finalize();
 
   for(SpaceCharge* sc: spaceCharges){
     for(Neighbour& nei: sc->fNeighbours){
@@ -239,7 +195,11 @@ AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
     }
   }
 
-  std::cout << Ntests << " tests to find " << Nnei << " neighbours" << std::endl;
+  const double perSC = spaceCharges.empty() ? 0 : double(neighbours.MemoryUsage())/spaceCharges.size();
+  mf::LogDebug("SpacePointSolver") << stats.nTests << " tests in " << stats.nCells
+                                   << " cells to find " << stats.nNeighbours << " neighbours, "
+                                   << neiMem << " bytes while searching, "
+                                   << sizeof(SpaceCharge) + perSC << " bytes per space charge";
 }
 
 // ---------------------------------------------------------------------------
@@ -249,6 +209,7 @@ BuildSystem(const std::vector<HitTriplet>& triplets,
             std::vector<InductionWireHit*>& iwires,
             std::vector<SpaceCharge*>& orphanSCs,
             bool incNei,
+            NeighbourList& neighbours,
             HitMap_t& hitmap) const
 {
   std::set<const recob::Hit*> ihits;
@@ -336,7 +297,7 @@ BuildSystem(const std::vector<HitTriplet>& triplets,
   std::cout << cwires.size() << " collection wire objects" << std::endl;
   std::cout << spaceCharges.size() << " potential space points" << std::endl;
 
-  if(incNei) AddNeighbours(spaceCharges);
+  if(incNei) AddNeighbours(spaceCharges, neighbours);
 }
 
 // ---------------------------------------------------------------------------
@@ -410,26 +371,53 @@ FillSystemToSpacePointsAndAssns(const std::vector<art::Ptr<recob::Hit>>& hitlist
 }
 
 // ---------------------------------------------------------------------------
-void SpacePointSolver::Minimize(const std::vector<CollectionWireHit*>& cwires,
-                                const std::vector<SpaceCharge*>& orphanSCs,
-                                double alpha,
+template<class MetricFunc, class IterateFunc>
+void SpacePointSolver::Minimize(MetricFunc metric,
+                                IterateFunc iterate,
                                 int maxiterations)
 {
-  double prevMetric = Metric(cwires, alpha);
+  double prevMetric = metric();
   std::cout << "Begin: " << prevMetric << std::endl;
   for(int i = 0; i < maxiterations; ++i){
-    Iterate(cwires, orphanSCs, alpha);
-    const double metric = Metric(cwires, alpha);
-    std::cout << i << " " << metric << std::endl;
-    if(metric > prevMetric){
+    iterate();
+    const double newMetric = metric();
+    std::cout << i << " " << newMetric << std::endl;
+    if(newMetric > prevMetric){
       std::cout << "Warning: metric increased" << std::endl;
       return;
     }
-    if(fabs(metric-prevMetric) < 1e-3*fabs(prevMetric)) return;
-    prevMetric = metric;
+    if(fabs(newMetric-prevMetric) < 1e-3*fabs(prevMetric)) return;
+    prevMetric = newMetric;
   }
 }
 
+// ---------------------------------------------------------------------------
+void SpacePointSolver::Minimize(const std::vector<CollectionWireHit*>& cwires,
+                                const std::vector<SpaceCharge*>& orphanSCs,
+                                double alpha,
+                                int maxiterations)
+{
+  Minimize([&](){return Metric(cwires, alpha);},
+           [&](){Iterate(cwires, orphanSCs, alpha);},
+           maxiterations);
+}
+
+// ---------------------------------------------------------------------------
+void SpacePointSolver::Minimize(FlatSolver& solver,
+                                double alpha,
+                                int maxiterations)
+{
+  Minimize([&](){return solver.Metric(alpha);},
+           [&](){
+             if(fParallelIterate) solver.IterateParallel(alpha);
+             else solver.Iterate(alpha);
+           },
+           maxiterations);
+
+  // The space points are filled from the original objects
+  solver.WriteBack();
+}
+
 // ---------------------------------------------------------------------------
 void SpacePointSolver::produce(art::Event& evt)
 {
@@ -486,38 +474,51 @@ void SpacePointSolver::produce(art::Event& evt)
   // Nodes with a bad collection wire that we otherwise can't address
   std::vector<SpaceCharge*> orphanSCs;
 
+  // Neighbours of all the space charges
+  NeighbourList neighbours;
+
   HitMap_t hitmap;
   if(is2view){
     std::cout << "Finding 2-view coincidences..." << std::endl;
     TripletFinder tf(xhits, uhits, {},
                      xbadchans, ubadchans, {},
-                     fDistThresh, fDistThreshDrift, fXHitOffset);
+                     fDistThresh, fDistThreshDrift, fXHitOffset,
+                     fParallelTPCs);
     BuildSystem(tf.TripletsTwoView(),
                 cwires, iwires, orphanSCs,
-                fAlpha != 0, hitmap);
+                fAlpha != 0, neighbours, hitmap);
   }
   else{
     std::cout << "Finding XUV coincidences..." << std::endl;
     TripletFinder tf(xhits, uhits, vhits,
                      xbadchans, ubadchans, vbadchans,
-                     fDistThresh, fDistThreshDrift, fXHitOffset);
+                     fDistThresh, fDistThreshDrift, fXHitOffset,
+                     fParallelTPCs);
     BuildSystem(tf.Triplets(),
                 cwires, iwires, orphanSCs,
-                fAlpha != 0, hitmap);
+                fAlpha != 0, neighbours, hitmap);
   }
 
   FillSystemToSpacePoints(cwires, orphanSCs, spcol_pre);
   spcol_pre.put();
 
   if(fFit){
+    std::unique_ptr<FlatSolver> flat;
+    if(fFlatSolver){
+      flat = std::make_unique<FlatSolver>(cwires, orphanSCs);
+      mf::LogDebug("SpacePointSolver") << "FlatSolver uses " << flat->MemoryUsage() << " bytes";
+    }
+
     std::cout << "Iterating with no regularization..." << std::endl;
-    Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
+    if(flat) Minimize(*flat, 0, fMaxIterationsNoReg);
+    else Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
 
     FillSystemToSpacePoints(cwires, orphanSCs, spcol_noreg);
     spcol_noreg.put();
 
     std::cout << "Now with regularization..." << std::endl;
-    Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
+    if(flat) Minimize(*flat, fAlpha, fMaxIterationsReg);
+    else Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
 
     FillSystemToSpacePointsAndAssns(hitlist, cwires, orphanSCs, hitmap, spcol, *assns);
     spcol.put();
@@ -4,6 +4,13 @@
 
 #include "TVector3.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
 #include "larcore/Geometry/Geometry.h"
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
@@ -19,12 +26,14 @@ namespace reco3d
                                const std::vector<raw::ChannelID_t>& ubad,
                                const std::vector<raw::ChannelID_t>& vbad,
                                double distThresh, double distThreshDrift,
-                               double xhitOffset)
+                               double xhitOffset,
+                               bool parallelTPCs)
     : geom(art::ServiceHandle<geo::Geometry const>()->provider()),
       detprop(art::ServiceHandle<detinfo::DetectorPropertiesService const>()->provider()),
       fDistThresh(distThresh),
       fDistThreshDrift(distThreshDrift),
-      fXHitOffset(xhitOffset)
+      fXHitOffset(xhitOffset),
+      fParallelTPCs(parallelTPCs)
   {
     FillHitMap(xhits, fX_by_tpc);
     FillHitMap(uhits, fU_by_tpc);
@@ -74,9 +83,8 @@ namespace reco3d
   class IntersectionCache
   {
   public:
-    IntersectionCache(geo::TPCID tpc)
-      : geom(art::ServiceHandle<geo::Geometry const>()->provider()),
-        fTPC(tpc)
+    IntersectionCache(const geo::GeometryCore* g, geo::TPCID tpc)
+      : geom(g), fTPC(tpc)
     {
     }
 
@@ -152,114 +160,198 @@ namespace reco3d
   }
 
   // -------------------------------------------------------------------------
-  std::vector<HitTriplet> TripletFinder::Triplets()
+  template<class T> const std::vector<T>& TripletFinder::
+  ByTPC(const std::map<geo::TPCID, std::vector<T>>& m, geo::TPCID tpc)
+  {
+    static const std::vector<T> empty;
+    auto it = m.find(tpc);
+    return it == m.end() ? empty : it->second;
+  }
+
+  // -------------------------------------------------------------------------
+  double SecondsSince(std::chrono::steady_clock::time_point start)
   {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::ForEachTPC(TPCFunc_t func)
+  {
+    std::vector<geo::TPCID> tpcs;
+    for(const auto& it: fX_by_tpc) tpcs.push_back(it.first);
+
+    // The TPCs are independent, so each one fills its own slot and the
+    // results are concatenated in the same order as the serial loop
+    std::vector<std::vector<HitTriplet>> rets(tpcs.size());
+    fStats.assign(tpcs.size(), TPCTripletStats());
+
+    auto processTPC = [&](size_t i)
+      {
+        fStats[i].tpc = tpcs[i];
+        rets[i] = (this->*func)(tpcs[i], fStats[i]);
+      };
+
+    if(fParallelTPCs){
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, tpcs.size(), 1),
+                        [&](const tbb::blocked_range<size_t>& r)
+                        {
+                          for(size_t i = r.begin(); i != r.end(); ++i) processTPC(i);
+                        });
+    }
+    else{
+      for(size_t i = 0; i < tpcs.size(); ++i) processTPC(i);
+    }
+
+    size_t nTot = 0;
+    for(const std::vector<HitTriplet>& r: rets) nTot += r.size();
+
     std::vector<HitTriplet> ret;
+    ret.reserve(nTot);
+    for(const std::vector<HitTriplet>& r: rets) ret.insert(ret.end(), r.begin(), r.end());
+
+    return ret;
+  }
+
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::Triplets()
+  {
+    std::vector<HitTriplet> ret = ForEachTPC(&TripletFinder::TripletsTPC);
+
+    for(const TPCTripletStats& s: fStats){
+      std::cout << s.tpc << " " << s.nXU << " XUs and " << s.nXV << " XVs -> " << s.nTriplets << " XUVs"
+                << " (" << 1e3*s.doubletTime << " ms doublets, " << 1e3*s.tripletTime << " ms triplets)" << std::endl;
+    }
+
+    std::cout << ret.size() << " XUVs total" << std::endl;
 
-    for(const auto& it: fX_by_tpc){
-      const geo::TPCID& tpc = it.first;
+    return ret;
+  }
 
-      std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
-      std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::TripletsTPC(geo::TPCID tpc,
+                                                     TPCTripletStats& stats) const
+  {
+    std::vector<HitTriplet> ret;
 
-      // Cache to prevent repeating the same questions
-      IntersectionCache isectUV(tpc);
+    auto start = std::chrono::steady_clock::now();
 
-      // For the efficient looping below to work we need to sort the doublet
-      // lists so the X hits occur in the same order.
-      std::sort(xus.begin(), xus.end(), LessThanXHit);
-      std::sort(xvs.begin(), xvs.end(), LessThanXHit);
+    std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
+    std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
 
-      auto xvit_begin = xvs.begin();
+    stats.doubletTime = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
 
-      int nxuv = 0;
-      for(const ChannelDoublet& xu: xus){
-        const HitOrChan& x = xu.a;
-        const HitOrChan& u = xu.b;
+    // Cache to prevent repeating the same questions
+    IntersectionCache isectUV(geom, tpc);
 
-        // Catch up until we're looking at the same X hit in XV
-        while(xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu)) ++xvit_begin;
+    // For the efficient looping below to work we need to sort the doublet
+    // lists so the X hits occur in the same order.
+    std::sort(xus.begin(), xus.end(), LessThanXHit);
+    std::sort(xvs.begin(), xvs.end(), LessThanXHit);
 
-        // Loop through all those matching hits
-        for(auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit){
-          const HitOrChan& v = xvit->b;
+    auto xvit_begin = xvs.begin();
 
-          // Only allow one bad channel per triplet
-          if(!x.hit && !u.hit) continue;
-          if(!x.hit && !v.hit) continue;
-          if(!u.hit && !v.hit) continue;
+    for(const ChannelDoublet& xu: xus){
+      const HitOrChan& x = xu.a;
+      const HitOrChan& u = xu.b;
 
-          if(u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
+      // Catch up until we're looking at the same X hit in XV
+      while(xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu)) ++xvit_begin;
 
-          geo::WireIDIntersection ptUV;
-          if(!isectUV(u.chan, v.chan, ptUV)) continue;
+      // Loop through all those matching hits
+      for(auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit){
+        const HitOrChan& v = xvit->b;
 
-          if(!CloseSpace(xu.pt, xvit->pt) ||
-             !CloseSpace(xu.pt, ptUV) ||
-             !CloseSpace(xvit->pt, ptUV)) continue;
+        // Only allow one bad channel per triplet
+        if(!x.hit && !u.hit) continue;
+        if(!x.hit && !v.hit) continue;
+        if(!u.hit && !v.hit) continue;
 
-          double xavg = 0;
-          int nx = 0;
-          if(x.hit){xavg += x.xpos; ++nx;}
-          if(u.hit){xavg += u.xpos; ++nx;}
-          if(v.hit){xavg += v.xpos; ++nx;}
-          xavg /= nx;
+        if(u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
 
-          const XYZ pt{xavg,
-              (xu.pt.y + xvit->pt.y + ptUV.y)/3,
-              (xu.pt.z + xvit->pt.z + ptUV.z)/3};
+        geo::WireIDIntersection ptUV;
+        if(!isectUV(u.chan, v.chan, ptUV)) continue;
 
-          ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
-          ++nxuv;
-        } // end for xv
-      } // end for xu
+        if(!CloseSpace(xu.pt, xvit->pt) ||
+           !CloseSpace(xu.pt, ptUV) ||
+           !CloseSpace(xvit->pt, ptUV)) continue;
 
-      std::cout << tpc << " " << xus.size() << " XUs and " << xvs.size() << " XVs -> " << nxuv << " XUVs" << std::endl;
+        double xavg = 0;
+        int nx = 0;
+        if(x.hit){xavg += x.xpos; ++nx;}
+        if(u.hit){xavg += u.xpos; ++nx;}
+        if(v.hit){xavg += v.xpos; ++nx;}
+        xavg /= nx;
 
-    } // end for tpc
+        const XYZ pt{xavg,
+            (xu.pt.y + xvit->pt.y + ptUV.y)/3,
+            (xu.pt.z + xvit->pt.z + ptUV.z)/3};
 
-    std::cout << ret.size() << " XUVs total" << std::endl;
+        ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
+      } // end for xv
+    } // end for xu
+
+    stats.tripletTime = SecondsSince(start);
+    stats.nXU = xus.size();
+    stats.nXV = xvs.size();
+    stats.nTriplets = ret.size();
 
     return ret;
   }
 
   // -------------------------------------------------------------------------
   std::vector<HitTriplet> TripletFinder::TripletsTwoView()
+  {
+    std::vector<HitTriplet> ret = ForEachTPC(&TripletFinder::TripletsTwoViewTPC);
+
+    for(const TPCTripletStats& s: fStats){
+      std::cout << s.tpc << " " << s.nXU << " XUs"
+                << " (" << 1e3*s.doubletTime << " ms doublets)" << std::endl;
+    }
+
+    std::cout << ret.size() << " XUs total" << std::endl;
+
+    return ret;
+  }
+
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::
+  TripletsTwoViewTPC(geo::TPCID tpc, TPCTripletStats& stats) const
   {
     std::vector<HitTriplet> ret;
 
-    for(const auto& it: fX_by_tpc){
-      const geo::TPCID& tpc = it.first;
+    const auto start = std::chrono::steady_clock::now();
 
-      std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
+    std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
 
-      for(const ChannelDoublet& xu: xus){
-        const HitOrChan& x = xu.a;
-        const HitOrChan& u = xu.b;
+    for(const ChannelDoublet& xu: xus){
+      const HitOrChan& x = xu.a;
+      const HitOrChan& u = xu.b;
 
-        double xavg = x.xpos;
-        int nx = 1;
-        if(u.hit){xavg += u.xpos; ++nx;}
-        xavg /= nx;
+      double xavg = x.xpos;
+      int nx = 1;
+      if(u.hit){xavg += u.xpos; ++nx;}
+      xavg /= nx;
 
-        const XYZ pt{xavg, xu.pt.y, xu.pt.z};
+      const XYZ pt{xavg, xu.pt.y, xu.pt.z};
 
-        ret.emplace_back(HitTriplet{x.hit, u.hit, 0, pt});
-      } // end for xu
-    } // end for tpc
+      ret.emplace_back(HitTriplet{x.hit, u.hit, 0, pt});
+    } // end for xu
 
-    std::cout << ret.size() << " XUs total" << std::endl;
+    stats.doubletTime = SecondsSince(start);
+    stats.nXU = xus.size();
+    stats.nTriplets = ret.size();
 
     return ret;
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret = DoubletHelper(tpc, fX_by_tpc[tpc], fU_by_tpc[tpc], fUbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = DoubletHelper(tpc, ByTPC(fX_by_tpc, tpc), ByTPC(fU_by_tpc, tpc), ByTPC(fUbad_by_tpc, tpc));
 
     // Find X(bad)+U(good) doublets, have to flip them for the final result
-    for(auto it: DoubletHelper(tpc, fU_by_tpc[tpc], {}, fXbad_by_tpc[tpc])){
+    for(auto it: DoubletHelper(tpc, ByTPC(fU_by_tpc, tpc), {}, ByTPC(fXbad_by_tpc, tpc))){
       ret.push_back({it.b, it.a, it.pt});
     }
 
@@ -267,12 +359,12 @@ namespace reco3d
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret = DoubletHelper(tpc, fX_by_tpc[tpc], fV_by_tpc[tpc], fVbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = DoubletHelper(tpc, ByTPC(fX_by_tpc, tpc), ByTPC(fV_by_tpc, tpc), ByTPC(fVbad_by_tpc, tpc));
 
     // Find X(bad)+V(good) doublets, have to flip them for the final result
-    for(auto it: DoubletHelper(tpc, fV_by_tpc[tpc], {}, fXbad_by_tpc[tpc])){
+    for(auto it: DoubletHelper(tpc, ByTPC(fV_by_tpc, tpc), {}, ByTPC(fXbad_by_tpc, tpc))){
       ret.push_back({it.b, it.a, it.pt});
     }
 
@@ -288,9 +380,12 @@ namespace reco3d
   {
     std::vector<ChannelDoublet> ret;
 
-    IntersectionCache isect(tpc);
+    IntersectionCache isect(geom, tpc);
 
+    // Both lists are sorted in the drift direction, so the b hits close to
+    // each a hit are a contiguous window, whose edges only move forwards
     auto b_begin = bhits.begin();
+    auto b_end = bhits.begin();
 
     for(const HitOrChan& a: ahits){
       // Bad channels are easy because there's no timing constraint
@@ -301,15 +396,20 @@ namespace reco3d
         }
       }
 
-      while(b_begin != bhits.end() &&
-            b_begin->xpos < a.xpos &&
-            !CloseDrift(b_begin->xpos, a.xpos)) ++b_begin;
-
-      for(auto bit = b_begin; bit != bhits.end(); ++bit){
+      b_begin = std::partition_point(b_begin, bhits.end(),
+                                     [&](const HitOrChan& b)
+                                     {
+                                       return b.xpos < a.xpos && !CloseDrift(b.xpos, a.xpos);
+                                     });
+      b_end = std::partition_point(std::max(b_begin, b_end), bhits.end(),
+                                   [&](const HitOrChan& b)
+                                   {
+                                     return !(b.xpos > a.xpos && !CloseDrift(b.xpos, a.xpos));
+                                   });
+
+      for(auto bit = b_begin; bit != b_end; ++bit){
         const HitOrChan& b = *bit;
 
-        if(b.xpos > a.xpos && !CloseDrift(b.xpos, a.xpos)) break;
-
         geo::WireIDIntersection pt;
         if(!isect(a.chan, b.chan, pt)) continue;
 
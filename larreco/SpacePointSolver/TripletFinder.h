@@ -50,6 +50,16 @@ namespace reco3d
     XYZ pt;
   };
 
+  /// Counters and timings for the search in one TPC
+  struct TPCTripletStats
+  {
+    geo::TPCID tpc;
+    size_t nXU = 0, nXV = 0;
+    size_t nTriplets = 0;
+    double doubletTime = 0; ///< seconds spent finding XU and XV doublets
+    double tripletTime = 0; ///< seconds spent combining them
+  };
+
   class TripletFinder
   {
   public:
@@ -60,12 +70,16 @@ namespace reco3d
                   const std::vector<raw::ChannelID_t>& ubad,
                   const std::vector<raw::ChannelID_t>& vbad,
                   double distThresh, double distThreshDrift,
-                  double xhitOffset);
+                  double xhitOffset,
+                  bool parallelTPCs = false);
 
     std::vector<HitTriplet> Triplets();
     /// Only search for XU intersections
     std::vector<HitTriplet> TripletsTwoView();
 
+    /// Per-TPC counters of the last call to Triplets() or TripletsTwoView()
+    const std::vector<TPCTripletStats>& Stats() const {return fStats;}
+
   protected:
     const geo::GeometryCore* geom;
     const detinfo::DetectorProperties* detprop;
@@ -81,8 +95,26 @@ namespace reco3d
     bool CloseSpace(geo::WireIDIntersection ra,
                     geo::WireIDIntersection rb) const;
 
-    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc);
-    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc);
+    /// Function finding the triplets of a single TPC
+    typedef std::vector<HitTriplet>
+      (TripletFinder::*TPCFunc_t)(geo::TPCID, TPCTripletStats&) const;
+
+    /// Runs \a func for each TPC with collection hits, concurrently if
+    /// requested, and concatenates the results in TPC order
+    std::vector<HitTriplet> ForEachTPC(TPCFunc_t func);
+
+    std::vector<HitTriplet> TripletsTPC(geo::TPCID tpc,
+                                        TPCTripletStats& stats) const;
+    std::vector<HitTriplet> TripletsTwoViewTPC(geo::TPCID tpc,
+                                               TPCTripletStats& stats) const;
+
+    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc) const;
+    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc) const;
+
+    /// The entry for \a tpc, or an empty vector. Unlike operator[] this does
+    /// not modify the map, so is safe to call from several threads
+    template<class T> static const std::vector<T>&
+    ByTPC(const std::map<geo::TPCID, std::vector<T>>& m, geo::TPCID tpc);
 
     std::vector<ChannelDoublet>
     DoubletHelper(geo::TPCID tpc,
@@ -93,6 +125,9 @@ namespace reco3d
     double fDistThresh;
     double fDistThreshDrift;
     double fXHitOffset;
+    bool fParallelTPCs;
+
+    std::vector<TPCTripletStats> fStats;
 
     std::map<geo::TPCID, std::vector<HitOrChan>> fX_by_tpc;
     std::map<geo::TPCID, std::vector<HitOrChan>> fU_by_tpc;
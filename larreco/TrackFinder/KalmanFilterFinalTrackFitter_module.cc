@@ -13,6 +13,7 @@
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/Table.h"
 #include "canvas/Utilities/InputTag.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 #include "canvas/Persistency/Common/FindManyP.h"
 
 #include "lardataobj/RecoBase/PFParticle.h"
@@ -173,6 +174,7 @@ namespace trkf {
 
   private:
     void produce(art::Event & e) override;
+    void endJob() override;
 
     Parameters p_;
     TrackStatePropagator prop;
@@ -621,4 +623,11 @@ bool trkf::KalmanFilterFinalTrackFitter::setDirFlip(const recob::Track& track, T
   return result;
 }
 
+void trkf::KalmanFilterFinalTrackFitter::endJob() {
+  const auto counters = kalmanFitter.counters();
+  mf::LogInfo("KalmanFilterFinalTrackFitter") << "Kalman fits: " << counters.fits << " (" << counters.failedFits << " failed), "
+				   << counters.propagations << " propagations, " << counters.updates << " updates, "
+				   << counters.rejectedHits << " rejected hits";
+}
+
 DEFINE_ART_MODULE(trkf::KalmanFilterFinalTrackFitter)
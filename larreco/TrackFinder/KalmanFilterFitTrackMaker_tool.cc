@@ -203,6 +203,13 @@ namespace trkmkr {
       return;
     }
 
+    /// the fit only reads the configuration and the products retrieved in initEvent
+    bool
+    isThreadSafe() const override
+    {
+      return true;
+    }
+
     /// function that actually calls the fitter
     bool makeTrackImpl(const recob::TrackTrajectory& traj,
                        const int tkID,
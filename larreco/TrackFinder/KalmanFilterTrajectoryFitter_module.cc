@@ -13,6 +13,7 @@
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/Table.h"
 #include "canvas/Utilities/InputTag.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include "lardataobj/RecoBase/Track.h"
 #include "lardataobj/RecoBase/Hit.h"
@@ -130,6 +131,7 @@ namespace trkf {
 
   private:
     void produce(art::Event & e) override;
+    void endJob() override;
 
     Parameters p_;
     TrackStatePropagator prop;
@@ -395,4 +397,11 @@ bool trkf::KalmanFilterTrajectoryFitter::setDirFlip(const recob::TrackTrajectory
   return result;
 }
 
+void trkf::KalmanFilterTrajectoryFitter::endJob() {
+  const auto counters = kalmanFitter.counters();
+  mf::LogInfo("KalmanFilterTrajectoryFitter") << "Kalman fits: " << counters.fits << " (" << counters.failedFits << " failed), "
+				   << counters.propagations << " propagations, " << counters.updates << " updates, "
+				   << counters.rejectedHits << " rejected hits";
+}
+
 DEFINE_ART_MODULE(trkf::KalmanFilterTrajectoryFitter)
@@ -89,11 +89,8 @@ void trkf::MCSFitProducer::produce(art::Event & e)
   bool ok = e.getByLabel(inputTag,inputH);
   if (!ok) throw cet::exception("MCSFitProducer") << "Cannot find input art::Handle with inputTag " << inputTag;
   const auto& inputVec = *(inputH.product());
-  for (const auto& element : inputVec) {
-    //fit
-    recob::MCSFitResult result = mcsfitter.fitMcs(element);
-    output->emplace_back(std::move(result));
-  }
+  //fit all tracks concurrently, results are in the order of the input tracks
+  *output = mcsfitter.fitMcs(inputVec);
   e.put(std::move(output));
 }
 
@@ -15,6 +15,7 @@
 #include <sstream>
 #include <iterator> // std::distance()
 #include <algorithm> // std::sort()
+#include <memory> // std::make_shared()
 
 // ROOT includes
 #include "TVector3.h"
@@ -47,6 +48,8 @@
 #include "larreco/Genfit/PointHit.h"
 #include "larreco/Genfit/GFTrack.h"
 #include "larreco/Genfit/GFKalman.h"
+#include "larreco/Genfit/GFMaterialCache.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
 
 // LArSoft includes
 #include "larcore/Geometry/Geometry.h"
@@ -179,6 +182,7 @@ namespace trkf {
     int fPdg;
     double fChi2Thresh;
     int fMaxPass;
+    double fMaterialCacheVoxelSize;
 
     genf::GFAbsTrackRep *repMC;
     genf::GFAbsTrackRep *rep;
@@ -232,6 +236,7 @@ namespace trkf {
     fChi2Thresh            = pset.get< double >("Chi2HitThresh", 12.0E12); //For Re-pass.
     fSortDim               = pset.get< std::string> ("SortDirection", "z"); // case sensitive
     fMaxPass               = pset.get< int  >("MaxPass", 2); // mu+ Hypothesis.
+    fMaterialCacheVoxelSize = pset.get< double >("MaterialCacheVoxelSize", 0.); // cm, 0 for no material cache.
     bool fGenfPRINT;
     if (pset.get_if_present("GenfPRINT", fGenfPRINT)) {
       MF_LOG_WARNING("Track3DKalmanSPS_GenFit")
@@ -396,6 +401,15 @@ namespace trkf {
   void Track3DKalmanSPS::beginJob()
   {
 
+    if (fMaterialCacheVoxelSize > 0.)
+      {
+        // material effects look the geometry up in the cache where no boundary is crossed
+        art::ServiceHandle<geo::Geometry const> geom;
+        auto cache = std::make_shared<genf::GFMaterialCache const>(*(geom->ROOTGeoManager()), fMaterialCacheVoxelSize);
+        MF_LOG_DEBUG("Track3DKalmanSPS_GenFit") << "Material cache of " << cache->nVoxels() << " voxels of "
+          << cache->voxelSize() << " cm, " << cache->nMaterials() << " materials";
+        genf::GFMaterialEffects::setMaterialCache(cache);
+      }
 
     art::ServiceHandle<art::TFileService const> tfs;
 
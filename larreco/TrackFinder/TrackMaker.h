@@ -142,6 +142,8 @@ namespace trkmkr {
    *
    * The tool is not meant to put collections in the event.
    *
+   * Tools whose makeTrack functions can run concurrently on different inputs declare it overriding isThreadSafe; producers may then fit several tracks in parallel.
+   *
    * Requirements are that a Track has at least 2 points, that it has the same number of Points and Momenta,
    * that TrajectoryPoints and Hit have a 1-1 correspondance (same number and  same order).
    *
@@ -156,6 +158,8 @@ namespace trkmkr {
 
     /// per-event initialization; concrete classes may override this function to retrieve other products or associations from the event.
     virtual void initEvent(const art::Event& e) { return; }
+    /// whether makeTrack can be called concurrently for different inputs (after initEvent); concrete classes may override this function to allow parallel fits.
+    virtual bool isThreadSafe() const { return false; }
 
     //@{
     /// makeTrack functions with recob::Trajectory as argument; calls the version with recob::TrackTrajectory using a dummy flags vector.
@@ -14,6 +14,9 @@
 //
 #include <memory>
 //
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+//
 #include "art/Utilities/make_tool.h"
 #include "larreco/TrackFinder/TrackMaker.h"
 #include "lardataobj/RecoBase/PFParticle.h"
@@ -41,7 +44,8 @@
    * spacePointsFromTrajP (bool to decide whether the produced recob::SpacePoint's are taken from the recob::tracking::TrajectoryPoint_t's of the fitted recob::Track),
    * trackFromPF (bool to decide whether to fit the recob::Track associated to the recob::PFParticle), and
    * showerFromPF (bool to decide whether to fit the recob::Shower associated to the recob::PFParticle - this option is intended to mitigate possible problems due to tracks being mis-identified as showers)
-   * seedFromPF (bool to decide whether to fit the recob::PFParticle using the associated seed)
+   * seedFromPF (bool to decide whether to fit the recob::PFParticle using the associated seed),
+   * parallelFits (bool to decide whether to run the fits concurrently, if the tool declares itself thread-safe; the outputs are the same as with serial fits)
    *
    * @author  G. Cerati (FNAL, MicroBooNE)
    * @date    2017
@@ -61,8 +65,21 @@ public:
   TrackProducerFromPFParticle & operator = (TrackProducerFromPFParticle const &) = delete;
   TrackProducerFromPFParticle & operator = (TrackProducerFromPFParticle &&) = delete;
 private:
+  /// Input and output of one fit; fits are collected in the order of the loop over PFParticles
+  struct FitJob {
+    art::Ptr<recob::PFParticle> pfp;
+    art::Ptr<recob::Track> track;                  // input track, if fitting the track associated to the PFParticle
+    std::unique_ptr<recob::TrackTrajectory> traj;  // input trajectory otherwise (from shower or seed)
+    int tkID = -1;
+    std::vector<art::Ptr<recob::Hit> > inHits;
+    bool fitok = false;
+    recob::Track outTrack;
+    std::vector<art::Ptr<recob::Hit> > outHits;
+    trkmkr::OptionalOutputs optionals;
+  };
   // Required functions.
   void produce(art::Event & e) override;
+  void runFit(FitJob& job) const;
   std::unique_ptr<trkmkr::TrackMaker> trackMaker_;
   art::InputTag pfpInputTag;
   art::InputTag trkInputTag;
@@ -74,6 +91,7 @@ private:
   bool trackFromPF_;
   bool showerFromPF_;
   bool seedFromPF_;
+  bool parallelFits_;
 };
 //
 TrackProducerFromPFParticle::TrackProducerFromPFParticle(fhicl::ParameterSet const & p)
@@ -86,6 +104,7 @@ TrackProducerFromPFParticle::TrackProducerFromPFParticle(fhicl::ParameterSet con
   , trackFromPF_{p.get<bool>("trackFromPF")}
   , showerFromPF_{p.get<bool>("showerFromPF")}
   , seedFromPF_{p.get<bool>("seedFromPF")}
+  , parallelFits_{p.get<bool>("parallelFits", false)}
 {
   //
   if (p.has_key("trackInputTag")) trkInputTag = p.get<art::InputTag>("trackInputTag");
@@ -140,7 +159,8 @@ void TrackProducerFromPFParticle::produce(art::Event & e)
   // Initialize tool for this event
   trackMaker_->initEvent(e);
   //
-  // Loop over pfps to fit
+  // Collect the fits to do, looping over pfps
+  std::vector<FitJob> jobs;
   for (unsigned int iPfp = 0; iPfp < inputPfps->size(); ++iPfp) {
     //
     const art::Ptr<recob::PFParticle> pfp(inputPfps, iPfp);
@@ -152,58 +172,12 @@ void TrackProducerFromPFParticle::produce(art::Event & e)
       for (art::Ptr<recob::Track> const& track: tracks) {
 	//
 	// Get track and its hits
-	std::vector<art::Ptr<recob::Hit> > inHits;
+	FitJob job;
+	job.pfp = pfp;
+	job.track = track;
 	decltype(auto) hitsRange = util::groupByIndex(trackHitsGroups, track.key());
-	for (art::Ptr<recob::Hit> const& hit: hitsRange) inHits.push_back(hit);
-	//
-	// Declare output objects
-	recob::Track outTrack;
-	std::vector<art::Ptr<recob::Hit> > outHits;
-	trkmkr::OptionalOutputs optionals;
-	if (doTrackFitHitInfo_) optionals.initTrackFitInfos();
-	if (doSpacePoints_ && !spacePointsFromTrajP_) optionals.initSpacePoints();
-	//
-	// Invoke tool to fit track and fill output objects
-	bool fitok = trackMaker_->makeTrack(track, inHits, outTrack, outHits, optionals);
-	if (!fitok) continue;
-	//
-	// Check that the requirement Nhits == Npoints is satisfied
-	// We also require the hits to the in the same order as the points (this cannot be enforced, can it?)
-	if (outTrack.NumberTrajectoryPoints()!=outHits.size()) {
-	  throw cet::exception("TrackProducerFromPFParticle") << "Produced recob::Track required to have 1-1 correspondance between hits and points.\n";
-	}
-	//
-	// Fill output collections, including Assns
-	outputTracks->emplace_back(std::move(outTrack));
-	const art::Ptr<recob::Track> aptr = trackPtrMaker(outputTracks->size()-1);
-	outputPfpTAssn->addSingle(pfp, aptr);
-	unsigned int ip = 0;
-	for (auto const& trhit: outHits) {
-	  recob::TrackHitMeta metadata(outputTracks->back().HasValidPoint(ip) ? ip : std::numeric_limits<int>::max(), -std::numeric_limits<double>::max());
-	  outputHits->addSingle(aptr, trhit, metadata);
-	  //
-	  if (doSpacePoints_ && spacePointsFromTrajP_ && outputTracks->back().HasValidPoint(ip)) {
-	    auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-	    const double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
-	    const double fErrXYZ[6] = {0};
-	    recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-	    outputSpacePoints->emplace_back(std::move(sp));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(trhit, apsp);
-	  }
-	  ip++;
-	}
-	if (doSpacePoints_ && !spacePointsFromTrajP_) {
-	  auto osp = optionals.spacePointHitPairs();
-	  for (auto it = osp.begin(); it!=osp.end(); ++it ) {
-	    outputSpacePoints->emplace_back(std::move(it->first));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(it->second,apsp);
-	  }
-	}
-	if (doTrackFitHitInfo_) {
-	  outputHitInfo->emplace_back(optionals.trackFitHitInfos());
-	}
+	for (art::Ptr<recob::Hit> const& hit: hitsRange) job.inHits.push_back(hit);
+	jobs.push_back(std::move(job));
       }
     }
     //
@@ -237,56 +211,12 @@ void TrackProducerFromPFParticle::produce(art::Event & e)
 	  p.push_back(pos);
 	  d.push_back(mom*dir);
 	}
-	recob::TrackTrajectory traj(std::move(p), std::move(d), recob::TrackTrajectory::Flags_t(p.size()), false);
-	//
-	// Declare output objects
-	recob::Track outTrack;
-	std::vector<art::Ptr<recob::Hit> > outHits;
-	trkmkr::OptionalOutputs optionals;
-	if (doTrackFitHitInfo_) optionals.initTrackFitInfos();
-	if (doSpacePoints_ && !spacePointsFromTrajP_) optionals.initSpacePoints();
-	//
-	// Invoke tool to fit track and fill output objects
-	bool fitok = trackMaker_->makeTrack(traj, iPfp, inHits, outTrack, outHits, optionals);
-	if (!fitok) continue;
-	//
-	// Check that the requirement Nhits == Npoints is satisfied
-	// We also require the hits to the in the same order as the points (this cannot be enforced, can it?)
-	if (outTrack.NumberTrajectoryPoints()!=outHits.size()) {
-	  throw cet::exception("TrackProducerFromPFParticle") << "Produced recob::Track required to have 1-1 correspondance between hits and points.\n";
-	}
-	//
-	// Fill output collections, including Assns
-	outputTracks->emplace_back(std::move(outTrack));
-	const art::Ptr<recob::Track> aptr = trackPtrMaker(outputTracks->size()-1);
-	outputPfpTAssn->addSingle(pfp, aptr);
-	unsigned int ip = 0;
-	for (auto const& trhit: outHits) {
-	  recob::TrackHitMeta metadata(outputTracks->back().HasValidPoint(ip) ? ip : std::numeric_limits<int>::max(), -std::numeric_limits<double>::max());
-	  outputHits->addSingle(aptr, trhit, metadata);
-	  //
-	  if (doSpacePoints_ && spacePointsFromTrajP_ && outputTracks->back().HasValidPoint(ip)) {
-	    auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-	    const double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
-	    const double fErrXYZ[6] = {0};
-	    recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-	    outputSpacePoints->emplace_back(std::move(sp));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(trhit, apsp);
-	  }
-	  ip++;
-	}
-	if (doSpacePoints_ && !spacePointsFromTrajP_) {
-	  auto osp = optionals.spacePointHitPairs();
-	  for (auto it = osp.begin(); it!=osp.end(); ++it ) {
-	    outputSpacePoints->emplace_back(std::move(it->first));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(it->second,apsp);
-	  }
-	}
-	if (doTrackFitHitInfo_) {
-	  outputHitInfo->emplace_back(optionals.trackFitHitInfos());
-	}
+	FitJob job;
+	job.pfp = pfp;
+	job.traj = std::make_unique<recob::TrackTrajectory>(std::move(p), std::move(d), recob::TrackTrajectory::Flags_t(inHits.size()), false);
+	job.tkID = iPfp;
+	job.inHits = inHits;
+	jobs.push_back(std::move(job));
       }
     }
     //
@@ -324,61 +254,70 @@ void TrackProducerFromPFParticle::produce(art::Event & e)
 	  p.push_back(pos);
 	  d.push_back(dir);
 	}
-	recob::TrackTrajectory traj(std::move(p), std::move(d), recob::TrackTrajectory::Flags_t(p.size()), false);
-	//
-	// Declare output objects
-	recob::Track outTrack;
-	std::vector<art::Ptr<recob::Hit> > outHits;
-	trkmkr::OptionalOutputs optionals;
-	if (doTrackFitHitInfo_) optionals.initTrackFitInfos();
-	if (doSpacePoints_ && !spacePointsFromTrajP_) optionals.initSpacePoints();
-	//
-	// Invoke tool to fit track and fill output objects
-	bool fitok = trackMaker_->makeTrack(traj, iPfp, inHits, outTrack, outHits, optionals);
-	if (!fitok) continue;
-	//
-	// Check that the requirement Nhits == Npoints is satisfied
-	// We also require the hits to the in the same order as the points (this cannot be enforced, can it?)
-	if (outTrack.NumberTrajectoryPoints()!=outHits.size()) {
-	  throw cet::exception("TrackProducerFromPFParticle") << "Produced recob::Track required to have 1-1 correspondance between hits and points.\n";
-	}
-	//
-	// Fill output collections, including Assns
-	outputTracks->emplace_back(std::move(outTrack));
-	const art::Ptr<recob::Track> aptr = trackPtrMaker(outputTracks->size()-1);
-	outputPfpTAssn->addSingle(pfp, aptr);
-	unsigned int ip = 0;
-	for (auto const& trhit: outHits) {
-	  recob::TrackHitMeta metadata(outputTracks->back().HasValidPoint(ip) ? ip : std::numeric_limits<int>::max(), -std::numeric_limits<double>::max());
-	  outputHits->addSingle(aptr, trhit, metadata);
-	  //
-	  if (doSpacePoints_ && spacePointsFromTrajP_ && outputTracks->back().HasValidPoint(ip)) {
-	    auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-	    const double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
-	    const double fErrXYZ[6] = {0};
-	    recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-	    outputSpacePoints->emplace_back(std::move(sp));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(trhit, apsp);
-	  }
-	  ip++;
-	}
-	if (doSpacePoints_ && !spacePointsFromTrajP_) {
-	  auto osp = optionals.spacePointHitPairs();
-	  for (auto it = osp.begin(); it!=osp.end(); ++it ) {
-	    outputSpacePoints->emplace_back(std::move(it->first));
-	    const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
-	    outputHitSpacePointAssn->addSingle(it->second,apsp);
-	  }
-	}
-	if (doTrackFitHitInfo_) {
-	  outputHitInfo->emplace_back(optionals.trackFitHitInfos());
-	}
+	FitJob job;
+	job.pfp = pfp;
+	job.traj = std::make_unique<recob::TrackTrajectory>(std::move(p), std::move(d), recob::TrackTrajectory::Flags_t(inHits.size()), false);
+	job.tkID = iPfp;
+	job.inHits = inHits;
+	jobs.push_back(std::move(job));
       }
     }
     //
   }
   //
+  // Invoke tool to fit tracks, concurrently if the tool allows it
+  if (parallelFits_ && trackMaker_->isThreadSafe()) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, jobs.size(), 1),
+      [&](const tbb::blocked_range<size_t>& r) {
+	for (size_t i = r.begin(); i != r.end(); ++i) runFit(jobs[i]);
+      });
+  } else {
+    for (auto& job : jobs) runFit(job);
+  }
+  //
+  // Fill output collections in the order of the fits
+  for (auto& job : jobs) {
+    if (!job.fitok) continue;
+    //
+    // Check that the requirement Nhits == Npoints is satisfied
+    // We also require the hits to the in the same order as the points (this cannot be enforced, can it?)
+    if (job.outTrack.NumberTrajectoryPoints()!=job.outHits.size()) {
+      throw cet::exception("TrackProducerFromPFParticle") << "Produced recob::Track required to have 1-1 correspondance between hits and points.\n";
+    }
+    //
+    // Fill output collections, including Assns
+    outputTracks->emplace_back(std::move(job.outTrack));
+    const art::Ptr<recob::Track> aptr = trackPtrMaker(outputTracks->size()-1);
+    outputPfpTAssn->addSingle(job.pfp, aptr);
+    unsigned int ip = 0;
+    for (auto const& trhit: job.outHits) {
+      recob::TrackHitMeta metadata(outputTracks->back().HasValidPoint(ip) ? ip : std::numeric_limits<int>::max(), -std::numeric_limits<double>::max());
+      outputHits->addSingle(aptr, trhit, metadata);
+      //
+      if (doSpacePoints_ && spacePointsFromTrajP_ && outputTracks->back().HasValidPoint(ip)) {
+	auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
+	const double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
+	const double fErrXYZ[6] = {0};
+	recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
+	outputSpacePoints->emplace_back(std::move(sp));
+	const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
+	outputHitSpacePointAssn->addSingle(trhit, apsp);
+      }
+      ip++;
+    }
+    if (doSpacePoints_ && !spacePointsFromTrajP_) {
+      auto osp = job.optionals.spacePointHitPairs();
+      for (auto it = osp.begin(); it!=osp.end(); ++it ) {
+	outputSpacePoints->emplace_back(std::move(it->first));
+	const art::Ptr<recob::SpacePoint> apsp = (*spacePointPtrMaker)(outputSpacePoints->size()-1);
+	outputHitSpacePointAssn->addSingle(it->second,apsp);
+      }
+    }
+    if (doTrackFitHitInfo_) {
+      outputHitInfo->emplace_back(job.optionals.trackFitHitInfos());
+    }
+  }
+  //
   // Put collections in the event
   e.put(std::move(outputTracks));
   e.put(std::move(outputHits));
@@ -393,4 +332,12 @@ void TrackProducerFromPFParticle::produce(art::Event & e)
   if (doSpacePoints_) delete spacePointPtrMaker;
 }
 //
+void TrackProducerFromPFParticle::runFit(FitJob& job) const
+{
+  if (doTrackFitHitInfo_) job.optionals.initTrackFitInfos();
+  if (doSpacePoints_ && !spacePointsFromTrajP_) job.optionals.initSpacePoints();
+  if (job.track.isNonnull()) job.fitok = trackMaker_->makeTrack(job.track, job.inHits, job.outTrack, job.outHits, job.optionals);
+  else job.fitok = trackMaker_->makeTrack(*job.traj, job.tkID, job.inHits, job.outTrack, job.outHits, job.optionals);
+}
+//
 DEFINE_ART_MODULE(TrackProducerFromPFParticle)
@@ -0,0 +1,166 @@
+/**
+ * @file   GFMaterialCache_test.cc
+ * @brief  Test of the material cache against the navigation of the geometry
+ * @see    GFMaterialCache.h
+ *
+ * The geometry is an iron box in a liquid argon box. Every step the cache
+ * answers must stay in a single volume when navigated with
+ * FindNextBoundaryAndStep(), and the cached material must be the material
+ * of that volume.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( GFMaterialCache_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// ROOT
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoNavigator.h"
+#include "TGeoVolume.h"
+
+// LArSoft libraries
+#include "larreco/Genfit/GFMaterialCache.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
+
+namespace {
+
+  const double WorldHalfSize = 100.; // cm
+  const double InnerHalfSize[3] = { 20., 30., 40. }; // cm
+  const double InnerCentre[3] = { 10., -5., 0. }; // cm
+
+  /// builds the box-in-box geometry in gGeoManager
+  struct BoxInBox {
+    BoxInBox() {
+      new TGeoManager("BoxInBox", "iron box in a liquid argon box");
+      TGeoMedium* lar = new TGeoMedium("LAr", 1, new TGeoMaterial("LAr", 39.948, 18., 1.396));
+      TGeoMedium* iron = new TGeoMedium("Fe", 2, new TGeoMaterial("Fe", 55.845, 26., 7.874));
+      TGeoVolume* top = gGeoManager->MakeBox("World", lar, WorldHalfSize, WorldHalfSize, WorldHalfSize);
+      gGeoManager->SetTopVolume(top);
+      TGeoVolume* inner = gGeoManager->MakeBox("Inner", iron, InnerHalfSize[0], InnerHalfSize[1], InnerHalfSize[2]);
+      top->AddNode(inner, 1, new TGeoTranslation(InnerCentre[0], InnerCentre[1], InnerCentre[2]));
+      gGeoManager->CloseGeometry();
+    }
+    ~BoxInBox() { delete gGeoManager; }
+  };
+
+  /// checks that a step the cache answers crosses no boundary and is in the cached material
+  void checkStep(const genf::GFMaterialCache& cache, TGeoNavigator& nav,
+                 const double pos[3], const double dir[3], double dist)
+  {
+    const genf::GFMaterialCache::MaterialParameters* cached = cache.find(pos[0], pos[1], pos[2], dist);
+    if (!cached) return; // left to the navigation
+
+    nav.InitTrack(pos, dir);
+    const TGeoVolume* volume = nav.GetCurrentVolume();
+    BOOST_REQUIRE(volume);
+    TGeoMaterial* mat = volume->GetMedium()->GetMaterial();
+    BOOST_CHECK_EQUAL(cached->density, mat->GetDensity());
+    BOOST_CHECK_EQUAL(cached->Z, mat->GetZ());
+    BOOST_CHECK_EQUAL(cached->A, mat->GetA());
+    BOOST_CHECK_EQUAL(cached->radiationLength, mat->GetRadLen());
+    BOOST_CHECK_EQUAL(cached->meanExcitationEnergy, genf::GFMaterialEffects::MeanExcEnergy_get(mat));
+
+    nav.FindNextBoundaryAndStep(dist);
+    BOOST_CHECK(!nav.IsStepEntering());
+    BOOST_CHECK(!nav.IsStepExiting());
+    BOOST_CHECK_SMALL(nav.GetStep() - dist, 1.E-9);
+    BOOST_CHECK_EQUAL(nav.GetCurrentVolume(), volume);
+  }
+
+  void randomDirection(std::mt19937& rng, double dir[3])
+  {
+    std::normal_distribution<double> gaus(0., 1.);
+    double norm = 0.;
+    while (!(norm > 1.E-6)) {
+      norm = 0.;
+      for (int i = 0; i < 3; ++i) { dir[i] = gaus(rng); norm += dir[i]*dir[i]; }
+      norm = std::sqrt(norm);
+    }
+    for (int i = 0; i < 3; ++i) dir[i] /= norm;
+  }
+
+} // local namespace
+
+
+BOOST_FIXTURE_TEST_SUITE(GFMaterialCacheTests, BoxInBox)
+
+BOOST_AUTO_TEST_CASE(FarFromBoundaries)
+{
+  const genf::GFMaterialCache cache(*gGeoManager, 2.);
+  BOOST_CHECK_EQUAL(cache.nMaterials(), 2U);
+  TGeoNavigator* nav = gGeoManager->GetCurrentNavigator();
+  BOOST_REQUIRE(nav);
+
+  std::mt19937 rng(2023);
+  const double points[][3] = {
+    { InnerCentre[0], InnerCentre[1], InnerCentre[2] }, // iron
+    { -70., 60., -60. },                                // argon
+    { 60., 70., 70. }                                   // argon
+  };
+  for (auto const& pos: points) {
+    // well inside the safety sphere the cache must answer
+    BOOST_CHECK(cache.find(pos[0], pos[1], pos[2], 1.));
+    for (double dist: { 0.1, 1., 5., 10. }) {
+      for (int i = 0; i < 20; ++i) {
+        double dir[3];
+        randomDirection(rng, dir);
+        checkStep(cache, *nav, pos, dir, dist);
+      }
+    }
+  }
+
+  // random points all over the world
+  std::uniform_real_distribution<double> flat(-WorldHalfSize, WorldHalfSize);
+  unsigned int nFound = 0;
+  for (int i = 0; i < 10000; ++i) {
+    const double pos[3] = { flat(rng), flat(rng), flat(rng) };
+    double dir[3];
+    randomDirection(rng, dir);
+    const double dist = std::exp(std::uniform_real_distribution<double>(std::log(1.E-3), std::log(50.))(rng));
+    if (cache.find(pos[0], pos[1], pos[2], dist)) ++nFound;
+    checkStep(cache, *nav, pos, dir, dist);
+  }
+  BOOST_CHECK_GT(nFound, 1000U);
+}
+
+BOOST_AUTO_TEST_CASE(NearBoundaries)
+{
+  const genf::GFMaterialCache cache(*gGeoManager, 2.);
+  TGeoNavigator* nav = gGeoManager->GetCurrentNavigator();
+  BOOST_REQUIRE(nav);
+
+  std::mt19937 rng(4321);
+  std::uniform_real_distribution<double> flat(-1., 1.);
+  for (int axis = 0; axis < 3; ++axis) {
+    for (int side: { -1, +1 }) {
+      const double face = InnerCentre[axis] + side*InnerHalfSize[axis];
+      for (double offset: { -3., -0.5, -1.E-2, -1.E-5, 1.E-5, 1.E-2, 0.5, 3. }) {
+        for (int i = 0; i < 20; ++i) {
+          // a point at offset from the face (positive outside the inner box), on the face area
+          double pos[3];
+          for (int j = 0; j < 3; ++j) pos[j] = InnerCentre[j] + flat(rng)*InnerHalfSize[j];
+          pos[axis] = face + side*offset;
+
+          // towards the face, a step longer than the offset crosses it
+          double dir[3] = { 0., 0., 0. };
+          dir[axis] = (offset > 0.) ? -side : side;
+          BOOST_CHECK(!cache.find(pos[0], pos[1], pos[2], std::abs(offset)*1.01));
+          for (double scale: { 0.5, 1.01, 2. }) checkStep(cache, *nav, pos, dir, std::abs(offset)*scale);
+
+          // and in any direction
+          randomDirection(rng, dir);
+          for (double scale: { 0.5, 1.01, 2. }) checkStep(cache, *nav, pos, dir, std::abs(offset)*scale);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,247 @@
+/**
+ * @file   RKTrackRep_benchmark.cc
+ * @brief  Kalman fits per second of recorded tracks with the Runge-Kutta track representation
+ *
+ * Usage: RKTrackRep_benchmark <track file> <configuration.fcl>
+ *
+ * The track file is a text file with the space points of the tracks, one
+ * point "x y z" (cm) per line, the tracks separated by empty lines; lines
+ * starting with '#' are skipped. The configuration is looked up in
+ * FHICL_FILE_PATH and should contain:
+ *
+ *     GeometryFile:  ""     # ROOT or GDML geometry; a liquid argon box if empty
+ *     BoxHalfSize:   1000.  # half size of the liquid argon box (cm)
+ *     PointError:    0.3    # error of the coordinates of each point (cm)
+ *     Momentum:      1.     # seed momentum (GeV/c)
+ *     PDG:           13     # particle hypothesis
+ *     NumIterations: 2      # as in Track3DKalmanSPS
+ *     MaxUpdate:     0.1    # as in Track3DKalmanSPS
+ *     Repetitions:   1      # number of passes over the tracks
+ *     MaterialCacheVoxelSize: 0. # cm; if positive, the material effects use a GFMaterialCache
+ *     OutputFile:    ""     # if set, the fitted states are written there
+ *
+ * see rktrackrep_benchmark.fcl. Each track is fitted with GFKalman the way
+ * Track3DKalmanSPS does, and the number of fits per second is reported. The
+ * fitted states can be written to a file, to compare different builds of the
+ * library or fits with and without material cache. GFKalman keeps some state
+ * from a fit to the next, so those are compared running the benchmark twice
+ * rather than fitting the tracks twice in the same job.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+// ROOT
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMedium.h"
+#include "TGeoVolume.h"
+#include "TMatrixT.h"
+#include "TVector3.h"
+
+// LArSoft libraries
+#include "larreco/Genfit/GFConstField.h"
+#include "larreco/Genfit/GFFieldManager.h"
+#include "larreco/Genfit/GFKalman.h"
+#include "larreco/Genfit/GFMaterialCache.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
+#include "larreco/Genfit/GFTrack.h"
+#include "larreco/Genfit/PointHit.h"
+#include "larreco/Genfit/RKTrackRep.h"
+
+//------------------------------------------------------------------------------
+namespace {
+
+  using Track = std::vector<TVector3>;
+
+  /// Reads the tracks from a text file with a point per line
+  std::vector<Track> readTracks(std::string const& fileName) {
+    std::ifstream in(fileName);
+    if (!in) throw cet::exception("RKTrackRep_benchmark") << "Can't open track file '" << fileName << "'\n";
+
+    std::vector<Track> tracks(1);
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && (line[0] == '#')) continue;
+      std::istringstream sline(line);
+      double x, y, z;
+      if (sline >> x >> y >> z) tracks.back().emplace_back(x, y, z);
+      else if (!tracks.back().empty()) tracks.emplace_back();
+    }
+    if (tracks.back().empty()) tracks.pop_back();
+    return tracks;
+  }
+
+  /// Makes the geometry the material effects are looked up in
+  void makeGeometry(std::string const& fileName, double halfSize) {
+    if (!fileName.empty()) {
+      TGeoManager::Import(fileName.c_str());
+      if (!gGeoManager) throw cet::exception("RKTrackRep_benchmark") << "Can't import geometry from '" << fileName << "'\n";
+      return;
+    }
+    new TGeoManager("LArBox", "liquid argon box");
+    TGeoMaterial* lar = new TGeoMaterial("LAr", 39.948, 18., 1.396);
+    TGeoMedium* medium = new TGeoMedium("LAr", 1, lar);
+    TGeoVolume* top = gGeoManager->MakeBox("World", medium, halfSize, halfSize, halfSize);
+    gGeoManager->SetTopVolume(top);
+    gGeoManager->CloseGeometry();
+  }
+
+  struct FitConfig {
+    double       pointError;
+    double       momentum;
+    int          pdg;
+    int          numIterations;
+    double       maxUpdate;
+  };
+
+  /// Result of the fit of one track
+  struct FitResult {
+    bool                 fitted = false;
+    double               chi2   = 0.;
+    unsigned int         ndf    = 0;
+    std::vector<double>  state;
+  };
+
+  /// Fits the track with GFKalman as Track3DKalmanSPS does
+  FitResult fit(Track const& track, FitConfig const& config) {
+    FitResult result;
+    if (track.size() < 3) return result;
+
+    TVector3 mom = track.back() - track.front();
+    mom.SetMag(config.momentum);
+    TVector3 const posErr(config.pointError, config.pointError, config.pointError);
+    TVector3 const momErr(mom[0] / 3., mom[1] / 3., mom[2] / 3.);
+
+    genf::GFAbsTrackRep* rep = new genf::RKTrackRep(track.front(), mom, posErr, momErr, config.pdg);
+    genf::GFTrack fitTrack(rep); // owns rep and the hits
+    fitTrack.setPDG(config.pdg);
+
+    double const err2 = config.pointError * config.pointError;
+    int iHit = 0;
+    for (TVector3 const& point : track) {
+      std::vector<double> err3 { err2, err2, 0., err2 }; // xx, yy, yz, zz as in Track3DKalmanSPS
+      fitTrack.addHit(new genf::PointHit(point, err3), 1, iHit++);
+    }
+
+    genf::GFKalman k;
+    k.setBlowUpFactor(5);
+    k.setInitialDirection(+1);
+    k.setNumIterations(config.numIterations);
+    k.setMaxUpdate(config.maxUpdate);
+
+    try {
+      k.processTrack(&fitTrack);
+    }
+    catch (cet::exception const&) {
+      return result;
+    }
+
+    result.fitted = true;
+    result.chi2   = rep->getChiSqu();
+    result.ndf    = rep->getNDF();
+    TMatrixT<Double_t> const& state = rep->getState();
+    for (int i = 0; i < state.GetNrows(); ++i) result.state.push_back(state[i][0]);
+    return result;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <track file> <configuration.fcl>" << std::endl;
+    return 1;
+  }
+
+  try {
+    cet::filepath_lookup_after1 policy("FHICL_FILE_PATH");
+    fhicl::ParameterSet config;
+    fhicl::make_ParameterSet(argv[2], policy, config);
+
+    FitConfig const fitConfig {
+      config.get<double>("PointError", 0.3),
+      config.get<double>("Momentum", 1.),
+      config.get<int>("PDG", 13),
+      config.get<int>("NumIterations", 2),
+      config.get<double>("MaxUpdate", 0.1)
+    };
+    size_t const nRepeat = std::max(config.get<size_t>("Repetitions", 1), size_t(1));
+
+    std::vector<Track> const tracks = readTracks(argv[1]);
+    size_t nPoints = 0;
+    for (Track const& track : tracks) nPoints += track.size();
+    std::cout << "Read " << tracks.size() << " tracks, " << nPoints << " points, from " << argv[1] << std::endl;
+
+    makeGeometry(config.get<std::string>("GeometryFile", ""), config.get<double>("BoxHalfSize", 1000.));
+    genf::GFFieldManager::getInstance()->init(new genf::GFConstField(0., 0., 0.));
+
+    double const voxelSize = config.get<double>("MaterialCacheVoxelSize", 0.);
+    if (voxelSize > 0.) {
+      auto const start = std::chrono::steady_clock::now();
+      auto cache = std::make_shared<genf::GFMaterialCache const>(*gGeoManager, voxelSize);
+      double const cacheSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "Material cache of " << cache->nVoxels() << " voxels of " << cache->voxelSize() << " cm, "
+                << cache->nMaterials() << " materials, built in " << 1.e3 * cacheSeconds << " ms" << std::endl;
+      genf::GFMaterialEffects::setMaterialCache(cache);
+    }
+
+    std::vector<FitResult> results(tracks.size());
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat)
+      for (size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) results[iTrack] = fit(tracks[iTrack], fitConfig);
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t nFitted = 0;
+    double sumChi2 = 0.;
+    unsigned int sumNDF = 0;
+    for (FitResult const& result : results) {
+      if (!result.fitted) continue;
+      ++nFitted;
+      sumChi2 += result.chi2;
+      sumNDF += result.ndf;
+    }
+
+    double const nFits = double(tracks.size()) * nRepeat;
+    std::cout << "\n" << nFitted << " of " << tracks.size() << " tracks fitted, total chi2/ndf "
+              << (sumNDF > 0 ? sumChi2 / sumNDF : 0.) << "\n"
+              << std::setprecision(4)
+              << "Total " << 1.e3 * seconds << " ms, " << (seconds > 0. ? nFits / seconds : 0.) << " fits/s, "
+              << (nPoints > 0 ? 1.e6 * seconds / (double(nPoints) * nRepeat) : 0.) << " us/point" << std::endl;
+
+    std::string const outputFile = config.get<std::string>("OutputFile", "");
+    if (!outputFile.empty()) {
+      std::ofstream out(outputFile);
+      out << std::setprecision(17);
+      for (size_t iTrack = 0; iTrack < results.size(); ++iTrack) {
+        FitResult const& result = results[iTrack];
+        out << iTrack << ' ' << result.fitted << ' ' << result.chi2 << ' ' << result.ndf;
+        for (double value : result.state) out << ' ' << value;
+        out << '\n';
+      }
+      std::cout << "Fitted states written to " << outputFile << std::endl;
+    }
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+} // main()
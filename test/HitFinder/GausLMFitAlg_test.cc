@@ -0,0 +1,144 @@
+/**
+ * @file   GausLMFitAlg_test.cc
+ * @brief  Test of the Levenberg-Marquardt multi-Gaussian fit of GausLMFitAlg
+ * @see    GausLMFitAlg.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( GausLMFitAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/HitFinder/GausLMFitAlg.h"
+
+namespace {
+
+  // two overlapping Gaussians on a small (fixed) pseudo-noise pattern
+  std::vector<float> makeWaveform(size_t nTicks, double baseline)
+  {
+    std::vector<float> waveform(nTicks);
+
+    for (size_t tick = 0; tick < nTicks; ++tick) {
+      double const x = tick + 0.5;
+      waveform[tick] = 30. * std::exp(-0.5 * std::pow((x - 20.) / 3., 2))
+                     + 15. * std::exp(-0.5 * std::pow((x - 30.) / 4., 2))
+                     + baseline + 0.2 * std::sin(1.7 * tick);
+    }
+    return waveform;
+  }
+
+  void setGaussian(hit::GausLMFitAlg::FitParams_t& params, size_t gausIdx, double amplitude, double mean, double sigma)
+  {
+    size_t const parIdx = 3 * gausIdx;
+
+    params.value[parIdx]       = amplitude;
+    params.value[parIdx+1]     = mean;
+    params.value[parIdx+2]     = sigma;
+    params.lowLimit[parIdx]    = 0.1 * amplitude;
+    params.highLimit[parIdx]   = 2. * amplitude;
+    params.lowLimit[parIdx+1]  = mean - 2. * sigma;
+    params.highLimit[parIdx+1] = mean + 2. * sigma;
+    params.lowLimit[parIdx+2]  = 0.5;
+    params.highLimit[parIdx+2] = 3. * sigma;
+  }
+
+} // local namespace
+
+
+BOOST_AUTO_TEST_SUITE( GausLMFitAlgSuite )
+
+BOOST_AUTO_TEST_CASE(FitTwoGaussians)
+{
+  std::vector<float> const waveform = makeWaveform(60, 0.);
+
+  hit::GausLMFitAlg              alg;
+  hit::GausLMFitAlg::FitParams_t params;
+  hit::GausLMFitAlg::Workspace   workspace;
+
+  params.nGaus = 2;
+  setGaussian(params, 0, 25., 21., 2.5);
+  setGaussian(params, 1, 12., 31., 3.);
+
+  double chi2(0.);
+  int    NDF(0);
+
+  BOOST_CHECK(alg.Fit(waveform.data(), waveform.size(), params, chi2, NDF, workspace));
+  BOOST_CHECK_EQUAL(NDF, 60 - 6);
+  BOOST_CHECK_CLOSE(params.value[0], 30., 2.);
+  BOOST_CHECK_CLOSE(params.value[1], 20., 1.);
+  BOOST_CHECK_CLOSE(params.value[2],  3., 2.);
+  BOOST_CHECK_CLOSE(params.value[3], 15., 2.);
+  BOOST_CHECK_CLOSE(params.value[4], 30., 1.);
+  BOOST_CHECK_CLOSE(params.value[5],  4., 2.);
+  BOOST_CHECK(params.error[1] > 0.);
+  BOOST_CHECK_EQUAL(params.error[6], 0.); // fixed baseline
+}
+
+BOOST_AUTO_TEST_CASE(FitFloatingBaseline)
+{
+  std::vector<float> const waveform = makeWaveform(60, 3.);
+
+  hit::GausLMFitAlg              alg;
+  hit::GausLMFitAlg::FitParams_t params;
+  hit::GausLMFitAlg::Workspace   workspace;
+
+  params.nGaus         = 2;
+  params.floatBaseline = true;
+  setGaussian(params, 0, 25., 21., 2.5);
+  setGaussian(params, 1, 12., 31., 3.);
+  params.value[6]     = 0.;
+  params.lowLimit[6]  = -12.;
+  params.highLimit[6] =  12.;
+
+  double chi2(0.);
+  int    NDF(0);
+
+  BOOST_CHECK(alg.Fit(waveform.data(), waveform.size(), params, chi2, NDF, workspace));
+  BOOST_CHECK_EQUAL(NDF, 60 - 7);
+  BOOST_CHECK_CLOSE(params.value[6], 3., 5.);
+  BOOST_CHECK_CLOSE(params.value[1], 20., 1.);
+}
+
+BOOST_AUTO_TEST_CASE(RespectLimits)
+{
+  std::vector<float> const waveform = makeWaveform(60, 0.);
+
+  hit::GausLMFitAlg              alg;
+  hit::GausLMFitAlg::FitParams_t params;
+  hit::GausLMFitAlg::Workspace   workspace;
+
+  // the true amplitude (30) is out of the allowed range
+  params.nGaus = 1;
+  setGaussian(params, 0, 10., 20., 3.);
+
+  double chi2(0.);
+  int    NDF(0);
+
+  BOOST_CHECK(alg.Fit(waveform.data(), waveform.size(), params, chi2, NDF, workspace));
+  BOOST_CHECK(params.value[0] <= params.highLimit[0]);
+}
+
+BOOST_AUTO_TEST_CASE(RejectTooManyParameters)
+{
+  std::vector<float> const waveform = makeWaveform(5, 0.);
+
+  hit::GausLMFitAlg              alg;
+  hit::GausLMFitAlg::FitParams_t params;
+  hit::GausLMFitAlg::Workspace   workspace;
+
+  params.nGaus = 2;
+  setGaussian(params, 0, 25., 2., 2.5);
+  setGaussian(params, 1, 12., 3., 3.);
+
+  double chi2(0.);
+  int    NDF(0);
+
+  BOOST_CHECK(!alg.Fit(waveform.data(), waveform.size(), params, chi2, NDF, workspace));
+  BOOST_CHECK(std::isinf(chi2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
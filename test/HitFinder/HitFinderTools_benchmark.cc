@@ -0,0 +1,292 @@
+/**
+ * @file   HitFinderTools_benchmark.cc
+ * @brief  Throughput of ICandidateHitFinder and IPeakFitter tools on recorded ROIs
+ *
+ * Usage: HitFinderTools_benchmark <ROI waveform file> <configuration.fcl>
+ *
+ * The ROI waveform file is written by the ROIWaveformDump module. The
+ * configuration is looked up in FHICL_FILE_PATH and should contain:
+ *
+ *     CandidateFinders: { name: { tool_type: ... } ... }
+ *     PeakFitters:      { name: { tool_type: ... } ... }
+ *     ReferenceFitter:  "name"              # fitter the others are compared to
+ *     MaxMultiHit:      10                  # skip pulse trains with more peaks
+ *     MaxROIs:          0                   # number of ROIs to read, 0 for all
+ *     Repetitions:      1                   # number of passes over the sample
+ *
+ * see hitfinder_benchmark.fcl. Every candidate finder is run on all the ROIs,
+ * then every peak fitter is run on the pulse trains it found. For each step
+ * the rate (ROIs/s), the time per waveform tick, the number of heap
+ * allocations and, for the fitters, the failure rate and the agreement of the
+ * fitted peak times with the reference fitter are reported.
+ *
+ * The tools are used exactly as GausHitFinder uses them, so they must not need
+ * art services: run them with their histogram output disabled.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "art/Utilities/make_tool.h"
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+// LArSoft libraries
+#include "lardataobj/RecoBase/Wire.h"
+#include "larreco/HitFinder/ROIWaveformIO.h"
+#include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+
+//------------------------------------------------------------------------------
+// count the heap allocations done by the tools
+namespace {
+  std::atomic<size_t> gNumAllocations{0};
+}
+
+void* operator new(std::size_t size) {
+  ++gNumAllocations;
+  if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+//------------------------------------------------------------------------------
+namespace {
+
+  using ROIRange_t = recob::Wire::RegionsOfInterest_t::datarange_t;
+
+  /// A pulse train to fit, as handed to the peak fitters by GausHitFinder
+  struct PulseTrain {
+    size_t                                          roiIdx;
+    reco_tool::ICandidateHitFinder::HitCandidateVec candidates;
+  };
+
+  /// Accumulates time and allocations of one step of the hit finding
+  struct StepStats {
+    std::string name;
+    double      seconds      = 0.;
+    size_t      nAllocations = 0;
+    size_t      nCalls       = 0;   ///< ROIs or pulse trains handled in one pass
+    size_t      nTicks       = 0;   ///< waveform ticks handled in one pass
+    size_t      nFailures    = 0;
+    double      sumChi2      = 0.;
+    double      sumDeltaT    = 0.;  ///< summed |peak time - reference peak time|
+    size_t      nCompared    = 0;
+  };
+
+  /// Times a callable run nRepeat times, recording the allocations of the first pass
+  template <typename Func>
+  void timeStep(StepStats& stats, size_t nRepeat, Func&& func) {
+    auto const start = std::chrono::steady_clock::now();
+
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) {
+      size_t const nAllocStart = gNumAllocations;
+
+      func(repeat);
+
+      if (repeat == 0) stats.nAllocations = gNumAllocations - nAllocStart;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / nRepeat;
+  }
+
+  void printHeader(std::string const& title) {
+    std::cout << "\n" << title << "\n"
+              << std::left << std::setw(24) << "tool"
+              << std::right << std::setw(12) << "calls"
+              << std::setw(14) << "ROIs/s"
+              << std::setw(12) << "ns/tick"
+              << std::setw(12) << "allocs/call"
+              << std::setw(10) << "fail %"
+              << std::setw(12) << "<chi2/NDF>"
+              << std::setw(10) << "<|dT|>" << std::endl;
+  }
+
+  void printStats(StepStats const& stats, size_t nROIs) {
+    size_t const nGood = stats.nCalls - stats.nFailures;
+
+    std::cout << std::left << std::setw(24) << stats.name
+              << std::right << std::setprecision(4)
+              << std::setw(12) << stats.nCalls
+              << std::setw(14) << (stats.seconds > 0. ? nROIs / stats.seconds : 0.)
+              << std::setw(12) << (stats.nTicks > 0 ? 1.e9 * stats.seconds / stats.nTicks : 0.)
+              << std::setw(12) << (stats.nCalls > 0 ? double(stats.nAllocations) / stats.nCalls : 0.)
+              << std::setw(10) << (stats.nCalls > 0 ? 100. * stats.nFailures / stats.nCalls : 0.)
+              << std::setw(12) << (nGood > 0 ? stats.sumChi2 / nGood : 0.)
+              << std::setw(10) << (stats.nCompared > 0 ? stats.sumDeltaT / stats.nCompared : 0.) << std::endl;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <ROI waveform file> <configuration.fcl>" << std::endl;
+    return 1;
+  }
+
+  try {
+    cet::filepath_lookup_after1 policy("FHICL_FILE_PATH");
+    fhicl::ParameterSet config;
+    fhicl::make_ParameterSet(argv[2], policy, config);
+
+    size_t const maxMultiHit = config.get<size_t>("MaxMultiHit", 10);
+    size_t const nRepeat     = std::max(config.get<size_t>("Repetitions", 1), size_t(1));
+
+    hit::ROIWaveformVec const roiWaveforms = hit::ReadROIWaveforms(argv[1], config.get<size_t>("MaxROIs", 0));
+
+    // Turn the recorded waveforms into the data ranges the tools expect
+    std::vector<ROIRange_t> roiRanges;
+    size_t                  nROITicks(0);
+
+    roiRanges.reserve(roiWaveforms.size());
+
+    for (auto const& roi: roiWaveforms) {
+      recob::Wire::RegionsOfInterest_t roiVec(roi.startTick + roi.samples.size());
+      roiVec.add_range(roi.startTick, roi.samples.begin(), roi.samples.end());
+      roiRanges.push_back(roiVec.get_ranges().front());
+      nROITicks += roi.samples.size();
+    }
+
+    std::cout << "Read " << roiRanges.size() << " ROIs, " << nROITicks << " ticks, from " << argv[1] << std::endl;
+
+    // Configure all the tools up front
+    fhicl::ParameterSet const finderConfigs   = config.get<fhicl::ParameterSet>("CandidateFinders");
+    fhicl::ParameterSet const fitterConfigs   = config.get<fhicl::ParameterSet>("PeakFitters");
+    std::string const         referenceFitter = config.get<std::string>("ReferenceFitter");
+
+    // the reference goes first so that the others can be compared to it
+    std::vector<std::string> fitterNames{ referenceFitter };
+
+    for (std::string const& fitterName: fitterConfigs.get_pset_names())
+      if (fitterName != referenceFitter) fitterNames.push_back(fitterName);
+
+    std::vector<std::unique_ptr<reco_tool::IPeakFitter>> peakFitters;
+
+    for (std::string const& fitterName: fitterNames)
+      peakFitters.push_back(art::make_tool<reco_tool::IPeakFitter>(fitterConfigs.get<fhicl::ParameterSet>(fitterName)));
+
+    for (std::string const& finderName: finderConfigs.get_pset_names()) {
+      auto candidateFinder = art::make_tool<reco_tool::ICandidateHitFinder>(finderConfigs.get<fhicl::ParameterSet>(finderName));
+
+      // ---- candidate finding ----
+      StepStats finderStats;
+      finderStats.name   = finderName;
+      finderStats.nCalls = roiRanges.size();
+      finderStats.nTicks = nROITicks;
+
+      // one slot per ROI so that keeping the results does not allocate
+      std::vector<reco_tool::ICandidateHitFinder::MergeHitCandidateVec> mergedCandidatesPerROI(roiRanges.size());
+
+      timeStep(finderStats, nRepeat, [&](size_t) {
+        for (size_t roiIdx = 0; roiIdx < roiRanges.size(); ++roiIdx) {
+          reco_tool::ICandidateHitFinder::HitCandidateVec      hitCandidateVec;
+          reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
+
+          candidateFinder->findHitCandidates(roiRanges[roiIdx], 0, roiWaveforms[roiIdx].channel, 0, hitCandidateVec);
+          candidateFinder->MergeHitCandidates(roiRanges[roiIdx], hitCandidateVec, mergedCandidateHitVec);
+
+          mergedCandidatesPerROI[roiIdx] = std::move(mergedCandidateHitVec);
+        }
+      });
+
+      std::vector<PulseTrain> pulseTrains;
+
+      for (size_t roiIdx = 0; roiIdx < roiRanges.size(); ++roiIdx) {
+        for (auto& mergedCands: mergedCandidatesPerROI[roiIdx]) {
+          // same selection as GausHitFinder
+          if (mergedCands.back().stopTick - mergedCands.front().startTick < 5) continue;
+          if (mergedCands.size() > maxMultiHit) continue;
+
+          pulseTrains.push_back({ roiIdx, std::move(mergedCands) });
+        }
+      }
+
+      size_t nTrainTicks(0);
+
+      for (auto const& pulseTrain: pulseTrains)
+        nTrainTicks += pulseTrain.candidates.back().stopTick - pulseTrain.candidates.front().startTick;
+
+      printHeader("Candidate finder " + finderName + ": " + std::to_string(pulseTrains.size()) + " pulse trains");
+      printStats(finderStats, roiRanges.size());
+
+      // ---- peak fitting ----
+      std::vector<std::vector<reco_tool::IPeakFitter::PeakParamsVec>> fitParams;
+
+      for (size_t fitterIdx = 0; fitterIdx < peakFitters.size(); ++fitterIdx) {
+        StepStats fitterStats;
+        fitterStats.name   = finderName + "/" + fitterNames[fitterIdx];
+        fitterStats.nCalls = pulseTrains.size();
+        fitterStats.nTicks = nTrainTicks;
+
+        // output slots are allocated before the timing starts
+        std::vector<reco_tool::IPeakFitter::PeakParamsVec> paramsVec(pulseTrains.size());
+
+        for (size_t trainIdx = 0; trainIdx < pulseTrains.size(); ++trainIdx)
+          paramsVec[trainIdx].reserve(pulseTrains[trainIdx].candidates.size());
+
+        timeStep(fitterStats, nRepeat, [&](size_t repeat) {
+          for (size_t trainIdx = 0; trainIdx < pulseTrains.size(); ++trainIdx) {
+            PulseTrain const& pulseTrain = pulseTrains[trainIdx];
+
+            double chi2PerNDF(0.);
+            int    NDF(1);
+
+            paramsVec[trainIdx].clear();
+
+            peakFitters[fitterIdx]->findPeakParameters(roiRanges[pulseTrain.roiIdx].data(), pulseTrain.candidates, paramsVec[trainIdx], chi2PerNDF, NDF);
+
+            if (repeat > 0) continue;
+
+            if (!(chi2PerNDF < std::numeric_limits<double>::infinity()) || paramsVec[trainIdx].empty()) fitterStats.nFailures++;
+            else fitterStats.sumChi2 += chi2PerNDF;
+          }
+        });
+
+        // Compare the fitted peak times with the reference fitter
+        if (!fitParams.empty()) {
+          for (size_t trainIdx = 0; trainIdx < pulseTrains.size(); ++trainIdx) {
+            auto const& reference = fitParams.front()[trainIdx];
+            auto const& fitted    = paramsVec[trainIdx];
+
+            if (reference.size() != fitted.size()) continue;
+
+            for (size_t peakIdx = 0; peakIdx < fitted.size(); ++peakIdx) {
+              fitterStats.sumDeltaT += std::abs(fitted[peakIdx].peakCenter - reference[peakIdx].peakCenter);
+              fitterStats.nCompared++;
+            }
+          }
+        }
+
+        fitParams.push_back(std::move(paramsVec));
+
+        printStats(fitterStats, roiRanges.size());
+      }
+    }
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+} // main()
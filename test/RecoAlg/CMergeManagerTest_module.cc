@@ -0,0 +1,186 @@
+/**
+ * @file   CMergeManagerTest_module.cc
+ * @brief  Test of the pair pruning and concurrent evaluation of CMergeManager
+ * @see    cmergemanager_test.fcl
+ *
+ * The clusters of generated events are merged by CMergeManager with the
+ * pruning of the pairs by MaxPairDistance() and with the pairs evaluated
+ * concurrently and sequentially, and compared with the merging of all the
+ * pairs. The algorithms need the geometry services (through
+ * util::GeometryUtilities), so the test runs as a module in a job.
+ */
+
+// C/C++ standard libraries
+#include <random>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// LArSoft libraries
+#include "lardata/Utilities/PxUtils.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoArray.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoPolyOverlap.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoShortestDist.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CBoolAlgoBase.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CMergeManager.h"
+#include "ClusterTestUtils.h"
+
+namespace {
+
+  using Clusters = std::vector<std::vector<util::PxHit>>;
+
+  /// Short straight clusters on each plane, many of them close enough to be merged
+  Clusters makeClusters(std::mt19937& random, unsigned int nPerPlane, double size) {
+    cluster::test::ClusterGenerator generator;
+    generator.size       = size;
+    generator.minLength  = 1.;
+    generator.maxLength  = 15.;
+    generator.minHits    = 1;
+    generator.maxHits    = 40;
+    generator.minCharge  = 50.;
+    generator.maxCharge  = 500.;
+    generator.wiggle     = 0.2;
+    generator.wiggleFreq = 3.;
+
+    Clusters clusters;
+    for (unsigned int plane = 0; plane < 3; ++plane) {
+      for (unsigned int i = 0; i < nPerPlane; ++i) clusters.push_back(generator.makeHits(random, plane));
+    }
+    return clusters;
+  }
+
+  /// Forwards to another algorithm without a distance limit, so that all the pairs are compared
+  class UnprunedAlgo : public cmtool::CBoolAlgoBase {
+  public:
+    UnprunedAlgo(cmtool::CBoolAlgoBase& algo) : fAlgo(algo) {}
+
+    virtual bool Bool(const ::cluster::ClusterParamsAlg& cluster1, const ::cluster::ClusterParamsAlg& cluster2)
+    { return fAlgo.Bool(cluster1, cluster2); }
+
+    virtual bool ThreadSafe() const { return fAlgo.ThreadSafe(); }
+
+    virtual ::cluster::ClusterParamsAlg::ParamsStage_t ParamsStage() const { return fAlgo.ParamsStage(); }
+
+    virtual bool UsesPolygon() const { return fAlgo.UsesPolygon(); }
+
+  private:
+    cmtool::CBoolAlgoBase& fAlgo;
+  };
+
+  struct MergeResult {
+    std::vector<std::vector<unsigned short>> merged;
+    cmtool::CMAlgoCounters                   counters;
+  };
+
+  MergeResult merge(Clusters const& clusters, cmtool::CBoolAlgoBase& algo, bool concurrent) {
+    cmtool::CMergeManager manager;
+    manager.AddMergeAlgo(&algo);
+    manager.MergeTillConverge(true);
+    manager.EvaluateConcurrently(concurrent);
+    manager.SetClusters(clusters);
+    manager.Process();
+    return { manager.GetBookKeeper().GetResult(), manager.GetMergeCounters() };
+  }
+
+  /// Throws if the results differ; calls are only compared if requested
+  void compare(std::string const& name, MergeResult const& result, MergeResult const& reference, bool sameCalls) {
+    cmtool::CMAlgoCounters const& c = result.counters;
+    cmtool::CMAlgoCounters const& r = reference.counters;
+    if ((result.merged != reference.merged) || (c.pairs != r.pairs) || (c.accepted != r.accepted) ||
+        (sameCalls && ((c.calls != r.calls) || (c.pruned != r.pruned)))) {
+      throw cet::exception("CMergeManagerTest")
+        << name << ": " << result.merged.size() << " clusters (" << reference.merged.size() << " expected), "
+        << c.pairs << " pairs (" << r.pairs << "), " << c.pruned << " pruned (" << r.pruned << "), "
+        << c.calls << " calls (" << r.calls << "), " << c.accepted << " merged (" << r.accepted << ")\n";
+    }
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+namespace cluster {
+
+  class CMergeManagerTest : public art::EDAnalyzer {
+  public:
+    explicit CMergeManagerTest(fhicl::ParameterSet const& pset);
+
+    void analyze(art::Event const& evt) override;
+
+  private:
+    /// Merges with the algorithm all the pairs, the pruned pairs and the pruned pairs concurrently
+    void testAlgo(std::string const& name, cmtool::CBoolAlgoBase& algo, Clusters const& clusters) const;
+
+    unsigned int fClustersPerPlane;
+    double       fSize;
+    unsigned int fSeed;
+  };
+
+  CMergeManagerTest::CMergeManagerTest(fhicl::ParameterSet const& pset)
+    : EDAnalyzer(pset)
+    , fClustersPerPlane(pset.get<unsigned int>("ClustersPerPlane", 60))
+    , fSize(pset.get<double>("Size", 60.))
+    , fSeed(pset.get<unsigned int>("Seed", 12345))
+  {}
+
+  void CMergeManagerTest::testAlgo(std::string const& name, cmtool::CBoolAlgoBase& algo, Clusters const& clusters) const {
+    UnprunedAlgo unpruned(algo);
+    MergeResult const reference  = merge(clusters, unpruned, false);
+    MergeResult const sequential = merge(clusters, algo, false);
+    MergeResult const concurrent = merge(clusters, algo, true);
+
+    if (reference.counters.pruned != 0)
+      throw cet::exception("CMergeManagerTest") << name << ": pairs pruned without a distance limit\n";
+
+    // the pruned pairs are not compared, but the merging must be the same
+    compare(name + " (pruned)", sequential, reference, false);
+    compare(name + " (pruned, concurrent)", concurrent, sequential, true);
+
+    mf::LogVerbatim("CMergeManagerTest")
+      << name << ": " << clusters.size() << " clusters merged into " << reference.merged.size() << ", "
+      << sequential.counters.pruned << " of " << sequential.counters.pairs << " pairs pruned, "
+      << sequential.counters.accepted << " merged";
+  }
+
+  void CMergeManagerTest::analyze(art::Event const& evt) {
+    std::mt19937 random(fSeed + evt.event());
+    Clusters const clusters = makeClusters(random, fClustersPerPlane, fSize);
+
+    // the algorithms read the geometry when they are created
+    cmtool::CBAlgoShortestDist shortDist;
+    shortDist.SetSquaredDistanceCut(4.);
+    cmtool::CBAlgoShortestDist longDist;
+    longDist.SetSquaredDistanceCut(36.);
+    cmtool::CBAlgoPolyOverlap overlap;
+
+    testAlgo("ShortestDist", shortDist, clusters);
+    testAlgo("PolyOverlap", overlap, clusters);
+
+    cmtool::CBAlgoArray overlapAndDist;
+    overlapAndDist.AddAlgo(&overlap, true);
+    overlapAndDist.AddAlgo(&shortDist, true);
+    testAlgo("PolyOverlap AND ShortestDist", overlapAndDist, clusters);
+
+    cmtool::CBAlgoArray overlapOrDist;
+    overlapOrDist.AddAlgo(&overlap, true);
+    overlapOrDist.AddAlgo(&shortDist, false);
+    testAlgo("PolyOverlap OR ShortestDist", overlapOrDist, clusters);
+
+    // evaluated as longDist OR (overlap AND shortDist): the long distance bounds it
+    cmtool::CBAlgoArray mixed;
+    mixed.AddAlgo(&longDist, true);
+    mixed.AddAlgo(&overlap, false);
+    mixed.AddAlgo(&shortDist, true);
+    testAlgo("ShortestDist OR PolyOverlap AND ShortestDist", mixed, clusters);
+  }
+
+} // namespace cluster
+
+DEFINE_ART_MODULE(cluster::CMergeManagerTest)
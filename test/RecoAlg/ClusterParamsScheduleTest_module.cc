@@ -0,0 +1,217 @@
+/**
+ * @file   ClusterParamsScheduleTest_module.cc
+ * @brief  Test of the scheduled computation of the ClusterParamsAlg parameters
+ * @see    clusterparams_schedule_test.fcl
+ *
+ * The parameters of generated clusters are computed with FillParams() and
+ * FillPolygon(), and with ScheduleParams() and SchedulePolygon() followed by
+ * GetParams(), asking directly for all the parameters or first for each of
+ * the intermediate stages. All the parameters must be the same, bit by bit.
+ * ClusterParamsAlg reads the geometry (through util::GeometryUtilities), so
+ * the test runs as a module in a job.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// LArSoft libraries
+#include "lardata/Utilities/PxUtils.h"
+#include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+#include "ClusterTestUtils.h"
+
+namespace {
+
+  using Stage = cluster::ClusterParamsAlg::ParamsStage_t;
+
+  /// Override arguments of FillParams() and ScheduleParams()
+  struct Overrides {
+    std::string name;
+    bool        averages, roughAxis, profileInfo, startPointAndDirection, finalSlope, trackShowerSep, endCharge;
+  };
+
+  /// Equal values, or both NaN
+  bool same(double a, double b) { return (a == b) || (std::isnan(a) && std::isnan(b)); }
+
+  /// Names of the parameters of the stages up to the specified one that differ
+  std::string differences(cluster::cluster_params const& p, cluster::cluster_params const& r, Stage stage, bool polygon) {
+    using CPA = cluster::ClusterParamsAlg;
+    std::string diff;
+    auto check = [&diff](bool equal, const char* name) { if (!equal) diff += std::string(" ") + name; };
+    auto checkPoint = [&](util::PxPoint const& a, util::PxPoint const& b, const char* name)
+      { check(same(a.w, b.w) && same(a.t, b.t) && (a.plane == b.plane), name); };
+
+    if (stage >= CPA::kAverages) {
+      check(same(p.N_Hits, r.N_Hits), "N_Hits");
+      check(same(p.sum_charge, r.sum_charge), "sum_charge");
+      check(same(p.mean_charge, r.mean_charge), "mean_charge");
+      check(same(p.rms_charge, r.rms_charge), "rms_charge");
+      check(same(p.sum_ADC, r.sum_ADC), "sum_ADC");
+      check(same(p.mean_ADC, r.mean_ADC), "mean_ADC");
+      check(same(p.rms_ADC, r.rms_ADC), "rms_ADC");
+      check(same(p.mean_x, r.mean_x), "mean_x");
+      check(same(p.mean_y, r.mean_y), "mean_y");
+      check(same(p.charge_wgt_x, r.charge_wgt_x), "charge_wgt_x");
+      check(same(p.charge_wgt_y, r.charge_wgt_y), "charge_wgt_y");
+      check(same(p.eigenvalue_principal, r.eigenvalue_principal), "eigenvalue_principal");
+      check(same(p.eigenvalue_secondary, r.eigenvalue_secondary), "eigenvalue_secondary");
+      check(same(p.multi_hit_wires, r.multi_hit_wires), "multi_hit_wires");
+      check(same(p.N_Wires, r.N_Wires), "N_Wires");
+      check(same(p.verticalness, r.verticalness), "verticalness");
+    }
+    if (stage >= CPA::kRoughAxis) {
+      check(same(p.rms_x, r.rms_x), "rms_x");
+      check(same(p.rms_y, r.rms_y), "rms_y");
+      check(same(p.RMS_charge, r.RMS_charge), "RMS_charge");
+      check(same(p.N_Hits_HC, r.N_Hits_HC), "N_Hits_HC");
+      check(same(p.cluster_angle_2d, r.cluster_angle_2d), "cluster_angle_2d");
+    }
+    if (stage >= CPA::kProfileInfo) {
+      check(same(p.width, r.width), "width");
+      check(same(p.offaxis_hits, r.offaxis_hits), "offaxis_hits");
+    }
+    if (stage >= CPA::kStartPointAndDirection) {
+      checkPoint(p.start_point, r.start_point, "start_point");
+      checkPoint(p.end_point, r.end_point, "end_point");
+      check(same(p.length, r.length), "length");
+      check(same(p.hit_density_1D, r.hit_density_1D), "hit_density_1D");
+      check(same(p.hit_density_2D, r.hit_density_2D), "hit_density_2D");
+      check(same(p.opening_angle, r.opening_angle), "opening_angle");
+      check(same(p.opening_angle_charge_wgt, r.opening_angle_charge_wgt), "opening_angle_charge_wgt");
+      check(same(p.closing_angle, r.closing_angle), "closing_angle");
+      check(same(p.closing_angle_charge_wgt, r.closing_angle_charge_wgt), "closing_angle_charge_wgt");
+      check(p.direction == r.direction, "direction");
+    }
+    if (stage >= CPA::kFinalSlope) {
+      check(same(p.angle_2d, r.angle_2d), "angle_2d");
+      check(same(p.modified_hit_density, r.modified_hit_density), "modified_hit_density");
+      check(same(p.modmeancharge, r.modmeancharge), "modmeancharge");
+    }
+    if (stage >= CPA::kEndCharges) {
+      check(same(p.start_charge, r.start_charge), "start_charge");
+      check(same(p.end_charge, r.end_charge), "end_charge");
+    }
+    if (stage >= CPA::kAllParams) {
+      check(same(p.showerness, r.showerness), "showerness");
+      check(same(p.trackness, r.trackness), "trackness");
+    }
+    if (polygon) {
+      bool equal = (p.PolyObject.Size() == r.PolyObject.Size());
+      for (unsigned int i = 0; equal && (i < p.PolyObject.Size()); ++i)
+        equal = (p.PolyObject.Point(i) == r.PolyObject.Point(i));
+      check(equal, "PolyObject");
+    }
+    return diff;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+namespace cluster {
+
+  class ClusterParamsScheduleTest : public art::EDAnalyzer {
+  public:
+    explicit ClusterParamsScheduleTest(fhicl::ParameterSet const& pset);
+
+    void analyze(art::Event const& evt) override;
+
+  private:
+    /// Compares the scheduled computation of the parameters of the hits with FillParams()
+    void testCluster(std::vector<util::PxHit> const& hits, Overrides const& o) const;
+
+    unsigned int fClusters;
+    unsigned int fSeed;
+  };
+
+  ClusterParamsScheduleTest::ClusterParamsScheduleTest(fhicl::ParameterSet const& pset)
+    : EDAnalyzer(pset)
+    , fClusters(pset.get<unsigned int>("Clusters", 200))
+    , fSeed(pset.get<unsigned int>("Seed", 12345))
+  {}
+
+  void ClusterParamsScheduleTest::testCluster(std::vector<util::PxHit> const& hits, Overrides const& o) const {
+    auto makeAlg = [&hits]() {
+      ClusterParamsAlg alg;
+      alg.SetVerbose(false);
+      alg.SetHits(hits);
+      alg.DisableFANN();
+      return alg;
+    };
+    auto schedule = [&o](ClusterParamsAlg& alg) {
+      alg.ScheduleParams(o.averages, o.roughAxis, o.profileInfo, o.startPointAndDirection,
+                         o.finalSlope, o.trackShowerSep, o.endCharge);
+      alg.SchedulePolygon();
+    };
+    auto fail = [&](std::string const& what, std::string const& diff) {
+      throw cet::exception("ClusterParamsScheduleTest")
+        << o.name << ", cluster of " << hits.size() << " hits, " << what << ": different" << diff << "\n";
+    };
+
+    ClusterParamsAlg eager = makeAlg();
+    eager.FillParams(o.averages, o.roughAxis, o.profileInfo, o.startPointAndDirection,
+                     o.finalSlope, o.trackShowerSep, o.endCharge);
+    eager.FillPolygon();
+    cluster_params const& reference = eager.GetParams();
+
+    // all at once
+    ClusterParamsAlg lazy = makeAlg();
+    schedule(lazy);
+    std::string diff = differences(lazy.GetParams(ClusterParamsAlg::kAllParams, true), reference, ClusterParamsAlg::kAllParams, true);
+    if (!diff.empty()) fail("all the parameters", diff);
+
+    // an intermediate stage first, then the rest; the copy of a scheduled object computes on its own
+    for (int stage = ClusterParamsAlg::kNoParams; stage < ClusterParamsAlg::kAllParams; ++stage) {
+      ClusterParamsAlg stepped = makeAlg();
+      schedule(stepped);
+      Stage const first = static_cast<Stage>(stage);
+      std::string const name = "stage " + std::to_string(stage);
+
+      diff = differences(stepped.GetParams(first), reference, first, false);
+      if (!diff.empty()) fail(name, diff);
+
+      ClusterParamsAlg const copy = stepped;
+
+      diff = differences(stepped.GetParams(), reference, ClusterParamsAlg::kAllParams, true);
+      if (!diff.empty()) fail(name + ", then all the parameters", diff);
+
+      diff = differences(copy.GetParams(), reference, ClusterParamsAlg::kAllParams, true);
+      if (!diff.empty()) fail(name + ", then all the parameters of a copy", diff);
+    }
+  }
+
+  void ClusterParamsScheduleTest::analyze(art::Event const& evt) {
+    std::mt19937 random(fSeed + evt.event());
+
+    // straight or curved clusters, sometimes with more hits on a wire
+    cluster::test::ClusterGenerator generator;
+    generator.maxCurvature = 0.05;
+
+    // as CMManagerBase schedules the input clusters and CMergeManager the merged ones
+    std::vector<Overrides> const overrides {
+      { "input clusters",  false, false, false, false, false, false, false },
+      { "merged clusters", true,  true,  true,  true,  true,  false, false }
+    };
+
+    for (unsigned int i = 0; i < fClusters; ++i) {
+      std::vector<util::PxHit> const hits = generator.makeHits(random, 2);
+      for (auto const& o : overrides) testCluster(hits, o);
+    }
+
+    mf::LogVerbatim("ClusterParamsScheduleTest")
+      << fClusters << " clusters: scheduled parameters are the same as with FillParams()";
+  }
+
+} // namespace cluster
+
+DEFINE_ART_MODULE(cluster::ClusterParamsScheduleTest)
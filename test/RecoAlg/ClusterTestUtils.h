@@ -0,0 +1,74 @@
+/**
+ * @file   ClusterTestUtils.h
+ * @brief  Generated clusters of hits for the tests of the cluster algorithms
+ * @see    CMergeManagerTest_module.cc, ClusterParamsScheduleTest_module.cc
+ */
+
+#ifndef CLUSTERTESTUTILS_H
+#define CLUSTERTESTUTILS_H
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+#include <vector>
+
+// LArSoft libraries
+#include "lardata/Utilities/PxUtils.h"
+
+namespace cluster {
+namespace test {
+
+  /**
+   * @brief Generates clusters of hits along straight or curved lines
+   *
+   * A cluster starts at a random point of a square, in a random direction,
+   * and has a random length and number of hits. The hits are on wires
+   * (0.3 cm pitch), their time wiggles around the line and their charge is
+   * random. All the draws come from the generator passed to makeHits(), so
+   * a seed gives the same clusters.
+   */
+  struct ClusterGenerator {
+    double size          = 100.;  ///< side of the square of the start points (cm)
+    double minLength     = 0.5;   ///< shortest cluster (cm)
+    double maxLength     = 30.;   ///< longest cluster (cm)
+    int    minHits       = 3;     ///< fewest hits of a cluster
+    int    maxHits       = 80;    ///< most hits of a cluster
+    double minCharge     = 20.;   ///< lowest charge of a hit
+    double maxCharge     = 800.;  ///< highest charge of a hit
+    double maxCurvature  = 0.;    ///< largest change of direction per cm (rad/cm), 0 for straight clusters
+    double wiggle        = 0.3;   ///< amplitude of the time wiggle of the hits (cm)
+    double wiggleFreq    = 5.;    ///< phase step of the wiggle from a hit to the next (rad)
+
+    /// Hits of a new cluster on the plane
+    std::vector<util::PxHit> makeHits(std::mt19937& random, unsigned int plane) const {
+      std::uniform_real_distribution<double> posDist(0., size), angleDist(0., 2. * M_PI),
+        lengthDist(minLength, maxLength), chargeDist(minCharge, maxCharge);
+      std::uniform_int_distribution<int> hitsDist(minHits, maxHits);
+
+      double const w0 = posDist(random), t0 = posDist(random);
+      double const angle = angleDist(random), length = lengthDist(random);
+      double const curve = (maxCurvature > 0.)
+        ? std::uniform_real_distribution<double>(-maxCurvature, maxCurvature)(random) : 0.;
+      int const nHits = hitsDist(random);
+
+      std::vector<util::PxHit> hits;
+      hits.reserve(nHits);
+      for (int iHit = 0; iHit < nHits; ++iHit) {
+        double const s = length * iHit / nHits;
+        util::PxHit hit;
+        hit.plane  = plane;
+        hit.w      = 0.3 * std::round((w0 + s * std::cos(angle + curve * s)) / 0.3); // on wires
+        hit.t      = t0 + s * std::sin(angle + curve * s) + wiggle * std::cos(wiggleFreq * iHit);
+        hit.charge = chargeDist(random);
+        hit.sumADC = 1.1 * hit.charge;
+        hit.peak   = hit.charge / 3.;
+        hits.push_back(hit);
+      }
+      return hits;
+    }
+  };
+
+} // namespace test
+} // namespace cluster
+
+#endif // CLUSTERTESTUTILS_H
@@ -0,0 +1,184 @@
+/**
+ * @file   CornerFinder_benchmark.cc
+ * @brief  Time of CornerFinderAlg on full plane images, histogram against flat images
+ *
+ * Usage: CornerFinder_benchmark <configuration.fcl>
+ *
+ * The configuration is looked up in FHICL_FILE_PATH and should contain:
+ *
+ *     CornerFinder: { ... }   # CornerFinderAlg configuration
+ *     Wires:        2400      # wires of the plane
+ *     Ticks:        6400      # time ticks of the plane
+ *     Tracks:       20        # straight tracks drawn on each image
+ *     Noise:        2.        # RMS of the noise added to each tick
+ *     Images:       3         # number of images
+ *     Seed:         12345     # seed of the images
+ *
+ * see cornerfinder_benchmark.fcl. The images are made of tracks with a
+ * Gaussian profile in time on top of Gaussian noise. The feature points of
+ * each image are found with the histogram implementation of the algorithm
+ * (UseFlatImages false) and with the flat one, and they are checked to be the
+ * same: the positions must match exactly, while the strengths may differ by
+ * rounding if the compiler contracts multiplications and additions
+ * differently in the two implementations.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+// ROOT
+#include "TH2.h"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/CornerFinderAlg.h"
+
+//------------------------------------------------------------------------------
+namespace {
+
+  /// Fills the image with noise and straight tracks
+  void makeImage(TH2F& image, unsigned int nTracks, double noise, std::mt19937& random) {
+    int const nWires = image.GetNbinsX();
+    int const nTicks = image.GetNbinsY();
+
+    std::normal_distribution<double> noiseDist(0., noise);
+    for (int iTick = 1; iTick <= nTicks; ++iTick)
+      for (int iWire = 1; iWire <= nWires; ++iWire)
+        image.SetBinContent(iWire, iTick, noiseDist(random));
+
+    std::uniform_real_distribution<double> wireDist(1., nWires), tickDist(1., nTicks),
+      angleDist(0., 2. * M_PI), lengthDist(50., 500.), chargeDist(10., 60.);
+    for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+      double const wire0 = wireDist(random), tick0 = tickDist(random);
+      double const angle = angleDist(random), charge = chargeDist(random);
+      double const dWire = std::cos(angle), dTick = 5. * std::sin(angle); // a few ticks per wire
+      int const nSteps = lengthDist(random);
+      for (int step = 0; step < nSteps; ++step) {
+        int const iWire = wire0 + dWire * step;
+        int const iTick = tick0 + dTick * step;
+        for (int dt = -3; dt <= 3; ++dt) {
+          if ((iWire < 1) || (iWire > nWires) || (iTick + dt < 1) || (iTick + dt > nTicks)) continue;
+          image.SetBinContent(iWire, iTick + dt, image.GetBinContent(iWire, iTick + dt) + charge * std::exp(-0.5 * dt * dt / 2.));
+        }
+      }
+    }
+  } // makeImage()
+
+  /// Feature points of the images, and the time it took to find them
+  struct StepStats {
+    std::string name;
+    double      seconds = 0.;
+    std::vector<std::vector<recob::EndPoint2D>> corners;
+  };
+
+  void findCorners(StepStats& stats, fhicl::ParameterSet const& config, std::vector<TH2F> const& images,
+                   std::vector<geo::WireID> const& wireIDs) {
+    corner::CornerFinderAlg alg(config);
+    stats.corners.resize(images.size());
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t iImage = 0; iImage < images.size(); ++iImage)
+      alg.get_feature_points(images[iImage], wireIDs, geo::kZ, stats.corners[iImage]);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <configuration.fcl>" << std::endl;
+    return 1;
+  }
+
+  try {
+    cet::filepath_lookup_after1 policy("FHICL_FILE_PATH");
+    fhicl::ParameterSet config;
+    fhicl::make_ParameterSet(argv[1], policy, config);
+
+    unsigned int const nWires  = config.get<unsigned int>("Wires", 2400);
+    unsigned int const nTicks  = config.get<unsigned int>("Ticks", 6400);
+    unsigned int const nTracks = config.get<unsigned int>("Tracks", 20);
+    double       const noise   = config.get<double>("Noise", 2.);
+    unsigned int const nImages = std::max(config.get<unsigned int>("Images", 3), 1U);
+
+    std::mt19937 random(config.get<unsigned int>("Seed", 12345));
+    std::vector<TH2F> images;
+    for (unsigned int iImage = 0; iImage < nImages; ++iImage) {
+      std::string const name = "h_image_" + std::to_string(iImage);
+      images.emplace_back(name.c_str(), "", nWires, 0, nWires, nTicks, 0, nTicks);
+      makeImage(images.back(), nTracks, noise, random);
+    }
+
+    std::vector<geo::WireID> wireIDs(nWires + 1);
+    for (unsigned int iWire = 0; iWire < wireIDs.size(); ++iWire) wireIDs[iWire] = geo::WireID(0, 0, 0, iWire);
+
+    fhicl::ParameterSet histConfig = config.get<fhicl::ParameterSet>("CornerFinder");
+    fhicl::ParameterSet flatConfig = histConfig;
+    histConfig.put_or_replace("UseFlatImages", false);
+    flatConfig.put_or_replace("UseFlatImages", true);
+
+    StepStats hist{"histograms"}, flat{"flat images"};
+    findCorners(hist, histConfig, images, wireIDs);
+    findCorners(flat, flatConfig, images, wireIDs);
+
+    size_t nCorners = 0, nMismatches = 0;
+    double maxStrengthDiff = 0.;
+    for (size_t iImage = 0; iImage < images.size(); ++iImage) {
+      auto const& histCorners = hist.corners[iImage];
+      auto const& flatCorners = flat.corners[iImage];
+      nCorners += histCorners.size();
+      if (histCorners.size() != flatCorners.size()) {
+        nMismatches += std::max(histCorners.size(), flatCorners.size());
+        continue;
+      }
+      for (size_t i = 0; i < histCorners.size(); ++i) {
+        if ((histCorners[i].DriftTime() != flatCorners[i].DriftTime()) || (histCorners[i].WireID() != flatCorners[i].WireID())) {
+          ++nMismatches;
+          continue;
+        }
+        double const strength = std::abs(histCorners[i].Strength());
+        if (strength > 0.)
+          maxStrengthDiff = std::max(maxStrengthDiff, std::abs(flatCorners[i].Strength() - histCorners[i].Strength()) / strength);
+      }
+    }
+
+    double const nPixels = double(nWires) * nTicks * nImages;
+
+    std::cout << "Found " << nCorners << " feature points in " << nImages << " images of "
+              << nWires << " wires x " << nTicks << " ticks\n"
+              << "\n"
+              << std::left << std::setw(16) << "implementation"
+              << std::right << std::setw(14) << "total ms" << std::setw(14) << "ns/pixel" << std::endl;
+    for (StepStats const* stats : {&hist, &flat}) {
+      std::cout << std::left << std::setw(16) << stats->name
+                << std::right << std::setprecision(4)
+                << std::setw(14) << 1.e3 * stats->seconds
+                << std::setw(14) << 1.e9 * stats->seconds / nPixels << std::endl;
+    }
+    std::cout << "\nSpeedup " << (flat.seconds > 0. ? hist.seconds / flat.seconds : 0.)
+              << ", mismatched feature points " << nMismatches
+              << ", largest relative difference of strength " << maxStrengthDiff << std::endl;
+
+    if (nMismatches > 0) return 1;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+} // main()
@@ -0,0 +1,127 @@
+/**
+ * @file   EventArena_test.cc
+ * @brief  Test of the event arena used by the Cluster3D containers
+ * @see    EventArena.h
+ */
+
+// C/C++ standard libraries
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( EventArena_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
+
+using lar_cluster3d::ArenaAllocator;
+using lar_cluster3d::EventArena;
+
+using IntList = std::list<int, ArenaAllocator<int>>;
+using IntMap  = std::unordered_map<int, IntList, std::hash<int>, std::equal_to<int>, ArenaAllocator<std::pair<const int, IntList>>>;
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(HeapWithoutScope)
+{
+  BOOST_TEST(EventArena::current() == nullptr);
+
+  IntList list;
+  for (int i = 0; i < 100; ++i) list.push_back(i);
+
+  IntMap map;
+  for (int i = 0; i < 100; ++i) map[i % 7].push_front(i);
+
+  BOOST_TEST(list.size() == 100U);
+  BOOST_TEST(map[3].size() == 14U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ScopedContainers)
+{
+  EventArena arena(4096);
+
+  for (int event = 0; event < 3; ++event) {
+    EventArena::Scope scope(arena);
+    BOOST_TEST(EventArena::current() == &arena);
+
+    IntList list;
+    IntMap  map;
+    for (int i = 0; i < 10000; ++i) {
+      list.push_back(i);
+      map[i % 97].push_back(i);
+    }
+
+    // the usual list operations across containers of the arena
+    IntList other;
+    other.splice(other.end(), list, list.begin(), std::next(list.begin(), 5000));
+    other.sort([](int left, int right){return left > right;});
+    list.remove_if([](int value){return value % 2 == 0;});
+
+    BOOST_TEST(other.front() == 4999);
+    BOOST_TEST(list.size() == 2500U);
+    BOOST_TEST(map[96].size() == 103U);
+    BOOST_TEST(arena.bytesReserved() > 0U);
+  }
+
+  // the arena is released and keeps a single chunk large enough for an event
+  BOOST_TEST(EventArena::current() == nullptr);
+  BOOST_TEST(arena.bytesReserved() == 0U);
+  BOOST_TEST(arena.highWaterMark() > 4096U);
+
+  size_t const highWaterMark = arena.highWaterMark();
+  {
+    EventArena::Scope scope(arena);
+    IntList list(1000, 1);
+  }
+  BOOST_TEST(arena.highWaterMark() == highWaterMark);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(MixedOrigins)
+{
+  EventArena arena(4096);
+
+  // a heap list can be freed in the scope and an arena list can be freed by another thread
+  IntList heapList(100, 2);
+  {
+    EventArena::Scope scope(arena);
+
+    IntList arenaList(100, 3);
+    heapList.clear();
+
+    std::thread([&arenaList]() { arenaList.clear(); }).join();
+
+    BOOST_TEST(arenaList.empty());
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ConcurrentScopes)
+{
+  EventArena arena(1024);
+
+  EventArena::Scope scope(arena);
+
+  std::vector<IntList> lists(4);
+  std::vector<std::thread> threads;
+
+  for (size_t idx = 0; idx < lists.size(); ++idx) {
+    threads.emplace_back([&arena, &lists, idx]() {
+      EventArena::Scope workerScope(arena);
+      for (int i = 0; i < 20000; ++i) lists[idx].push_back(int(idx) * 100000 + i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // the worker scopes ending does not release the arena while the outer one is open
+  for (size_t idx = 0; idx < lists.size(); ++idx) {
+    BOOST_TEST(lists[idx].size() == 20000U);
+    BOOST_TEST(lists[idx].back() == int(idx) * 100000 + 19999);
+  }
+  BOOST_TEST(arena.bytesReserved() > 0U);
+
+  for (auto& list : lists) list.clear();
+}
@@ -0,0 +1,259 @@
+/**
+ * @file   FlatKdTree_test.cc
+ * @brief  Test of the radius and k nearest neighbor queries of the flat kdTree
+ * @see    FlatKdTree.h
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( FlatKdTree_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// utility libraries
+#include "fhiclcpp/ParameterSet.h"
+
+using lar_cluster3d::FlatKdTree;
+
+namespace {
+
+  // hits scattered in a box, with some on top of each other and a dense track
+  reco::HitPairList makeHits(size_t nHits)
+  {
+    std::mt19937 rng(2468);
+    std::uniform_real_distribution<float> flat(-50., 50.);
+
+    reco::HitPairList hits;
+    for (size_t i = 0; i < nHits; ++i) {
+      Eigen::Vector3f position(flat(rng), flat(rng), flat(rng));
+      if (i % 5 == 0) position = Eigen::Vector3f(0.1 * i, 0.05 * i, 0.3 * (i % 50));
+      if (i % 17 == 0 && i > 0) position = hits.back().getPosition();
+      hits.emplace_back();
+      hits.back().setPosition(position);
+    }
+    return hits;
+  }
+
+  // hits along a few tracks in one TPC, with wires and peak times, some with wide peaks
+  reco::HitPairList makeTrackHits(size_t nTracks, size_t nHitsPerTrack)
+  {
+    std::mt19937 rng(1357);
+    std::uniform_real_distribution<float> flat(-20., 20.), smear(-0.15, 0.15);
+    std::uniform_real_distribution<float> sigma(0.5, 4.);
+
+    const float wirePitch  = 0.3;                      // cm
+    const float tickToX    = 0.05;                     // cm per tick
+    const float wireDir[3][2] = {{0.866, 0.5}, {0.866, -0.5}, {0., 1.}}; // (y, z) normal to the wires of each plane
+
+    reco::HitPairList hits;
+    for (size_t track = 0; track < nTracks; ++track) {
+      Eigen::Vector3f start(flat(rng), flat(rng), flat(rng));
+      Eigen::Vector3f direction(flat(rng), flat(rng), flat(rng));
+      direction.normalize();
+      for (size_t i = 0; i < nHitsPerTrack; ++i) {
+        Eigen::Vector3f position = start + 0.2 * i * direction + Eigen::Vector3f(smear(rng), smear(rng), smear(rng));
+        std::vector<geo::WireID> wireIDs;
+        for (unsigned int plane = 0; plane < 3; ++plane) {
+          float projection = wireDir[plane][0] * position[1] + wireDir[plane][1] * position[2];
+          wireIDs.emplace_back(0, 0, plane, unsigned(1000 + std::round(projection / wirePitch)));
+        }
+        hits.emplace_back(hits.size(), 0, position, 100., position[0] / tickToX, 0., sigma(rng), 1., 1., 0., 0., 0.,
+                          reco::ClusterHit2DVec(3, nullptr), std::vector<float>(3, 0.), wireIDs);
+      }
+    }
+    return hits;
+  }
+
+  FlatKdTree makeTree(size_t leafSize)
+  {
+    fhicl::ParameterSet pset;
+    pset.put("EnableMonitoring", false);
+    pset.put("LeafSize", leafSize);
+    return FlatKdTree(pset);
+  }
+
+  std::vector<float> bruteForceDist2(const reco::HitPairList& hits, const Eigen::Vector3f& point)
+  {
+    std::vector<float> dist2;
+    for (const auto& hit: hits) {
+      const Eigen::Vector3f delta = hit.getPosition() - point;
+      dist2.push_back(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+    }
+    std::sort(dist2.begin(), dist2.end());
+    return dist2;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RadiusMatchesBruteForce)
+{
+  reco::HitPairList hits = makeHits(2000);
+
+  for (size_t leafSize: {1, 8, 64}) {
+    FlatKdTree tree = makeTree(leafSize);
+    tree.BuildKdTree(hits);
+    BOOST_TEST(tree.size() == hits.size());
+
+    FlatKdTree::NeighborVec neighbors;
+    for (float radius: {0.5f, 3.f, 20.f}) {
+      for (const auto& hit: hits) {
+        tree.RadiusSearch(hit.getPosition(), radius, neighbors);
+
+        std::vector<float> expected = bruteForceDist2(hits, hit.getPosition());
+        expected.erase(std::upper_bound(expected.begin(), expected.end(), radius * radius), expected.end());
+
+        std::vector<float> found;
+        for (const auto& neighbor: neighbors) found.push_back(neighbor.dist2);
+        std::sort(found.begin(), found.end());
+
+        BOOST_TEST(found == expected, boost::test_tools::per_element());
+        BOOST_TEST(std::count_if(neighbors.begin(), neighbors.end(), [&](const auto& n){return n.hit == &hit;}) == 1);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(KNearestMatchesBruteForce)
+{
+  reco::HitPairList hits = makeHits(1500);
+
+  for (size_t leafSize: {1, 8}) {
+    FlatKdTree tree = makeTree(leafSize);
+    tree.BuildKdTree(hits);
+
+    FlatKdTree::NeighborVec neighbors;
+    for (size_t k: {1, 5, 32}) {
+      for (const auto& hit: hits) {
+        BOOST_TEST(tree.KNearest(hit.getPosition(), k, neighbors) == k);
+
+        std::vector<float> expected = bruteForceDist2(hits, hit.getPosition());
+        expected.resize(k);
+
+        std::vector<float> found;
+        for (const auto& neighbor: neighbors) found.push_back(neighbor.dist2);
+
+        // closest first
+        BOOST_TEST(found == expected, boost::test_tools::per_element());
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(BatchedMatchesSingle)
+{
+  reco::HitPairList hits = makeHits(1000);
+
+  FlatKdTree tree = makeTree(8);
+  tree.BuildKdTree(hits);
+
+  FlatKdTree::Hit3DVec queries;
+  for (const auto& hit: hits) queries.push_back(&hit);
+
+  FlatKdTree::OffsetVec   offsets;
+  FlatKdTree::NeighborVec batched, single;
+
+  tree.RadiusSearch(queries, 4., offsets, batched);
+  BOOST_TEST_REQUIRE(offsets.size() == queries.size() + 1);
+  for (size_t i = 0; i < queries.size(); ++i) {
+    tree.RadiusSearch(queries[i]->getPosition(), 4., single);
+    BOOST_TEST_REQUIRE(offsets[i + 1] - offsets[i] == single.size());
+    for (size_t j = 0; j < single.size(); ++j) BOOST_TEST(batched[offsets[i] + j].hit == single[j].hit);
+  }
+
+  tree.KNearest(queries, 6, offsets, batched);
+  BOOST_TEST(batched.size() == 6 * queries.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    tree.KNearest(queries[i]->getPosition(), 6, single);
+    for (size_t j = 0; j < single.size(); ++j) BOOST_TEST(batched[offsets[i] + j].dist2 == single[j].dist2);
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SmallTrees)
+{
+  FlatKdTree tree = makeTree(4);
+  FlatKdTree::NeighborVec neighbors;
+
+  tree.BuildKdTree(reco::HitPairList());
+  BOOST_TEST(tree.size() == 0U);
+  BOOST_TEST(tree.RadiusSearch(Eigen::Vector3f(0., 0., 0.), 10., neighbors) == 0U);
+  BOOST_TEST(tree.KNearest(Eigen::Vector3f(0., 0., 0.), 3, neighbors) == 0U);
+
+  reco::HitPairList hits = makeHits(3);
+  tree.BuildKdTree(hits);
+  BOOST_TEST(tree.numNodes() == 1U);
+  BOOST_TEST(tree.KNearest(Eigen::Vector3f(0., 0., 0.), 10, neighbors) == 3U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(KdTreeNeighborhoods)
+{
+  reco::HitPairList hits = makeTrackHits(20, 100);
+
+  const float refLeafBestDist = 0.6;
+
+  fhicl::ParameterSet pset;
+  pset.put("EnableMonitoring", false);
+  pset.put("PairSigmaPeakTime", 3.);
+  pset.put("RefLeafBestDist", refLeafBestDist);
+  lar_cluster3d::kdTree listTree(pset);
+
+  lar_cluster3d::kdTree::KdTreeNodeList nodes;
+  lar_cluster3d::kdTree::KdTreeNode     topNode = listTree.BuildKdTree(hits, nodes);
+
+  FlatKdTree flatTree = makeTree(8);
+  flatTree.BuildKdTree(hits);
+
+  FlatKdTree::NeighborVec buffer;
+  size_t nFound(0), nFarInX(0);
+
+  for (const auto& hit: hits) {
+    lar_cluster3d::kdTree::CandPairList listNeighbors, flatNeighbors;
+    float bestDist = std::numeric_limits<float>::max();
+
+    listTree.FindNearestNeighbors(&hit, topNode, listNeighbors, bestDist);
+    listTree.FindNearestNeighbors(&hit, flatTree, buffer, flatNeighbors);
+
+    // closest first
+    BOOST_TEST(std::is_sorted(flatNeighbors.begin(), flatNeighbors.end(),
+                              [](const auto& left, const auto& right){return left.first < right.first;}));
+
+    // the same hits, with the same separation, except for the list tree ones at least as far in x as the cut
+    size_t farInX(0);
+    for (const auto& neighbor: listNeighbors) {
+      auto flatItr = std::find_if(flatNeighbors.begin(), flatNeighbors.end(), [&](const auto& n){return n.second == neighbor.second;});
+      if (std::fabs(neighbor.second->getPosition()[0] - hit.getPosition()[0]) >= refLeafBestDist) {
+        BOOST_TEST((flatItr == flatNeighbors.end()));
+        farInX++;
+      }
+      else {
+        BOOST_TEST_REQUIRE((flatItr != flatNeighbors.end()));
+        BOOST_TEST(flatItr->first == neighbor.first);
+      }
+    }
+
+    // and no other hit
+    BOOST_TEST(flatNeighbors.size() == listNeighbors.size() - farInX);
+
+    nFound  += flatNeighbors.size();
+    nFarInX += farInX;
+  }
+
+  // most hits have neighbors
+  BOOST_TEST(nFound > hits.size());
+  BOOST_TEST_MESSAGE(nFound << " neighbors found in both trees, " << nFarInX << " far in x only by the list tree");
+}
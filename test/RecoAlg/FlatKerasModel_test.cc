@@ -0,0 +1,280 @@
+/**
+ * @file   FlatKerasModel_test.cc
+ * @brief  Test of the flat Keras inference engine against KerasModel, and of its binary format
+ * @see    keras_flat_model.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( FlatKerasModel_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_flat_model.h"
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_model.h"
+
+namespace {
+
+  using Patch = std::vector< std::vector<float> >;
+
+  std::mt19937 gen(1234);
+
+  /// writes n random weights as "[ w1 w2 ... ]", the format of dump_to_simple_cpp.py
+  void writeArray(std::ofstream& fout, size_t n, float scale) {
+    std::normal_distribution<float> dist(0., scale);
+    fout << "[";
+    for (size_t i = 0; i < n; ++i) fout << " " << dist(gen);
+    fout << "]\n";
+  }
+
+  void writeConv(std::ofstream& fout, size_t kernels, size_t depth, size_t rows, size_t cols, std::string const& border) {
+    fout << kernels << " " << depth << " " << rows << " " << cols << " " << border << "\n";
+    for (size_t i = 0; i < kernels * depth * rows; ++i) writeArray(fout, cols, 0.3);
+    writeArray(fout, kernels, 0.1);
+  }
+
+  void writeDense(std::ofstream& fout, size_t inputs, size_t neurons) {
+    fout << inputs << " " << neurons << "\n";
+    for (size_t i = 0; i < inputs; ++i) writeArray(fout, neurons, 0.3);
+    writeArray(fout, neurons, 0.1);
+  }
+
+  /// a small CNN with all the supported layers, "same" and "valid" borders and even kernels
+  std::string writeModel(std::string const& outAct) {
+    std::string const fname = "FlatKerasModel_test_" + outAct + ".nnet";
+    std::ofstream fout(fname);
+    fout << "layers 12\n";
+    fout << "layer 0 Convolution2D\n";  writeConv(fout, 5, 1, 3, 3, "same");
+    fout << "layer 1 Activation\nrelu\n";
+    fout << "layer 2 Convolution2D\n";  writeConv(fout, 4, 5, 3, 5, "valid");
+    fout << "layer 3 Activation\ntanh\n";
+    fout << "layer 4 Convolution2D\n";  writeConv(fout, 3, 4, 2, 2, "same");
+    fout << "layer 5 MaxPooling2D\n2 2\n";
+    fout << "layer 6 Dropout\n";
+    fout << "layer 7 Flatten\n";
+    fout << "layer 8 Dense\n";          writeDense(fout, 5 * 3 * 3, 9);
+    fout << "layer 9 Activation\nrelu\n";
+    fout << "layer 10 Dense\n";         writeDense(fout, 9, 3);
+    fout << "layer 11 Activation\n" << outAct << "\n";
+    return fname;
+  }
+
+  Patch randomPatch(size_t rows, size_t cols) {
+    std::uniform_real_distribution<float> dist(-1., 1.);
+    Patch patch(rows, std::vector<float>(cols));
+    for (auto& row : patch) for (auto& v : row) v = dist(gen);
+    return patch;
+  }
+
+  std::vector<float> referenceOutput(keras::KerasModel& model, Patch const& patch) {
+    keras::DataChunk2D sample;
+    sample.set_data(std::vector<Patch>(1, patch));
+    return model.compute_output(&sample);
+  }
+
+  void checkEqual(std::vector<float> const& result, std::vector<float> const& expected) {
+    BOOST_TEST_REQUIRE(result.size() == expected.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+      BOOST_TEST(std::abs(result[i] - expected[i]) < 1e-5);
+    }
+  }
+
+  void compareEngines(std::string const& outAct) {
+    std::string const fname = writeModel(outAct);
+    keras::KerasModel     model(fname);
+    keras::FlatKerasModel flatModel(fname);
+    std::remove(fname.c_str());
+
+    BOOST_TEST(flatModel.get_output_length() == 3);
+
+    // single patches, also changing the patch size
+    for (size_t rows : {12, 13}) {
+      Patch const patch = randomPatch(rows, 10);
+      checkEqual(flatModel.compute_output(patch), referenceOutput(model, patch));
+    }
+
+    // batch, of which only the first patches are requested
+    std::vector<Patch> patches;
+    for (size_t i = 0; i < 7; ++i) patches.push_back(randomPatch(12, 10));
+
+    auto const results = flatModel.compute_output(patches, 5);
+    BOOST_TEST_REQUIRE(results.size() == 5U);
+    for (size_t i = 0; i < results.size(); ++i) checkEqual(results[i], referenceOutput(model, patches[i]));
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SoftmaxOutput)
+{
+  compareEngines("softmax");
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SigmoidOutput)
+{
+  compareEngines("sigmoid");
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(PlanChanges)
+{
+  std::string const fname = writeModel("softmax");
+  keras::KerasModel     model(fname);
+  keras::FlatKerasModel flatModel(fname);
+  std::remove(fname.c_str());
+
+  // the workspace is planned again when the patch size changes, also for a smaller batch,
+  // and the larger batch that follows must not reuse it
+  for (auto const& step : { std::make_pair(12, 7), std::make_pair(13, 2), std::make_pair(13, 7), std::make_pair(12, 3) }) {
+    std::vector<Patch> patches;
+    for (int i = 0; i < step.second; ++i) patches.push_back(randomPatch(step.first, 10));
+
+    auto const results = flatModel.compute_output(patches, patches.size());
+    BOOST_TEST_REQUIRE(results.size() == patches.size());
+    for (size_t i = 0; i < results.size(); ++i) checkEqual(results[i], referenceOutput(model, patches[i]));
+  }
+
+  // a patch too small for the valid convolution is refused, and the last plan is still usable
+  BOOST_CHECK_THROW(flatModel.compute_output(randomPatch(2, 2)), std::runtime_error);
+  Patch const patch = randomPatch(12, 10);
+  checkEqual(flatModel.compute_output(patch), referenceOutput(model, patch));
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(MismatchedPatches)
+{
+  std::string const fname = writeModel("softmax");
+  keras::KerasModel     model(fname);
+  keras::FlatKerasModel flatModel(fname);
+  std::remove(fname.c_str());
+
+  // a later patch of the batch with more or fewer rows, or a longer or shorter row, is refused
+  for (auto const& size : { std::make_pair(13, 10), std::make_pair(11, 10), std::make_pair(12, 11), std::make_pair(12, 9) }) {
+    std::vector<Patch> patches(3, randomPatch(12, 10));
+    patches[1] = randomPatch(size.first, size.second);
+    BOOST_CHECK_THROW(flatModel.compute_output(patches, patches.size()), std::runtime_error);
+  }
+  Patch ragged = randomPatch(12, 10);
+  ragged[5].resize(12);
+  std::vector<Patch> patches(2, randomPatch(12, 10));
+  patches[1] = ragged;
+  BOOST_CHECK_THROW(flatModel.compute_output(patches, patches.size()), std::runtime_error);
+  BOOST_CHECK_THROW(flatModel.compute_output(ragged), std::runtime_error);
+
+  // patches beyond the requested samples are not used, and the model still works
+  patches[1] = randomPatch(20, 20);
+  auto const results = flatModel.compute_output(patches, 1);
+  BOOST_TEST_REQUIRE(results.size() == 1U);
+  checkEqual(results[0], referenceOutput(model, patches[0]));
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(BinaryFormat)
+{
+  std::string const fname = writeModel("softmax");
+  std::string const binName = fname + "b";
+
+  keras::FlatKerasModel textModel(fname);
+  textModel.save_binary(binName);
+
+  BOOST_TEST(!keras::FlatKerasModel::is_binary(fname));
+  BOOST_TEST(keras::FlatKerasModel::is_binary(binName));
+
+  // the weights are stored as they are used, so the outputs are exactly the same
+  {
+    keras::FlatKerasModel readModel(binName, false);
+    keras::FlatKerasModel mappedModel(binName, true);
+
+    std::vector<Patch> patches;
+    for (size_t i = 0; i < 4; ++i) patches.push_back(randomPatch(12, 10));
+
+    auto const expected = textModel.compute_output(patches, patches.size());
+    BOOST_TEST(readModel.compute_output(patches, patches.size()) == expected);
+    BOOST_TEST(mappedModel.compute_output(patches, patches.size()) == expected);
+  }
+
+  // a truncated file is refused
+  {
+    std::ifstream fin(binName, std::ios::binary);
+    std::string const data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    std::ofstream(binName, std::ios::binary) << data.substr(0, data.size() / 2);
+  }
+  BOOST_CHECK_THROW(keras::FlatKerasModel(binName, true), std::runtime_error);
+
+  std::remove(fname.c_str());
+  std::remove(binName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CorruptedBinary)
+{
+  std::string const fname = writeModel("softmax");
+  std::string const binName = fname + "b";
+  keras::FlatKerasModel(fname).save_binary(binName);
+
+  std::string data;
+  {
+    std::ifstream fin(binName, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+  }
+
+  // layout documented in keras_flat_model.h: 24 bytes of header, then 80 bytes per layer
+  size_t const headerSize = 24, recordSize = 80;
+  auto field32 = [&](std::string& d, size_t layer, size_t offset) -> uint32_t& {
+    return *reinterpret_cast<uint32_t*>(&d[headerSize + layer * recordSize + offset]);
+  };
+  auto field64 = [&](std::string& d, size_t layer, size_t offset) -> uint64_t& {
+    return *reinterpret_cast<uint64_t*>(&d[headerSize + layer * recordSize + offset]);
+  };
+  uint32_t const layers = *reinterpret_cast<uint32_t const*>(&data[16]);
+  size_t pooling = layers;
+  for (size_t i = 0; i < layers; ++i) if (field32(data, i, 0) == 1) pooling = i; // Op::MaxPooling
+  BOOST_TEST_REQUIRE(pooling < layers);
+
+  auto checkRefused = [&](std::string const& corrupted) {
+    std::ofstream(binName, std::ios::binary) << corrupted;
+    BOOST_CHECK_THROW(keras::FlatKerasModel(binName, false), std::runtime_error);
+    BOOST_CHECK_THROW(keras::FlatKerasModel(binName, true), std::runtime_error);
+  };
+
+  // pooling over no rows or columns
+  for (size_t offset : {36, 40}) {
+    std::string corrupted = data;
+    field32(corrupted, pooling, offset) = 0;
+    checkRefused(corrupted);
+  }
+
+  // weights or biases beyond the file, also with offset + size overflowing
+  {
+    std::string corrupted = data;
+    field64(corrupted, 0, 48) = uint64_t(-64);
+    checkRefused(corrupted);
+  }
+  {
+    std::string corrupted = data;
+    field64(corrupted, 0, 64) = (data.size() + 63) / 64 * 64;
+    checkRefused(corrupted);
+  }
+
+  // more layers than the file holds
+  {
+    std::string corrupted = data;
+    *reinterpret_cast<uint32_t*>(&corrupted[16]) = uint32_t(-1);
+    checkRefused(corrupted);
+  }
+
+  std::remove(fname.c_str());
+  std::remove(binName.c_str());
+}
@@ -0,0 +1,215 @@
+/**
+ * @file   HoughTransform_benchmark.cc
+ * @brief  Time of the Hough transform of recorded clusters, sparse against dense accumulator
+ *
+ * Usage: HoughTransform_benchmark <cluster file> <configuration.fcl>
+ *
+ * The cluster file is written by HoughBaseAlg with its ClusterDumpFile
+ * parameter set (e.g. in HoughLineFinder). The configuration is looked up in
+ * FHICL_FILE_PATH and should contain:
+ *
+ *     NumAngleCells:           20000     # as in HoughBaseAlg
+ *     RhoResolutionFactor:     5         # as in HoughBaseAlg
+ *     MaxDenseAccumulatorSize: 67108864  # as in HoughBaseAlg
+ *     MaxClusters:             0         # number of clusters to read, 0 for all
+ *     Repetitions:             1         # number of passes over the clusters
+ *     Seed:                    12345     # seed of the order the points are added in
+ *
+ * see houghtransform_benchmark.fcl. The points of each cluster are added to
+ * the accumulator in a random order, as HoughBaseAlg does, then half of them
+ * are subtracted and the maximum of the accumulator is looked for. This is
+ * done with the sparse accumulator, with the dense one (falling back to the
+ * sparse one for the clusters too large) and with the dense one transforming
+ * the clusters concurrently. The time per point and angle is reported, and the
+ * maxima found by each accumulator are checked to be the same.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/HoughBaseAlg.h"
+#include "larreco/RecoAlg/HoughClusterIO.h"
+
+//------------------------------------------------------------------------------
+namespace {
+
+  /// Configuration of the accumulators
+  struct TransformConfig {
+    unsigned int numAngleCells;
+    float        rhoResolutionFactor;
+    size_t       maxDenseSize; ///< 0 for the sparse accumulator
+  };
+
+  /// Maxima returned while adding the points, and the final one
+  using Maxima = std::vector<std::array<int, 3>>;
+
+  /// Transforms the cluster with points in the specified order, returns whether the accumulator was dense
+  bool transform(cluster::HoughClusterPoints const& cluster, std::vector<size_t> const& order,
+                 TransformConfig const& config, Maxima& maxima) {
+    cluster::HoughTransform c;
+    if (config.maxDenseSize == 0) {
+      c.Init(cluster.dx, cluster.dy, config.rhoResolutionFactor, config.numAngleCells);
+    }
+    else {
+      // the box of the points that can be accumulated, as HoughBaseAlg does
+      int xMin = cluster.dx, xMax = 0, yMin = cluster.dy, yMax = 0;
+      for (auto const& point : cluster.points) {
+        if ((point.first < 0) || (point.first > (int) cluster.dx) || (point.second < 0) || (point.second > (int) cluster.dy)) continue;
+        xMin = std::min(xMin, point.first);
+        xMax = std::max(xMax, point.first);
+        yMin = std::min(yMin, point.second);
+        yMax = std::max(yMax, point.second);
+      }
+      if ((xMin > xMax) || (yMin > yMax))
+        c.Init(cluster.dx, cluster.dy, config.rhoResolutionFactor, config.numAngleCells);
+      else
+        c.Init(cluster.dx, cluster.dy, config.rhoResolutionFactor, config.numAngleCells, xMin, xMax, yMin, yMax, config.maxDenseSize);
+    }
+
+    maxima.clear();
+    for (size_t index : order) maxima.push_back(c.AddPointReturnMax(cluster.points[index].first, cluster.points[index].second));
+    for (size_t i = 0; i < order.size() / 2; ++i) c.SubtractPoint(cluster.points[order[i]].first, cluster.points[order[i]].second);
+
+    std::array<int, 3> max {{ 0, 0, 0 }};
+    max[0] = c.GetMax(max[1], max[2]);
+    maxima.push_back(max);
+
+    return c.IsDense();
+  }
+
+  /// Accumulated cost of one way of transforming all the clusters
+  struct StepStats {
+    std::string         name;
+    double              seconds = 0.;
+    size_t              nDense  = 0;
+    std::vector<Maxima> maxima;
+  };
+
+  /// Runs func nRepeat times, adding the mean time to stats
+  template <typename Func>
+  void timeStep(StepStats& stats, size_t nRepeat, Func func) {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) func();
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / nRepeat;
+  }
+
+  void printHeader() {
+    std::cout << "\n"
+              << std::left << std::setw(28) << "accumulator"
+              << std::right << std::setw(14) << "total ms"
+              << std::setw(16) << "ns/(point*angle)"
+              << std::setw(10) << "dense"
+              << std::setw(14) << "mismatches" << std::endl;
+  }
+
+  void printStats(StepStats const& stats, double nPointAngles, StepStats const& reference) {
+    size_t nMismatches = 0;
+    for (size_t i = 0; i < stats.maxima.size(); ++i)
+      if (stats.maxima[i] != reference.maxima[i]) ++nMismatches;
+
+    std::cout << std::left << std::setw(28) << stats.name
+              << std::right << std::setprecision(4)
+              << std::setw(14) << 1.e3 * stats.seconds
+              << std::setw(16) << (nPointAngles > 0. ? 1.e9 * stats.seconds / nPointAngles : 0.)
+              << std::setw(10) << stats.nDense
+              << std::setw(14) << nMismatches << std::endl;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <cluster file> <configuration.fcl>" << std::endl;
+    return 1;
+  }
+
+  try {
+    cet::filepath_lookup_after1 policy("FHICL_FILE_PATH");
+    fhicl::ParameterSet config;
+    fhicl::make_ParameterSet(argv[2], policy, config);
+
+    TransformConfig const sparseConfig {
+      config.get<unsigned int>("NumAngleCells", 20000),
+      config.get<float>("RhoResolutionFactor", 5.),
+      0
+    };
+    TransformConfig denseConfig = sparseConfig;
+    denseConfig.maxDenseSize = std::max(config.get<size_t>("MaxDenseAccumulatorSize", 1UL << 26), size_t(1));
+    size_t const nRepeat = std::max(config.get<size_t>("Repetitions", 1), size_t(1));
+
+    std::vector<cluster::HoughClusterPoints> const clusters = cluster::ReadHoughClusters(argv[1], config.get<size_t>("MaxClusters", 0));
+
+    // the order the points are added in, the same for all the accumulators
+    std::mt19937 random(config.get<unsigned int>("Seed", 12345));
+    std::vector<std::vector<size_t>> orders(clusters.size());
+    size_t nPoints = 0;
+    for (size_t iCluster = 0; iCluster < clusters.size(); ++iCluster) {
+      orders[iCluster].resize(clusters[iCluster].points.size());
+      std::iota(orders[iCluster].begin(), orders[iCluster].end(), size_t(0));
+      std::shuffle(orders[iCluster].begin(), orders[iCluster].end(), random);
+      nPoints += orders[iCluster].size();
+    }
+
+    std::cout << "Read " << clusters.size() << " clusters, " << nPoints << " points, from " << argv[1] << std::endl;
+
+    StepStats sparse{"sparse"}, dense{"dense"}, parallel{"dense, concurrent clusters"};
+    for (StepStats* stats : {&sparse, &dense, &parallel}) stats->maxima.resize(clusters.size());
+
+    timeStep(sparse, nRepeat, [&]() {
+      for (size_t iCluster = 0; iCluster < clusters.size(); ++iCluster)
+        transform(clusters[iCluster], orders[iCluster], sparseConfig, sparse.maxima[iCluster]);
+    });
+
+    timeStep(dense, nRepeat, [&]() {
+      dense.nDense = 0;
+      for (size_t iCluster = 0; iCluster < clusters.size(); ++iCluster)
+        if (transform(clusters[iCluster], orders[iCluster], denseConfig, dense.maxima[iCluster])) ++dense.nDense;
+    });
+
+    std::vector<char> isDense(clusters.size(), 0);
+    timeStep(parallel, nRepeat, [&]() {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, clusters.size(), 1),
+        [&](const tbb::blocked_range<size_t>& range) {
+          for (size_t iCluster = range.begin(); iCluster != range.end(); ++iCluster)
+            isDense[iCluster] = transform(clusters[iCluster], orders[iCluster], denseConfig, parallel.maxima[iCluster]);
+        });
+    });
+    parallel.nDense = std::count(isDense.begin(), isDense.end(), 1);
+
+    double const nPointAngles = double(nPoints) * sparseConfig.numAngleCells;
+
+    printHeader();
+    for (StepStats const* stats : {&sparse, &dense, &parallel}) printStats(*stats, nPointAngles, sparse);
+
+    std::cout << "\nDense speedup " << (dense.seconds > 0. ? sparse.seconds / dense.seconds : 0.)
+              << ", with concurrent clusters " << (parallel.seconds > 0. ? sparse.seconds / parallel.seconds : 0.) << std::endl;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+} // main()
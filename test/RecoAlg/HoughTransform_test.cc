@@ -0,0 +1,136 @@
+/**
+ * @file   HoughTransform_test.cc
+ * @brief  Test of the dense Hough transform accumulator against the sparse one
+ * @see    HoughBaseAlg.h
+ *
+ * Points on generated lines, with some noise, are added to both accumulators
+ * in a random order, as HoughBaseAlg does, and then half of them are
+ * subtracted. The maxima returned while adding, the final maximum and the
+ * counters around it must be the same.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( HoughTransform_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/HoughBaseAlg.h"
+
+// utility libraries
+#include "cetlib_except/exception.h"
+
+namespace {
+
+  unsigned int const dx = 400;   // wires
+  unsigned int const dy = 3000;  // ticks
+  float const rhoResolutionFactor = 5.;
+  unsigned int const numAngleCells = 2000;
+
+  using Points = std::vector<std::pair<int, int>>;
+
+  /// A few lines in a corner of the plane, with noise points around them (all in the plane)
+  Points makePoints(std::mt19937& random)
+  {
+    std::uniform_real_distribution<double> start(0., 100.), angle(0., M_PI), length(20., 120.);
+    std::uniform_int_distribution<int> noise(0, 150), nLines(1, 4);
+
+    Points points;
+    int const n = nLines(random);
+    for (int iLine = 0; iLine < n; ++iLine) {
+      double const x0 = 150. + start(random), y0 = 500. + 5. * start(random);
+      double const a = angle(random), l = length(random);
+      for (double s = 0.; s < l; s += 1.)
+        points.emplace_back(int(x0 + s * std::cos(a)), int(y0 + 8. * s * std::sin(a)));
+    }
+    for (int i = 0; i < 30; ++i) points.emplace_back(100 + noise(random), 500 + 5 * noise(random));
+    return points;
+  }
+
+  /// Initializes the transform as HoughBaseAlg does, dense if maxDenseCells allows
+  void init(cluster::HoughTransform& c, Points const& points, size_t maxDenseCells)
+  {
+    if (maxDenseCells == 0) {
+      c.Init(dx, dy, rhoResolutionFactor, numAngleCells);
+      return;
+    }
+    int xMin = dx, xMax = 0, yMin = dy, yMax = 0;
+    for (auto const& point : points) {
+      xMin = std::min(xMin, point.first);
+      xMax = std::max(xMax, point.first);
+      yMin = std::min(yMin, point.second);
+      yMax = std::max(yMax, point.second);
+    }
+    c.Init(dx, dy, rhoResolutionFactor, numAngleCells, xMin, xMax, yMin, yMax, maxDenseCells);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(DenseMatchesSparse)
+{
+  std::mt19937 random(24680);
+
+  for (int iCluster = 0; iCluster < 10; ++iCluster) {
+    Points const points = makePoints(random);
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::shuffle(order.begin(), order.end(), random);
+
+    cluster::HoughTransform sparse, dense;
+    init(sparse, points, 0);
+    init(dense, points, 1UL << 26);
+    BOOST_TEST(!sparse.IsDense());
+    BOOST_TEST_REQUIRE(dense.IsDense());
+
+    for (size_t index : order) {
+      std::array<int, 3> const sparseMax = sparse.AddPointReturnMax(points[index].first, points[index].second);
+      std::array<int, 3> const denseMax = dense.AddPointReturnMax(points[index].first, points[index].second);
+      BOOST_TEST(sparseMax == denseMax, boost::test_tools::per_element());
+    }
+
+    for (size_t i = 0; i < order.size() / 2; ++i) {
+      auto const& point = points[order[i]];
+      BOOST_TEST(sparse.SubtractPoint(point.first, point.second) == dense.SubtractPoint(point.first, point.second));
+    }
+
+    int sparseAngle = 0, sparseDist = 0, denseAngle = 0, denseDist = 0;
+    int const sparsePeak = sparse.GetMax(sparseAngle, sparseDist);
+    int const densePeak = dense.GetMax(denseAngle, denseDist);
+    BOOST_TEST(sparsePeak > 0);
+    BOOST_TEST(densePeak == sparsePeak);
+    BOOST_TEST(denseAngle == sparseAngle);
+    BOOST_TEST(denseDist == sparseDist);
+
+    // the counters around the peak
+    int const lastAngle = std::min(sparseAngle + 3, int(numAngleCells) - 1);
+    for (int angle = std::max(sparseAngle - 3, 0); angle <= lastAngle; ++angle)
+      for (int dist = sparseDist - 10; dist <= sparseDist + 10; ++dist)
+        BOOST_TEST(dense.GetCell(angle, dist) == sparse.GetCell(angle, dist));
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(DenseLimits)
+{
+  std::mt19937 random(13579);
+  Points const points = makePoints(random);
+
+  // too large to be dense: the sparse accumulator is used
+  cluster::HoughTransform c;
+  init(c, points, 1);
+  BOOST_TEST(!c.IsDense());
+
+  // points outside the box of the dense accumulator are rejected
+  init(c, points, 1UL << 26);
+  BOOST_TEST_REQUIRE(c.IsDense());
+  BOOST_CHECK_THROW(c.AddPointReturnMax(dx, dy), cet::exception);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file   TrajectoryMCSFitter_test.cc
+ * @brief  Test of the coarse-to-fine likelihood scan and of the tabulated energy loss of TrajectoryMCSFitter
+ * @see    TrajectoryMCSFitter.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( TrajectoryMCSFitter_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/TrajectoryMCSFitter.h"
+
+namespace {
+
+  /// fitter with the settings of mcsfitproducer.fcl
+  trkf::TrajectoryMCSFitter makeFitter(int eLossMode, int pCoarseStepFactor, bool eLossTable) {
+    return trkf::TrajectoryMCSFitter(13, 3, 14.0, 2, 10, eLossMode, 0.01, 7.50, 0.01, 3.0, pCoarseStepFactor, eLossTable);
+  }
+
+  /// scattering angles (mrad) of a track with momentum p, in segments of 1 radiation length
+  void makeTrack(std::mt19937& gen, double p, size_t nseg, std::vector<float>& dtheta, std::vector<float>& radl, std::vector<float>& cumLen) {
+    std::normal_distribution<double> theta(0., 13.6 / p);
+    for (size_t i = 0; i < nseg; ++i) {
+      dtheta.push_back(std::abs(theta(gen)));
+      radl.push_back(1.0);
+      cumLen.push_back(14.0 * i);
+    }
+  }
+
+  void compareScans(int eLossMode) {
+    std::mt19937 gen(4321);
+    auto const reference = makeFitter(eLossMode, 1, false);
+    auto const fast      = makeFitter(eLossMode, 10, true);
+
+    for (double p : {0.3, 0.8, 1.5, 3.0}) {
+      std::vector<float> dtheta, radl, cumLen;
+      makeTrack(gen, p, 20, dtheta, radl, cumLen);
+      for (bool fwd : {true, false}) {
+        auto const expected = reference.doLikelihoodScan(dtheta, radl, cumLen, fwd, true, 13);
+        auto const result   = fast.doLikelihoodScan(dtheta, radl, cumLen, fwd, true, 13);
+        BOOST_TEST(std::abs(result.p - expected.p) < 1e-6);
+        BOOST_TEST(std::abs(result.pUnc - expected.pUnc) < 1e-6);
+        BOOST_TEST(std::abs(result.logL - expected.logL) < 1e-3);
+      }
+    }
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(TabulatedEnergyLoss)
+{
+  auto const exact = makeFitter(0, 1, false);
+  auto const table = makeFitter(0, 1, true);
+  for (int pid : {13, 211, 321, 2212}) {
+    double const m = exact.mass(pid);
+    for (double e = m + 0.05; e < 7.; e += 0.25) {
+      for (double len : {1., 14., 100., 400.}) {
+        BOOST_TEST(std::abs(table.GetE(e, len, m) - exact.GetE(e, len, m)) < 1e-4);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(LandauScan)
+{
+  compareScans(0);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(BetheBlochScan)
+{
+  compareScans(2);
+}
@@ -0,0 +1,206 @@
+/**
+ * @file   kdTree_benchmark.cc
+ * @brief  Build and query times of the Cluster3D kdTree and FlatKdTree on recorded 3D hits
+ *
+ * Usage: kdTree_benchmark <3D hit file> <configuration.fcl>
+ *
+ * The 3D hit file is written by the Cluster3D module with its Hit3DDumpFile
+ * parameter set. The configuration is looked up in FHICL_FILE_PATH and should
+ * contain:
+ *
+ *     kdTree:       { ... }   # configuration of the original kdTree
+ *     FlatKdTree:   { ... }   # configuration of the FlatKdTree (LeafSize)
+ *     Radius:       1.        # radius of the FlatKdTree radius queries (cm)
+ *     KNearest:     8         # number of neighbors of the k nearest queries
+ *     MaxEvents:    0         # number of events to read, 0 for all
+ *     Repetitions:  1         # number of passes over each event
+ *
+ * see kdtree_benchmark.fcl. For every event both trees are built from the
+ * HitPairList and queried once for each of its hits, the original one with
+ * FindNearestNeighbors() as DBScanAlg and MinSpanTreeAlg use it, the flat one
+ * with batched radius and k nearest neighbor queries. The time per hit, the
+ * number of heap allocations per hit and the mean number of neighbors found
+ * are reported.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/ClusterHit3DIO.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+
+//------------------------------------------------------------------------------
+// count the heap allocations done by the trees
+namespace {
+  std::atomic<size_t> gNumAllocations{0};
+}
+
+void* operator new(std::size_t size) {
+  ++gNumAllocations;
+  if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+//------------------------------------------------------------------------------
+namespace {
+
+  /// Accumulated cost of one step over all the events
+  struct StepStats {
+    std::string name;
+    double      seconds      = 0.;
+    size_t      nAllocations = 0;
+    size_t      nNeighbors   = 0;
+  };
+
+  /// Runs func nRepeat times, adding the mean time and the allocations of the first pass to stats
+  template <typename Func>
+  void timeStep(StepStats& stats, size_t nRepeat, Func func) {
+    auto const start = std::chrono::steady_clock::now();
+
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) {
+      size_t const nAllocStart = gNumAllocations;
+
+      size_t const nNeighbors = func();
+
+      if (repeat == 0) {
+        stats.nAllocations += gNumAllocations - nAllocStart;
+        stats.nNeighbors   += nNeighbors;
+      }
+    }
+
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / nRepeat;
+  }
+
+  void printHeader() {
+    std::cout << "\n"
+              << std::left << std::setw(24) << "step"
+              << std::right << std::setw(14) << "total ms"
+              << std::setw(12) << "ns/hit"
+              << std::setw(14) << "allocs/hit"
+              << std::setw(14) << "<neighbors>" << std::endl;
+  }
+
+  void printStats(StepStats const& stats, size_t nHits) {
+    std::cout << std::left << std::setw(24) << stats.name
+              << std::right << std::setprecision(4)
+              << std::setw(14) << 1.e3 * stats.seconds
+              << std::setw(12) << (nHits > 0 ? 1.e9 * stats.seconds / nHits : 0.)
+              << std::setw(14) << (nHits > 0 ? double(stats.nAllocations) / nHits : 0.)
+              << std::setw(14) << (nHits > 0 ? double(stats.nNeighbors) / nHits : 0.) << std::endl;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <3D hit file> <configuration.fcl>" << std::endl;
+    return 1;
+  }
+
+  try {
+    cet::filepath_lookup_after1 policy("FHICL_FILE_PATH");
+    fhicl::ParameterSet config;
+    fhicl::make_ParameterSet(argv[2], policy, config);
+
+    float  const radius    = config.get<float> ("Radius",   1.);
+    size_t const kNearest  = config.get<size_t>("KNearest", 8);
+    size_t const nRepeat   = std::max(config.get<size_t>("Repetitions", 1), size_t(1));
+
+    std::vector<reco::HitPairList> const events = lar_cluster3d::ReadClusterHit3Ds(argv[1], config.get<size_t>("MaxEvents", 0));
+
+    size_t nHits(0);
+    for (auto const& hitPairList : events) nHits += hitPairList.size();
+
+    std::cout << "Read " << events.size() << " events, " << nHits << " 3D hits, from " << argv[1] << std::endl;
+
+    lar_cluster3d::kdTree     listTree(config.get<fhicl::ParameterSet>("kdTree"));
+    lar_cluster3d::FlatKdTree flatTree(config.get<fhicl::ParameterSet>("FlatKdTree"));
+
+    StepStats listBuild{"kdTree build"}, listQuery{"kdTree neighbors"};
+    StepStats flatBuild{"FlatKdTree build"}, flatRadius{"FlatKdTree radius"}, flatKNN{"FlatKdTree k nearest"};
+
+    // The buffers are reused across queries and events, as a caller of the flat tree would
+    lar_cluster3d::FlatKdTree::Hit3DVec    queries;
+    lar_cluster3d::FlatKdTree::OffsetVec   offsets;
+    lar_cluster3d::FlatKdTree::NeighborVec neighbors;
+
+    for (auto const& hitPairList : events) {
+
+      // The original tree, built into a node list (freed as the tools do) and queried once per hit
+      timeStep(listBuild, nRepeat, [&]() {
+        lar_cluster3d::kdTree::KdTreeNodeList nodeList;
+        listTree.BuildKdTree(hitPairList, nodeList);
+        return size_t(0);
+      });
+
+      lar_cluster3d::kdTree::KdTreeNodeList nodeList;
+      lar_cluster3d::kdTree::KdTreeNode     topNode = listTree.BuildKdTree(hitPairList, nodeList);
+
+      timeStep(listQuery, nRepeat, [&]() {
+        size_t nFound(0);
+        for (auto const& hit : hitPairList) {
+          lar_cluster3d::kdTree::CandPairList candPairList;
+          float                               bestDistance(std::numeric_limits<float>::max());
+
+          nFound += listTree.FindNearestNeighbors(&hit, topNode, candPairList, bestDistance);
+        }
+        return nFound;
+      });
+
+      // The flat tree with batched queries
+      timeStep(flatBuild, nRepeat, [&]() {
+        flatTree.BuildKdTree(hitPairList);
+        return size_t(0);
+      });
+
+      queries.clear();
+      for (auto const& hit : hitPairList) queries.push_back(&hit);
+
+      timeStep(flatRadius, nRepeat, [&]() {
+        flatTree.RadiusSearch(queries, radius, offsets, neighbors);
+        return neighbors.size();
+      });
+
+      timeStep(flatKNN, nRepeat, [&]() {
+        flatTree.KNearest(queries, kNearest, offsets, neighbors);
+        return neighbors.size();
+      });
+    }
+
+    printHeader();
+    for (StepStats const* stats : {&listBuild, &listQuery, &flatBuild, &flatRadius, &flatKNN}) printStats(*stats, nHits);
+
+    std::cout << "\nBuild speedup " << (flatBuild.seconds > 0. ? listBuild.seconds / flatBuild.seconds : 0.)
+              << ", query speedup (radius " << radius << ") " << (flatRadius.seconds > 0. ? listQuery.seconds / flatRadius.seconds : 0.) << std::endl;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+} // main()
@@ -0,0 +1,116 @@
+/**
+ * @file   kerasLoad_benchmark.cc
+ * @brief  Startup time of the Keras models: text parsing against the binary format
+ *
+ * Usage: kerasLoad_benchmark <model.nnet> [<patch rows> <patch cols> [<repetitions>]]
+ *
+ * The text model (as written by dump_to_simple_cpp.py) is loaded with KerasModel
+ * and FlatKerasModel, converted to the binary format next to the original file
+ * (<model.nnet>b, removed at the end) and loaded from it with a single read and
+ * memory-mapped. The mean load time of each is reported. If the patch size is
+ * given, all the models are also run on one random patch and the largest
+ * difference to the KerasModel output is printed.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// LArSoft libraries
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_flat_model.h"
+#include "larreco/RecoAlg/ImagePatternAlgs/Keras/keras_model.h"
+
+//------------------------------------------------------------------------------
+namespace {
+
+  using Patch = std::vector< std::vector<float> >;
+
+  /// mean time in ms of nRepeat calls to load(), the model of the last one is kept
+  template <typename Model, typename Load>
+  double timeLoad(std::unique_ptr<Model>& model, size_t nRepeat, Load load) {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) {
+      model.reset();
+      model = load();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / nRepeat;
+  }
+
+  double maxDifference(std::vector<float> const& a, std::vector<float> const& b) {
+    if (a.size() != b.size()) return HUGE_VAL;
+    double diff = 0.;
+    for (size_t i = 0; i < a.size(); ++i) diff = std::max(diff, double(std::abs(a[i] - b[i])));
+    return diff;
+  }
+
+} // local namespace
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <model.nnet> [<patch rows> <patch cols> [<repetitions>]]" << std::endl;
+    return 1;
+  }
+
+  std::string const textName = argv[1];
+  std::string const binName  = textName + "b";
+  size_t const rows    = (argc > 3) ? std::atoi(argv[2]) : 0;
+  size_t const cols    = (argc > 3) ? std::atoi(argv[3]) : 0;
+  size_t const nRepeat = (argc > 4) ? std::max(std::atoi(argv[4]), 1) : 3;
+
+  try {
+    std::unique_ptr<keras::KerasModel>     textModel;
+    std::unique_ptr<keras::FlatKerasModel> flatTextModel, readModel, mappedModel;
+
+    double const textMs     = timeLoad(textModel, nRepeat, [&]() { return std::make_unique<keras::KerasModel>(textName); });
+    double const flatTextMs = timeLoad(flatTextModel, nRepeat, [&]() { return std::make_unique<keras::FlatKerasModel>(textName); });
+
+    flatTextModel->save_binary(binName);
+
+    double const readMs   = timeLoad(readModel, nRepeat, [&]() { return std::make_unique<keras::FlatKerasModel>(binName, false); });
+    double const mappedMs = timeLoad(mappedModel, nRepeat, [&]() { return std::make_unique<keras::FlatKerasModel>(binName, true); });
+
+    std::cout << "\n" << std::left << std::setw(32) << "loader" << std::right << std::setw(12) << "ms" << std::endl;
+    std::cout << std::left << std::setw(32) << "KerasModel text" << std::right << std::setw(12) << textMs << std::endl;
+    std::cout << std::left << std::setw(32) << "FlatKerasModel text" << std::right << std::setw(12) << flatTextMs << std::endl;
+    std::cout << std::left << std::setw(32) << "FlatKerasModel binary read" << std::right << std::setw(12) << readMs << std::endl;
+    std::cout << std::left << std::setw(32) << "FlatKerasModel binary mapped" << std::right << std::setw(12) << mappedMs << std::endl;
+    std::cout << "\nSpeedup of binary read " << (readMs > 0. ? textMs / readMs : 0.)
+              << ", mapped " << (mappedMs > 0. ? textMs / mappedMs : 0.) << std::endl;
+
+    if (rows && cols) {
+      std::mt19937 gen(12345);
+      std::uniform_real_distribution<float> dist(0., 1.);
+      Patch patch(rows, std::vector<float>(cols));
+      for (auto& row : patch) for (auto& v : row) v = dist(gen);
+
+      keras::DataChunk2D sample;
+      sample.set_data(std::vector<Patch>(1, patch));
+      auto const expected = textModel->compute_output(&sample);
+
+      std::cout << "Max output difference to KerasModel: text " << maxDifference(flatTextModel->compute_output(patch), expected)
+                << ", read " << maxDifference(readModel->compute_output(patch), expected)
+                << ", mapped " << maxDifference(mappedModel->compute_output(patch), expected) << std::endl;
+    }
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    std::remove(binName.c_str());
+    return 1;
+  }
+
+  std::remove(binName.c_str());
+  return 0;
+} // main()
@@ -0,0 +1,174 @@
+/**
+ * @file   FlatSolver_test.cc
+ * @brief  Test of the array-based SpacePointSolver minimizer
+ * @see    FlatSolver.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( FlatSolver_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/SpacePointSolver/FlatSolver.h"
+#include "larreco/SpacePointSolver/NeighbourSearch.h"
+#include "larreco/SpacePointSolver/Solver.h"
+
+namespace {
+
+  /// A random system of collection wires each crossing a few induction wires,
+  /// built the same way as SpacePointSolver::BuildSystem()
+  struct TestSystem
+  {
+    std::vector<std::unique_ptr<InductionWireHit>> iwireStore;
+    std::vector<std::unique_ptr<CollectionWireHit>> cwireStore;
+    std::vector<std::unique_ptr<SpaceCharge>> orphanStore;
+
+    std::vector<CollectionWireHit*> cwires;
+    std::vector<SpaceCharge*> orphanSCs;
+    NeighbourList neighbours;
+
+    explicit TestSystem(bool incNei)
+    {
+      std::mt19937 rng(4321);
+      std::uniform_real_distribution<double> flat(0., 1.);
+
+      const int nU = 60, nV = 60, nX = 80;
+      for (int i = 0; i < nU + nV; ++i)
+        iwireStore.push_back(std::make_unique<InductionWireHit>(i, 100. * flat(rng)));
+
+      std::vector<SpaceCharge*> spaceCharges;
+      for (int x = 0; x < nX; ++x) {
+        std::vector<SpaceCharge*> scs;
+        for (int u = 0; u < nU; ++u) {
+          const int v = (x + 2 * u) % nV;
+          if ((x + u) % 9 != 0) continue;
+          scs.push_back(new SpaceCharge(0.7 * x, 0.3 * u, 0.3 * v, nullptr,
+                                        iwireStore[u].get(), iwireStore[nU + v].get()));
+        }
+        if (scs.empty()) continue;
+        cwireStore.push_back(std::make_unique<CollectionWireHit>(nU + nV + x, 150. * flat(rng), scs));
+        for (SpaceCharge* sc: scs) sc->fCWire = cwireStore.back().get();
+        cwires.push_back(cwireStore.back().get());
+        spaceCharges.insert(spaceCharges.end(), scs.begin(), scs.end());
+      }
+
+      for (int i = 0; i < 10; ++i) {
+        orphanStore.push_back(std::make_unique<SpaceCharge>(60. + i, 0.3 * i, 0.5 * i, nullptr,
+                                                            iwireStore[i].get(), iwireStore[nU + 3 * i].get()));
+        orphanSCs.push_back(orphanStore.back().get());
+        spaceCharges.push_back(orphanSCs.back());
+      }
+
+      if (!incNei) return;
+      NeighbourSearchStats stats;
+      FindNeighboursCellList(spaceCharges, 5., neighbours, stats);
+      neighbours.Finalize();
+      for (SpaceCharge* sc: spaceCharges)
+        for (Neighbour& nei: sc->fNeighbours)
+          sc->fNeiPotential += nei.fCoupling * nei.fSC->fPred;
+    }
+
+    std::vector<double> Preds() const
+    {
+      std::vector<double> ret;
+      for (CollectionWireHit* cwire: cwires)
+        for (SpaceCharge* sc: cwire->fCrossings) ret.push_back(sc->fPred);
+      for (SpaceCharge* sc: orphanSCs) ret.push_back(sc->fPred);
+      for (auto const& iwire: iwireStore) ret.push_back(iwire->fPred);
+      return ret;
+    }
+  };
+
+  void CheckSame(std::vector<double> const& a, std::vector<double> const& b, double tol)
+  {
+    BOOST_TEST_REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+      BOOST_TEST(std::abs(a[i] - b[i]) <= tol * (1. + std::abs(a[i])));
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SerialMatchesPointerSolver)
+{
+  // The arithmetic is the same, but some sums are in a different order (the
+  // induction wires of Metric() are added up in array rather than pointer
+  // order), so the results only agree within rounding
+  const double tol = 1e-9;
+
+  for (double alpha: {0., 0.05}) {
+    TestSystem ptrSys(alpha != 0), flatSys(alpha != 0);
+    FlatSolver solver(flatSys.cwires, flatSys.orphanSCs);
+
+    BOOST_TEST(solver.NCollectionWires() == flatSys.cwires.size());
+    BOOST_TEST(std::abs(solver.Metric(alpha) - Metric(ptrSys.cwires, alpha)) <= tol * std::abs(Metric(ptrSys.cwires, alpha)));
+
+    for (int i = 0; i < 5; ++i) {
+      Iterate(ptrSys.cwires, ptrSys.orphanSCs, alpha);
+      solver.Iterate(alpha);
+      const double ptrMetric = Metric(ptrSys.cwires, alpha);
+      BOOST_TEST(std::abs(solver.Metric(alpha) - ptrMetric) <= tol * std::abs(ptrMetric));
+    }
+
+    solver.WriteBack();
+    CheckSame(ptrSys.Preds(), flatSys.Preds(), tol);
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ParallelConverges)
+{
+  const double alpha = 0.05;
+
+  TestSystem serialSys(true), parallelSys(true);
+  FlatSolver serial(serialSys.cwires, serialSys.orphanSCs);
+  FlatSolver parallel(parallelSys.cwires, parallelSys.orphanSCs);
+
+  double prevMetric = parallel.Metric(alpha);
+  for (int i = 0; i < 20; ++i) {
+    serial.Iterate(alpha);
+    parallel.IterateParallel(alpha);
+    const double metric = parallel.Metric(alpha);
+    BOOST_TEST(metric <= prevMetric + 1e-9 * std::abs(prevMetric));
+    prevMetric = metric;
+  }
+  BOOST_TEST(parallel.NColours() > 1U);
+  BOOST_TEST(parallel.NColours() < parallel.NCollectionWires());
+
+  // the visiting order differs, but both reach the same minimum
+  BOOST_TEST(std::abs(parallel.Metric(alpha) - serial.Metric(alpha)) <= 1e-2 * std::abs(serial.Metric(alpha)));
+
+  // charge is only moved between crossings of each collection wire
+  parallel.WriteBack();
+  for (CollectionWireHit* cwire: parallelSys.cwires) {
+    double sum = 0;
+    for (SpaceCharge* sc: cwire->fCrossings) {
+      BOOST_TEST(sc->fPred >= 0.);
+      sum += sc->fPred;
+    }
+    BOOST_TEST(std::abs(sum - cwire->fCharge) <= 1e-9 * cwire->fCharge);
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ParallelIsReproducible)
+{
+  const double alpha = 0.05;
+
+  TestSystem sys1(true), sys2(true);
+  FlatSolver solver1(sys1.cwires, sys1.orphanSCs);
+  FlatSolver solver2(sys2.cwires, sys2.orphanSCs);
+  for (int i = 0; i < 5; ++i) {
+    solver1.IterateParallel(alpha);
+    solver2.IterateParallel(alpha);
+  }
+  solver1.WriteBack();
+  solver2.WriteBack();
+  CheckSame(sys1.Preds(), sys2.Preds(), 0.);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file   NeighbourSearch_test.cc
+ * @brief  Test of the SpacePointSolver neighbour searches
+ * @see    NeighbourSearch.h
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( NeighbourSearch_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/SpacePointSolver/NeighbourSearch.h"
+#include "larreco/SpacePointSolver/Solver.h"
+
+namespace {
+
+  constexpr double kCritDist = 5;
+
+  // space charges scattered around the origin, so that some cells are on
+  // either side of zero, plus some clumps with many neighbours
+  std::vector<std::unique_ptr<SpaceCharge>> makeSpaceCharges(unsigned int nPoints)
+  {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> flat(-40., 40.);
+    std::normal_distribution<double> clump(0., 2.);
+
+    std::vector<std::unique_ptr<SpaceCharge>> scs;
+    for (unsigned int i = 0; i < nPoints; ++i) {
+      double x = flat(rng), y = flat(rng), z = flat(rng);
+      if (i % 4 == 0) { x = 10. + clump(rng); y = -3. + clump(rng); z = clump(rng); }
+      scs.push_back(std::make_unique<SpaceCharge>(x, y, z, nullptr, nullptr, nullptr));
+      scs.back()->fPred = 1. + i % 7;
+    }
+    return scs;
+  }
+
+  std::vector<SpaceCharge*> pointers(std::vector<std::unique_ptr<SpaceCharge>> const& scs)
+  {
+    std::vector<SpaceCharge*> ret;
+    for (auto const& sc: scs) ret.push_back(sc.get());
+    return ret;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CellListMatchesMap)
+{
+  auto mapSCs = makeSpaceCharges(3000);
+  auto cellSCs = makeSpaceCharges(3000);
+
+  NeighbourList mapNeis, cellNeis;
+  NeighbourSearchStats mapStats, cellStats;
+  FindNeighboursMap(pointers(mapSCs), kCritDist, mapNeis, mapStats);
+  FindNeighboursCellList(pointers(cellSCs), kCritDist, cellNeis, cellStats);
+  mapNeis.Finalize();
+  cellNeis.Finalize();
+
+  BOOST_TEST(cellStats.nNeighbours == mapStats.nNeighbours);
+  BOOST_TEST(cellStats.nTests == mapStats.nTests);
+  BOOST_TEST(cellStats.nCells == mapStats.nCells);
+  BOOST_TEST(cellNeis.size() == mapNeis.size());
+  BOOST_TEST(cellNeis.size() > 0U);
+
+  // same neighbours with the same couplings in the same order
+  for (size_t i = 0; i < mapSCs.size(); ++i) {
+    auto const& mapRange = mapSCs[i]->fNeighbours;
+    auto const& cellRange = cellSCs[i]->fNeighbours;
+    BOOST_TEST_REQUIRE(cellRange.size() == mapRange.size());
+    for (size_t j = 0; j < mapRange.size(); ++j) {
+      size_t const mapIdx = std::find_if(mapSCs.begin(), mapSCs.end(), [&](auto const& sc){ return sc.get() == mapRange.begin()[j].fSC; }) - mapSCs.begin();
+      size_t const cellIdx = std::find_if(cellSCs.begin(), cellSCs.end(), [&](auto const& sc){ return sc.get() == cellRange.begin()[j].fSC; }) - cellSCs.begin();
+      BOOST_TEST(cellIdx == mapIdx);
+      BOOST_TEST(cellRange.begin()[j].fCoupling == mapRange.begin()[j].fCoupling);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CellListFindsAllPairs)
+{
+  auto scs = makeSpaceCharges(1000);
+
+  NeighbourList neis;
+  NeighbourSearchStats stats;
+  FindNeighboursCellList(pointers(scs), kCritDist, neis, stats);
+  neis.Finalize();
+
+  long nPairs = 0;
+  for (auto const& sc1: scs) {
+    for (auto const& sc2: scs) {
+      if (sc1 == sc2) continue;
+      double const dist2 = std::pow(sc1->fX - sc2->fX, 2) + std::pow(sc1->fY - sc2->fY, 2) + std::pow(sc1->fZ - sc2->fZ, 2);
+      if (dist2 > kCritDist * kCritDist) continue;
+      ++nPairs;
+      bool found = false;
+      for (Neighbour const& nei: sc1->fNeighbours) found |= (nei.fSC == sc2.get());
+      BOOST_TEST(found);
+    }
+  }
+  BOOST_TEST(stats.nNeighbours == nPairs);
+  BOOST_TEST(neis.MemoryUsage() >= nPairs * sizeof(Neighbour));
+}